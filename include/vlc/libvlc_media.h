@@ -139,6 +139,13 @@ typedef struct libvlc_media_stats_t
     float       f_send_bitrate;
 } libvlc_media_stats_t;
 
+typedef struct libvlc_media_prefetch_stats_t
+{
+    int64_t     i_hits;
+    int64_t     i_stalls;
+    int64_t     i_wasted_bytes;
+} libvlc_media_prefetch_stats_t;
+
 typedef struct libvlc_media_track_info_t
 {
     /* Codec fourcc */
@@ -637,6 +644,19 @@ LIBVLC_API libvlc_state_t libvlc_media_get_state(
 LIBVLC_API int libvlc_media_get_stats( libvlc_media_t *p_md,
                                            libvlc_media_stats_t *p_stats );
 
+/**
+ * Get the current statistics about the prefetch of the media
+ * \param p_md: media descriptor object
+ * \param p_stats: structure that contain the prefetch statistics
+ *                 (this structure must be allocated by the caller)
+ * \return true if the statistics are available, false otherwise
+ *
+ * \libvlc_return_bool
+ * \version LibVLC 3.0.0 and later.
+ */
+LIBVLC_API int libvlc_media_get_prefetch_stats( libvlc_media_t *p_md,
+                                   libvlc_media_prefetch_stats_t *p_stats );
+
 /* The following method uses libvlc_media_list_t, however, media_list usage is optionnal
  * and this is here for convenience */
 #define VLC_FORWARD_DECLARE_OBJECT(a) struct a
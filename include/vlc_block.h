@@ -142,6 +142,37 @@ VLC_API void block_Init( block_t *, void *, size_t );
  */
 VLC_API block_t *block_Alloc(size_t size) VLC_USED VLC_MALLOC;
 
+/**
+ * Block pool statistics.
+ *
+ * Counters of the size-class pool backing block_Alloc().
+ * They are process-wide and monotonic, except for the byte counts.
+ */
+typedef struct block_pool_stats_t
+{
+    uint64_t i_hits; /**< allocations served from the pool */
+    uint64_t i_misses; /**< poolable allocations that hit the heap */
+    uint64_t i_drops; /**< releases freed because the pool was full */
+    size_t   i_bytes_held; /**< bytes currently cached by the pool */
+    size_t   i_bytes_limit; /**< maximum bytes the pool may cache */
+} block_pool_stats_t;
+
+/**
+ * Caps the memory cached by the block_Alloc() pool.
+ *
+ * The pool and its limit are shared by the whole process. Cached blocks in
+ * excess of the new limit are freed; those cached by other threads once they
+ * next allocate or release a block.
+ *
+ * @param limit maximum cached bytes (0 disables pooling)
+ */
+VLC_API void block_PoolSetLimit(size_t limit);
+
+/**
+ * Gets a snapshot of the block_Alloc() pool statistics.
+ */
+VLC_API void block_PoolGetStats(block_pool_stats_t *);
+
 VLC_API block_t *block_TryRealloc(block_t *, ssize_t pre, size_t body) VLC_USED;
 
 /**
@@ -430,6 +461,24 @@ static inline block_t *block_ChainGather( block_t *p_list )
  */
 VLC_API block_fifo_t *block_FifoNew(void) VLC_USED VLC_MALLOC;
 
+/**
+ * Creates a FIFO queue of blocks with lock-free producers.
+ *
+ * This is a variant of block_FifoNew() for queues with any number of
+ * producers but a single consumer. Producers push onto a lock-free stack:
+ * block_FifoPut() does not take the FIFO lock unless the consumer is
+ * sleeping, and block_FifoGet() does not take the lock unless the queue is
+ * empty. The locked functions (vlc_fifo_QueueUnlocked() and so on) remain
+ * usable.
+ *
+ * @warning Blocks must only be dequeued by one thread at a time: either by a
+ * single thread calling block_FifoGet(), or while holding the FIFO lock.
+ * Likewise, only the consuming thread may call vlc_fifo_Wait().
+ *
+ * @return the FIFO or NULL on memory error
+ */
+VLC_API block_fifo_t *block_FifoNewMPSC(void) VLC_USED VLC_MALLOC;
+
 /**
  * Destroys a FIFO created by block_FifoNew().
  *
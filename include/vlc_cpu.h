@@ -65,8 +65,10 @@ VLC_API unsigned vlc_CPU(void);
 
 # ifdef __SSE2__
 #  define vlc_CPU_SSE2() (1)
+#  define VLC_SSE2
 # else
 #  define vlc_CPU_SSE2() ((vlc_CPU() & VLC_CPU_SSE2) != 0)
+#  define VLC_SSE2 __attribute__ ((__target__ ("sse2")))
 # endif
 
 # ifdef __SSE3__
@@ -107,8 +109,10 @@ VLC_API unsigned vlc_CPU(void);
 
 # ifdef __AVX2__
 #  define vlc_CPU_AVX2() (1)
+#  define VLC_AVX2
 # else
 #  define vlc_CPU_AVX2() ((vlc_CPU() & VLC_CPU_AVX2) != 0)
+#  define VLC_AVX2 __attribute__ ((__target__ ("avx2")))
 # endif
 
 # ifdef __3dNOW__
@@ -298,6 +298,43 @@ VLC_API void filter_DeleteBlend( filter_t * );
         return p_outpic;                                                \
     }
 
+/**
+ * Callback processing one horizontal band (slice) of a picture.
+ *
+ * \param opaque data passed to filter_RunSlices
+ * \param i_slice index of the slice, from 0 to i_slices - 1
+ * \param i_slices number of slices the picture is split into
+ */
+typedef void (*filter_slice_cb)( filter_t *, void *opaque,
+                                 unsigned i_slice, unsigned i_slices );
+
+/**
+ * It splits the processing of a picture across the filter threads.
+ *
+ * The callback is called once per slice, possibly concurrently from the
+ * threads shared by all the filters of the instance (see the
+ * "filter-threads" option). The calling thread processes slices too, and
+ * the function only returns once every slice has been processed.
+ *
+ * Slices must not depend on each other's output.
+ *
+ * \param i_max_slices upper bound on the number of slices
+ */
+VLC_API void filter_RunSlices( filter_t *, unsigned i_max_slices,
+                               filter_slice_cb, void *opaque );
+
+/**
+ * It returns the range of lines [*pi_first, *pi_last) covered by a slice
+ * of a plane of i_lines lines.
+ */
+static inline void filter_GetSliceLines( unsigned i_slice, unsigned i_slices,
+                                         int i_lines,
+                                         int *pi_first, int *pi_last )
+{
+    *pi_first = (int64_t)i_lines * i_slice / i_slices;
+    *pi_last = (int64_t)i_lines * (i_slice + 1) / i_slices;
+}
+
 /**
  * Filter chain management API
  * The filter chain management API is used to dynamically construct filters
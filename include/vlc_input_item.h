@@ -408,6 +408,11 @@ struct input_stats_t
     /* Aout */
     int64_t i_played_abuffers;
     int64_t i_lost_abuffers;
+
+    /* Prefetch */
+    int64_t i_prefetch_hits;
+    int64_t i_prefetch_stalls;
+    int64_t i_prefetch_wasted_bytes;
 };
 
 /**
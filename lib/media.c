@@ -727,6 +727,21 @@ int libvlc_media_get_stats( libvlc_media_t *p_md,
     return true;
 }
 
+int libvlc_media_get_prefetch_stats( libvlc_media_t *p_md,
+                                     libvlc_media_prefetch_stats_t *p_stats )
+{
+    if( !p_md->p_input_item )
+        return false;
+
+    input_stats_t *p_itm_stats = p_md->p_input_item->p_stats;
+    vlc_mutex_lock( &p_itm_stats->lock );
+    p_stats->i_hits = p_itm_stats->i_prefetch_hits;
+    p_stats->i_stalls = p_itm_stats->i_prefetch_stalls;
+    p_stats->i_wasted_bytes = p_itm_stats->i_prefetch_wasted_bytes;
+    vlc_mutex_unlock( &p_itm_stats->lock );
+    return true;
+}
+
 /**************************************************************************
  * event_manager
  **************************************************************************/
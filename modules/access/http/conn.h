@@ -34,6 +34,7 @@ struct vlc_http_conn_cbs
 {
     struct vlc_http_stream *(*stream_open)(struct vlc_http_conn *,
                                            const struct vlc_http_msg *);
+    bool (*busy)(struct vlc_http_conn *);
     void (*release)(struct vlc_http_conn *);
 };
 
@@ -49,6 +50,17 @@ vlc_http_stream_open(struct vlc_http_conn *conn, const struct vlc_http_msg *m)
     return conn->cbs->stream_open(conn, m);
 }
 
+/**
+ * Checks whether streams are open on a connection.
+ *
+ * An HTTP/1 connection carries only one stream at a time, and cannot be reused
+ * while it is busy.
+ */
+static inline bool vlc_http_conn_busy(struct vlc_http_conn *conn)
+{
+    return conn->cbs->busy(conn);
+}
+
 static inline void vlc_http_conn_release(struct vlc_http_conn *conn)
 {
     conn->cbs->release(conn);
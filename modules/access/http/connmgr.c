@@ -92,66 +92,150 @@ static char *vlc_http_proxy_find(const char *hostname, unsigned port,
 }
 
 
+/** Connections unused for that long are closed */
+#define VLC_HTTP_MGR_IDLE_TIMEOUT (30 * CLOCK_FREQ)
+
+/** Established connection, for reuse by later requests */
+struct vlc_http_mgr_conn
+{
+    struct vlc_http_mgr_conn *next;
+    struct vlc_http_conn *conn;
+    uint_fast64_t id; /**< Unique, unlike the conn pointer once released */
+    mtime_t last_used;
+    bool multiplex; /**< HTTP/2, otherwise one stream at a time (HTTP/1) */
+    bool secure;
+    unsigned port;
+    char host[];
+};
+
 struct vlc_http_mgr
 {
     vlc_object_t *obj;
     vlc_tls_creds_t *creds;
     struct vlc_http_cookie_jar_t *jar;
-    struct vlc_http_conn *conn;
+    vlc_mutex_t lock; /**< Protects creds, conns and next_id */
+    struct vlc_http_mgr_conn *conns;
+    uint_fast64_t next_id;
 };
 
-static struct vlc_http_conn *vlc_http_mgr_find(struct vlc_http_mgr *mgr,
-                                               const char *host, unsigned port)
+static int vlc_http_mgr_add(struct vlc_http_mgr *mgr, bool secure,
+                            const char *host, unsigned port,
+                            struct vlc_http_conn *conn, bool multiplex,
+                            uint_fast64_t *restrict idp)
 {
-    (void) host; (void) port;
-    return mgr->conn;
+    size_t len = strlen(host) + 1;
+    struct vlc_http_mgr_conn *c = malloc(sizeof (*c) + len);
+    if (unlikely(c == NULL))
+        return -1;
+
+    c->conn = conn;
+    c->id = ++mgr->next_id;
+    c->last_used = mdate();
+    c->multiplex = multiplex;
+    c->secure = secure;
+    c->port = port;
+    memcpy(c->host, host, len);
+    c->next = mgr->conns;
+    mgr->conns = c;
+    *idp = c->id;
+    return 0;
 }
 
-static void vlc_http_mgr_release(struct vlc_http_mgr *mgr,
-                                 struct vlc_http_conn *conn)
+static void vlc_http_mgr_remove(struct vlc_http_mgr_conn **restrict pp)
 {
-    assert(mgr->conn == conn);
-    mgr->conn = NULL;
+    struct vlc_http_mgr_conn *c = *pp;
 
-    vlc_http_conn_release(conn);
+    *pp = c->next;
+    vlc_http_conn_release(c->conn);
+    free(c);
 }
 
-static
-struct vlc_http_msg *vlc_http_mgr_reuse(struct vlc_http_mgr *mgr,
-                                        const char *host, unsigned port,
-                                        const struct vlc_http_msg *req)
+static void vlc_http_mgr_release(struct vlc_http_mgr *mgr, uint_fast64_t id)
 {
-    struct vlc_http_conn *conn = vlc_http_mgr_find(mgr, host, port);
-    if (conn == NULL)
-        return NULL;
+    for (struct vlc_http_mgr_conn **pp = &mgr->conns; *pp != NULL;
+         pp = &(*pp)->next)
+        if ((*pp)->id == id)
+        {
+            vlc_http_mgr_remove(pp);
+            return;
+        }
+    /* Already released by another request */
+}
 
-    struct vlc_http_stream *stream = vlc_http_stream_open(conn, req);
-    if (stream != NULL)
+/**
+ * Closes the connections that have not been used for a while.
+ * A connection with open streams is in use, whatever its last request.
+ */
+static void vlc_http_mgr_prune(struct vlc_http_mgr *mgr, mtime_t now)
+{
+    struct vlc_http_mgr_conn **pp = &mgr->conns;
+
+    while (*pp != NULL)
     {
-        struct vlc_http_msg *m = vlc_http_msg_get_initial(stream);
-        if (m != NULL)
-            return m;
+        struct vlc_http_mgr_conn *c = *pp;
+
+        if (vlc_http_conn_busy(c->conn))
+            c->last_used = now;
+        else if (c->last_used + VLC_HTTP_MGR_IDLE_TIMEOUT < now)
+        {
+            vlc_http_mgr_remove(pp);
+            continue;
+        }
+        pp = &c->next;
+    }
+}
 
-        /* NOTE: If the request were not idempotent, we would not know if it
-         * was processed by the other end. Thus POST is not used/supported so
-         * far, and CONNECT is treated as if it were idempotent (which works
-         * fine here). */
+static
+struct vlc_http_stream *vlc_http_mgr_reuse(struct vlc_http_mgr *mgr,
+                                           bool secure,
+                                           const char *host, unsigned port,
+                                           const struct vlc_http_msg *req,
+                                           uint_fast64_t *restrict idp)
+{
+    struct vlc_http_mgr_conn **pp = &mgr->conns;
+
+    while (*pp != NULL)
+    {
+        struct vlc_http_mgr_conn *c = *pp;
+
+        if (c->secure != secure || c->port != port || strcmp(c->host, host))
+        {
+            pp = &c->next;
+            continue;
+        }
+
+        /* Streams are only opened with the lock held, so an HTTP/1
+         * connection cannot become busy between the check and the open.
+         * A busy one is left open for its current request. */
+        if (!c->multiplex && vlc_http_conn_busy(c->conn))
+        {
+            pp = &c->next;
+            continue;
+        }
+
+        struct vlc_http_stream *stream = vlc_http_stream_open(c->conn, req);
+        if (stream != NULL)
+        {
+            c->last_used = mdate();
+            *idp = c->id;
+            return stream;
+        }
+        /* Get rid of closing or reset connection. Open streams, if any,
+         * keep it alive until they are closed. */
+        vlc_http_mgr_remove(pp);
     }
-    /* Get rid of closing or reset connection */
-    vlc_http_mgr_release(mgr, conn);
     return NULL;
 }
 
-static struct vlc_http_msg *vlc_https_request(struct vlc_http_mgr *mgr,
+static struct vlc_http_stream *vlc_https_open(struct vlc_http_mgr *mgr,
                                               const char *host, unsigned port,
-                                              const struct vlc_http_msg *req)
+                                              const struct vlc_http_msg *req,
+                                              uint_fast64_t *restrict idp,
+                                              bool *restrict reused)
 {
     vlc_tls_t *tls;
     bool http2 = true;
 
-    if (mgr->creds == NULL && mgr->conn != NULL)
-        return NULL; /* switch from HTTP to HTTPS not implemented */
-
     if (mgr->creds == NULL)
     {   /* First TLS connection: load x509 credentials */
         mgr->creds = vlc_tls_ClientCreate(mgr->obj);
@@ -160,9 +244,14 @@ static struct vlc_http_msg *vlc_https_request(struct vlc_http_mgr *mgr,
     }
 
     /* TODO? non-idempotent request support */
-    struct vlc_http_msg *resp = vlc_http_mgr_reuse(mgr, host, port, req);
-    if (resp != NULL)
-        return resp; /* existing connection reused */
+    struct vlc_http_stream *stream = vlc_http_mgr_reuse(mgr, true, host, port,
+                                                        req, idp);
+    if (stream != NULL)
+    {
+        *reused = true;
+        return stream; /* existing connection reused */
+    }
+    *reused = false;
 
     char *proxy = vlc_http_proxy_find(host, port, true);
     if (proxy != NULL)
@@ -197,24 +286,35 @@ static struct vlc_http_msg *vlc_https_request(struct vlc_http_mgr *mgr,
         return NULL;
     }
 
-    mgr->conn = conn;
+    if (unlikely(vlc_http_mgr_add(mgr, true, host, port, conn, http2, idp)))
+    {
+        vlc_http_conn_release(conn);
+        return NULL;
+    }
 
-    return vlc_http_mgr_reuse(mgr, host, port, req);
+    /* The new connection is not shared yet */
+    stream = vlc_http_stream_open(conn, req);
+    if (stream == NULL)
+        vlc_http_mgr_release(mgr, *idp);
+    return stream;
 }
 
-static struct vlc_http_msg *vlc_http_request(struct vlc_http_mgr *mgr,
+static struct vlc_http_stream *vlc_http_open(struct vlc_http_mgr *mgr,
                                              const char *host, unsigned port,
-                                             const struct vlc_http_msg *req)
+                                             const struct vlc_http_msg *req,
+                                             uint_fast64_t *restrict idp,
+                                             bool *restrict reused)
 {
-    if (mgr->creds != NULL && mgr->conn != NULL)
-        return NULL; /* switch from HTTPS to HTTP not implemented */
-
-    struct vlc_http_msg *resp = vlc_http_mgr_reuse(mgr, host, port, req);
-    if (resp != NULL)
-        return resp;
+    struct vlc_http_stream *stream = vlc_http_mgr_reuse(mgr, false, host, port,
+                                                        req, idp);
+    if (stream != NULL)
+    {
+        *reused = true;
+        return stream;
+    }
+    *reused = false;
 
     struct vlc_http_conn *conn;
-    struct vlc_http_stream *stream;
 
     char *proxy = vlc_http_proxy_find(host, port, false);
     if (proxy != NULL)
@@ -240,22 +340,57 @@ static struct vlc_http_msg *vlc_http_request(struct vlc_http_mgr *mgr,
     if (stream == NULL)
         return NULL;
 
-    resp = vlc_http_msg_get_initial(stream);
-    if (resp == NULL)
-    {
+    if (unlikely(vlc_http_mgr_add(mgr, false, host, port, conn, false, idp)))
+    {   /* Not reusable, it will close along with the stream */
         vlc_http_conn_release(conn);
-        return NULL;
+        *idp = 0;
     }
-
-    mgr->conn = conn;
-    return resp;
+    return stream;
 }
 
 struct vlc_http_msg *vlc_http_mgr_request(struct vlc_http_mgr *mgr, bool https,
                                           const char *host, unsigned port,
                                           const struct vlc_http_msg *m)
 {
-    return (https ? vlc_https_request : vlc_http_request)(mgr, host, port, m);
+    for (;;)
+    {
+        uint_fast64_t id;
+        struct vlc_http_stream *stream;
+        bool reused;
+
+        /* Only the connection lookup and setup is serialized. The response
+         * is waited for unlocked, so that requests share HTTP/2 connections
+         * concurrently. An HTTP/1 connection belongs to a single request
+         * until its stream is closed. The connection is then referred to by
+         * its identifier since another request may have released it
+         * meanwhile. */
+        vlc_mutex_lock(&mgr->lock);
+        vlc_http_mgr_prune(mgr, mdate());
+        stream = (https ? vlc_https_open : vlc_http_open)(mgr, host, port, m,
+                                                          &id, &reused);
+        vlc_mutex_unlock(&mgr->lock);
+
+        if (stream == NULL)
+            return NULL;
+
+        struct vlc_http_msg *resp = vlc_http_msg_get_initial(stream);
+        if (resp != NULL)
+            return resp;
+
+        /* NOTE: If the request were not idempotent, we would not know if it
+         * was processed by the other end. Thus POST is not used/supported so
+         * far, and CONNECT is treated as if it were idempotent (which works
+         * fine here). */
+        if (id != 0)
+        {   /* Get rid of closing or reset connection */
+            vlc_mutex_lock(&mgr->lock);
+            vlc_http_mgr_release(mgr, id);
+            vlc_mutex_unlock(&mgr->lock);
+        }
+
+        if (!reused)
+            return NULL;
+    }
 }
 
 struct vlc_http_cookie_jar_t *vlc_http_mgr_get_jar(struct vlc_http_mgr *mgr)
@@ -273,15 +408,18 @@ struct vlc_http_mgr *vlc_http_mgr_create(vlc_object_t *obj,
     mgr->obj = obj;
     mgr->creds = NULL;
     mgr->jar = jar;
-    mgr->conn = NULL;
+    vlc_mutex_init(&mgr->lock);
+    mgr->conns = NULL;
+    mgr->next_id = 0;
     return mgr;
 }
 
 void vlc_http_mgr_destroy(struct vlc_http_mgr *mgr)
 {
-    if (mgr->conn != NULL)
-        vlc_http_mgr_release(mgr, mgr->conn);
+    while (mgr->conns != NULL)
+        vlc_http_mgr_remove(&mgr->conns);
     if (mgr->creds != NULL)
         vlc_tls_Delete(mgr->creds);
+    vlc_mutex_destroy(&mgr->lock);
     free(mgr);
 }
@@ -39,6 +39,11 @@ struct vlc_http_cookie_jar_t;
  * establishing a new one. If succesful, the initial HTTP response header is
  * returned.
  *
+ * Connections are kept per server, and this function can be called from
+ * several threads at once: concurrent requests to the same server are then
+ * multiplexed over a single HTTP/2 connection when available. Otherwise, each
+ * of them gets its own HTTP/1 connection, which is reused once idle.
+ *
  * @param mgr HTTP connection manager
  * @param https whether to use HTTPS (true) or unencrypted HTTP (false)
  * @param host name of authoritative HTTP server to send the request to
@@ -0,0 +1,260 @@
+/*****************************************************************************
+ * connmgr_test.c: HTTP connection manager tests
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#undef NDEBUG
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <sys/types.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#ifndef SOCK_CLOEXEC
+# define SOCK_CLOEXEC 0
+# define accept4(a,b,c,d) accept(a,b,c)
+#endif
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include <vlc_fs.h>
+#include "connmgr.h"
+#include "message.h"
+
+#define CLIENTS 4
+#define REQUESTS 50
+#define SERVERS_MAX (CLIENTS * REQUESTS)
+
+static const char body[] = "Hello world!";
+
+static vlc_mutex_t lock = VLC_STATIC_MUTEX;
+static vlc_thread_t servers[SERVERS_MAX];
+static unsigned connection_count = 0;
+
+/* Answers the requests of a connection until the client closes it */
+static void *server_thread(void *data)
+{
+    int fd = (intptr_t)data;
+    char buf[1024];
+    size_t buflen = 0;
+
+    for (;;)
+    {
+        ssize_t val = recv(fd, buf + buflen, sizeof (buf) - buflen - 1, 0);
+        if (val <= 0)
+            break;
+        buflen += val;
+        buf[buflen] = '\0';
+
+        char *end = strstr(buf, "\r\n\r\n");
+        if (end == NULL)
+        {
+            assert(buflen < sizeof (buf) - 1);
+            continue;
+        }
+
+        assert(!strncmp(buf, "GET /test HTTP/1.1\r\n", 20));
+
+        char resp[128];
+        int len = snprintf(resp, sizeof (resp), "HTTP/1.1 200 OK\r\n"
+                           "Content-Length: %zu\r\n\r\n%s",
+                           strlen(body), body);
+        assert(len > 0 && (size_t)len < sizeof (resp));
+        val = send(fd, resp, len, MSG_NOSIGNAL);
+        assert(val == len);
+
+        /* GET requests have no body */
+        end += 4;
+        buflen -= end - buf;
+        memmove(buf, end, buflen);
+    }
+
+    vlc_close(fd);
+    return NULL;
+}
+
+static void *listen_thread(void *data)
+{
+    int lfd = (intptr_t)data;
+
+    for (;;)
+    {
+        int cfd = accept4(lfd, NULL, NULL, SOCK_CLOEXEC);
+        if (cfd == -1)
+            continue;
+
+        int canc = vlc_savecancel();
+        vlc_mutex_lock(&lock);
+        assert(connection_count < SERVERS_MAX);
+        if (vlc_clone(servers + connection_count, server_thread,
+                      (void *)(intptr_t)cfd, VLC_THREAD_PRIORITY_LOW))
+            assert(!"Thread error");
+        connection_count++;
+        vlc_mutex_unlock(&lock);
+        vlc_restorecancel(canc);
+    }
+    vlc_assert_unreachable();
+}
+
+static int server_socket(unsigned *port)
+{
+    int fd = socket(PF_INET6, SOCK_STREAM|SOCK_CLOEXEC, IPPROTO_TCP);
+    if (fd == -1)
+        return -1;
+
+    struct sockaddr_in6 addr = {
+        .sin6_family = AF_INET6,
+#ifdef HAVE_SA_LEN
+        .sin6_len = sizeof (addr),
+#endif
+        .sin6_addr = in6addr_loopback,
+    };
+    socklen_t addrlen = sizeof (addr);
+
+    if (bind(fd, (struct sockaddr *)&addr, addrlen)
+     || getsockname(fd, (struct sockaddr *)&addr, &addrlen))
+    {
+        vlc_close(fd);
+        return -1;
+    }
+
+    *port = ntohs(addr.sin6_port);
+    return fd;
+}
+
+struct client
+{
+    struct vlc_http_mgr *mgr;
+    unsigned port;
+    vlc_thread_t thread;
+};
+
+static void *client_thread(void *data)
+{
+    struct client *c = data;
+    char authority[32];
+
+    snprintf(authority, sizeof (authority), "[::1]:%u", c->port);
+
+    for (unsigned i = 0; i < REQUESTS; i++)
+    {
+        struct vlc_http_msg *req = vlc_http_req_create("GET", "http",
+                                                       authority, "/test");
+        assert(req != NULL);
+
+        struct vlc_http_msg *resp = vlc_http_mgr_request(c->mgr, false, "::1",
+                                                         c->port, req);
+        vlc_http_msg_destroy(req);
+        assert(resp != NULL);
+        assert(vlc_http_msg_get_status(resp) == 200);
+
+        char buf[sizeof (body)];
+        size_t len = 0;
+        block_t *b;
+
+        while ((b = vlc_http_msg_read(resp)) != NULL)
+        {
+            assert(b != vlc_http_error);
+            assert(len + b->i_buffer < sizeof (buf));
+            memcpy(buf + len, b->p_buffer, b->i_buffer);
+            len += b->i_buffer;
+            block_Release(b);
+        }
+        assert(len == strlen(body));
+        assert(!memcmp(buf, body, len));
+        vlc_http_msg_destroy(resp);
+    }
+    return NULL;
+}
+
+int main(void)
+{
+    struct client clients[CLIENTS];
+    unsigned port;
+
+    unsetenv("http_proxy");
+
+    int lfd = server_socket(&port);
+    if (lfd == -1)
+        return 77;
+
+    if (listen(lfd, 255))
+    {
+        vlc_close(lfd);
+        return 77;
+    }
+
+    vlc_thread_t th;
+    if (vlc_clone(&th, listen_thread, (void *)(intptr_t)lfd,
+                  VLC_THREAD_PRIORITY_LOW))
+        assert(!"Thread error");
+
+    struct vlc_http_mgr *mgr = vlc_http_mgr_create(NULL, NULL);
+    assert(mgr != NULL);
+
+    /* Test concurrent requests to the same server */
+    for (unsigned i = 0; i < CLIENTS; i++)
+    {
+        clients[i].mgr = mgr;
+        clients[i].port = port;
+        if (vlc_clone(&clients[i].thread, client_thread, clients + i,
+                      VLC_THREAD_PRIORITY_LOW))
+            assert(!"Thread error");
+    }
+
+    for (unsigned i = 0; i < CLIENTS; i++)
+        vlc_join(clients[i].thread, NULL);
+
+    /* Idle HTTP/1 connections are reused, busy ones are never shared */
+    vlc_mutex_lock(&lock);
+    assert(connection_count > 0);
+    assert(connection_count <= CLIENTS);
+    vlc_mutex_unlock(&lock);
+
+    /* Test sequential requests over a kept connection */
+    clients[0].mgr = mgr;
+    clients[0].port = port;
+    client_thread(clients);
+
+    vlc_mutex_lock(&lock);
+    assert(connection_count <= CLIENTS);
+    vlc_mutex_unlock(&lock);
+
+    vlc_http_mgr_destroy(mgr);
+
+    vlc_cancel(th);
+    vlc_join(th, NULL);
+
+    /* The server sees the connections closed by the manager */
+    for (unsigned i = 0; i < connection_count; i++)
+        vlc_join(servers[i], NULL);
+
+    vlc_close(lfd);
+    return 0;
+}
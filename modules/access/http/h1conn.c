@@ -113,10 +113,11 @@ struct vlc_h1_conn
     struct vlc_http_stream stream;
     uintmax_t content_length;
     bool connection_close;
-    bool active;
-    bool released;
+    bool active; /**< Stream open, the connection is owned by its reader */
+    bool released; /**< Connection released by owner */
     bool proxy;
     void *opaque;
+    vlc_mutex_t lock; /**< Protects active and released */
 };
 
 #define CO(conn) ((conn)->opaque)
@@ -147,24 +148,41 @@ static struct vlc_http_stream *vlc_h1_stream_open(struct vlc_http_conn *c,
     size_t len;
     ssize_t val;
 
+    vlc_mutex_lock(&conn->lock);
+    assert(!conn->released);
+    /* The TLS session is only changed by the stream, i.e. while active */
     if (conn->active || conn->conn.tls == NULL)
+    {
+        vlc_mutex_unlock(&conn->lock);
         return NULL;
+    }
+    conn->active = true;
+    vlc_mutex_unlock(&conn->lock);
 
     char *payload = vlc_http_msg_format(req, &len, conn->proxy);
     if (unlikely(payload == NULL))
-        return NULL;
+        goto error;
 
     vlc_http_dbg(CO(conn), "outgoing request:\n%.*s", (int)len, payload);
     val = vlc_tls_Write(conn->conn.tls, payload, len);
     free(payload);
 
     if (val < (ssize_t)len)
-        return vlc_h1_stream_fatal(conn);
+    {
+        vlc_h1_stream_fatal(conn);
+        goto error;
+    }
 
-    conn->active = true;
     conn->content_length = 0;
     conn->connection_close = false;
     return &conn->stream;
+
+error:
+    vlc_mutex_lock(&conn->lock);
+    conn->active = false;
+    assert(!conn->released);
+    vlc_mutex_unlock(&conn->lock);
+    return NULL;
 }
 
 static struct vlc_http_msg *vlc_h1_stream_wait(struct vlc_http_stream *stream)
@@ -271,15 +289,21 @@ static block_t *vlc_h1_stream_read(struct vlc_http_stream *stream)
 static void vlc_h1_stream_close(struct vlc_http_stream *stream, bool abort)
 {
     struct vlc_h1_conn *conn = vlc_h1_stream_conn(stream);
+    bool destroy;
 
     assert(conn->active);
 
-    if (abort)
+    /* Do not reuse the connection with an unread body pending */
+    if (abort || conn->connection_close
+     || (conn->content_length != 0 && conn->content_length != UINTMAX_MAX))
         vlc_h1_stream_fatal(conn);
 
+    vlc_mutex_lock(&conn->lock);
     conn->active = false;
+    destroy = conn->released;
+    vlc_mutex_unlock(&conn->lock);
 
-    if (conn->released)
+    if (destroy)
         vlc_h1_conn_destroy(conn);
 }
 
@@ -300,23 +324,40 @@ static void vlc_h1_conn_destroy(struct vlc_h1_conn *conn)
         vlc_tls_Shutdown(conn->conn.tls, true);
         vlc_tls_Close(conn->conn.tls);
     }
+    vlc_mutex_destroy(&conn->lock);
     free(conn);
 }
 
+static bool vlc_h1_conn_busy(struct vlc_http_conn *c)
+{
+    struct vlc_h1_conn *conn = container_of(c, struct vlc_h1_conn, conn);
+    bool busy;
+
+    vlc_mutex_lock(&conn->lock);
+    busy = conn->active;
+    vlc_mutex_unlock(&conn->lock);
+    return busy;
+}
+
 static void vlc_h1_conn_release(struct vlc_http_conn *c)
 {
     struct vlc_h1_conn *conn = container_of(c, struct vlc_h1_conn, conn);
+    bool destroy;
 
+    vlc_mutex_lock(&conn->lock);
     assert(!conn->released);
     conn->released = true;
+    destroy = !conn->active;
+    vlc_mutex_unlock(&conn->lock);
 
-    if (!conn->active)
+    if (destroy)
         vlc_h1_conn_destroy(conn);
 }
 
 static const struct vlc_http_conn_cbs vlc_h1_conn_callbacks =
 {
     vlc_h1_stream_open,
+    vlc_h1_conn_busy,
     vlc_h1_conn_release,
 };
 
@@ -333,6 +374,7 @@ struct vlc_http_conn *vlc_h1_conn_create(void *ctx, vlc_tls_t *tls, bool proxy)
     conn->released = false;
     conn->proxy = proxy;
     conn->opaque = ctx;
+    vlc_mutex_init(&conn->lock);
 
     return &conn->conn;
 }
@@ -710,9 +710,21 @@ static void vlc_h2_conn_release(struct vlc_http_conn *c)
         vlc_h2_conn_destroy(conn);
 }
 
+static bool vlc_h2_conn_busy(struct vlc_http_conn *c)
+{
+    struct vlc_h2_conn *conn = container_of(c, struct vlc_h2_conn, conn);
+    bool busy;
+
+    vlc_mutex_lock(&conn->lock);
+    busy = (conn->streams != NULL);
+    vlc_mutex_unlock(&conn->lock);
+    return busy;
+}
+
 static const struct vlc_http_conn_cbs vlc_h2_conn_callbacks =
 {
     vlc_h2_stream_open,
+    vlc_h2_conn_busy,
     vlc_h2_conn_release,
 };
 
@@ -100,6 +100,20 @@ static int rtp_timeout (mtime_t deadline)
     return t;
 }
 
+#ifdef HAVE_RECVMMSG
+/** Maximum number of datagrams received per system call */
+# define RTP_VLEN 32
+
+static void rtp_cleanup_blocks (void *data)
+{
+    block_t **blocks = data;
+
+    for (unsigned i = 0; i < RTP_VLEN; i++)
+        if (blocks[i] != NULL)
+            block_Release (blocks[i]);
+}
+#endif
+
 /**
  * RTP/RTCP session thread for datagram sockets
  */
@@ -109,6 +123,21 @@ void *rtp_dgram_thread (void *opaque)
     demux_sys_t *sys = demux->p_sys;
     mtime_t deadline = VLC_TS_INVALID;
     int rtp_fd = sys->fd;
+#ifdef HAVE_RECVMMSG
+    size_t mru = DEFAULT_MRU;
+    struct mmsghdr msgs[RTP_VLEN];
+    struct iovec iovecs[RTP_VLEN];
+    block_t *blocks[RTP_VLEN];
+
+    for (unsigned i = 0; i < RTP_VLEN; i++)
+    {
+        memset (&msgs[i], 0, sizeof (msgs[i]));
+        msgs[i].msg_hdr.msg_iov = &iovecs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        blocks[i] = NULL;
+    }
+    vlc_cleanup_push (rtp_cleanup_blocks, blocks);
+#else
     struct iovec iov =
     {
         .iov_len = DEFAULT_MRU,
@@ -118,6 +147,7 @@ void *rtp_dgram_thread (void *opaque)
         .msg_iov = &iov,
         .msg_iovlen = 1,
     };
+#endif
 
     struct pollfd ufd[1];
     ufd[0].fd = rtp_fd;
@@ -139,6 +169,70 @@ void *rtp_dgram_thread (void *opaque)
             if (unlikely(ufd[0].revents & POLLHUP))
                 break; /* RTP socket dead (DCCP only) */
 
+#ifdef HAVE_RECVMMSG
+            unsigned vlen = 0;
+
+            /* Refill the buffers consumed by the previous batch, if any */
+            while (vlen < RTP_VLEN)
+            {
+                if (blocks[vlen] == NULL)
+                {
+                    blocks[vlen] = block_Alloc (mru);
+                    if (unlikely(blocks[vlen] == NULL))
+                        break;
+                }
+                iovecs[vlen].iov_base = blocks[vlen]->p_buffer;
+                iovecs[vlen].iov_len = mru;
+                vlen++;
+            }
+
+            if (unlikely(vlen == 0))
+            {
+                if (mru == DEFAULT_MRU)
+                    break; /* we are totallly screwed */
+                mru = DEFAULT_MRU;
+                continue; /* retry with shrunk MRU */
+            }
+
+            int count = recvmmsg (rtp_fd, msgs, vlen,
+                                  MSG_DONTWAIT | MSG_TRUNC, NULL);
+            if (count == -1 && errno != EAGAIN)
+                msg_Warn (demux, "RTP network error: %s",
+                          vlc_strerror_c(errno));
+
+            size_t new_mru = mru;
+
+            for (int i = 0; i < count; i++)
+            {
+                block_t *block = blocks[i];
+                size_t len = msgs[i].msg_len;
+
+                blocks[i] = NULL;
+                /* Each buffer was received with its own size */
+                if (len > iovecs[i].iov_len)
+                {
+                    msg_Err(demux, "%zu bytes packet truncated (MRU was %zu)",
+                            len, iovecs[i].iov_len);
+                    block->i_flags |= BLOCK_FLAG_CORRUPTED;
+                    if (len > new_mru)
+                        new_mru = len;
+                    len = iovecs[i].iov_len;
+                }
+                block->i_buffer = len;
+                rtp_process (demux, block);
+            }
+
+            if (new_mru > mru)
+            {   /* Takes effect with the next buffers */
+                mru = new_mru;
+                for (unsigned j = 0; j < RTP_VLEN; j++)
+                    if (blocks[j] != NULL)
+                    {
+                        block_Release (blocks[j]);
+                        blocks[j] = NULL;
+                    }
+            }
+#else
             block_t *block = block_Alloc (iov.iov_len);
             if (unlikely(block == NULL))
             {
@@ -178,6 +272,7 @@ void *rtp_dgram_thread (void *opaque)
                           vlc_strerror_c(errno));
                 block_Release (block);
             }
+#endif
         }
 
     dequeue:
@@ -185,6 +280,10 @@ void *rtp_dgram_thread (void *opaque)
             deadline = VLC_TS_INVALID;
         vlc_restorecancel (canc);
     }
+#ifdef HAVE_RECVMMSG
+    vlc_cleanup_pop ();
+    rtp_cleanup_blocks (blocks);
+#endif
     return NULL;
 }
 
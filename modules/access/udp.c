@@ -76,11 +76,21 @@ vlc_module_begin ()
     set_callbacks( Open, Close )
 vlc_module_end ()
 
+#ifdef HAVE_RECVMMSG
+/** Maximum number of datagrams received per system call */
+# define UDP_VLEN 64
+#endif
+
 struct access_sys_t
 {
     int fd;
     int timeout;
     size_t mtu;
+#ifdef HAVE_RECVMMSG
+    block_t *batch; /**< spare receive buffer, large enough for UDP_VLEN */
+    struct mmsghdr msgs[UDP_VLEN];
+    struct iovec iovecs[UDP_VLEN];
+#endif
 };
 
 /*****************************************************************************
@@ -174,6 +184,15 @@ static int Open( vlc_object_t *p_this )
     if( sys->timeout > 0)
         sys->timeout *= 1000;
 
+#ifdef HAVE_RECVMMSG
+    sys->batch = NULL;
+    for( unsigned i = 0; i < UDP_VLEN; i++ )
+    {
+        memset( &sys->msgs[i], 0, sizeof (sys->msgs[i]) );
+        sys->msgs[i].msg_hdr.msg_iov = &sys->iovecs[i];
+        sys->msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+#endif
     return VLC_SUCCESS;
 }
 
@@ -185,6 +204,10 @@ static void Close( vlc_object_t *p_this )
     stream_t     *p_access = (stream_t*)p_this;
     access_sys_t *sys = p_access->p_sys;
 
+#ifdef HAVE_RECVMMSG
+    if( sys->batch != NULL )
+        block_Release( sys->batch );
+#endif
     net_Close( sys->fd );
 }
 
@@ -221,6 +244,113 @@ static int Control( stream_t *p_access, int i_query, va_list args )
 /*****************************************************************************
  * BlockUDP:
  *****************************************************************************/
+static int WaitUDP(stream_t *access, bool *restrict eof)
+{
+    access_sys_t *sys = access->p_sys;
+    struct pollfd ufd[1];
+
+    ufd[0].fd = sys->fd;
+    ufd[0].events = POLLIN;
+
+    switch (vlc_poll_i11e(ufd, 1, sys->timeout))
+    {
+        case 0:
+            msg_Err(access, "receive time-out");
+            *eof = true;
+            /* fall through */
+        case -1:
+            return -1;
+    }
+    return 0;
+}
+
+#ifdef HAVE_RECVMMSG
+/**
+ * Receives all pending datagrams (up to UDP_VLEN) with a single system call,
+ * and returns them concatenated within a single block. A full batch of
+ * 7x188 bytes TS datagrams thus yields one large block for the demuxer.
+ */
+static block_t *BlockUDP(stream_t *access, bool *restrict eof)
+{
+    access_sys_t *sys = access->p_sys;
+    const size_t mtu = sys->mtu;
+    block_t *pkt = sys->batch;
+
+    if (pkt != NULL && pkt->i_size < UDP_VLEN * mtu)
+    {   /* MTU grew since the buffer was allocated */
+        block_Release(pkt);
+        pkt = NULL;
+    }
+    if (pkt == NULL)
+    {
+        pkt = block_Alloc(UDP_VLEN * mtu);
+        if (unlikely(pkt == NULL))
+        {   /* OOM - dequeue and discard one packet */
+            char dummy;
+            recv(sys->fd, &dummy, 1, 0);
+            return NULL;
+        }
+    }
+    sys->batch = NULL;
+    pkt->i_buffer = UDP_VLEN * mtu;
+
+    if (WaitUDP(access, eof))
+        goto skip;
+
+    for (unsigned i = 0; i < UDP_VLEN; i++)
+    {
+        sys->iovecs[i].iov_base = pkt->p_buffer + i * mtu;
+        sys->iovecs[i].iov_len = mtu;
+    }
+
+    /* MSG_TRUNC: get the real length of oversized datagrams (Linux) */
+    int count = recvmmsg(sys->fd, sys->msgs, UDP_VLEN,
+                         MSG_DONTWAIT | MSG_TRUNC, NULL);
+    if (count <= 0)
+        goto skip;
+
+    size_t total = 0;
+    for (int i = 0; i < count; i++)
+    {
+        size_t len = sys->msgs[i].msg_len;
+
+        if (len > mtu || (sys->msgs[i].msg_hdr.msg_flags & MSG_TRUNC))
+        {
+            msg_Err(access, "%zu bytes packet truncated (MTU was %zu)",
+                    len, mtu);
+            pkt->i_flags |= BLOCK_FLAG_CORRUPTED;
+            if (len > sys->mtu)
+                sys->mtu = len;
+            len = mtu;
+        }
+
+        /* Close the gap left by short datagrams, if any */
+        if (total != i * mtu)
+            memmove(pkt->p_buffer + total, pkt->p_buffer + i * mtu, len);
+        total += len;
+    }
+
+    if (total < (UDP_VLEN * mtu) / 2)
+    {   /* Do not waste a large buffer on a few datagrams: copy them out
+         * and keep the buffer for the next batch. */
+        block_t *small = block_Alloc(total);
+        if (likely(small != NULL))
+        {
+            memcpy(small->p_buffer, pkt->p_buffer, total);
+            small->i_flags = pkt->i_flags;
+            pkt->i_flags = 0;
+            sys->batch = pkt;
+            return small;
+        }
+    }
+
+    pkt->i_buffer = total;
+    return pkt;
+skip:
+    sys->batch = pkt;
+    return NULL;
+}
+#else
 static block_t *BlockUDP(stream_t *access, bool *restrict eof)
 {
     access_sys_t *sys = access->p_sys;
@@ -245,20 +375,8 @@ static block_t *BlockUDP(stream_t *access, bool *restrict eof)
 #endif
     };
 
-    struct pollfd ufd[1];
-
-    ufd[0].fd = sys->fd;
-    ufd[0].events = POLLIN;
-
-    switch (vlc_poll_i11e(ufd, 1, sys->timeout))
-    {
-        case 0:
-            msg_Err(access, "receive time-out");
-            *eof = true;
-            /* fall through */
-        case -1:
-            goto skip;
-     }
+    if (WaitUDP(access, eof))
+        goto skip;
 
     ssize_t len = recvmsg(sys->fd, &msg, 0);
     if (len < 0)
@@ -282,3 +400,4 @@ skip:
 
     return pkt;
 }
+#endif
@@ -46,10 +46,18 @@
 #else
 #   include <sys/socket.h>
 #endif
+#ifdef HAVE_SENDMMSG
+#   include <sys/uio.h>
+#   include <netinet/udp.h>
+#endif
 
 #include <vlc_network.h>
 
 #define MAX_EMPTY_BLOCKS 200
+/** Maximum number of datagrams per batched system call */
+#define MAX_BATCH 64
+/** Maximum payload of a segmentation offload (GSO) super-packet */
+#define MAX_GSO_SIZE 65000
 
 /*****************************************************************************
  * Module descriptor
@@ -70,6 +78,15 @@ static void Close( vlc_object_t * );
                           "of packets that will be sent at a time. It " \
                           "helps reducing the scheduling load on " \
                           "heavily-loaded systems." )
+#define BATCH_TEXT N_("Batched transmission window (ms)")
+#define BATCH_LONGTEXT N_("Packets due within this time window are sent " \
+                          "together with a single system call, using UDP " \
+                          "segmentation offload where supported. " \
+                          "This reduces the system load with many or high " \
+                          "bit rate outputs. 0 sends packets one by one. " \
+                          "Packets carrying a clock reference are still " \
+                          "sent at their date. When packets are grouped, " \
+                          "each group is sent as a batch instead." )
 
 vlc_module_begin ()
     set_description( N_("UDP stream output") )
@@ -79,6 +96,11 @@ vlc_module_begin ()
     add_integer( SOUT_CFG_PREFIX "caching", DEFAULT_PTS_DELAY / 1000, CACHING_TEXT, CACHING_LONGTEXT, true )
     add_integer( SOUT_CFG_PREFIX "group", 1, GROUP_TEXT, GROUP_LONGTEXT,
                                  true )
+#ifdef HAVE_SENDMMSG
+    add_integer( SOUT_CFG_PREFIX "batch", 0, BATCH_TEXT, BATCH_LONGTEXT,
+                 true )
+        change_integer_range( 0, 1000 )
+#endif
 
     set_capability( "sout access", 0 )
     add_shortcut( "udp" )
@@ -92,6 +114,9 @@ vlc_module_end ()
 static const char *const ppsz_sout_options[] = {
     "caching",
     "group",
+#ifdef HAVE_SENDMMSG
+    "batch",
+#endif
     NULL
 };
 
@@ -107,6 +132,9 @@ static ssize_t Write   ( sout_access_out_t *, block_t * );
 static int Control( sout_access_out_t *, int, va_list );
 
 static void* ThreadWrite( void * );
+#ifdef HAVE_SENDMMSG
+static void* ThreadWriteBatch( void * );
+#endif
 static block_t *NewUDPPacket( sout_access_out_t *, mtime_t );
 
 struct sout_access_out_sys_t
@@ -120,6 +148,18 @@ struct sout_access_out_sys_t
     block_fifo_t *p_empty_blocks;
     block_t      *p_buffer;
 
+#ifdef HAVE_SENDMMSG
+    mtime_t       i_batch_window;
+    bool          b_gso;
+# ifndef NDEBUG
+    /* Debug-only batching counters, logged when the output is closed; they
+     * are not exported as statistics. Written by the sending thread only,
+     * read after it is joined. */
+    uint64_t      i_sent_packets;
+    uint64_t      i_sent_calls;
+# endif
+#endif
+
     vlc_thread_t  thread;
 };
 
@@ -209,11 +249,24 @@ static int Open( vlc_object_t *p_this )
     p_sys->i_handle = i_handle;
     p_sys->i_mtu = var_CreateGetInteger( p_this, "mtu" );
     p_sys->b_mtu_warning = false;
-    p_sys->p_fifo = block_FifoNew();
-    p_sys->p_empty_blocks = block_FifoNew();
+    /* Both queues have a single consumer thread */
+    p_sys->p_fifo = block_FifoNewMPSC();
+    p_sys->p_empty_blocks = block_FifoNewMPSC();
     p_sys->p_buffer = NULL;
 
-    if( vlc_clone( &p_sys->thread, ThreadWrite, p_access,
+    void *(*thread)( void * ) = ThreadWrite;
+#ifdef HAVE_SENDMMSG
+    p_sys->i_batch_window = INT64_C(1000)
+                          * var_GetInteger( p_access, SOUT_CFG_PREFIX "batch" );
+    p_sys->b_gso = true;
+# ifndef NDEBUG
+    p_sys->i_sent_packets = p_sys->i_sent_calls = 0;
+# endif
+    if( p_sys->i_batch_window > 0 )
+        thread = ThreadWriteBatch;
+#endif
+
+    if( vlc_clone( &p_sys->thread, thread, p_access,
                            VLC_THREAD_PRIORITY_HIGHEST ) )
     {
         msg_Err( p_access, "cannot spawn sout access thread" );
@@ -240,6 +293,13 @@ static void Close( vlc_object_t * p_this )
 
     vlc_cancel( p_sys->thread );
     vlc_join( p_sys->thread, NULL );
+#if defined(HAVE_SENDMMSG) && !defined(NDEBUG)
+    if( p_sys->i_sent_calls > 0 )
+        msg_Dbg( p_access, "sent %"PRIu64" packets in %"PRIu64" system calls "
+                 "(%.2f packets per call)", p_sys->i_sent_packets,
+                 p_sys->i_sent_calls,
+                 (double)p_sys->i_sent_packets / p_sys->i_sent_calls );
+#endif
     block_FifoRelease( p_sys->p_fifo );
     block_FifoRelease( p_sys->p_empty_blocks );
 
@@ -453,3 +513,297 @@ static void* ThreadWrite( void *data )
     }
     return NULL;
 }
+
+#ifdef HAVE_SENDMMSG
+/* Accounts one system call sending the given number of packets */
+static inline void SentCount( sout_access_out_sys_t *p_sys, unsigned i_count )
+{
+#ifndef NDEBUG
+    p_sys->i_sent_calls++;
+    p_sys->i_sent_packets += i_count;
+#else
+    VLC_UNUSED(p_sys); VLC_UNUSED(i_count);
+#endif
+}
+
+#ifdef UDP_SEGMENT
+/**
+ * Sends packets of i_seg bytes (except the last one) as a single
+ * super-packet segmented by the kernel or the network interface.
+ * @return true if handled, false if the packets must be sent otherwise
+ */
+static bool SendGSORun( sout_access_out_t *p_access, block_t **pp_pk,
+                        unsigned i_count, size_t i_seg )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    struct iovec iov[MAX_BATCH];
+
+    assert( i_count <= MAX_BATCH );
+    for( unsigned i = 0; i < i_count; i++ )
+    {
+        iov[i].iov_base = pp_pk[i]->p_buffer;
+        iov[i].iov_len = pp_pk[i]->i_buffer;
+    }
+
+    union
+    {
+        char buf[CMSG_SPACE(sizeof (uint16_t))];
+        struct cmsghdr align;
+    } control;
+    struct msghdr msg = {
+        .msg_iov = iov,
+        .msg_iovlen = i_count,
+        .msg_control = control.buf,
+        .msg_controllen = sizeof (control.buf),
+    };
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR( &msg );
+
+    cmsg->cmsg_level = SOL_UDP;
+    cmsg->cmsg_type = UDP_SEGMENT;
+    cmsg->cmsg_len = CMSG_LEN(sizeof (uint16_t));
+    *(uint16_t *)CMSG_DATA(cmsg) = i_seg;
+
+    if( sendmsg( p_sys->i_handle, &msg, 0 ) >= 0 )
+    {
+        SentCount( p_sys, i_count );
+        return true;
+    }
+
+    switch( errno )
+    {
+        case EINVAL:
+        case EIO:
+        case ENOPROTOOPT:
+        case EOPNOTSUPP:
+            msg_Dbg( p_access, "UDP segmentation offload not supported: %s",
+                     vlc_strerror_c(errno) );
+            p_sys->b_gso = false;
+            return false;
+    }
+    msg_Warn( p_access, "send error: %s", vlc_strerror_c(errno) );
+    return true; /* do not send the same packets twice */
+}
+
+/**
+ * Sends packets of equal size (except the last one) as super-packets of
+ * at most MAX_GSO_SIZE bytes and MAX_BATCH segments each.
+ * @return the number of packets handled, the others must be sent otherwise
+ */
+static unsigned SendGSO( sout_access_out_t *p_access, block_t **pp_pk,
+                         unsigned i_count )
+{
+    const size_t i_seg = pp_pk[0]->i_buffer;
+
+    if( i_seg == 0 )
+        return 0;
+    for( unsigned i = 0; i < i_count; i++ )
+        if( i + 1 < i_count ? pp_pk[i]->i_buffer != i_seg
+                            : pp_pk[i]->i_buffer > i_seg )
+            return 0;
+
+    unsigned i_run = MAX_GSO_SIZE / i_seg;
+    if( i_run > MAX_BATCH )
+        i_run = MAX_BATCH;
+    if( i_run < 2 )
+        return 0;
+
+    unsigned i_done = 0;
+    while( i_done < i_count )
+    {
+        unsigned i_len = __MIN( i_run, i_count - i_done );
+
+        if( !SendGSORun( p_access, pp_pk + i_done, i_len, i_seg ) )
+            break;
+        i_done += i_len;
+    }
+    return i_done;
+}
+#endif
+
+static void SendBatch( sout_access_out_t *p_access, block_t **pp_pk,
+                       unsigned i_count )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    struct mmsghdr msgs[MAX_BATCH];
+    struct iovec iov[MAX_BATCH];
+
+#ifdef UDP_SEGMENT
+    if( p_sys->b_gso && i_count > 1 )
+    {
+        unsigned i_sent = SendGSO( p_access, pp_pk, i_count );
+
+        pp_pk += i_sent;
+        i_count -= i_sent;
+    }
+#endif
+
+    for( unsigned i = 0; i < i_count; i++ )
+    {
+        iov[i].iov_base = pp_pk[i]->p_buffer;
+        iov[i].iov_len = pp_pk[i]->i_buffer;
+        memset( &msgs[i], 0, sizeof (msgs[i]) );
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    for( unsigned i = 0; i < i_count; )
+    {
+        int val = sendmmsg( p_sys->i_handle, msgs + i, i_count - i, 0 );
+
+        SentCount( p_sys, (val > 0) ? val : 0 );
+        if( val < 0 )
+        {   /* Skip the failing packet */
+            msg_Warn( p_access, "send error: %s", vlc_strerror_c(errno) );
+            val = 1;
+        }
+        i += val;
+    }
+}
+
+typedef struct
+{
+    block_t *pp_pk[MAX_BATCH];
+    unsigned i_count;
+    block_t *p_next; /**< Dequeued packet, for the next batch */
+    bool     b_next_paced; /**< Whether p_next must be sent at its date */
+} udp_batch_t;
+
+/**
+ * Counts packets as ThreadWrite() does: the last packet of each group and
+ * the packets carrying a clock reference are sent at their date, the others
+ * right after.
+ */
+static bool IsPacingPoint( const block_t *p_pk, unsigned *pi_to_send,
+                           unsigned i_group )
+{
+    if( --*pi_to_send == 0 || (p_pk->i_flags & BLOCK_FLAG_CLOCK) )
+    {
+        *pi_to_send = i_group;
+        return true;
+    }
+    return false;
+}
+
+static void BatchCleanup( void *data )
+{
+    udp_batch_t *batch = data;
+
+    for( unsigned i = 0; i < batch->i_count; i++ )
+        block_Release( batch->pp_pk[i] );
+    if( batch->p_next != NULL )
+        block_Release( batch->p_next );
+}
+
+/*****************************************************************************
+ * ThreadWriteBatch: Write all packets due within a time window at once.
+ *****************************************************************************/
+static void* ThreadWriteBatch( void *data )
+{
+    sout_access_out_t *p_access = data;
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    mtime_t i_date_last = -1;
+    const unsigned i_group = var_GetInteger( p_access,
+                                             SOUT_CFG_PREFIX "group" );
+    unsigned i_to_send = i_group;
+    unsigned i_dropped_packets = 0;
+    udp_batch_t batch = { .i_count = 0, .p_next = NULL };
+
+    vlc_cleanup_push( BatchCleanup, &batch );
+    for (;;)
+    {
+        block_t *p_pk = batch.p_next;
+        bool b_paced = batch.b_next_paced;
+        mtime_t i_date;
+
+        batch.p_next = NULL;
+        if( p_pk == NULL )
+        {
+            p_pk = block_FifoGet( p_sys->p_fifo );
+            b_paced = IsPacingPoint( p_pk, &i_to_send, i_group );
+        }
+
+        i_date = p_sys->i_caching + p_pk->i_dts;
+        if( i_date_last > 0 )
+        {
+            if( i_date - i_date_last > 2000000 )
+            {
+                if( !i_dropped_packets )
+                    msg_Dbg( p_access, "mmh, hole (%"PRId64" > 2s) -> drop",
+                             i_date - i_date_last );
+
+                block_FifoPut( p_sys->p_empty_blocks, p_pk );
+
+                i_date_last = i_date;
+                i_dropped_packets++;
+                continue;
+            }
+            else if( i_date - i_date_last < -1000 )
+            {
+                if( !i_dropped_packets )
+                    msg_Dbg( p_access, "mmh, packets in the past (%"PRId64")",
+                             i_date_last - i_date );
+            }
+        }
+
+        /* Gather the packets already queued up to the next pacing point.
+         * Without groups, the packets due in the same window are gathered,
+         * but a clock reference still starts a new batch. */
+        batch.pp_pk[batch.i_count++] = p_pk;
+        i_date_last = i_date;
+        while( batch.i_count < MAX_BATCH )
+        {
+            vlc_fifo_Lock( p_sys->p_fifo );
+            p_pk = vlc_fifo_DequeueUnlocked( p_sys->p_fifo );
+            vlc_fifo_Unlock( p_sys->p_fifo );
+            if( p_pk == NULL )
+                break;
+
+            const bool b_next_paced = IsPacingPoint( p_pk, &i_to_send,
+                                                     i_group );
+            mtime_t i_next = p_sys->i_caching + p_pk->i_dts;
+            bool b_split;
+
+            if( i_group > 1 )
+                b_split = b_next_paced;
+            else
+                b_split = (p_pk->i_flags & BLOCK_FLAG_CLOCK)
+                       || i_next > i_date + p_sys->i_batch_window
+                       || i_next < i_date_last - 1000;
+            if( b_split )
+            {
+                batch.p_next = p_pk;
+                batch.b_next_paced = b_next_paced;
+                break;
+            }
+            batch.pp_pk[batch.i_count++] = p_pk;
+            i_date_last = i_next;
+        }
+
+        if( b_paced )
+            mwait( i_date );
+
+        int canc = vlc_savecancel();
+        SendBatch( p_access, batch.pp_pk, batch.i_count );
+
+        if( i_dropped_packets )
+        {
+            msg_Dbg( p_access, "dropped %i packets", i_dropped_packets );
+            i_dropped_packets = 0;
+        }
+
+        mtime_t i_sent = mdate();
+        if ( i_sent > i_date + 20000 )
+        {
+            msg_Dbg( p_access, "packet has been sent too late (%"PRId64 ")",
+                     i_sent - i_date );
+        }
+
+        for( unsigned i = 0; i < batch.i_count; i++ )
+            block_FifoPut( p_sys->p_empty_blocks, batch.pp_pk[i] );
+        batch.i_count = 0;
+        vlc_restorecancel( canc );
+    }
+    vlc_cleanup_pop();
+    return NULL;
+}
+#endif
@@ -36,6 +36,7 @@
 #include "logic/AlwaysLowestAdaptationLogic.hpp"
 #include "logic/PredictiveAdaptationLogic.hpp"
 #include "logic/NearOptimalAdaptationLogic.hpp"
+#include "logic/HybridAdaptationLogic.hpp"
 #include "tools/Debug.hpp"
 #include <vlc_stream.h>
 #include <vlc_demux.h>
@@ -117,7 +118,8 @@ bool PlaylistManager::setupPeriod()
         BaseAdaptationSet *set = *it;
         if(set && streamFactory)
         {
-            SegmentTracker *tracker = new (std::nothrow) SegmentTracker(logic, set);
+            SegmentTracker *tracker = new (std::nothrow) SegmentTracker(logic, set,
+                                    var_InheritInteger(p_demux, "adaptive-prefetch"));
             if(!tracker)
                 continue;
 
@@ -759,6 +761,15 @@ AbstractAdaptationLogic *PlaylistManager::createLogic(AbstractAdaptationLogic::L
             logic = noplogic;
             break;
         }
+        case AbstractAdaptationLogic::Hybrid:
+        {
+            HybridAdaptationLogic *hybridlogic =
+                    new (std::nothrow) HybridAdaptationLogic(VLC_OBJECT(p_demux));
+            if(hybridlogic)
+                conn->setDownloadRateObserver(hybridlogic);
+            logic = hybridlogic;
+            break;
+        }
         case AbstractAdaptationLogic::Predictive:
         {
             AbstractAdaptationLogic *predictivelogic =
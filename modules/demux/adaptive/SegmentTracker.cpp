@@ -29,6 +29,10 @@
 #include "playlist/Segment.h"
 #include "playlist/SegmentChunk.hpp"
 #include "logic/AbstractAdaptationLogic.h"
+#include "http/HTTPConnectionManager.h"
+
+#include <algorithm>
+#include <vector>
 
 using namespace adaptive;
 using namespace adaptive::logic;
@@ -76,7 +80,8 @@ SegmentTrackerEvent::SegmentTrackerEvent(const ID &id, mtime_t duration)
     u.segment.id = &id;
 }
 
-SegmentTracker::SegmentTracker(AbstractAdaptationLogic *logic_, BaseAdaptationSet *adaptSet)
+SegmentTracker::SegmentTracker(AbstractAdaptationLogic *logic_, BaseAdaptationSet *adaptSet,
+                               unsigned maxprefetch_)
 {
     first = true;
     curNumber = next = 0;
@@ -87,6 +92,9 @@ SegmentTracker::SegmentTracker(AbstractAdaptationLogic *logic_, BaseAdaptationSe
     setAdaptationLogic(logic_);
     adaptationSet = adaptSet;
     format = StreamFormat::UNSUPPORTED;
+    maxprefetch = maxprefetch_;
+    buffering.current = 0;
+    buffering.target = 0;
 }
 
 SegmentTracker::~SegmentTracker()
@@ -127,6 +135,7 @@ bool SegmentTracker::segmentsListReady() const
 
 void SegmentTracker::reset()
 {
+    flushPrefetched();
     notify(SegmentTrackerEvent(curRepresentation, NULL));
     curRepresentation = NULL;
     init_sent = false;
@@ -165,6 +174,9 @@ SegmentChunk * SegmentTracker::getNextChunk(bool switch_allowed,
 
     if(rep != curRepresentation)
     {
+        /* Chunks requested ahead belong to the previous representation:
+         * drop them, next still points to the first of them */
+        flushPrefetched();
         notify(SegmentTrackerEvent(curRepresentation, rep));
         prevRep = curRepresentation;
         curRepresentation = rep;
@@ -233,10 +245,27 @@ SegmentChunk * SegmentTracker::getNextChunk(bool switch_allowed,
     }
 
     bool b_gap = false;
-    segment = rep->getNextSegment(BaseRepresentation::INFOTYPE_MEDIA, next, &next, &b_gap);
-    if(!segment)
+    SegmentChunk *chunk;
+    mtime_t duration;
+    if(!prefetched.empty())
     {
-        return NULL;
+        const PrefetchedChunk &entry = prefetched.front();
+        chunk = entry.chunk;
+        next = entry.number;
+        duration = entry.duration;
+        b_gap = entry.b_gap;
+        prefetched.pop_front();
+    }
+    else
+    {
+        segment = rep->getNextSegment(BaseRepresentation::INFOTYPE_MEDIA, next, &next, &b_gap);
+        if(!segment)
+        {
+            return NULL;
+        }
+        chunk = segment->toChunk(next, rep, connManager);
+        const Timescale timescale = rep->inheritTimescale();
+        duration = timescale.ToTime(segment->duration.Get());
     }
 
     if(initializing)
@@ -246,14 +275,10 @@ SegmentChunk * SegmentTracker::getNextChunk(bool switch_allowed,
         initializing = false;
     }
 
-    SegmentChunk *chunk = segment->toChunk(next, rep, connManager);
-
     /* Notify new segment length for stats / logic */
     if(chunk)
     {
-        const Timescale timescale = rep->inheritTimescale();
-        notify(SegmentTrackerEvent(rep->getAdaptationSet()->getID(),
-                                   timescale.ToTime(segment->duration.Get())));
+        notify(SegmentTrackerEvent(rep->getAdaptationSet()->getID(), duration));
     }
 
     /* We need to check segment/chunk format changes, as we can't rely on representation's (HLS)*/
@@ -273,11 +298,105 @@ SegmentChunk * SegmentTracker::getNextChunk(bool switch_allowed,
     {
         curNumber = next;
         next++;
+        prefetch(rep, duration, connManager);
     }
 
     return chunk;
 }
 
+unsigned SegmentTracker::getPrefetchWindow(BaseRepresentation *rep, mtime_t duration,
+                                           AbstractConnectionManager *connManager) const
+{
+    if(!maxprefetch || duration <= 0)
+        return 0;
+
+    /* Request what is still missing to reach the buffering target,
+     * besides the chunk being returned */
+    const mtime_t missing = buffering.target - buffering.current - duration;
+    if(missing <= 0)
+        return 0;
+    unsigned window = (missing + duration - 1) / duration;
+
+    /* When segments download slower than real time, more requests would
+     * only share the same bandwidth: just hide the request latency */
+    const size_t bps = connManager->getDownloadRate(adaptationSet->getID());
+    if(bps && bps < rep->getBandwidth())
+        window = 1;
+
+    return std::min(window, maxprefetch);
+}
+
+void SegmentTracker::prefetch(BaseRepresentation *rep, mtime_t duration,
+                              AbstractConnectionManager *connManager)
+{
+    const unsigned window = getPrefetchWindow(rep, duration, connManager);
+
+    /* Top up by batches, so adjacent ranges can go in the same request */
+    if(prefetched.size() > window / 2)
+        return;
+
+    const Timescale timescale = rep->inheritTimescale();
+    uint64_t number = prefetched.empty() ? next : prefetched.back().number + 1;
+    std::vector<ISegment *> segments;
+    std::vector<PrefetchedChunk> entries;
+    while(prefetched.size() + entries.size() < window)
+    {
+        PrefetchedChunk entry;
+        entry.b_gap = false;
+        ISegment *segment = rep->getNextSegment(BaseRepresentation::INFOTYPE_MEDIA, number,
+                                                &number, &entry.b_gap);
+        if(!segment)
+            break;
+        entry.chunk = NULL;
+        entry.number = number++;
+        entry.duration = timescale.ToTime(segment->duration.Get());
+        segments.push_back(segment);
+        entries.push_back(entry);
+    }
+
+    for(size_t i = 0; i < segments.size();)
+    {
+        size_t j = i + 1;
+        while(j < segments.size() &&
+              segments[j - 1]->isAdjacent(entries[j - 1].number, segments[j],
+                                          entries[j].number, rep))
+            j++;
+
+        std::vector<SegmentChunk *> chunks;
+        if(j - i > 1)
+        {
+            const std::vector<ISegment *> run(segments.begin() + i, segments.begin() + j);
+            ISegment::toChunks(run, entries[i].number, rep, connManager, chunks);
+        }
+        else
+        {
+            SegmentChunk *chunk = segments[i]->toChunk(entries[i].number, rep, connManager);
+            if(chunk)
+                chunks.push_back(chunk);
+        }
+
+        for(size_t k = 0; k < chunks.size(); k++)
+        {
+            entries[i + k].chunk = chunks[k];
+            prefetched.push_back(entries[i + k]);
+        }
+
+        /* Don't leave holes in the queue */
+        if(chunks.size() < j - i)
+            break;
+        i = j;
+    }
+}
+
+void SegmentTracker::flushPrefetched()
+{
+    while(!prefetched.empty())
+    {
+        delete prefetched.front().chunk;
+        prefetched.pop_front();
+    }
+}
+
 bool SegmentTracker::setPositionByTime(mtime_t time, bool restarted, bool tryonly)
 {
     uint64_t segnumber;
@@ -297,6 +416,7 @@ bool SegmentTracker::setPositionByTime(mtime_t time, bool restarted, bool tryonl
 
 void SegmentTracker::setPositionByNumber(uint64_t segnumber, bool restarted)
 {
+    flushPrefetched();
     if(restarted)
     {
         initializing = true;
@@ -337,8 +457,10 @@ void SegmentTracker::notifyBufferingState(bool enabled) const
     notify(SegmentTrackerEvent(adaptationSet->getID(), enabled));
 }
 
-void SegmentTracker::notifyBufferingLevel(mtime_t min, mtime_t current, mtime_t target) const
+void SegmentTracker::notifyBufferingLevel(mtime_t min, mtime_t current, mtime_t target)
 {
+    buffering.current = current;
+    buffering.target = target;
     notify(SegmentTrackerEvent(adaptationSet->getID(), min, current, target));
 }
 
@@ -112,7 +112,7 @@ namespace adaptive
     class SegmentTracker
     {
         public:
-            SegmentTracker(AbstractAdaptationLogic *, BaseAdaptationSet *);
+            SegmentTracker(AbstractAdaptationLogic *, BaseAdaptationSet *, unsigned = 0);
             ~SegmentTracker();
 
             StreamFormat getCurrentFormat() const;
@@ -124,13 +124,26 @@ namespace adaptive
             mtime_t getPlaybackTime() const; /* Current segment start time if selected */
             mtime_t getMinAheadTime() const;
             void notifyBufferingState(bool) const;
-            void notifyBufferingLevel(mtime_t, mtime_t, mtime_t) const;
+            void notifyBufferingLevel(mtime_t, mtime_t, mtime_t);
             void registerListener(SegmentTrackerListenerInterface *);
             void updateSelected();
 
         private:
+            class PrefetchedChunk
+            {
+                public:
+                    SegmentChunk *chunk;
+                    uint64_t number;
+                    mtime_t duration;
+                    bool b_gap;
+            };
+
             void setAdaptationLogic(AbstractAdaptationLogic *);
             void notify(const SegmentTrackerEvent &) const;
+            unsigned getPrefetchWindow(BaseRepresentation *, mtime_t,
+                                       AbstractConnectionManager *) const;
+            void prefetch(BaseRepresentation *, mtime_t, AbstractConnectionManager *);
+            void flushPrefetched();
             bool first;
             bool initializing;
             bool index_sent;
@@ -142,6 +155,14 @@ namespace adaptive
             BaseAdaptationSet *adaptationSet;
             BaseRepresentation *curRepresentation;
             std::list<SegmentTrackerListenerInterface *> listeners;
+            /* media chunks already requested, following next */
+            std::list<PrefetchedChunk> prefetched;
+            unsigned maxprefetch;
+            struct
+            {
+                mtime_t current;
+                mtime_t target;
+            } buffering;
     };
 }
 
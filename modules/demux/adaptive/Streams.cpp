@@ -592,6 +592,15 @@ void AbstractStream::trackerEvent(const SegmentTrackerEvent &event)
             {
                 needrestart = true;
             }
+            break;
+
+        case SegmentTrackerEvent::BUFFERING_LEVEL_CHANGE:
+            /* Let the downloader serve first the stream closest to underrun */
+            if(connManager)
+                connManager->updateBufferingLevel(*event.u.buffering_level.id,
+                                                  event.u.buffering_level.current);
+            break;
+
         default:
             break;
     }
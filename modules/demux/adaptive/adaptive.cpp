@@ -76,10 +76,17 @@ static void Close   (vlc_object_t *);
 #define ADAPT_ACCESS_TEXT N_("Use regular HTTP modules")
 #define ADAPT_ACCESS_LONGTEXT N_("Connect using http access instead of custom http code")
 
+#define ADAPT_WORKERS_TEXT N_("Parallel downloads")
+#define ADAPT_WORKERS_LONGTEXT N_("Number of segments which can be downloaded at the same time")
+
+#define ADAPT_PREFETCH_TEXT N_("Prefetched segments")
+#define ADAPT_PREFETCH_LONGTEXT N_("Maximum number of segments requested ahead of the one being read")
+
 static const AbstractAdaptationLogic::LogicType pi_logics[] = {
                                 AbstractAdaptationLogic::Default,
                                 AbstractAdaptationLogic::Predictive,
                                 AbstractAdaptationLogic::NearOptimal,
+                                AbstractAdaptationLogic::Hybrid,
                                 AbstractAdaptationLogic::RateBased,
                                 AbstractAdaptationLogic::FixedRate,
                                 AbstractAdaptationLogic::AlwaysLowest,
@@ -89,6 +96,7 @@ static const char *const ppsz_logics_values[] = {
                                 "",
                                 "predictive",
                                 "nearoptimal",
+                                "hybrid",
                                 "rate",
                                 "fixedrate",
                                 "lowest",
@@ -97,6 +105,7 @@ static const char *const ppsz_logics_values[] = {
 static const char *const ppsz_logics[] = { N_("Default"),
                                            N_("Predictive"),
                                            N_("Near Optimal"),
+                                           N_("Throughput/Buffer Hybrid"),
                                            N_("Bandwidth Adaptive"),
                                            N_("Fixed Bandwidth"),
                                            N_("Lowest Bandwidth/Quality"),
@@ -122,6 +131,10 @@ vlc_module_begin ()
                      ADAPT_HEIGHT_TEXT, ADAPT_HEIGHT_TEXT, false )
         add_integer( "adaptive-bw",     250, ADAPT_BW_TEXT,     ADAPT_BW_LONGTEXT,     false )
         add_bool   ( "adaptive-use-access", false, ADAPT_ACCESS_TEXT, ADAPT_ACCESS_LONGTEXT, true );
+        add_integer( "adaptive-workers", 3, ADAPT_WORKERS_TEXT, ADAPT_WORKERS_LONGTEXT, true )
+            change_integer_range( 1, 16 )
+        add_integer( "adaptive-prefetch", 3, ADAPT_PREFETCH_TEXT, ADAPT_PREFETCH_LONGTEXT, true )
+            change_integer_range( 0, 16 )
         set_callbacks( Open, Close )
 vlc_module_end ()
 
@@ -25,6 +25,8 @@
 
 #include <string>
 
+struct vlc_http_mgr;
+
 namespace adaptive
 {
     namespace http
@@ -38,9 +40,11 @@ namespace adaptive
                 ~AuthStorage();
                 void addCookie( const std::string &cookie, const ConnectionParams & );
                 std::string getCookie( const ConnectionParams &, bool secure );
+                struct vlc_http_mgr * getHTTPManager() const; /* shared HTTP/2 connections */
 
             private:
                 vlc_http_cookie_jar_t *p_cookies_jar;
+                struct vlc_http_mgr *p_http_mgr;
         };
     }
 }
@@ -456,6 +456,101 @@ block_t * HTTPChunkBufferedSource::read(size_t readsize)
     return p_block;
 }
 
+HTTPChunkSharedRequest::HTTPChunkSharedRequest(HTTPChunkBufferedSource *source_)
+{
+    source = source_;
+    refs = 1;
+    position = 0;
+}
+
+HTTPChunkSharedRequest::~HTTPChunkSharedRequest()
+{
+    delete source;
+}
+
+void HTTPChunkSharedRequest::hold()
+{
+    refs++;
+}
+
+void HTTPChunkSharedRequest::release()
+{
+    if(--refs == 0)
+        delete this;
+}
+
+block_t * HTTPChunkSharedRequest::read(size_t offset, size_t size)
+{
+    /* Ranges are read in order, but a range can be dropped unread */
+    if(offset < position)
+        return NULL;
+
+    while(position < offset)
+    {
+        block_t *p_skip = source->read(std::min(offset - position,
+                                                     (size_t) HTTPChunkSource::CHUNK_SIZE));
+        if(!p_skip)
+            return NULL;
+        position += p_skip->i_buffer;
+        block_Release(p_skip);
+    }
+
+    block_t *p_block = source->read(size);
+    if(p_block)
+        position += p_block->i_buffer;
+    return p_block;
+}
+
+HTTPChunkRangeSource::HTTPChunkRangeSource(HTTPChunkSharedRequest *request_,
+                                           const BytesRange &range, size_t offset_) :
+    AbstractChunkSource(),
+    request(request_),
+    offset(offset_),
+    consumed(0)
+{
+    request->hold();
+    setBytesRange(range);
+    contentLength = range.getEndByte() - range.getStartByte() + 1;
+    eof = false;
+}
+
+HTTPChunkRangeSource::~HTTPChunkRangeSource()
+{
+    request->release();
+}
+
+bool HTTPChunkRangeSource::hasMoreData() const
+{
+    return !eof && consumed < contentLength;
+}
+
+block_t * HTTPChunkRangeSource::readBlock()
+{
+    return read(HTTPChunkSource::CHUNK_SIZE);
+}
+
+block_t * HTTPChunkRangeSource::read(size_t readsize)
+{
+    if(readsize > contentLength - consumed)
+        readsize = contentLength - consumed;
+
+    block_t *p_block = NULL;
+    if(!eof && readsize)
+        p_block = request->read(offset + consumed, readsize);
+
+    if(!p_block)
+    {
+        eof = true;
+        return NULL;
+    }
+
+    consumed += p_block->i_buffer;
+    if(p_block->i_buffer < readsize)
+        eof = true;
+
+    return p_block;
+}
+
 HTTPChunk::HTTPChunk(const std::string &url, AbstractConnectionManager *manager,
                      const adaptive::ID &id):
     AbstractChunk(new HTTPChunkSource(url, manager, id))
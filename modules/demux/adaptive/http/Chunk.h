@@ -138,6 +138,39 @@ namespace adaptive
                 bool                held;
         };
 
+        /* Single request shared by the sources of adjacent byte ranges */
+        class HTTPChunkSharedRequest
+        {
+            public:
+                HTTPChunkSharedRequest(HTTPChunkBufferedSource *);
+                void               hold();
+                void               release();
+                block_t *          read(size_t offset, size_t size);
+
+            private:
+                ~HTTPChunkSharedRequest();
+                HTTPChunkBufferedSource *source;
+                unsigned            refs;
+                size_t              position; /* read pointer in request */
+        };
+
+        class HTTPChunkRangeSource : public AbstractChunkSource
+        {
+            public:
+                HTTPChunkRangeSource(HTTPChunkSharedRequest *, const BytesRange &,
+                                     size_t offset);
+                virtual ~HTTPChunkRangeSource();
+                virtual block_t *   readBlock       (); /* impl */
+                virtual block_t *   read            (size_t); /* impl */
+                virtual bool        hasMoreData     () const; /* impl */
+
+            private:
+                HTTPChunkSharedRequest *request;
+                size_t              offset; /* of our range in the request */
+                size_t              consumed;
+                bool                eof;
+        };
+
         class HTTPChunk : public AbstractChunk
         {
             public:
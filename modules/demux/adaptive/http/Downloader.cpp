@@ -28,37 +28,44 @@
 
 using namespace adaptive::http;
 
-Downloader::Downloader()
+Downloader::Downloader(unsigned workers_)
 {
     vlc_mutex_init(&lock);
     vlc_cond_init(&waitcond);
+    vlc_cond_init(&updatedcond);
+    workers = workers_ ? workers_ : 1;
     killed = false;
-    thread_handle_valid = false;
 }
 
 bool Downloader::start()
 {
-    if(!thread_handle_valid &&
-       vlc_clone(&thread_handle, downloaderThread,
-                 static_cast<void *>(this), VLC_THREAD_PRIORITY_INPUT))
+    if(!thread_handles.empty())
+        return true;
+
+    for(unsigned i=0; i<workers; i++)
     {
-        return false;
+        vlc_thread_t thread_handle;
+        if(vlc_clone(&thread_handle, downloaderThread,
+                     static_cast<void *>(this), VLC_THREAD_PRIORITY_INPUT))
+            break;
+        thread_handles.push_back(thread_handle);
     }
-    thread_handle_valid = true;
-    return true;
+    return !thread_handles.empty();
 }
 
 Downloader::~Downloader()
 {
     vlc_mutex_lock( &lock );
     killed = true;
-    vlc_cond_signal(&waitcond);
+    vlc_cond_broadcast(&waitcond);
     vlc_mutex_unlock( &lock );
 
-    if(thread_handle_valid)
-        vlc_join(thread_handle, NULL);
+    std::vector<vlc_thread_t>::const_iterator it;
+    for(it = thread_handles.begin(); it != thread_handles.end(); ++it)
+        vlc_join(*it, NULL);
     vlc_mutex_destroy(&lock);
     vlc_cond_destroy(&waitcond);
+    vlc_cond_destroy(&updatedcond);
 }
 void Downloader::schedule(HTTPChunkBufferedSource *source)
 {
@@ -72,8 +79,18 @@ void Downloader::schedule(HTTPChunkBufferedSource *source)
 void Downloader::cancel(HTTPChunkBufferedSource *source)
 {
     vlc_mutex_lock(&lock);
-    source->release();
+    /* remove first so no other worker can pick it up again */
     chunks.remove(source);
+    while(isDownloading(source))
+        vlc_cond_wait(&updatedcond, &lock);
+    source->release();
+    vlc_mutex_unlock(&lock);
+}
+
+void Downloader::updateBufferingLevel(const ID &id, mtime_t level)
+{
+    vlc_mutex_lock(&lock);
+    levels[id] = level;
     vlc_mutex_unlock(&lock);
 }
 
@@ -92,27 +109,88 @@ void Downloader::DownloadSource(HTTPChunkBufferedSource *source)
         source->bufferize(HTTPChunkSource::CHUNK_SIZE);
 }
 
+bool Downloader::isDownloading(const HTTPChunkBufferedSource *source) const
+{
+    std::list<HTTPChunkBufferedSource *>::const_iterator it;
+    for(it = downloading.begin(); it != downloading.end(); ++it)
+        if(*it == source)
+            return true;
+    return false;
+}
+
+unsigned Downloader::getActiveCount(const ID &id) const
+{
+    unsigned count = 0;
+    std::list<HTTPChunkBufferedSource *>::const_iterator it;
+    for(it = downloading.begin(); it != downloading.end(); ++it)
+        if((*it)->sourceid == id)
+            count++;
+    return count;
+}
+
+HTTPChunkBufferedSource * Downloader::getNextSource() const
+{
+    /* Streams with the fewest downloads in flight first, then the one
+     * closest to underrun, then in queue order */
+    HTTPChunkBufferedSource *next = NULL;
+    unsigned nextactive = 0;
+    mtime_t nextlevel = 0;
+
+    std::list<HTTPChunkBufferedSource *>::const_iterator it;
+    for(it = chunks.begin(); it != chunks.end(); ++it)
+    {
+        HTTPChunkBufferedSource *source = *it;
+        if(isDownloading(source))
+            continue;
+
+        const unsigned active = getActiveCount(source->sourceid);
+        std::map<ID, mtime_t>::const_iterator lit = levels.find(source->sourceid);
+        const mtime_t level = (lit != levels.end()) ? (*lit).second : 0;
+
+        if(next == NULL || active < nextactive ||
+           (active == nextactive && level < nextlevel))
+        {
+            next = source;
+            nextactive = active;
+            nextlevel = level;
+        }
+    }
+
+    return next;
+}
+
 void Downloader::Run()
 {
     vlc_mutex_lock(&lock);
     while(1)
     {
-        while(chunks.empty() && !killed)
+        HTTPChunkBufferedSource *source = NULL;
+        while(!killed && (source = getNextSource()) == NULL)
             vlc_cond_wait(&waitcond, &lock);
 
         if(killed)
             break;
 
-        if(!chunks.empty())
+        /* Read one chunk without holding the queue lock, so other
+         * workers can fetch other sources meanwhile */
+        downloading.push_back(source);
+        vlc_mutex_unlock(&lock);
+
+        DownloadSource(source);
+
+        vlc_mutex_lock(&lock);
+        downloading.remove(source);
+        if(source->isDone())
+        {
+            chunks.remove(source);
+            source->release();
+        }
+        else
         {
-            HTTPChunkBufferedSource *source = chunks.front();
-            DownloadSource(source);
-            if(source->isDone())
-            {
-                chunks.pop_front();
-                source->release();
-            }
+            /* still queued, let an idle worker take it over */
+            vlc_cond_signal(&waitcond);
         }
+        vlc_cond_broadcast(&updatedcond);
     }
     vlc_mutex_unlock(&lock);
 }
@@ -24,6 +24,8 @@
 
 #include <vlc_common.h>
 #include <list>
+#include <map>
+#include <vector>
 
 namespace adaptive
 {
@@ -34,22 +36,31 @@ namespace adaptive
         class Downloader
         {
             public:
-                Downloader();
+                Downloader(unsigned = 1);
                 ~Downloader();
                 bool start();
                 void schedule(HTTPChunkBufferedSource *);
                 void cancel(HTTPChunkBufferedSource *);
+                void updateBufferingLevel(const ID &, mtime_t);
 
             private:
                 static void * downloaderThread(void *);
                 void Run();
                 void DownloadSource(HTTPChunkBufferedSource *);
-                vlc_thread_t thread_handle;
+                HTTPChunkBufferedSource * getNextSource() const;
+                bool isDownloading(const HTTPChunkBufferedSource *) const;
+                unsigned getActiveCount(const ID &) const;
+                std::vector<vlc_thread_t> thread_handles;
                 vlc_mutex_t  lock;
                 vlc_cond_t   waitcond;
-                bool         thread_handle_valid;
+                vlc_cond_t   updatedcond;
+                unsigned     workers;
                 bool         killed;
                 std::list<HTTPChunkBufferedSource *> chunks;
+                /* sources currently read by a worker, outside of the lock */
+                std::list<HTTPChunkBufferedSource *> downloading;
+                /* buffered duration per stream, least buffered goes first */
+                std::map<ID, mtime_t> levels;
         };
 
     }
@@ -27,9 +27,17 @@
 #include "Sockets.hpp"
 #include "../adaptive/tools/Helper.h"
 
+#include <algorithm>
 #include <cstdio>
 #include <sstream>
 #include <vlc_stream.h>
+#include <vlc_block.h>
+
+extern "C"
+{
+    #include "../../../access/http/message.h"
+    #include "../../../access/http/resource.h"
+}
 
 using namespace adaptive::http;
 
@@ -514,6 +522,214 @@ void StreamUrlConnection::setUsed( bool b )
        reset();
 }
 
+static int LibVLCHTTPRequestFormat(const struct vlc_http_resource *,
+                                   struct vlc_http_msg *req, void *opaque)
+{
+    const BytesRange *range = static_cast<const BytesRange *>(opaque);
+
+    if(vlc_http_msg_add_header(req, "Cache-Control", "no-cache"))
+        return -1;
+
+    if(range->isValid())
+    {
+        if(range->getEndByte())
+            return vlc_http_msg_add_header(req, "Range", "bytes=%zu-%zu",
+                                           range->getStartByte(), range->getEndByte());
+        return vlc_http_msg_add_header(req, "Range", "bytes=%zu-",
+                                       range->getStartByte());
+    }
+    return 0;
+}
+
+static int LibVLCHTTPResponseValidate(const struct vlc_http_resource *,
+                                      const struct vlc_http_msg *resp, void *opaque)
+{
+    const BytesRange *range = static_cast<const BytesRange *>(opaque);
+
+    /* Range ignored by the server, the payload would start at 0 */
+    if(range->isValid() && range->getStartByte() > 0 &&
+       vlc_http_msg_get_status(resp) == 200)
+        return -1;
+    return 0;
+}
+
+static const struct vlc_http_resource_cbs LibVLCHTTPCallbacks =
+{
+    LibVLCHTTPRequestFormat,
+    LibVLCHTTPResponseValidate,
+};
+
+LibVLCHTTPConnection::LibVLCHTTPConnection(vlc_object_t *p_object_, struct vlc_http_mgr *mgr)
+    : AbstractConnection(p_object_)
+{
+    http_mgr = mgr;
+    resource = NULL;
+    p_pending = NULL;
+    psz_useragent = var_InheritString(p_object_, "http-user-agent");
+}
+
+LibVLCHTTPConnection::~LibVLCHTTPConnection()
+{
+    reset();
+    free(psz_useragent);
+}
+
+void LibVLCHTTPConnection::reset()
+{
+    if(p_pending)
+        block_Release(p_pending);
+    p_pending = NULL;
+    /* aborts the stream if it was not fully read */
+    if(resource)
+        vlc_http_res_destroy(resource);
+    resource = NULL;
+    bytesRead = 0;
+    contentLength = 0;
+    bytesRange = BytesRange();
+}
+
+bool LibVLCHTTPConnection::canReuse(const ConnectionParams &params_) const
+{
+    return ( available &&
+             params.getHostname() == params_.getHostname() &&
+             params.getScheme() == params_.getScheme() &&
+             params.getPort() == params_.getPort() );
+}
+
+int LibVLCHTTPConnection::request(const std::string &path, const BytesRange &range)
+{
+    reset();
+
+    /* Set new path for this query */
+    params.setPath(path);
+
+    msg_Dbg(p_object, "Retrieving %s @%zu", params.getUrl().c_str(),
+                      range.isValid() ? range.getStartByte() : 0);
+
+    if(!http_mgr)
+        return VLC_EGENERIC;
+
+    std::string url = params.getUrl();
+    for(int i_redir = 0;; i_redir++)
+    {
+        resource = (struct vlc_http_resource *) malloc(sizeof(*resource));
+        if(!resource)
+            return VLC_ENOMEM;
+
+        if(vlc_http_res_init(resource, &LibVLCHTTPCallbacks, http_mgr,
+                             url.c_str(), psz_useragent, NULL))
+        {
+            free(resource);
+            resource = NULL;
+            return VLC_EGENERIC;
+        }
+
+        resource->response = vlc_http_res_open(resource, const_cast<BytesRange *>(&range));
+        if(!resource->response)
+        {
+            msg_Err(p_object, "Failed reading %s", url.c_str());
+            reset();
+            return VLC_EGENERIC;
+        }
+
+        const int status = vlc_http_msg_get_status(resource->response);
+        if(status == 200 || status == 206)
+            break;
+
+        char *psz_location = (i_redir < 3) ? vlc_http_res_get_redirect(resource) : NULL;
+        reset();
+        if(!psz_location)
+        {
+            msg_Err(p_object, "Failed reading %s: %d", url.c_str(), status);
+            return VLC_ENOOBJ;
+        }
+        msg_Info(p_object, "%d redirection to %s", status, psz_location);
+        url = psz_location;
+        free(psz_location);
+        params = ConnectionParams(url);
+    }
+
+    bytesRange = range;
+    const uintmax_t i_size = vlc_http_msg_get_size(resource->response);
+    if(i_size != UINTMAX_MAX)
+        contentLength = i_size;
+    else if(range.isValid() && range.getEndByte() > 0)
+        contentLength = range.getEndByte() - range.getStartByte() + 1;
+
+    return VLC_SUCCESS;
+}
+
+ssize_t LibVLCHTTPConnection::read(void *p_buffer, size_t len)
+{
+    if(!resource)
+        return VLC_EGENERIC;
+
+    if(len == 0)
+        return VLC_SUCCESS;
+
+    const size_t toRead = (contentLength) ? contentLength - bytesRead : len;
+    if (toRead == 0)
+        return VLC_SUCCESS;
+
+    if(len > toRead)
+        len = toRead;
+
+    /* payload comes in frames/blocks, fill up the request */
+    size_t copied = 0;
+    while(copied < len)
+    {
+        if(!p_pending)
+        {
+            p_pending = vlc_http_res_read(resource);
+            if(p_pending == vlc_http_error)
+            {
+                p_pending = NULL;
+                if(copied == 0)
+                {
+                    reset();
+                    return -1;
+                }
+                break;
+            }
+            else if(!p_pending) /* EOF */
+                break;
+        }
+
+        const size_t i_copy = std::min(len - copied, p_pending->i_buffer);
+        memcpy(&((uint8_t *)p_buffer)[copied], p_pending->p_buffer, i_copy);
+        p_pending->p_buffer += i_copy;
+        p_pending->i_buffer -= i_copy;
+        copied += i_copy;
+        if(p_pending->i_buffer == 0)
+        {
+            block_Release(p_pending);
+            p_pending = NULL;
+        }
+    }
+
+    bytesRead += copied;
+
+    if(contentLength == bytesRead && !p_pending)
+    {
+        /* wait for the end of stream, so the stream is not cancelled */
+        block_t *p_block = vlc_http_res_read(resource);
+        if(p_block && p_block != vlc_http_error)
+            block_Release(p_block);
+    }
+
+    if(copied < len || contentLength == bytesRead) /* set EOF */
+        reset();
+
+    return copied;
+}
+
+void LibVLCHTTPConnection::setUsed( bool b )
+{
+    available = !b;
+    if(available)
+        reset();
+}
+
 ConnectionFactory::ConnectionFactory( AuthStorage *auth )
 {
     authStorage = auth;
@@ -529,15 +745,21 @@ AbstractConnection * ConnectionFactory::createConnection(vlc_object_t *p_object,
     if((params.getScheme() != "http" && params.getScheme() != "https") || params.getHostname().empty())
         return NULL;
 
-    const int sockettype = (params.getScheme() == "https") ? TLSSocket::TLS : Socket::REGULAR;
-    Socket *socket = (sockettype == TLSSocket::TLS) ? new (std::nothrow) TLSSocket()
-                                                    : new (std::nothrow) Socket();
+    /* TLS goes through the shared manager: one connection per server, with
+     * HTTP/2 multiplexing and session resumption when the server offers it */
+    if(params.getScheme() == "https")
+    {
+        if(!authStorage || !authStorage->getHTTPManager())
+            return NULL;
+        return new (std::nothrow) LibVLCHTTPConnection(p_object, authStorage->getHTTPManager());
+    }
+
+    Socket *socket = new (std::nothrow) Socket();
     if(!socket)
         return NULL;
 
-    /* disable pipelined tls until we have ticket/resume session support */
     HTTPConnection *conn = new (std::nothrow)
-            HTTPConnection(p_object, authStorage, socket, sockettype != TLSSocket::TLS);
+            HTTPConnection(p_object, authStorage, socket, true);
     if(!conn)
     {
         delete socket;
@@ -30,6 +30,9 @@
 #include <vlc_common.h>
 #include <string>
 
+struct vlc_http_mgr;
+struct vlc_http_resource;
+
 namespace adaptive
 {
     namespace http
@@ -122,6 +125,29 @@ namespace adaptive
                 stream_t *p_streamurl;
        };
 
+       /* Requests through the shared access/http connections manager, where
+        * HTTP/2 streams to the same server multiplex over one connection */
+       class LibVLCHTTPConnection : public AbstractConnection
+       {
+            public:
+                LibVLCHTTPConnection(vlc_object_t *, struct vlc_http_mgr *);
+                virtual ~LibVLCHTTPConnection();
+
+                virtual bool    canReuse     (const ConnectionParams &) const;
+
+                virtual int     request     (const std::string& path, const BytesRange & = BytesRange());
+                virtual ssize_t read        (void *p_buffer, size_t len);
+
+                virtual void    setUsed( bool );
+
+            protected:
+                void reset();
+                struct vlc_http_mgr *http_mgr;
+                struct vlc_http_resource *resource;
+                block_t *p_pending; /* partially read payload */
+                char *psz_useragent;
+       };
+
        class ConnectionFactory
        {
            public:
@@ -40,19 +40,38 @@ AbstractConnectionManager::AbstractConnectionManager(vlc_object_t *p_object_)
 {
     p_object = p_object_;
     rateObserver = NULL;
+    vlc_mutex_init(&ratelock);
 }
 
 AbstractConnectionManager::~AbstractConnectionManager()
 {
-
+    vlc_mutex_destroy(&ratelock);
 }
 
 void AbstractConnectionManager::updateDownloadRate(const adaptive::ID &sourceid, size_t size, mtime_t time)
 {
+    if(time > 0)
+    {
+        vlc_mutex_lock(&ratelock);
+        rates[sourceid] = CLOCK_FREQ * size * 8 / time;
+        vlc_mutex_unlock(&ratelock);
+    }
+
     if(rateObserver)
         rateObserver->updateDownloadRate(sourceid, size, time);
 }
 
+size_t AbstractConnectionManager::getDownloadRate(const adaptive::ID &sourceid) const
+{
+    size_t bps = 0;
+    vlc_mutex_lock(&ratelock);
+    std::map<ID, size_t>::const_iterator it = rates.find(sourceid);
+    if(it != rates.end())
+        bps = (*it).second;
+    vlc_mutex_unlock(&ratelock);
+    return bps;
+}
+
 void AbstractConnectionManager::setDownloadRateObserver(IDownloadRateObserver *obs)
 {
     rateObserver = obs;
@@ -62,7 +81,7 @@ HTTPConnectionManager::HTTPConnectionManager    (vlc_object_t *p_object_, Connec
     : AbstractConnectionManager( p_object_ )
 {
     vlc_mutex_init(&lock);
-    downloader = new (std::nothrow) Downloader();
+    downloader = new (std::nothrow) Downloader(var_InheritInteger(p_object, "adaptive-workers"));
     downloader->start();
     factory = factory_;
 }
@@ -71,7 +90,7 @@ HTTPConnectionManager::HTTPConnectionManager    (vlc_object_t *p_object_, AuthSt
     : AbstractConnectionManager( p_object_ )
 {
     vlc_mutex_init(&lock);
-    downloader = new (std::nothrow) Downloader();
+    downloader = new (std::nothrow) Downloader(var_InheritInteger(p_object, "adaptive-workers"));
     downloader->start();
     if(var_InheritBool(p_object, "adaptive-use-access"))
         factory = new (std::nothrow) StreamUrlConnectionFactory();
@@ -157,3 +176,8 @@ void HTTPConnectionManager::cancel(AbstractChunkSource *source)
     if(src)
         downloader->cancel(src);
 }
+
+void HTTPConnectionManager::updateBufferingLevel(const adaptive::ID &id, mtime_t level)
+{
+    downloader->updateBufferingLevel(id, level);
+}
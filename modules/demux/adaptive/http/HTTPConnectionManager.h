@@ -26,11 +26,13 @@
 #define HTTPCONNECTIONMANAGER_H_
 
 #include "../logic/IDownloadRateObserver.h"
+#include "../ID.hpp"
 
 #include <vlc_common.h>
 
 #include <vector>
 #include <string>
+#include <map>
 
 namespace adaptive
 {
@@ -52,15 +54,19 @@ namespace adaptive
                 virtual AbstractConnection * getConnection(ConnectionParams &) = 0;
                 virtual void start(AbstractChunkSource *) = 0;
                 virtual void cancel(AbstractChunkSource *) = 0;
+                virtual void updateBufferingLevel(const ID &, mtime_t) = 0;
 
                 virtual void updateDownloadRate(const ID &, size_t, mtime_t); /* impl */
                 void setDownloadRateObserver(IDownloadRateObserver *);
+                size_t getDownloadRate(const ID &) const;
 
             protected:
                 vlc_object_t                                       *p_object;
 
             private:
                 IDownloadRateObserver                              *rateObserver;
+                mutable vlc_mutex_t                                 ratelock;
+                std::map<ID, size_t>                                rates; /* last bps per stream */
         };
 
         class HTTPConnectionManager : public AbstractConnectionManager
@@ -75,6 +81,7 @@ namespace adaptive
 
                 virtual void start(AbstractChunkSource *) /* impl */;
                 virtual void cancel(AbstractChunkSource *) /* impl */;
+                virtual void updateBufferingLevel(const ID &, mtime_t) /* impl */;
 
             private:
                 void    releaseAllConnections ();
@@ -99,80 +99,3 @@ bool Socket::send(vlc_object_t *p_object, const void *buf, size_t size)
 
     return net_Write(p_object, netfd, buf, size) == (ssize_t)size;
 }
-
-TLSSocket::TLSSocket() : Socket( TLS )
-{
-    creds = NULL;
-    tls = NULL;
-}
-
-TLSSocket::~TLSSocket()
-{
-    disconnect();
-}
-
-bool TLSSocket::connect(vlc_object_t *p_object, const std::string &hostname, int port)
-{
-    disconnect();
-    if(!Socket::connect(p_object, hostname, port))
-        return false;
-
-    creds = vlc_tls_ClientCreate(p_object);
-    if(!creds)
-    {
-        disconnect();
-        return false;
-    }
-
-    tls = vlc_tls_ClientSessionCreateFD(creds, netfd, hostname.c_str(), "https", NULL, NULL);
-    if(!tls)
-    {
-        disconnect();
-        return false;
-    }
-
-    return true;
-}
-
-bool TLSSocket::connected() const
-{
-    return Socket::connected() && tls;
-}
-
-ssize_t TLSSocket::read(vlc_object_t *, void *p_buffer, size_t len)
-{
-    return vlc_tls_Read(tls, p_buffer, len, true);
-}
-
-std::string TLSSocket::readline(vlc_object_t *)
-{
-    char *line = ::vlc_tls_GetLine(tls);
-    if(line == NULL)
-        return "";
-
-    std::string ret(line);
-    ::free(line);
-    return ret;
-}
-
-bool TLSSocket::send(vlc_object_t *, const void *buf, size_t size)
-{
-    if (!connected())
-        return false;
-
-    if (size == 0)
-        return true;
-
-    return vlc_tls_Write(tls, buf, size) == (ssize_t)size;
-}
-
-void TLSSocket::disconnect()
-{
-    if(tls)
-        vlc_tls_SessionDelete(tls);
-    if(creds)
-        vlc_tls_Delete(creds);
-    tls = NULL;
-    creds = NULL;
-    Socket::disconnect();
-}
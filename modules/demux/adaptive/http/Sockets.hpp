@@ -21,7 +21,6 @@
 #define SOCKETS_HPP
 
 #include <vlc_common.h>
-#include <vlc_tls.h>
 #include <string>
 
 namespace adaptive
@@ -47,24 +46,6 @@ namespace adaptive
                 int netfd;
                 int type;
         };
-
-        class TLSSocket : public Socket
-        {
-            public:
-                TLSSocket();
-                virtual ~TLSSocket();
-                virtual bool    connect     (vlc_object_t *, const std::string&, int port = 443);
-                virtual bool    connected   () const;
-                virtual bool    send        (vlc_object_t *, const void *buf, size_t size);
-                virtual ssize_t read        (vlc_object_t *, void *p_buffer, size_t len);
-                virtual std::string readline(vlc_object_t *);
-                virtual void    disconnect  ();
-                static const int TLS = REGULAR + 1;
-
-            private:
-                vlc_tls_creds_t *creds;
-                vlc_tls_t *tls;
-        };
     }
 }
 
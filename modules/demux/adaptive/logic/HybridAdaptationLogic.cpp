@@ -0,0 +1,236 @@
+/*
+ * HybridAdaptationLogic.cpp
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "HybridAdaptationLogic.hpp"
+#include "Representationselectors.hpp"
+
+#include "../playlist/BaseAdaptationSet.h"
+#include "../playlist/BaseRepresentation.h"
+#include "../tools/Debug.hpp"
+
+#include <cmath>
+
+using namespace adaptive::logic;
+using namespace adaptive;
+
+/*
+ * Throughput and buffer occupancy hybrid, after DYNAMIC
+ * From Theory to Practice: Improving Bitrate Adaptation in the DASH Reference Player
+ *
+ * Selects on the predicted throughput while the buffer is low, then on
+ * BOLA once it is filled, without climbing above the sustainable rate.
+ */
+
+#define minimumBufferS    (CLOCK_FREQ * 6)  /* Qmin */
+#define bufferTargetS     (CLOCK_FREQ * 30) /* Qmax */
+#define throughputSamples 5
+
+HybridContext::HybridContext()
+    : buffering_min( minimumBufferS )
+    , buffering_level( 0 )
+    , buffering_target( bufferTargetS )
+    , b_bufferbased( false )
+{ }
+
+unsigned HybridContext::getThroughput() const
+{
+    /* harmonic mean, so a single fast download can't inflate it */
+    if(samples.empty())
+        return 0;
+    double inv = 0.0;
+    for(std::list<unsigned>::const_iterator it = samples.begin(); it != samples.end(); ++it)
+        inv += 1.0 / *it;
+    return samples.size() / inv;
+}
+
+void HybridContext::pushThroughput(unsigned bps)
+{
+    if(bps == 0)
+        return;
+    if(samples.size() >= throughputSamples)
+        samples.pop_front();
+    samples.push_back(bps);
+}
+
+HybridAdaptationLogic::HybridAdaptationLogic( vlc_object_t *p_obj )
+    : AbstractAdaptationLogic()
+    , p_obj( p_obj )
+{
+    vlc_mutex_init(&lock);
+}
+
+HybridAdaptationLogic::~HybridAdaptationLogic()
+{
+    vlc_mutex_destroy(&lock);
+}
+
+BaseRepresentation *
+HybridAdaptationLogic::getBufferBasedRepresentation( BaseAdaptationSet *adaptSet,
+                                                     RepresentationSelector &selector,
+                                                     const HybridContext &ctx ) const
+{
+    /* utilities are shifted so the lowest one is 1 */
+    const float umin = getUtility(selector.lowest(adaptSet)) - 1.0;
+    const float umax = getUtility(selector.highest(adaptSet)) - umin;
+    const float Qmin = (float) ctx.buffering_min / CLOCK_FREQ;
+    const float Qmax = (float) std::max(ctx.buffering_target, ctx.buffering_min + CLOCK_FREQ) / CLOCK_FREQ;
+    const float Q = (float) ctx.buffering_level / CLOCK_FREQ;
+
+    const float gammaP = (umax - 1.0) / (Qmax / Qmin - 1.0);
+    if(gammaP <= 0.0) /* single quality */
+        return selector.lowest(adaptSet);
+    const float Vp = Qmin / gammaP;
+
+    BaseRepresentation *ret = NULL;
+    BaseRepresentation *prev = NULL;
+    float argmax = 0;
+    for(BaseRepresentation *rep = selector.lowest(adaptSet);
+                            rep && rep != prev; rep = selector.higher(adaptSet, rep))
+    {
+        const float arg = ( Vp * (getUtility(rep) - umin + gammaP) - Q ) / rep->getBandwidth();
+        if(ret == NULL || argmax <= arg)
+        {
+            ret = rep;
+            argmax = arg;
+        }
+        prev = rep;
+    }
+    return ret;
+}
+
+BaseRepresentation *HybridAdaptationLogic::getNextRepresentation(BaseAdaptationSet *adaptSet, BaseRepresentation *prevRep)
+{
+    RepresentationSelector selector(maxwidth, maxheight);
+
+    vlc_mutex_lock(&lock);
+
+    std::map<ID, HybridContext>::iterator it = streams.find(adaptSet->getID());
+    if(it == streams.end())
+    {
+        vlc_mutex_unlock(&lock);
+        return selector.lowest(adaptSet);
+    }
+    HybridContext ctxcopy = (*it).second;
+
+    vlc_mutex_unlock(&lock);
+
+    /* keep a safety margin on the prediction */
+    const unsigned bps = ctxcopy.getThroughput() * 9 / 10;
+    BaseRepresentation *m = (bps) ? selector.select(adaptSet, bps) : selector.lowest(adaptSet);
+
+    if(prevRep && ctxcopy.b_bufferbased)
+    {
+        BaseRepresentation *mb = getBufferBasedRepresentation(adaptSet, selector, ctxcopy);
+        /* Don't let the buffer rule climb above what the link sustains */
+        if(mb->getBandwidth() > prevRep->getBandwidth() &&
+           mb->getBandwidth() > m->getBandwidth())
+            mb = (m->getBandwidth() > prevRep->getBandwidth()) ? m : prevRep;
+        m = mb;
+    }
+
+    BwDebug( msg_Info(p_obj, "buffering level %.2f%% %s rep %ld kBps %u kBps",
+             (float) 100 * ctxcopy.buffering_level / ctxcopy.buffering_target,
+             ctxcopy.b_bufferbased ? "buffer" : "throughput",
+             m->getBandwidth()/8000, bps / 8000); );
+
+    return m;
+}
+
+float HybridAdaptationLogic::getUtility(const BaseRepresentation *rep) const
+{
+    return std::log((float)rep->getBandwidth());
+}
+
+void HybridAdaptationLogic::updateDownloadRate(const ID &id, size_t dlsize, mtime_t time)
+{
+    if(unlikely(time == 0))
+        return;
+
+    vlc_mutex_lock(&lock);
+    std::map<ID, HybridContext>::iterator it = streams.find(id);
+    if(it != streams.end())
+        (*it).second.pushThroughput(CLOCK_FREQ * dlsize * 8 / time);
+    vlc_mutex_unlock(&lock);
+}
+
+void HybridAdaptationLogic::trackerEvent(const SegmentTrackerEvent &event)
+{
+    switch(event.type)
+    {
+    case SegmentTrackerEvent::BUFFERING_STATE:
+        {
+            const ID &id = *event.u.buffering.id;
+            vlc_mutex_lock(&lock);
+            if(event.u.buffering.enabled)
+            {
+                if(streams.find(id) == streams.end())
+                {
+                    HybridContext ctx;
+                    streams.insert(std::pair<ID, HybridContext>(id, ctx));
+                }
+            }
+            else
+            {
+                std::map<ID, HybridContext>::iterator it = streams.find(id);
+                if(it != streams.end())
+                    streams.erase(it);
+            }
+            vlc_mutex_unlock(&lock);
+            BwDebug(msg_Info(p_obj, "Stream %s is now known %sactive", id.str().c_str(),
+                         (event.u.buffering.enabled) ? "" : "in"));
+        }
+        break;
+
+    case SegmentTrackerEvent::BUFFERING_LEVEL_CHANGE:
+        {
+            const ID &id = *event.u.buffering_level.id;
+            vlc_mutex_lock(&lock);
+            std::map<ID, HybridContext>::iterator it = streams.find(id);
+            if(it == streams.end())
+            {
+                /* Not (or no longer) buffering */
+                vlc_mutex_unlock(&lock);
+                break;
+            }
+            HybridContext &ctx = (*it).second;
+            if(event.u.buffering_level.minimum > 0)
+                ctx.buffering_min = event.u.buffering_level.minimum;
+            ctx.buffering_level = event.u.buffering_level.current;
+            ctx.buffering_target = event.u.buffering_level.target;
+
+            /* Go buffer based once half way to the target, and back
+             * to throughput when falling under the minimum */
+            const mtime_t high = ctx.buffering_min +
+                                 (ctx.buffering_target - ctx.buffering_min) / 2;
+            if(!ctx.b_bufferbased && ctx.buffering_level >= high)
+                ctx.b_bufferbased = true;
+            else if(ctx.b_bufferbased && ctx.buffering_level < ctx.buffering_min)
+                ctx.b_bufferbased = false;
+            vlc_mutex_unlock(&lock);
+        }
+        break;
+
+    default:
+            break;
+    }
+}
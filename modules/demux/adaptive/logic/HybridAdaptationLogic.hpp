@@ -0,0 +1,71 @@
+/*
+ * HybridAdaptationLogic.hpp
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef HYBRIDADAPTATIONLOGIC_HPP
+#define HYBRIDADAPTATIONLOGIC_HPP
+
+#include "AbstractAdaptationLogic.h"
+#include "Representationselectors.hpp"
+#include <map>
+#include <list>
+
+namespace adaptive
+{
+    namespace logic
+    {
+        class HybridContext
+        {
+            friend class HybridAdaptationLogic;
+
+            public:
+                HybridContext();
+                unsigned getThroughput() const;
+                void     pushThroughput(unsigned);
+
+            private:
+                mtime_t buffering_min;
+                mtime_t buffering_level;
+                mtime_t buffering_target;
+                bool    b_bufferbased; /* else throughput based */
+                std::list<unsigned> samples;
+        };
+
+        class HybridAdaptationLogic : public AbstractAdaptationLogic
+        {
+            public:
+                HybridAdaptationLogic(vlc_object_t *);
+                virtual ~HybridAdaptationLogic();
+
+                virtual BaseRepresentation* getNextRepresentation(BaseAdaptationSet *, BaseRepresentation *);
+                virtual void                updateDownloadRate     (const ID &, size_t, mtime_t); /* reimpl */
+                virtual void                trackerEvent           (const SegmentTrackerEvent &); /* reimpl */
+
+            private:
+                BaseRepresentation *        getBufferBasedRepresentation(BaseAdaptationSet *,
+                                                                         RepresentationSelector &,
+                                                                         const HybridContext &) const;
+                float                       getUtility(const BaseRepresentation *) const;
+                std::map<adaptive::ID, HybridContext> streams;
+                vlc_object_t *              p_obj;
+                vlc_mutex_t                 lock;
+        };
+    }
+}
+
+#endif // HYBRIDADAPTATIONLOGIC_HPP
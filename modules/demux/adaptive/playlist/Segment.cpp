@@ -91,6 +91,65 @@ SegmentChunk* ISegment::toChunk(size_t index, BaseRepresentation *rep, AbstractC
     return NULL;
 }
 
+size_t ISegment::toChunks(const std::vector<ISegment *> &segments, size_t index,
+                          BaseRepresentation *rep, AbstractConnectionManager *connManager,
+                          std::vector<SegmentChunk *> &chunks)
+{
+    const ISegment *first = segments.front();
+    const ISegment *last = segments.back();
+    const std::string url = first->getUrlSegment().toString(index, rep);
+    HTTPChunkBufferedSource *source = new (std::nothrow) HTTPChunkBufferedSource(url, connManager,
+                                                                                 rep->getAdaptationSet()->getID());
+    if( !source )
+        return 0;
+    source->setBytesRange(BytesRange(first->startByte, last->endByte));
+
+    HTTPChunkSharedRequest *request = new (std::nothrow) HTTPChunkSharedRequest(source);
+    if( !request )
+    {
+        delete source;
+        return 0;
+    }
+
+    const size_t count = chunks.size();
+    std::vector<ISegment *>::const_iterator it;
+    for(it = segments.begin(); it != segments.end(); ++it)
+    {
+        ISegment *segment = *it;
+        HTTPChunkRangeSource *range = new (std::nothrow)
+                HTTPChunkRangeSource(request, BytesRange(segment->startByte, segment->endByte),
+                                     segment->startByte - first->startByte);
+        if( !range )
+            break;
+
+        SegmentChunk *chunk = new (std::nothrow) SegmentChunk(segment, range, rep);
+        if( !chunk )
+        {
+            delete range;
+            break;
+        }
+        chunks.push_back(chunk);
+    }
+
+    if( chunks.size() > count )
+        connManager->start(source);
+    /* each range source holds its own reference */
+    request->release();
+
+    return chunks.size() - count;
+}
+
+bool ISegment::isAdjacent(size_t index, const ISegment *other, size_t otherindex,
+                          BaseRepresentation *rep) const
+{
+    if(startByte == endByte || !endByte || other->startByte == other->endByte ||
+       !other->endByte || other->startByte != endByte + 1)
+        return false;
+
+    return getUrlSegment().toString(index, rep) ==
+           other->getUrlSegment().toString(otherindex, rep);
+}
+
 bool ISegment::isTemplate() const
 {
     return templated;
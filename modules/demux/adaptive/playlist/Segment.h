@@ -59,6 +59,12 @@ namespace adaptive
                  *          when using an UrlTemplate
                  */
                 virtual SegmentChunk*                   toChunk         (size_t, BaseRepresentation *, AbstractConnectionManager *);
+                /* chunks of adjacent byte ranges, served by a single request */
+                static size_t                           toChunks        (const std::vector<ISegment *> &, size_t,
+                                                                         BaseRepresentation *, AbstractConnectionManager *,
+                                                                         std::vector<SegmentChunk *> &);
+                virtual bool                            isAdjacent      (size_t, const ISegment *, size_t,
+                                                                         BaseRepresentation *) const;
                 virtual void                            setByteRange    (size_t start, size_t end);
                 virtual void                            setSequenceNumber(uint64_t);
                 virtual uint64_t                        getSequenceNumber() const;
@@ -43,6 +43,7 @@
 #include <vlc_codecs.h>
 #include <vlc_charset.h>
 #include <vlc_memory.h>
+#include <vlc_threads.h>
 
 #include "libavi.h"
 #include "../rawdv.h"
@@ -58,6 +59,11 @@
     "Recreate a index for the AVI file. Use this if your AVI file is damaged "\
     "or incomplete (not seekable)." )
 
+#define INDEX_BACKGROUND_TEXT N_("Create index in background")
+#define INDEX_BACKGROUND_LONGTEXT N_( \
+    "When the index has to be recreated, start playing with the file index " \
+    "and build the new one in background instead of waiting for it." )
+
 #define BI_RAWRGB 0x00
 #define BI_RGBBITFIELDS 0x03
 
@@ -83,6 +89,8 @@ vlc_module_begin ()
     add_integer( "avi-index", 0,
               INDEX_TEXT, INDEX_LONGTEXT, false )
         change_integer_list( pi_index, ppsz_indexes )
+    add_bool( "avi-index-background", false,
+              INDEX_BACKGROUND_TEXT, INDEX_BACKGROUND_LONGTEXT, true )
 
     set_callbacks( Open, Close )
 vlc_module_end ()
@@ -122,11 +130,10 @@ typedef struct
 
 typedef struct
 {
-    vlc_fourcc_t i_id;
-    uint32_t     i_flags;
     off_t        i_pos;
-    uint32_t     i_length;
     int64_t      i_lengthtotal;
+    uint32_t     i_length;
+    uint32_t     i_flags;
 
 } avi_entry_t;
 
@@ -141,6 +148,8 @@ static void avi_index_Init( avi_index_t * );
 static void avi_index_Clean( avi_index_t * );
 static void avi_index_Append( avi_index_t *, off_t *, avi_entry_t * );
 
+typedef struct avi_index_builder_t avi_index_builder_t;
+
 typedef struct
 {
     bool            b_activated;
@@ -163,6 +172,11 @@ typedef struct
     /* Avi Index */
     avi_index_t     idx;
 
+    /* OpenDML sub-indexes not loaded yet (see AVI_IndexLoadLazy) */
+    avi_chunk_indx_t *p_indx_lazy;
+    unsigned int    i_indx_lazy;        /* next super index entry */
+    bool            b_index_nokeyframe; /* index without any key frame */
+
     unsigned int    i_idxposc;  /* numero of chunk */
     unsigned int    i_idxposb;  /* byte in the current chunk */
 
@@ -199,6 +213,9 @@ struct demux_sys_t
 
     unsigned int       i_attachment;
     input_attachment_t **attachment;
+
+    /* index created in background */
+    avi_index_builder_t *p_builder;
 };
 
 static inline off_t __EVEN( off_t i )
@@ -221,12 +238,18 @@ static int AVI_StreamBytesSet ( demux_t *,
 vlc_fourcc_t AVI_FourccGetCodec( unsigned int i_cat, vlc_fourcc_t );
 static int   AVI_GetKeyFlag    ( vlc_fourcc_t , uint8_t * );
 
-static int AVI_PacketGetHeader( demux_t *, avi_packet_t *p_pk );
-static int AVI_PacketNext     ( demux_t * );
-static int AVI_PacketSearch   ( demux_t * );
+static int AVI_PacketGetHeader( stream_t *, avi_packet_t *p_pk );
+static int AVI_PacketNext     ( stream_t * );
+static int AVI_PacketSearch   ( demux_t *, stream_t * );
 
 static void AVI_IndexLoad    ( demux_t * );
+static int  AVI_IndexLoadLazy( demux_t *, avi_track_t * );
+static void AVI_IndexLoadLazyAll( demux_t * );
+static uint64_t AVI_IndexLazyDuration( const avi_chunk_indx_t * );
 static void AVI_IndexCreate  ( demux_t * );
+static int  AVI_IndexBuilderStart( demux_t * );
+static void AVI_IndexBuilderMerge( demux_t * );
+static void AVI_IndexBuilderStop ( demux_t * );
 
 static void AVI_ExtractSubtitle( demux_t *, unsigned int i_stream, avi_chunk_list_t *, avi_chunk_STRING_t * );
 
@@ -262,6 +285,8 @@ static void Close ( vlc_object_t * p_this )
     demux_t *    p_demux = (demux_t *)p_this;
     demux_sys_t *p_sys = p_demux->p_sys  ;
 
+    AVI_IndexBuilderStop( p_demux );
+
     for( unsigned int i = 0; i < p_sys->i_track; i++ )
     {
         if( p_sys->track[i] )
@@ -755,7 +780,15 @@ static int Open( vlc_object_t * p_this )
 aviindex:
         if( p_sys->b_fastseekable )
         {
-            AVI_IndexCreate( p_demux );
+            if( var_InheritBool( p_demux, "avi-index-background" ) &&
+                AVI_IndexBuilderStart( p_demux ) == VLC_SUCCESS )
+            {
+                /* play with the file index meanwhile */
+                if( !b_index )
+                    AVI_IndexLoad( p_demux );
+            }
+            else
+                AVI_IndexCreate( p_demux );
         }
         else if( p_sys->b_seekable )
         {
@@ -779,7 +812,10 @@ aviindex:
     for( unsigned int i = 0; i < p_sys->i_track; i++ )
     {
         const avi_track_t *tk = p_sys->track[i];
-        if( tk->fmt.i_cat == VIDEO_ES && tk->idx.p_entry )
+        if( tk->fmt.i_cat == VIDEO_ES && tk->p_indx_lazy )
+            i_idx_totalframes = __MAX(i_idx_totalframes,
+                                      AVI_IndexLazyDuration( tk->p_indx_lazy ));
+        else if( tk->fmt.i_cat == VIDEO_ES && tk->idx.p_entry )
             i_idx_totalframes = __MAX(i_idx_totalframes, tk->idx.i_size);
     }
     if( i_idx_totalframes != p_avih->i_totalframes &&
@@ -853,6 +889,9 @@ aviindex:
         if( p_auds->p_wf->wFormatTag != WAVE_FORMAT_PCM &&
             tk->i_rate == p_auds->p_wf->nSamplesPerSec )
         {
+            /* the whole index is needed */
+            while( AVI_IndexLoadLazy( p_demux, tk ) == VLC_SUCCESS );
+
             int64_t i_track_length =
                 tk->idx.p_entry[tk->idx.i_size-1].i_length +
                 tk->idx.p_entry[tk->idx.i_size-1].i_lengthtotal;
@@ -991,6 +1030,8 @@ static int Demux_Seekable( demux_t *p_demux )
     /* cannot be more than 100 stream (dcXX or wbXX) */
     avi_track_toread_t toread[100];
 
+    /* switch to the index built in background once ready */
+    AVI_IndexBuilderMerge( p_demux );
 
     /* detect new selected/unselected streams */
     for( i_track = 0; i_track < p_sys->i_track; i_track++ )
@@ -1048,6 +1089,8 @@ static int Demux_Seekable( demux_t *p_demux )
         avi_track_t *tk = p_sys->track[i_track];
 
         toread[i_track].b_ok = tk->b_activated && !tk->b_eof;
+        if( tk->i_idxposc >= tk->idx.i_size )
+            AVI_IndexLoadLazy( p_demux, tk );
         if( tk->i_idxposc < tk->idx.i_size )
         {
             toread[i_track].i_posf = tk->idx.p_entry[tk->i_idxposc].i_pos;
@@ -1126,10 +1169,11 @@ static int Demux_Seekable( demux_t *p_demux )
 
             /* no valid index, we will parse directly the stream
              * in case we fail we will disable all finished stream */
+            AVI_IndexLoadLazyAll( p_demux );
             if( p_sys->b_seekable && p_sys->i_movi_lastchunk_pos >= p_sys->i_movi_begin + 12 )
             {
                 vlc_stream_Seek( p_demux->s, p_sys->i_movi_lastchunk_pos );
-                if( AVI_PacketNext( p_demux ) )
+                if( AVI_PacketNext( p_demux->s ) )
                 {
                     return( AVI_TrackStopFinishedStreams( p_demux ) ? 0 : 1 );
                 }
@@ -1143,7 +1187,7 @@ static int Demux_Seekable( demux_t *p_demux )
             {
                 avi_packet_t avi_pk;
 
-                if( AVI_PacketGetHeader( p_demux, &avi_pk ) )
+                if( AVI_PacketGetHeader( p_demux->s, &avi_pk ) )
                 {
                     msg_Warn( p_demux,
                              "cannot get packet header, track disabled" );
@@ -1152,7 +1196,7 @@ static int Demux_Seekable( demux_t *p_demux )
                 if( avi_pk.i_stream >= p_sys->i_track ||
                     ( avi_pk.i_cat != AUDIO_ES && avi_pk.i_cat != VIDEO_ES ) )
                 {
-                    if( AVI_PacketNext( p_demux ) )
+                    if( AVI_PacketNext( p_demux->s ) )
                     {
                         msg_Warn( p_demux,
                                   "cannot skip packet, track disabled" );
@@ -1179,7 +1223,6 @@ static int Demux_Seekable( demux_t *p_demux )
 
                     /* add this chunk to the index */
                     avi_entry_t index;
-                    index.i_id     = avi_pk.i_fourcc;
                     index.i_flags  = AVI_GetKeyFlag(tk->fmt.i_codec, avi_pk.i_peek);
                     index.i_pos    = avi_pk.i_pos;
                     index.i_length = avi_pk.i_size;
@@ -1193,7 +1236,7 @@ static int Demux_Seekable( demux_t *p_demux )
                     }
                     else
                     {
-                        if( AVI_PacketNext( p_demux ) )
+                        if( AVI_PacketNext( p_demux->s ) )
                         {
                             msg_Warn( p_demux,
                                       "cannot skip packet, track disabled" );
@@ -1290,6 +1333,8 @@ static int Demux_Seekable( demux_t *p_demux )
             toread[i_track].i_toread--;
         }
 
+        if( tk->i_idxposc >= tk->idx.i_size )
+            AVI_IndexLoadLazy( p_demux, tk );
         if( tk->i_idxposc < tk->idx.i_size)
         {
             toread[i_track].i_posf =
@@ -1394,7 +1439,7 @@ static int Demux_UnSeekable( demux_t *p_demux )
 
         avi_packet_t    avi_pk;
 
-        if( AVI_PacketGetHeader( p_demux, &avi_pk ) )
+        if( AVI_PacketGetHeader( p_demux->s, &avi_pk ) )
         {
             return VLC_DEMUXER_EOF;
         }
@@ -1411,18 +1456,18 @@ static int Demux_UnSeekable( demux_t *p_demux )
                 case AVIFOURCC_JUNK:
                 case AVIFOURCC_LIST:
                 case AVIFOURCC_RIFF:
-                    return( !AVI_PacketNext( p_demux ) ? 1 : 0 );
+                    return( !AVI_PacketNext( p_demux->s ) ? 1 : 0 );
                 case AVIFOURCC_idx1:
                     if( p_sys->b_odml )
                     {
-                        return( !AVI_PacketNext( p_demux ) ? 1 : 0 );
+                        return( !AVI_PacketNext( p_demux->s ) ? 1 : 0 );
                     }
                     return VLC_DEMUXER_EOF;
                 default:
                     msg_Warn( p_demux,
                               "seems to have lost position @%"PRIu64", resync",
                               vlc_stream_Tell(p_demux->s) );
-                    if( AVI_PacketSearch( p_demux ) )
+                    if( AVI_PacketSearch( p_demux, p_demux->s ) )
                     {
                         msg_Err( p_demux, "resync failed" );
                         return VLC_DEMUXER_EGENERIC;
@@ -1462,7 +1507,7 @@ static int Demux_UnSeekable( demux_t *p_demux )
             }
             else
             {
-                if( AVI_PacketNext( p_demux ) )
+                if( AVI_PacketNext( p_demux->s ) )
                 {
                     return VLC_DEMUXER_EOF;
                 }
@@ -1500,6 +1545,8 @@ static int Seek( demux_t *p_demux, mtime_t i_date, int i_percent, bool b_accurat
 
     if( p_sys->b_seekable )
     {
+        AVI_IndexBuilderMerge( p_demux );
+
         int64_t i_pos_backup = vlc_stream_Tell( p_demux->s );
 
         /* Check and lazy load indexes if it was not done (not fastseekable) */
@@ -1854,10 +1901,14 @@ static int AVI_StreamChunkFind( demux_t *p_demux, unsigned int i_stream )
 
     /* find first chunk of i_stream that isn't in index */
 
+    /* chunks after the last indexed one are only known once every
+     * sub-index is loaded */
+    AVI_IndexLoadLazyAll( p_demux );
+
     if( p_sys->i_movi_lastchunk_pos >= p_sys->i_movi_begin + 12 )
     {
         vlc_stream_Seek( p_demux->s, p_sys->i_movi_lastchunk_pos );
-        if( AVI_PacketNext( p_demux ) )
+        if( AVI_PacketNext( p_demux->s ) )
         {
             return VLC_EGENERIC;
         }
@@ -1869,7 +1920,7 @@ static int AVI_StreamChunkFind( demux_t *p_demux, unsigned int i_stream )
 
     for( ;; )
     {
-        if( AVI_PacketGetHeader( p_demux, &avi_pk ) )
+        if( AVI_PacketGetHeader( p_demux->s, &avi_pk ) )
         {
             msg_Warn( p_demux, "cannot get packet header" );
             return VLC_EGENERIC;
@@ -1877,7 +1928,7 @@ static int AVI_StreamChunkFind( demux_t *p_demux, unsigned int i_stream )
         if( avi_pk.i_stream >= p_sys->i_track ||
             ( avi_pk.i_cat != AUDIO_ES && avi_pk.i_cat != VIDEO_ES ) )
         {
-            if( AVI_PacketNext( p_demux ) )
+            if( AVI_PacketNext( p_demux->s ) )
             {
                 return VLC_EGENERIC;
             }
@@ -1899,7 +1950,6 @@ static int AVI_StreamChunkFind( demux_t *p_demux, unsigned int i_stream )
 
             /* add this chunk to the index */
             avi_entry_t index;
-            index.i_id     = avi_pk.i_fourcc;
             index.i_flags  = AVI_GetKeyFlag(tk_pk->fmt.i_codec, avi_pk.i_peek);
             index.i_pos    = avi_pk.i_pos;
             index.i_length = avi_pk.i_size;
@@ -1911,7 +1961,7 @@ static int AVI_StreamChunkFind( demux_t *p_demux, unsigned int i_stream )
                 return VLC_SUCCESS;
             }
 
-            if( AVI_PacketNext( p_demux ) )
+            if( AVI_PacketNext( p_demux->s ) )
             {
                 return VLC_EGENERIC;
             }
@@ -1929,6 +1979,9 @@ static int AVI_StreamChunkSet( demux_t *p_demux, unsigned int i_stream,
     p_stream->i_idxposc = i_ck;
     p_stream->i_idxposb = 0;
 
+    while( i_ck >= p_stream->idx.i_size &&
+           AVI_IndexLoadLazy( p_demux, p_stream ) == VLC_SUCCESS );
+
     if(  i_ck >= p_stream->idx.i_size )
     {
         p_stream->i_idxposc = p_stream->idx.i_size - 1;
@@ -1954,6 +2007,11 @@ static int AVI_StreamBytesSet( demux_t    *p_demux,
     demux_sys_t *p_sys = p_demux->p_sys;
     avi_track_t *p_stream = p_sys->track[i_stream];
 
+    while( ( p_stream->idx.i_size == 0 ||
+             i_byte >= p_stream->idx.p_entry[p_stream->idx.i_size - 1].i_lengthtotal +
+                       p_stream->idx.p_entry[p_stream->idx.i_size - 1].i_length ) &&
+           AVI_IndexLoadLazy( p_demux, p_stream ) == VLC_SUCCESS );
+
     if( ( p_stream->idx.i_size > 0 )
         &&( i_byte < p_stream->idx.p_entry[p_stream->idx.i_size - 1].i_lengthtotal +
                 p_stream->idx.p_entry[p_stream->idx.i_size - 1].i_length ) )
@@ -2208,17 +2266,17 @@ static void AVI_ParseStreamHeader( vlc_fourcc_t i_id,
 /****************************************************************************
  *
  ****************************************************************************/
-static int AVI_PacketGetHeader( demux_t *p_demux, avi_packet_t *p_pk )
+static int AVI_PacketGetHeader( stream_t *s, avi_packet_t *p_pk )
 {
     const uint8_t *p_peek;
 
-    if( vlc_stream_Peek( p_demux->s, &p_peek, 16 ) < 16 )
+    if( vlc_stream_Peek( s, &p_peek, 16 ) < 16 )
     {
         return VLC_EGENERIC;
     }
     p_pk->i_fourcc  = VLC_FOURCC( p_peek[0], p_peek[1], p_peek[2], p_peek[3] );
     p_pk->i_size    = GetDWLE( p_peek + 4 );
-    p_pk->i_pos     = vlc_stream_Tell( p_demux->s );
+    p_pk->i_pos     = vlc_stream_Tell( s );
     if( p_pk->i_fourcc == AVIFOURCC_LIST || p_pk->i_fourcc == AVIFOURCC_RIFF )
     {
         p_pk->i_type = VLC_FOURCC( p_peek[8],  p_peek[9],
@@ -2235,12 +2293,12 @@ static int AVI_PacketGetHeader( demux_t *p_demux, avi_packet_t *p_pk )
     return VLC_SUCCESS;
 }
 
-static int AVI_PacketNext( demux_t *p_demux )
+static int AVI_PacketNext( stream_t *s )
 {
     avi_packet_t    avi_ck;
     size_t          i_skip = 0;
 
-    if( AVI_PacketGetHeader( p_demux, &avi_ck ) )
+    if( AVI_PacketGetHeader( s, &avi_ck ) )
     {
         return VLC_EGENERIC;
     }
@@ -2265,7 +2323,7 @@ static int AVI_PacketNext( demux_t *p_demux )
     if( i_skip > SSIZE_MAX )
         return VLC_EGENERIC;
 
-    ssize_t i_ret = vlc_stream_Read( p_demux->s, NULL, i_skip );
+    ssize_t i_ret = vlc_stream_Read( s, NULL, i_skip );
     if( i_ret < 0 || (size_t) i_ret != i_skip )
     {
         return VLC_EGENERIC;
@@ -2273,7 +2331,7 @@ static int AVI_PacketNext( demux_t *p_demux )
     return VLC_SUCCESS;
 }
 
-static int AVI_PacketSearch( demux_t *p_demux )
+static int AVI_PacketSearch( demux_t *p_demux, stream_t *s )
 {
     demux_sys_t     *p_sys = p_demux->p_sys;
     avi_packet_t    avi_pk;
@@ -2281,11 +2339,11 @@ static int AVI_PacketSearch( demux_t *p_demux )
 
     for( ;; )
     {
-        if( vlc_stream_Read( p_demux->s, NULL, 1 ) != 1 )
+        if( vlc_stream_Read( s, NULL, 1 ) != 1 )
         {
             return VLC_EGENERIC;
         }
-        AVI_PacketGetHeader( p_demux, &avi_pk );
+        AVI_PacketGetHeader( s, &avi_pk );
         if( avi_pk.i_stream < p_sys->i_track &&
             ( avi_pk.i_cat == AUDIO_ES || avi_pk.i_cat == VIDEO_ES ) )
         {
@@ -2333,14 +2391,19 @@ static void avi_index_Append( avi_index_t *p_index, off_t *pi_last_pos,
     if( *pi_last_pos < p_entry->i_pos )
          *pi_last_pos = p_entry->i_pos;
 
-    /* add the entry */
+    /* add the entry, growing the table geometrically as indexes of large
+     * files are appended one entry at a time */
     if( p_index->i_size >= p_index->i_max )
     {
-        p_index->i_max += 16384;
-        p_index->p_entry = realloc_or_free( p_index->p_entry,
-                                            p_index->i_max * sizeof( *p_index->p_entry ) );
-        if( !p_index->p_entry )
+        unsigned int i_max = p_index->i_max ? p_index->i_max * 2 : 16384;
+        if( i_max <= p_index->i_max )
+            return;
+        avi_entry_t *p_new = realloc( p_index->p_entry,
+                                      i_max * sizeof( *p_index->p_entry ) );
+        if( !p_new )
             return;
+        p_index->p_entry = p_new;
+        p_index->i_max = i_max;
     }
     /* calculate cumulate length */
     if( p_index->i_size > 0 )
@@ -2444,7 +2507,6 @@ static int AVI_IndexLoad_idx1( demux_t *p_demux,
             (i_cat == p_sys->track[i_stream]->fmt.i_cat || i_cat == UNKNOWN_ES ) )
         {
             avi_entry_t index;
-            index.i_id     = p_idx1->entry[i_index].i_fourcc;
             index.i_flags  = p_idx1->entry[i_index].i_flags&(~AVIIF_FIXKEYFRAME);
             index.i_pos    = p_idx1->entry[i_index].i_pos + i_offset;
             index.i_length = p_idx1->entry[i_index].i_length;
@@ -2489,7 +2551,6 @@ static void __Parse_indx( demux_t *p_demux, avi_index_t *p_index, off_t *pi_max_
     {
         for( unsigned i = 0; i < p_indx->i_entriesinuse; i++ )
         {
-            index.i_id     = p_indx->i_id;
             index.i_flags  = p_indx->idx.std[i].i_size & 0x80000000 ? 0 : AVIIF_KEYFRAME;
             index.i_pos    = p_indx->i_baseoffset + p_indx->idx.std[i].i_offset - 8;
             index.i_length = p_indx->idx.std[i].i_size&0x7fffffff;
@@ -2502,7 +2563,6 @@ static void __Parse_indx( demux_t *p_demux, avi_index_t *p_index, off_t *pi_max_
     {
         for( unsigned i = 0; i < p_indx->i_entriesinuse; i++ )
         {
-            index.i_id     = p_indx->i_id;
             index.i_flags  = p_indx->idx.field[i].i_size & 0x80000000 ? 0 : AVIIF_KEYFRAME;
             index.i_pos    = p_indx->i_baseoffset + p_indx->idx.field[i].i_offset - 8;
             index.i_length = p_indx->idx.field[i].i_size;
@@ -2553,6 +2613,14 @@ static void AVI_IndexLoad_indx( demux_t *p_demux,
         {
             if ( !p_sys->b_seekable )
                 return;
+
+            /* Large OpenDML files have hundreds of sub-indexes spread over
+             * the file: when seeking is cheap and the super index gives the
+             * stream duration, only read the first one now and the others
+             * when playback or seek reach them */
+            const bool b_lazy = p_sys->b_odml && p_sys->b_fastseekable &&
+                                AVI_IndexLazyDuration( p_indx ) > 0;
+
             avi_chunk_t    ck_sub;
             for( unsigned i = 0; i < p_indx->i_entriesinuse; i++ )
             {
@@ -2565,6 +2633,14 @@ static void AVI_IndexLoad_indx( demux_t *p_demux,
                 if( ck_sub.indx.i_indextype == AVI_INDEX_OF_CHUNKS )
                     __Parse_indx( p_demux, &p_index[i_stream], pi_last_offset, &ck_sub.indx );
                 AVI_ChunkClean( p_demux->s, &ck_sub );
+
+                if( b_lazy && p_index[i_stream].i_size > 0 &&
+                    i + 1 < p_indx->i_entriesinuse )
+                {
+                    p_stream->p_indx_lazy = p_indx;
+                    p_stream->i_indx_lazy = i + 1;
+                    break;
+                }
             }
         }
         else
@@ -2591,6 +2667,12 @@ static void AVI_IndexLoad( demux_t *p_demux )
     off_t i_indx_last_pos = p_sys->i_movi_lastchunk_pos;
     off_t i_idx1_last_pos = p_sys->i_movi_lastchunk_pos;
 
+    for( unsigned i = 0; i < p_sys->i_track; i++ )
+    {
+        p_sys->track[i]->p_indx_lazy = NULL;
+        p_sys->track[i]->b_index_nokeyframe = false;
+    }
+
     AVI_IndexLoad_indx( p_demux, p_idx_indx, &i_indx_last_pos );
     if( !p_sys->b_odml )
         AVI_IndexLoad_idx1( p_demux, p_idx_idx1, &i_idx1_last_pos );
@@ -2608,6 +2690,7 @@ static void AVI_IndexLoad( demux_t *p_demux )
         {
             msg_Dbg( p_demux, "selected standard index for stream[%u]", i );
             p_sys->track[i]->idx = p_idx_idx1[i];
+            p_sys->track[i]->p_indx_lazy = NULL;
             avi_index_Clean( &p_idx_indx[i] );
         }
     }
@@ -2626,75 +2709,107 @@ static void AVI_IndexLoad( demux_t *p_demux )
             msg_Err( p_demux, "no key frame set for track %u", i );
             for( unsigned j = 0; j < p_index->i_size; j++ )
                 p_index->p_entry[j].i_flags |= AVIIF_KEYFRAME;
+            p_sys->track[i]->b_index_nokeyframe = true;
         }
 
         /* */
-        msg_Dbg( p_demux, "stream[%d] created %d index entries",
-                 i, p_index->i_size );
+        msg_Dbg( p_demux, "stream[%d] created %d index entries%s",
+                 i, p_index->i_size,
+                 p_sys->track[i]->p_indx_lazy ? " (more to be loaded)" : "" );
     }
 }
 
-static void AVI_IndexCreate( demux_t *p_demux )
+/* Sum of the durations of the super index, 0 if one is missing */
+static uint64_t AVI_IndexLazyDuration( const avi_chunk_indx_t *p_indx )
 {
-    demux_sys_t *p_sys = p_demux->p_sys;
-
-    avi_chunk_list_t *p_riff;
-    avi_chunk_list_t *p_movi;
+    uint64_t i_duration = 0;
 
-    unsigned int i_stream;
-    off_t i_movi_end;
+    for( unsigned i = 0; i < p_indx->i_entriesinuse; i++ )
+    {
+        if( p_indx->idx.super[i].i_duration == 0 )
+            return 0;
+        i_duration += p_indx->idx.super[i].i_duration;
+    }
+    return i_duration;
+}
 
-    mtime_t i_dialog_update;
-    vlc_dialog_id *p_dialog_id = NULL;
+/* Appends the entries of the next OpenDML sub-index(es) not loaded yet.
+ * Returns VLC_SUCCESS if the index of the track has grown */
+static int AVI_IndexLoadLazy( demux_t *p_demux, avi_track_t *tk )
+{
+    demux_sys_t      *p_sys = p_demux->p_sys;
+    avi_chunk_indx_t *p_indx = tk->p_indx_lazy;
+    const unsigned int i_size = tk->idx.i_size;
 
-    p_riff = AVI_ChunkFind( &p_sys->ck_root, AVIFOURCC_RIFF, 0);
-    p_movi = AVI_ChunkFind( p_riff, AVIFOURCC_movi, 0);
+    if( p_indx == NULL )
+        return VLC_EGENERIC;
 
-    if( !p_movi )
+    while( tk->idx.i_size == i_size && tk->i_indx_lazy < p_indx->i_entriesinuse )
     {
-        msg_Err( p_demux, "cannot find p_movi" );
-        return;
+        avi_chunk_t ck_sub;
+
+        if( vlc_stream_Seek( p_demux->s,
+                             p_indx->idx.super[tk->i_indx_lazy].i_offset ) ||
+            AVI_ChunkRead( p_demux->s, &ck_sub, NULL ) )
+        {
+            msg_Warn( p_demux, "cannot read sub-index %u", tk->i_indx_lazy );
+            break;
+        }
+        tk->i_indx_lazy++;
+        if( ck_sub.indx.i_indextype == AVI_INDEX_OF_CHUNKS )
+            __Parse_indx( p_demux, &tk->idx, &p_sys->i_movi_lastchunk_pos, &ck_sub.indx );
+        AVI_ChunkClean( p_demux->s, &ck_sub );
     }
 
-    for( i_stream = 0; i_stream < p_sys->i_track; i_stream++ )
-        avi_index_Init( &p_sys->track[i_stream]->idx );
+    if( tk->idx.i_size == i_size || tk->i_indx_lazy >= p_indx->i_entriesinuse )
+        tk->p_indx_lazy = NULL;
 
-    i_movi_end = __MIN( (off_t)(p_movi->i_chunk_pos + p_movi->i_chunk_size),
-                        stream_Size( p_demux->s ) );
+    if( tk->b_index_nokeyframe )
+    {
+        for( unsigned j = i_size; j < tk->idx.i_size; j++ )
+            tk->idx.p_entry[j].i_flags |= AVIIF_KEYFRAME;
+    }
 
-    vlc_stream_Seek( p_demux->s, p_movi->i_chunk_pos + 12 );
-    msg_Warn( p_demux, "creating index from LIST-movi, will take time !" );
+    return tk->idx.i_size > i_size ? VLC_SUCCESS : VLC_EGENERIC;
+}
 
+static void AVI_IndexLoadLazyAll( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
 
-    /* Only show dialog if AVI is > 10MB */
-    i_dialog_update = mdate();
-    if( stream_Size( p_demux->s ) > 10000000 )
+    for( unsigned i = 0; i < p_sys->i_track; i++ )
     {
-        p_dialog_id =
-            vlc_dialog_display_progress( p_demux, false, 0.0, _("Cancel"),
-                                         _("Broken or missing AVI Index"),
-                                         _("Fixing AVI Index...") );
+        while( AVI_IndexLoadLazy( p_demux, p_sys->track[i] ) == VLC_SUCCESS );
     }
+}
+
+/* Indexes the chunks of every track, from the current position of s up to
+ * the end of LIST-movi, and in the following RIFF-AVIX for OpenDML files.
+ * pf_progress is called regularly and stops the scan when returning false */
+static void AVI_IndexScan( demux_t *p_demux, stream_t *s,
+                           off_t i_movi_end, off_t i_avix_pos,
+                           avi_index_t p_index[], off_t *pi_last_pos,
+                           bool (*pf_progress)( void *, double ), void *p_opaque )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    mtime_t i_progress_update = mdate();
 
     for( ;; )
     {
         avi_packet_t pk;
 
-        /* Don't update/check dialog too often */
-        if( p_dialog_id != NULL && mdate() - i_dialog_update > 100000 )
+        /* Don't update/check progress too often */
+        if( mdate() - i_progress_update > 100000 )
         {
-            if( vlc_dialog_is_cancelled( p_demux, p_dialog_id ) )
+            double f_current = vlc_stream_Tell( s );
+            double f_size    = stream_Size( s );
+            if( !pf_progress( p_opaque, f_current / f_size ) )
                 break;
 
-            double f_current = vlc_stream_Tell( p_demux->s );
-            double f_size    = stream_Size( p_demux->s );
-            double f_pos     = f_current / f_size;
-            vlc_dialog_update_progress( p_demux, p_dialog_id, f_pos );
-
-            i_dialog_update = mdate();
+            i_progress_update = mdate();
         }
 
-        if( AVI_PacketGetHeader( p_demux, &pk ) )
+        if( AVI_PacketGetHeader( s, &pk ) )
             break;
 
         if( pk.i_stream < p_sys->i_track &&
@@ -2703,31 +2818,25 @@ static void AVI_IndexCreate( demux_t *p_demux )
             avi_track_t *tk = p_sys->track[pk.i_stream];
 
             avi_entry_t index;
-            index.i_id      = pk.i_fourcc;
             index.i_flags   = AVI_GetKeyFlag(tk->fmt.i_codec, pk.i_peek);
             index.i_pos     = pk.i_pos;
             index.i_length  = pk.i_size;
             index.i_lengthtotal = pk.i_size;
-            avi_index_Append( &tk->idx, &p_sys->i_movi_lastchunk_pos, &index );
+            avi_index_Append( &p_index[pk.i_stream], pi_last_pos, &index );
         }
         else
         {
             switch( pk.i_fourcc )
             {
             case AVIFOURCC_idx1:
-                if( p_sys->b_odml )
+                if( p_sys->b_odml && i_avix_pos > 0 )
                 {
-                    avi_chunk_list_t *p_sysx;
-                    p_sysx = AVI_ChunkFind( &p_sys->ck_root,
-                                            AVIFOURCC_RIFF, 1 );
-
                     msg_Dbg( p_demux, "looking for new RIFF chunk" );
-                    if( vlc_stream_Seek( p_demux->s,
-                                         p_sysx->i_chunk_pos + 24 ) )
-                        goto print_stat;
+                    if( vlc_stream_Seek( s, i_avix_pos + 24 ) )
+                        return;
                     break;
                 }
-                goto print_stat;
+                return;
 
             case AVIFOURCC_RIFF:
                     msg_Dbg( p_demux, "new RIFF chunk found" );
@@ -2739,30 +2848,316 @@ static void AVI_IndexCreate( demux_t *p_demux )
 
             default:
                 msg_Warn( p_demux, "need resync, probably broken avi" );
-                if( AVI_PacketSearch( p_demux ) )
+                if( AVI_PacketSearch( p_demux, s ) )
                 {
                     msg_Warn( p_demux, "lost sync, abord index creation" );
-                    goto print_stat;
+                    return;
                 }
             }
         }
 
         if( ( !p_sys->b_odml && pk.i_pos + pk.i_size >= i_movi_end ) ||
-            AVI_PacketNext( p_demux ) )
+            AVI_PacketNext( s ) )
         {
             break;
         }
     }
+}
+
+static int AVI_IndexScanInit( demux_t *p_demux, off_t *pi_movi_begin,
+                              off_t *pi_movi_end, off_t *pi_avix_pos )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    avi_chunk_list_t *p_riff = AVI_ChunkFind( &p_sys->ck_root, AVIFOURCC_RIFF, 0);
+    avi_chunk_list_t *p_movi = AVI_ChunkFind( p_riff, AVIFOURCC_movi, 0);
+
+    if( !p_movi )
+    {
+        msg_Err( p_demux, "cannot find p_movi" );
+        return VLC_EGENERIC;
+    }
+
+    *pi_movi_begin = p_movi->i_chunk_pos;
+    *pi_movi_end = __MIN( (off_t)(p_movi->i_chunk_pos + p_movi->i_chunk_size),
+                          stream_Size( p_demux->s ) );
+
+    avi_chunk_list_t *p_sysx = AVI_ChunkFind( &p_sys->ck_root, AVIFOURCC_RIFF, 1 );
+    *pi_avix_pos = p_sysx ? p_sysx->i_chunk_pos : 0;
+
+    return VLC_SUCCESS;
+}
+
+typedef struct
+{
+    demux_t       *p_demux;
+    vlc_dialog_id *p_dialog_id;
+} avi_index_dialog_t;
+
+static bool AVI_IndexCreateProgress( void *p_data, double f_pos )
+{
+    avi_index_dialog_t *p_dialog = p_data;
+
+    if( p_dialog->p_dialog_id == NULL )
+        return true;
+    if( vlc_dialog_is_cancelled( p_dialog->p_demux, p_dialog->p_dialog_id ) )
+        return false;
+
+    vlc_dialog_update_progress( p_dialog->p_demux, p_dialog->p_dialog_id, f_pos );
+    return true;
+}
 
-print_stat:
-    if( p_dialog_id != NULL )
-        vlc_dialog_release( p_demux, p_dialog_id );
+static void AVI_IndexCreate( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
 
+    unsigned int i_stream;
+    off_t i_movi_begin, i_movi_end, i_avix_pos;
+
+    if( AVI_IndexScanInit( p_demux, &i_movi_begin, &i_movi_end, &i_avix_pos ) )
+        return;
+
+    /* The track count comes from the file: do not size a stack array by it */
+    avi_index_t *p_index = calloc( p_sys->i_track, sizeof( *p_index ) );
+    if( p_index == NULL )
+        return;
     for( i_stream = 0; i_stream < p_sys->i_track; i_stream++ )
+        avi_index_Init( &p_index[i_stream] );
+
+    vlc_stream_Seek( p_demux->s, i_movi_begin + 12 );
+    msg_Warn( p_demux, "creating index from LIST-movi, will take time !" );
+
+
+    /* Only show dialog if AVI is > 10MB */
+    avi_index_dialog_t dialog = { p_demux, NULL };
+    if( stream_Size( p_demux->s ) > 10000000 )
     {
+        dialog.p_dialog_id =
+            vlc_dialog_display_progress( p_demux, false, 0.0, _("Cancel"),
+                                         _("Broken or missing AVI Index"),
+                                         _("Fixing AVI Index...") );
+    }
+
+    AVI_IndexScan( p_demux, p_demux->s, i_movi_end, i_avix_pos,
+                   p_index, &p_sys->i_movi_lastchunk_pos,
+                   AVI_IndexCreateProgress, &dialog );
+
+    if( dialog.p_dialog_id != NULL )
+        vlc_dialog_release( p_demux, dialog.p_dialog_id );
+
+    for( i_stream = 0; i_stream < p_sys->i_track; i_stream++ )
+    {
+        avi_track_t *tk = p_sys->track[i_stream];
+
+        avi_index_Clean( &tk->idx );
+        tk->idx = p_index[i_stream];
+        tk->p_indx_lazy = NULL;
+
         msg_Dbg( p_demux, "stream[%d] creating %d index entries",
-                i_stream, p_sys->track[i_stream]->idx.i_size );
+                i_stream, tk->idx.i_size );
+    }
+    free( p_index );
+}
+
+/*****************************************************************************
+ * Background index creation: the chunks are scanned from a separate stream
+ * and thread, while playing with the file index, and the new index replaces
+ * the file one once complete.
+ *****************************************************************************/
+struct avi_index_builder_t
+{
+    vlc_thread_t thread;
+    vlc_mutex_t  lock;
+    bool         b_abort;
+    bool         b_done;
+
+    demux_t     *p_demux;
+    stream_t    *s;
+    off_t        i_movi_end;
+    off_t        i_avix_pos;
+
+    off_t        i_last_pos;
+    avi_index_t  index[];   /* one per track */
+};
+
+static bool AVI_IndexBuilderProgress( void *p_data, double f_pos )
+{
+    avi_index_builder_t *p_builder = p_data;
+    VLC_UNUSED( f_pos );
+
+    vlc_mutex_lock( &p_builder->lock );
+    bool b_continue = !p_builder->b_abort;
+    vlc_mutex_unlock( &p_builder->lock );
+
+    return b_continue;
+}
+
+static void *AVI_IndexBuilderThread( void *p_data )
+{
+    avi_index_builder_t *p_builder = p_data;
+
+    AVI_IndexScan( p_builder->p_demux, p_builder->s,
+                   p_builder->i_movi_end, p_builder->i_avix_pos,
+                   p_builder->index, &p_builder->i_last_pos,
+                   AVI_IndexBuilderProgress, p_builder );
+
+    vlc_mutex_lock( &p_builder->lock );
+    p_builder->b_done = true;
+    vlc_mutex_unlock( &p_builder->lock );
+
+    return NULL;
+}
+
+static int AVI_IndexBuilderStart( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    off_t i_movi_begin;
+
+    if( p_demux->s->psz_url == NULL )
+        return VLC_EGENERIC;
+
+    avi_index_builder_t *p_builder =
+        malloc( sizeof( *p_builder ) + p_sys->i_track * sizeof( avi_index_t ) );
+    if( unlikely( p_builder == NULL ) )
+        return VLC_EGENERIC;
+
+    if( AVI_IndexScanInit( p_demux, &i_movi_begin, &p_builder->i_movi_end,
+                           &p_builder->i_avix_pos ) )
+    {
+        free( p_builder );
+        return VLC_EGENERIC;
+    }
+
+    p_builder->s = vlc_stream_NewURL( p_demux, p_demux->s->psz_url );
+    if( p_builder->s == NULL ||
+        vlc_stream_Seek( p_builder->s, i_movi_begin + 12 ) )
+    {
+        if( p_builder->s != NULL )
+            vlc_stream_Delete( p_builder->s );
+        free( p_builder );
+        return VLC_EGENERIC;
+    }
+
+    p_builder->p_demux = p_demux;
+    p_builder->b_abort = false;
+    p_builder->b_done = false;
+    p_builder->i_last_pos = 0;
+    for( unsigned i = 0; i < p_sys->i_track; i++ )
+        avi_index_Init( &p_builder->index[i] );
+    vlc_mutex_init( &p_builder->lock );
+
+    if( vlc_clone( &p_builder->thread, AVI_IndexBuilderThread, p_builder,
+                   VLC_THREAD_PRIORITY_LOW ) )
+    {
+        vlc_mutex_destroy( &p_builder->lock );
+        vlc_stream_Delete( p_builder->s );
+        free( p_builder );
+        return VLC_EGENERIC;
     }
+
+    msg_Dbg( p_demux, "creating index in background" );
+    p_sys->p_builder = p_builder;
+    return VLC_SUCCESS;
+}
+
+static void AVI_IndexBuilderDelete( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    avi_index_builder_t *p_builder = p_sys->p_builder;
+
+    for( unsigned i = 0; i < p_sys->i_track; i++ )
+        avi_index_Clean( &p_builder->index[i] );
+    vlc_mutex_destroy( &p_builder->lock );
+    vlc_stream_Delete( p_builder->s );
+    free( p_builder );
+
+    p_sys->p_builder = NULL;
+}
+
+/* Switches to the new index once built, keeping each track on its current
+ * chunk */
+static void AVI_IndexBuilderMerge( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    avi_index_builder_t *p_builder = p_sys->p_builder;
+
+    if( p_builder == NULL )
+        return;
+
+    vlc_mutex_lock( &p_builder->lock );
+    const bool b_done = p_builder->b_done;
+    vlc_mutex_unlock( &p_builder->lock );
+    if( !b_done )
+        return;
+
+    vlc_join( p_builder->thread, NULL );
+
+    for( unsigned i = 0; i < p_sys->i_track; i++ )
+    {
+        avi_track_t *tk = p_sys->track[i];
+        avi_index_t *p_index = &p_builder->index[i];
+        bool b_found = tk->idx.i_size == 0;
+
+        /* the scan was interrupted, keep the file index */
+        if( p_index->i_size < tk->idx.i_size )
+            continue;
+
+        if( tk->idx.i_size > 0 )
+        {
+            const unsigned i_ck = __MIN( tk->i_idxposc, tk->idx.i_size - 1 );
+            const off_t i_pos = tk->idx.p_entry[i_ck].i_pos;
+            unsigned i_min = 0, i_max = p_index->i_size;
+
+            while( i_min < i_max )
+            {
+                unsigned i_mid = ( i_min + i_max ) / 2;
+                if( p_index->p_entry[i_mid].i_pos < i_pos )
+                    i_min = i_mid + 1;
+                else
+                    i_max = i_mid;
+            }
+            if( i_min < p_index->i_size && p_index->p_entry[i_min].i_pos == i_pos )
+            {
+                tk->i_idxposc = i_min + ( tk->i_idxposc - i_ck );
+                b_found = true;
+            }
+        }
+
+        avi_index_Clean( &tk->idx );
+        tk->idx = *p_index;
+        tk->p_indx_lazy = NULL;
+        avi_index_Init( p_index );
+
+        if( !b_found && tk->b_activated )
+        {
+            tk->b_eof = AVI_TrackSeek( p_demux, i, p_sys->i_time ) != 0;
+            tk->i_next_block_flags |= BLOCK_FLAG_DISCONTINUITY;
+        }
+    }
+    p_sys->i_movi_lastchunk_pos = __MAX( p_sys->i_movi_lastchunk_pos,
+                                         p_builder->i_last_pos );
+    p_sys->i_length = AVI_MovieGetLength( p_demux );
+    p_sys->b_indexloaded = true;
+
+    msg_Dbg( p_demux, "index created in background, length %"PRId64" s",
+             p_sys->i_length );
+
+    AVI_IndexBuilderDelete( p_demux );
+}
+
+static void AVI_IndexBuilderStop( demux_t *p_demux )
+{
+    avi_index_builder_t *p_builder = p_demux->p_sys->p_builder;
+
+    if( p_builder == NULL )
+        return;
+
+    vlc_mutex_lock( &p_builder->lock );
+    p_builder->b_abort = true;
+    vlc_mutex_unlock( &p_builder->lock );
+
+    vlc_join( p_builder->thread, NULL );
+    AVI_IndexBuilderDelete( p_demux );
 }
 
 /* */
@@ -3055,7 +3450,15 @@ static mtime_t  AVI_MovieGetLength( demux_t *p_demux )
             continue;
         }
 
-        if( tk->i_samplesize )
+        if( tk->p_indx_lazy )
+        {
+            /* from the durations of the super index */
+            uint64_t i_duration = AVI_IndexLazyDuration( tk->p_indx_lazy );
+            if( tk->i_samplesize )
+                i_duration *= tk->i_samplesize;
+            i_length = AVI_GetDPTS( tk, i_duration );
+        }
+        else if( tk->i_samplesize )
         {
             i_length = AVI_GetDPTS( tk,
                                     tk->idx.p_entry[tk->idx.i_size-1].i_lengthtotal +
@@ -0,0 +1,117 @@
+/*****************************************************************************
+ * index_cache.c: on-disk cache of demuxer seek indexes
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_configuration.h>
+#include <vlc_fs.h>
+#include <vlc_md5.h>
+
+#include "index_cache.h"
+
+static char *index_cache_Path( const char *psz_prefix, const char *psz_url,
+                               bool b_create )
+{
+    char *psz_dir = config_GetUserDir( VLC_CACHE_DIR );
+    if( !psz_dir )
+        return NULL;
+    if( b_create )
+        vlc_mkdir( psz_dir, 0700 );
+
+    struct md5_s md5;
+    InitMD5( &md5 );
+    AddMD5( &md5, psz_url, strlen( psz_url ) );
+    EndMD5( &md5 );
+    char *psz_hash = psz_md5_hash( &md5 );
+
+    char *psz_path = NULL;
+    if( psz_hash &&
+        asprintf( &psz_path, "%s"DIR_SEP"%s-%s.idx", psz_dir, psz_prefix,
+                  psz_hash ) < 0 )
+        psz_path = NULL;
+
+    free( psz_hash );
+    free( psz_dir );
+    return psz_path;
+}
+
+FILE *index_cache_Open( const char *psz_prefix, const char *psz_url )
+{
+    char *psz_path = index_cache_Path( psz_prefix, psz_url, false );
+    if( !psz_path )
+        return NULL;
+
+    FILE *p_file = vlc_fopen( psz_path, "rb" );
+    free( psz_path );
+    return p_file;
+}
+
+int index_cache_Begin( index_cache_writer_t *p_writer, const char *psz_prefix,
+                       const char *psz_url )
+{
+    p_writer->p_file = NULL;
+    p_writer->psz_tmp = NULL;
+    p_writer->psz_path = index_cache_Path( psz_prefix, psz_url, true );
+    if( !p_writer->psz_path )
+        return VLC_ENOMEM;
+
+    if( asprintf( &p_writer->psz_tmp, "%s.XXXXXX", p_writer->psz_path ) < 0 )
+    {
+        p_writer->psz_tmp = NULL;
+        goto error;
+    }
+
+    int fd = vlc_mkstemp( p_writer->psz_tmp );
+    if( fd == -1 )
+        goto error;
+
+    p_writer->p_file = fdopen( fd, "wb" );
+    if( !p_writer->p_file )
+    {
+        vlc_close( fd );
+        vlc_unlink( p_writer->psz_tmp );
+        goto error;
+    }
+    return VLC_SUCCESS;
+
+error:
+    free( p_writer->psz_tmp );
+    free( p_writer->psz_path );
+    p_writer->psz_tmp = p_writer->psz_path = NULL;
+    return VLC_EGENERIC;
+}
+
+int index_cache_End( index_cache_writer_t *p_writer, bool b_ok )
+{
+    if( fclose( p_writer->p_file ) )
+        b_ok = false;
+
+    if( !b_ok || vlc_rename( p_writer->psz_tmp, p_writer->psz_path ) )
+    {
+        b_ok = false;
+        vlc_unlink( p_writer->psz_tmp );
+    }
+
+    free( p_writer->psz_tmp );
+    free( p_writer->psz_path );
+    return b_ok ? VLC_SUCCESS : VLC_EGENERIC;
+}
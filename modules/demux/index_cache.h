@@ -0,0 +1,56 @@
+/*****************************************************************************
+ * index_cache.h: on-disk cache of demuxer seek indexes
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef VLC_DEMUX_INDEX_CACHE_H
+#define VLC_DEMUX_INDEX_CACHE_H
+
+#include <stdio.h>
+
+/* Index files live in the user cache directory, named after a per demuxer
+ * prefix and a hash of the media url. Their content is up to the demuxer,
+ * and is written in host endianness: the cache is not meant to be shared. */
+
+# ifdef __cplusplus
+extern "C" {
+# endif
+
+typedef struct
+{
+    FILE *p_file;   /* temporary file to write the index to */
+    char *psz_path;
+    char *psz_tmp;
+} index_cache_writer_t;
+
+/* Opens the cached index of an url for reading, or returns NULL */
+FILE *index_cache_Open( const char *psz_prefix, const char *psz_url );
+
+/* Creates a temporary file to write the index of an url to */
+int index_cache_Begin( index_cache_writer_t *, const char *psz_prefix,
+                       const char *psz_url );
+
+/* Closes the temporary file and, if b_ok, atomically replaces the cached
+ * index with it, so readers never see a partial index.
+ * Returns VLC_SUCCESS if the index was stored. */
+int index_cache_End( index_cache_writer_t *, bool b_ok );
+
+# ifdef __cplusplus
+}
+# endif
+
+#endif
@@ -23,6 +23,8 @@
  *****************************************************************************/
 
 #include "matroska_segment.hpp"
+#include "matroska_segment_indexer.hpp"
+#include "stream_io_callback.hpp"
 #include "chapters.hpp"
 #include "demux.hpp"
 #include "util.hpp"
@@ -31,6 +33,7 @@
 
 #include <new>
 #include <iterator>
+#include <limits>
 
 matroska_segment_c::matroska_segment_c( demux_sys_t & demuxer, EbmlStream & estream )
     :segment(NULL)
@@ -61,11 +64,14 @@ matroska_segment_c::matroska_segment_c( demux_sys_t & demuxer, EbmlStream & estr
     ,ep(NULL)
     ,b_preloaded(false)
     ,b_ref_external_segments(false)
+    ,p_indexer(NULL)
 {
 }
 
 matroska_segment_c::~matroska_segment_c()
 {
+    delete p_indexer;
+
     free( psz_writing_application );
     free( psz_muxing_application );
     free( psz_segment_filename );
@@ -524,6 +530,41 @@ bool matroska_segment_c::PreloadClusters(uint64 i_cluster_pos)
     return true;
 }
 
+void matroska_segment_c::StartIndexer()
+{
+    bool b_seekable;
+
+    /* a second full read of the file is only cheap enough locally */
+    if( sys.demuxer.psz_file == NULL )
+        return;
+
+    if( vlc_stream_Control( sys.demuxer.s, STREAM_CAN_FASTSEEK, &b_seekable ) ||
+        !b_seekable )
+        return;
+
+    stream_t *p_stream = static_cast<vlc_stream_io_callback&>( es.I_O() ).stream();
+    if( p_stream->psz_url == NULL )
+        return;
+
+    SegmentSeeker::track_ids_t track_ids;
+    for( tracks_map_t::const_iterator it = tracks.begin(); it != tracks.end(); ++it )
+        track_ids.push_back( it->first );
+
+    SegmentSeeker::fptr_t i_end = segment->IsFiniteSize()
+        ? segment->GetEndPosition()
+        : std::numeric_limits<SegmentSeeker::fptr_t>::max();
+
+    p_indexer = new (std::nothrow) SegmentIndexer( sys.demuxer, p_stream->psz_url, track_ids,
+                                                   i_timescale, cluster->GetElementPosition(),
+                                                   i_end );
+    if( p_indexer && !p_indexer->Start() )
+    {
+        msg_Warn( &sys.demuxer, "cannot index clusters in background" );
+        delete p_indexer;
+        p_indexer = NULL;
+    }
+}
+
 bool matroska_segment_c::PreloadFamily( const matroska_segment_c & of_segment )
 {
     if ( b_preloaded )
@@ -697,6 +738,9 @@ bool matroska_segment_c::Preload( )
     if( cluster )
         EnsureDuration();
 
+    if( cluster && !b_cues && var_InheritBool( &sys.demuxer, "mkv-index-clusters" ) )
+        StartIndexer();
+
     return true;
 }
 
@@ -853,6 +897,9 @@ bool matroska_segment_c::Seek( demux_t &demuxer, mtime_t i_absolute_mk_date, mti
 
     // find appropriate seekpoints //
 
+    if( p_indexer )
+        p_indexer->Merge( _seeker );
+
     try {
         seekpoints = _seeker.get_seekpoints( *this, i_mk_date, priority, selected_tracks );
     }
@@ -1154,10 +1201,78 @@ void matroska_segment_c::ESDestroy( )
     }
 }
 
-int matroska_segment_c::BlockGet( KaxBlock * & pp_block, KaxSimpleBlock * & pp_simpleblock, bool *pb_key_picture, bool *pb_discardable_picture, int64_t *pi_duration )
+/* Size of the header stripped from every frame of the track, if any */
+static size_t StrippedHeaderSize( const mkv_track_t *p_track )
+{
+    if( p_track->i_compression_type == MATROSKA_COMPRESSION_HEADER &&
+        p_track->p_compression_data != NULL &&
+        p_track->i_encoding_scope & MATROSKA_ENCODING_SCOPE_ALL_FRAMES )
+        return p_track->p_compression_data->GetSize();
+    return 0;
+}
+
+/* Reads the frames of a block, with only the element header and lacing
+ * already parsed, straight into a chain of block_t.
+ * Stops at the first invalid frame, keeping the frames read before it.
+ * Returns NULL when the frames are not needed (unselected track) or none
+ * could be read */
+block_t *matroska_segment_c::BlockReadFrames( KaxInternalBlock & block, const mkv_track_t *p_track )
+{
+    if( p_track == NULL )
+        return NULL;
+
+    if( p_track->fmt.i_cat != DATA_ES )
+    {
+        bool b_selected;
+        if( p_track->p_es == NULL ||
+            es_out_Control( sys.demuxer.out, ES_OUT_GET_ES_STATE, p_track->p_es, &b_selected ) ||
+            !b_selected )
+            return NULL;
+    }
+
+    /* room for the stripped header, restored by BlockDecode() */
+    const size_t i_headroom = StrippedHeaderSize( p_track );
+
+    block_t *p_frames = NULL;
+    block_t **pp_last = &p_frames;
+    uint64_t i_total = 0;
+
+    for( unsigned int i_frame = 0; i_frame < block.NumberFrames(); i_frame++ )
+    {
+        const uint64_t i_size = block.GetFrameSize( i_frame );
+        i_total += i_size;
+        if( i_size == 0 || i_total > block.GetSize() )
+        {
+            msg_Warn( &sys.demuxer, "Cannot read frame (too long or no frame)" );
+            break;
+        }
+
+        block_t *p_frame = block_Alloc( i_headroom + i_size );
+        if( unlikely( p_frame == NULL ) )
+            break;
+
+        const uint64_t i_pos = block.GetDataPosition( i_frame );
+        if( es.I_O().getFilePointer() != i_pos )
+            es.I_O().setFilePointer( i_pos, seek_beginning );
+        if( es.I_O().read( p_frame->p_buffer + i_headroom, i_size ) != i_size )
+        {
+            msg_Warn( &sys.demuxer, "Cannot read frame (too long or no frame)" );
+            block_Release( p_frame );
+            break;
+        }
+
+        *pp_last = p_frame;
+        pp_last = &p_frame->p_next;
+    }
+
+    return p_frames;
+}
+
+int matroska_segment_c::BlockGet( KaxBlock * & pp_block, KaxSimpleBlock * & pp_simpleblock, bool *pb_key_picture, bool *pb_discardable_picture, int64_t *pi_duration, block_t **pp_frames )
 {
     pp_simpleblock = NULL;
     pp_block = NULL;
+    block_t *p_frames = NULL;
 
     *pb_key_picture         = true;
     *pb_discardable_picture = false;
@@ -1175,9 +1290,13 @@ int matroska_segment_c::BlockGet( KaxBlock * & pp_block, KaxSimpleBlock * & pp_s
         bool               & b_discardable_picture;
         bool                 b_cluster_timecode;
 
+        block_t           *& frames;
+        bool                 b_read_frames;
+
     } payload = {
         this, ep, &sys.demuxer, pp_block, pp_simpleblock,
-        *pi_duration, *pb_key_picture, *pb_discardable_picture, true
+        *pi_duration, *pb_key_picture, *pb_discardable_picture, true,
+        p_frames, pp_frames != NULL
     };
 
     MKV_SWITCH_CREATE( EbmlTypeDispatcher, BlockGetHandler_l1, BlockPayload )
@@ -1194,6 +1313,8 @@ int matroska_segment_c::BlockGet( KaxBlock * & pp_block, KaxSimpleBlock * & pp_s
         {
             VLC_UNUSED( kcue );
             msg_Warn( vars.p_demuxer, "find KaxCues FIXME" );
+            block_ChainRelease( vars.frames );
+            vars.frames = NULL;
             throw VLC_EGENERIC;
         }
         E_CASE_DEFAULT(element)
@@ -1233,9 +1354,14 @@ int matroska_segment_c::BlockGet( KaxBlock * & pp_block, KaxSimpleBlock * & pp_s
             }
 
             vars.simpleblock = &ksblock;
-            vars.simpleblock->ReadData( vars.obj->es.I_O() );
+            /* only the header and lacing, the frames are read below */
+            vars.simpleblock->ReadData( vars.obj->es.I_O(), SCOPE_PARTIAL_DATA );
             vars.simpleblock->SetParent( *vars.obj->cluster );
 
+            if( vars.b_read_frames )
+                vars.frames = vars.obj->BlockReadFrames( ksblock,
+                                  vars.obj->FindTrackByBlock( NULL, &ksblock ) );
+
             if( ksblock.IsKeyframe() )
             {
                 bool const b_valid_track = vars.obj->FindTrackByBlock( NULL, &ksblock ) != NULL;
@@ -1253,10 +1379,16 @@ int matroska_segment_c::BlockGet( KaxBlock * & pp_block, KaxSimpleBlock * & pp_s
         E_CASE( KaxBlock, kblock )
         {
             vars.block = &kblock;
-            vars.block->ReadData( vars.obj->es.I_O() );
+            vars.block->ReadData( vars.obj->es.I_O(), SCOPE_PARTIAL_DATA );
             vars.block->SetParent( *vars.obj->cluster );
 
             const mkv_track_t *p_track = vars.obj->FindTrackByBlock( &kblock, NULL );
+
+            if( vars.b_read_frames )
+            {
+                block_ChainRelease( vars.frames );
+                vars.frames = vars.obj->BlockReadFrames( kblock, p_track );
+            }
             if( p_track != NULL && p_track->fmt.i_cat == SPU_ES )
             {
                 vars.obj->_seeker.add_seekpoint( kblock.TrackNum(),
@@ -1328,6 +1460,8 @@ int matroska_segment_c::BlockGet( KaxBlock * & pp_block, KaxSimpleBlock * & pp_s
                 ep->Unkeep();
                 pp_simpleblock = NULL;
                 pp_block = NULL;
+                block_ChainRelease( p_frames );
+                p_frames = NULL;
                 continue;
             }
             if( pp_simpleblock != NULL )
@@ -1340,20 +1474,37 @@ int matroska_segment_c::BlockGet( KaxBlock * & pp_block, KaxSimpleBlock * & pp_s
             {
                 if( p_track->fmt.i_codec == VLC_CODEC_THEORA )
                 {
-                    DataBuffer *    p_data = &pp_block->GetBuffer(0);
-                    const uint8_t * p_buff = p_data->Buffer();
                     /* if the second bit of a Theora frame is 1
                        it's not a keyframe */
-                    if( p_data->Size() && p_buff )
+                    const size_t i_stripped = StrippedHeaderSize( p_track );
+                    uint8_t i_first = 0;
+                    bool b_read = false;
+                    if( i_stripped > 0 )
+                    {
+                        /* the frame starts with the stripped header */
+                        i_first = p_track->p_compression_data->GetBuffer()[0];
+                        b_read = true;
+                    }
+                    else if( p_frames != NULL )
+                    {
+                        i_first = p_frames->p_buffer[0];
+                        b_read = true;
+                    }
+                    else if( pp_block->NumberFrames() && pp_block->GetFrameSize(0) )
                     {
-                        if( p_buff[0] & 0x40 )
-                            *pb_key_picture = false;
+                        /* payload was not loaded, peek at the first byte */
+                        const uint64 i_pos = es.I_O().getFilePointer();
+                        es.I_O().setFilePointer( pp_block->GetDataPosition(0), seek_beginning );
+                        b_read = es.I_O().read( &i_first, 1 ) == 1;
+                        es.I_O().setFilePointer( i_pos, seek_beginning );
                     }
-                    else
+                    if( !b_read || ( i_first & 0x40 ) )
                         *pb_key_picture = false;
                 }
             }
 
+            if( pp_frames != NULL )
+                *pp_frames = p_frames;
             return VLC_SUCCESS;
         }
 
@@ -1402,6 +1553,8 @@ int matroska_segment_c::BlockGet( KaxBlock * & pp_block, KaxSimpleBlock * & pp_s
                         ep->Unkeep();
                         pp_simpleblock = NULL;
                         pp_block = NULL;
+                        block_ChainRelease( p_frames );
+                        p_frames = NULL;
 
                         break;
                     }
@@ -1414,11 +1567,13 @@ int matroska_segment_c::BlockGet( KaxBlock * & pp_block, KaxSimpleBlock * & pp_s
 
                 default:
                     msg_Err( &sys.demuxer, "invalid level = %d", i_level );
+                    block_ChainRelease( p_frames );
                     return VLC_EGENERIC;
             }
         }
         catch (int ret_code)
         {
+            block_ChainRelease( p_frames );
             return ret_code;
         }
         catch (...)
@@ -1428,6 +1583,8 @@ int matroska_segment_c::BlockGet( KaxBlock * & pp_block, KaxSimpleBlock * & pp_s
             ep->Unkeep();
             pp_simpleblock = NULL;
             pp_block = NULL;
+            block_ChainRelease( p_frames );
+            p_frames = NULL;
         }
     }
 }
@@ -35,6 +35,7 @@
 #include <memory>
 
 class EbmlParser;
+class SegmentIndexer;
 
 class chapter_edition_c;
 class chapter_translation_c;
@@ -137,12 +138,14 @@ public:
     bool Preload();
     bool PreloadFamily( const matroska_segment_c & segment );
     bool PreloadClusters( uint64 i_cluster_position );
+    void StartIndexer();
     void InformationCreate();
 
     bool FastSeek( demux_t &, mtime_t i_mk_date, mtime_t i_mk_time_offset );
     bool Seek( demux_t &, mtime_t i_mk_date, mtime_t i_mk_time_offset );
 
-    int BlockGet( KaxBlock * &, KaxSimpleBlock * &, bool *, bool *, int64_t *);
+    int BlockGet( KaxBlock * &, KaxSimpleBlock * &, bool *, bool *, int64_t *, block_t **pp_frames = NULL );
+    block_t *BlockReadFrames( KaxInternalBlock &, const mkv_track_t * );
 
     mkv_track_t * FindTrackByBlock(const KaxBlock *, const KaxSimpleBlock * );
 
@@ -172,6 +175,7 @@ private:
     void EnsureDuration();
 
     SegmentSeeker _seeker;
+    SegmentIndexer *p_indexer;
 
     friend SegmentSeeker;
 };
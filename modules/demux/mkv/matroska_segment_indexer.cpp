@@ -0,0 +1,684 @@
+/*****************************************************************************
+ * matroska_segment_indexer.cpp : matroska demuxer
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "matroska_segment_indexer.hpp"
+#include "../index_cache.h"
+
+#include <vlc_fs.h>
+#include <vlc_url.h>
+
+#include <sys/stat.h>
+#include <limits>
+
+namespace {
+    enum {
+        EBML_ID_HEADER         = 0x1A45DFA3,
+        EBML_ID_SEGMENT        = 0x18538067,
+        EBML_ID_SEEKHEAD       = 0x114D9B74,
+        EBML_ID_INFO           = 0x1549A966,
+        EBML_ID_TRACKS         = 0x1654AE6B,
+        EBML_ID_CUES           = 0x1C53BB6B,
+        EBML_ID_CHAPTERS       = 0x1043A770,
+        EBML_ID_ATTACHMENTS    = 0x1941A469,
+        EBML_ID_TAGS           = 0x1254C367,
+        EBML_ID_CLUSTER        = 0x1F43B675,
+        EBML_ID_TIMECODE       = 0xE7,
+        EBML_ID_SIMPLEBLOCK    = 0xA3,
+        EBML_ID_BLOCKGROUP     = 0xA0,
+        EBML_ID_BLOCK          = 0xA1,
+        EBML_ID_REFERENCEBLOCK = 0xFB,
+    };
+
+    /* track number, timecode and flags */
+    const size_t BLOCK_HEADER_MAX = 8 + 2 + 1;
+
+    bool IsTopLevel( uint64_t i_id )
+    {
+        switch( i_id )
+        {
+            case EBML_ID_HEADER:
+            case EBML_ID_SEGMENT:
+            case EBML_ID_SEEKHEAD:
+            case EBML_ID_INFO:
+            case EBML_ID_TRACKS:
+            case EBML_ID_CUES:
+            case EBML_ID_CHAPTERS:
+            case EBML_ID_ATTACHMENTS:
+            case EBML_ID_TAGS:
+            case EBML_ID_CLUSTER:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    /* reads an EBML variable size integer, keeping the length marker for
+     * ids, returns its length or 0 on error */
+    unsigned ReadVint( stream_t *s, uint64_t *pi_value, bool b_id, bool *pb_unknown )
+    {
+        uint8_t p_buf[8];
+        if( vlc_stream_Read( s, p_buf, 1 ) != 1 )
+            return 0;
+
+        unsigned i_len = 1;
+        uint8_t  i_mask = 0x80;
+        while( i_mask && !( p_buf[0] & i_mask ) )
+        {
+            i_mask >>= 1;
+            i_len++;
+        }
+        if( !i_mask || i_len > ( b_id ? 4 : 8 ) )
+            return 0;
+
+        if( i_len > 1 &&
+            vlc_stream_Read( s, &p_buf[1], i_len - 1 ) != (ssize_t)( i_len - 1 ) )
+            return 0;
+
+        uint64_t i_value = b_id ? p_buf[0] : ( p_buf[0] & ( i_mask - 1 ) );
+        bool b_all_ones = !b_id && i_value == uint64_t( i_mask - 1 );
+        for( unsigned i = 1; i < i_len; i++ )
+        {
+            i_value = ( i_value << 8 ) | p_buf[i];
+            b_all_ones &= p_buf[i] == 0xFF;
+        }
+
+        if( pb_unknown )
+            *pb_unknown = b_all_ones;
+        *pi_value = i_value;
+        return i_len;
+    }
+
+    unsigned ReadElementHeader( stream_t *s, uint64_t *pi_id, uint64_t *pi_size, bool *pb_unknown )
+    {
+        unsigned i_id_len = ReadVint( s, pi_id, true, NULL );
+        if( !i_id_len )
+            return 0;
+        unsigned i_size_len = ReadVint( s, pi_size, false, pb_unknown );
+        if( !i_size_len )
+            return 0;
+        return i_id_len + i_size_len;
+    }
+
+    bool ParseBlockHeader( const uint8_t *p_buf, size_t i_buf,
+                           uint64_t *pi_track, int16_t *pi_timecode, uint8_t *pi_flags )
+    {
+        if( i_buf < 1 )
+            return false;
+
+        unsigned i_len = 1;
+        uint8_t  i_mask = 0x80;
+        while( i_mask && !( p_buf[0] & i_mask ) )
+        {
+            i_mask >>= 1;
+            i_len++;
+        }
+        if( !i_mask || i_buf < i_len + 3 )
+            return false;
+
+        uint64_t i_track = p_buf[0] & ( i_mask - 1 );
+        for( unsigned i = 1; i < i_len; i++ )
+            i_track = ( i_track << 8 ) | p_buf[i];
+
+        *pi_track    = i_track;
+        *pi_timecode = int16_t( GetWBE( &p_buf[i_len] ) );
+        *pi_flags    = p_buf[i_len + 2];
+        return true;
+    }
+}
+
+SegmentIndexer::SegmentIndexer( demux_t & demuxer_, const char * psz_url_,
+                                SegmentSeeker::track_ids_t const& tracks_,
+                                uint64_t i_timescale_, fptr_t i_start_, fptr_t i_end_ )
+    : demuxer( demuxer_ )
+    , psz_url( strdup( psz_url_ ) )
+    , s( NULL )
+    , tracks( tracks_ )
+    , i_timescale( i_timescale_ )
+    , i_start( i_start_ )
+    , i_end( i_end_ )
+    , b_cache( false )
+    , i_file_size( 0 )
+    , i_file_mtime( 0 )
+    , is_running( false )
+    , b_abort( false )
+    , b_done( false )
+    , i_merged_clusters( 0 )
+    , i_merged_seekpoints( 0 )
+    , i_merged_ranges( 0 )
+{
+    vlc_mutex_init( &lock );
+    std::sort( tracks.begin(), tracks.end() );
+}
+
+SegmentIndexer::~SegmentIndexer()
+{
+    if( is_running )
+    {
+        vlc_mutex_lock( &lock );
+        b_abort = true;
+        vlc_mutex_unlock( &lock );
+
+        vlc_join( thread, NULL );
+    }
+
+    if( s )
+    {
+        vlc_stream_Delete( s );
+        var_Destroy( &demuxer, "mkv-index-progress" );
+    }
+
+    vlc_mutex_destroy( &lock );
+    free( psz_url );
+}
+
+bool SegmentIndexer::Start()
+{
+    if( psz_url == NULL )
+        return false;
+
+    /* the demuxer stream can't be shared with the indexing thread */
+    s = vlc_stream_NewURL( &demuxer, psz_url );
+    if( s == NULL )
+        return false;
+
+    if( vlc_stream_GetSize( s, &i_file_size ) != VLC_SUCCESS )
+        i_file_size = 0;
+    if( i_file_size && i_end > i_file_size )
+        i_end = i_file_size;
+
+    var_Create( &demuxer, "mkv-index-progress", VLC_VAR_FLOAT );
+
+    if( i_file_size && var_InheritBool( &demuxer, "mkv-index-cache" ) )
+    {
+        b_cache = true;
+
+        char *psz_path = vlc_uri2path( psz_url );
+        struct stat st;
+        if( psz_path && vlc_stat( psz_path, &st ) == 0 )
+            i_file_mtime = st.st_mtime;
+        free( psz_path );
+
+        if( CacheLoad() )
+        {
+            b_done = true;
+            var_SetFloat( &demuxer, "mkv-index-progress", 1.f );
+            return true;
+        }
+    }
+
+    is_running = !vlc_clone( &thread, Run, this, VLC_THREAD_PRIORITY_LOW );
+    return is_running;
+}
+
+void SegmentIndexer::Merge( SegmentSeeker & seeker )
+{
+    vlc_mutex_lock( &lock );
+
+    for( ; i_merged_clusters < clusters.size(); ++i_merged_clusters )
+        seeker.add_cluster( clusters[i_merged_clusters] );
+
+    for( ; i_merged_seekpoints < seekpoints.size(); ++i_merged_seekpoints )
+        seeker.add_seekpoint( seekpoints[i_merged_seekpoints].first,
+                              seekpoints[i_merged_seekpoints].second );
+
+    /* every key frame in there is known, no need to search it again.
+     * The last range may have grown since the previous merge. */
+    if( i_merged_ranges > 0 )
+        --i_merged_ranges;
+    for( ; i_merged_ranges < ranges.size(); ++i_merged_ranges )
+        seeker.mark_range_as_searched( ranges[i_merged_ranges] );
+
+    vlc_mutex_unlock( &lock );
+}
+
+void *SegmentIndexer::Run( void *p_data )
+{
+    static_cast<SegmentIndexer*>( p_data )->Run();
+    return NULL;
+}
+
+void SegmentIndexer::Run()
+{
+    fptr_t i_pos = i_start;
+    bool   b_complete = false;
+    int    i_last_progress = -1;
+
+    msg_Dbg( &demuxer, "indexing clusters from %" PRIu64, i_pos );
+
+    for( ;; )
+    {
+        vlc_mutex_lock( &lock );
+        bool b_stop = b_abort;
+        vlc_mutex_unlock( &lock );
+
+        if( b_stop )
+            break;
+
+        if( i_pos >= i_end )
+        {
+            b_complete = true;
+            break;
+        }
+
+        if( vlc_stream_Tell( s ) != i_pos && vlc_stream_Seek( s, i_pos ) )
+            break;
+
+        uint64_t i_id, i_size;
+        bool b_unknown_size;
+        unsigned i_header = ReadElementHeader( s, &i_id, &i_size, &b_unknown_size );
+        if( !i_header )
+        {
+            /* end of stream */
+            b_complete = i_end == std::numeric_limits<fptr_t>::max();
+            break;
+        }
+
+        fptr_t const i_data = i_pos + i_header;
+
+        if( i_id == EBML_ID_CLUSTER )
+        {
+            fptr_t i_limit = i_end;
+            if( !b_unknown_size && i_size < i_end - i_data )
+                i_limit = i_data + i_size;
+
+            fptr_t i_cluster_end = ScanCluster( i_data, i_limit, b_unknown_size );
+            if( i_cluster_end <= i_data )
+                break;
+
+            /* without timecode, its key frames are unknown: leave it to
+             * the linear search of the seeker */
+            vlc_mutex_lock( &lock );
+            if( cluster.pts >= 0 )
+            {
+                cluster.fpos = i_pos;
+                cluster.size = i_cluster_end - i_pos;
+                clusters.push_back( cluster );
+                seekpoints.insert( seekpoints.end(), cluster_seekpoints.begin(),
+                                   cluster_seekpoints.end() );
+                AddSearchedRange( i_pos, i_cluster_end );
+            }
+            vlc_mutex_unlock( &lock );
+
+            i_pos = i_cluster_end;
+        }
+        else if( i_id == EBML_ID_HEADER || i_id == EBML_ID_SEGMENT )
+        {
+            /* next segment of the same file */
+            b_complete = true;
+            break;
+        }
+        else
+        {
+            if( b_unknown_size )
+                break;
+
+            vlc_mutex_lock( &lock );
+            AddSearchedRange( i_pos, i_data + i_size );
+            vlc_mutex_unlock( &lock );
+
+            i_pos = i_data + i_size;
+        }
+
+        if( i_end != std::numeric_limits<fptr_t>::max() && i_end > i_start )
+        {
+            int i_progress = 100 * ( std::min( i_pos, i_end ) - i_start ) / ( i_end - i_start );
+            if( i_progress != i_last_progress )
+            {
+                var_SetFloat( &demuxer, "mkv-index-progress", i_progress / 100.f );
+                i_last_progress = i_progress;
+            }
+        }
+    }
+
+    vlc_mutex_lock( &lock );
+    b_done = true;
+    size_t i_clusters = clusters.size();
+    size_t i_seekpoints = seekpoints.size();
+    vlc_mutex_unlock( &lock );
+
+    if( b_complete )
+        var_SetFloat( &demuxer, "mkv-index-progress", 1.f );
+
+    msg_Dbg( &demuxer, "indexed %zu clusters and %zu key frames%s", i_clusters,
+             i_seekpoints, b_complete ? "" : " (interrupted)" );
+
+    if( b_complete && b_cache )
+        CacheStore();
+}
+
+/* Extends the last searched range if contiguous, must be called locked */
+void SegmentIndexer::AddSearchedRange( fptr_t i_range_start, fptr_t i_range_end )
+{
+    if( !ranges.empty() && ranges.back().end == i_range_start )
+        ranges.back().end = i_range_end;
+    else
+        ranges.push_back( SegmentSeeker::Range( i_range_start, i_range_end ) );
+}
+
+/* Scans the children of a cluster, returns the cluster end position or 0 */
+SegmentIndexer::fptr_t
+SegmentIndexer::ScanCluster( fptr_t i_pos, fptr_t i_limit, bool b_unknown_size )
+{
+    int64_t i_cluster_timecode = -1;
+
+    cluster.pts      = -1;
+    cluster.duration = -1;
+    cluster_seekpoints.clear();
+
+    struct {
+        SegmentIndexer *obj;
+        void operator()( uint64_t i_track, int16_t i_timecode, fptr_t i_fpos,
+                         int64_t i_cluster_timecode )
+        {
+            if( !std::binary_search( obj->tracks.begin(), obj->tracks.end(), i_track ) )
+                return;
+
+            int64_t i_block_timecode = i_cluster_timecode + i_timecode;
+            if( i_block_timecode < 0 )
+                return;
+
+            mtime_t i_pts = mtime_t( uint64_t( i_block_timecode ) * obj->i_timescale / 1000 );
+            obj->cluster_seekpoints.push_back(
+                track_seekpoint_t( track_id_t( i_track ), SegmentSeeker::Seekpoint( i_fpos, i_pts ) ) );
+        }
+    } add_keyframe = { this };
+
+    while( i_pos < i_limit )
+    {
+        if( vlc_stream_Tell( s ) != i_pos && vlc_stream_Seek( s, i_pos ) )
+            return 0;
+
+        uint64_t i_id, i_size;
+        bool b_unknown_child;
+        unsigned i_header = ReadElementHeader( s, &i_id, &i_size, &b_unknown_child );
+        if( !i_header )
+        {
+            /* an unknown sized cluster can end the stream */
+            if( b_unknown_size )
+                break;
+            return 0;
+        }
+
+        if( b_unknown_size && IsTopLevel( i_id ) )
+            break; /* end of this cluster */
+
+        if( b_unknown_child )
+            return 0;
+
+        fptr_t const i_data = i_pos + i_header;
+        uint8_t p_buf[BLOCK_HEADER_MAX];
+
+        switch( i_id )
+        {
+            case EBML_ID_TIMECODE:
+                if( i_size <= 8 && vlc_stream_Read( s, p_buf, i_size ) == (ssize_t) i_size )
+                {
+                    uint64_t i_timecode = 0;
+                    for( size_t i = 0; i < i_size; i++ )
+                        i_timecode = ( i_timecode << 8 ) | p_buf[i];
+                    if( i_timecode <= uint64_t( INT64_MAX ) )
+                    {
+                        i_cluster_timecode = i_timecode;
+                        cluster.pts = mtime_t( i_timecode * i_timescale / 1000 );
+                    }
+                }
+                break;
+
+            case EBML_ID_SIMPLEBLOCK:
+            {
+                uint64_t i_track;
+                int16_t  i_timecode;
+                uint8_t  i_flags;
+                size_t   i_read = std::min<uint64_t>( i_size, sizeof(p_buf) );
+
+                if( i_cluster_timecode >= 0 &&
+                    vlc_stream_Read( s, p_buf, i_read ) == (ssize_t) i_read &&
+                    ParseBlockHeader( p_buf, i_read, &i_track, &i_timecode, &i_flags ) &&
+                    ( i_flags & 0x80 ) )
+                    add_keyframe( i_track, i_timecode, i_pos, i_cluster_timecode );
+                break;
+            }
+
+            case EBML_ID_BLOCKGROUP:
+            {
+                /* a Block without ReferenceBlock is a key frame */
+                bool     b_block = false;
+                bool     b_reference = false;
+                uint64_t i_track = 0;
+                int16_t  i_timecode = 0;
+                fptr_t   i_block_pos = 0;
+
+                for( fptr_t i_child = i_data; i_child < i_data + i_size; )
+                {
+                    if( vlc_stream_Tell( s ) != i_child && vlc_stream_Seek( s, i_child ) )
+                        return 0;
+
+                    uint64_t i_child_id, i_child_size;
+                    bool b_unknown;
+                    unsigned i_child_header = ReadElementHeader( s, &i_child_id, &i_child_size, &b_unknown );
+                    if( !i_child_header || b_unknown )
+                        return 0;
+
+                    if( i_child_id == EBML_ID_BLOCK )
+                    {
+                        uint8_t i_flags;
+                        size_t  i_read = std::min<uint64_t>( i_child_size, sizeof(p_buf) );
+
+                        b_block = vlc_stream_Read( s, p_buf, i_read ) == (ssize_t) i_read &&
+                                  ParseBlockHeader( p_buf, i_read, &i_track, &i_timecode, &i_flags );
+                        i_block_pos = i_child;
+                    }
+                    else if( i_child_id == EBML_ID_REFERENCEBLOCK )
+                        b_reference = true;
+
+                    i_child += i_child_header + i_child_size;
+                }
+
+                if( i_cluster_timecode >= 0 && b_block && !b_reference )
+                    add_keyframe( i_track, i_timecode, i_block_pos, i_cluster_timecode );
+                break;
+            }
+
+            default:
+                break;
+        }
+
+        i_pos = i_data + i_size;
+    }
+
+    return std::min( i_pos, i_limit );
+}
+
+/*****************************************************************************
+ * Index cache
+ *****************************************************************************/
+#define MKV_INDEX_CACHE_MAGIC   "VLCMKVIX"
+#define MKV_INDEX_CACHE_VERSION 2
+
+namespace {
+    struct cache_header_t
+    {
+        char     magic[8];
+        uint32_t i_version;
+        uint32_t i_url;
+        uint64_t i_size;
+        int64_t  i_mtime;
+        uint64_t i_timescale;
+        uint64_t i_start;
+        uint64_t i_clusters;
+        uint64_t i_seekpoints;
+        uint64_t i_ranges;
+    };
+
+    struct cache_cluster_t
+    {
+        uint64_t i_fpos;
+        int64_t  i_pts;
+        uint64_t i_size;
+    };
+
+    struct cache_seekpoint_t
+    {
+        uint64_t i_track;
+        uint64_t i_fpos;
+        int64_t  i_pts;
+    };
+
+    struct cache_range_t
+    {
+        uint64_t i_start;
+        uint64_t i_end;
+    };
+}
+
+bool SegmentIndexer::CacheLoad()
+{
+    FILE *p_file = index_cache_Open( "mkv", psz_url );
+    if( p_file == NULL )
+        return false;
+
+    bool b_ok = false;
+    cache_header_t hdr;
+    std::vector<char> url;
+    std::vector<SegmentSeeker::Cluster> cached_clusters;
+    std::vector<track_seekpoint_t> cached_seekpoints;
+    std::vector<SegmentSeeker::Range> cached_ranges;
+
+    /* every cluster and block being at least a few bytes */
+    if( fread( &hdr, sizeof(hdr), 1, p_file ) != 1 ||
+        memcmp( hdr.magic, MKV_INDEX_CACHE_MAGIC, sizeof(hdr.magic) ) ||
+        hdr.i_version != MKV_INDEX_CACHE_VERSION ||
+        hdr.i_size != i_file_size || hdr.i_mtime != i_file_mtime ||
+        hdr.i_timescale != i_timescale || hdr.i_start != i_start ||
+        hdr.i_url != strlen( psz_url ) ||
+        hdr.i_clusters > i_file_size / 4 || hdr.i_seekpoints > i_file_size / 4 ||
+        hdr.i_ranges > hdr.i_clusters + 1 )
+        goto end;
+
+    url.resize( hdr.i_url );
+    if( fread( url.data(), 1, hdr.i_url, p_file ) != hdr.i_url ||
+        memcmp( url.data(), psz_url, hdr.i_url ) )
+        goto end;
+
+    try
+    {
+        cached_clusters.reserve( hdr.i_clusters );
+        cached_seekpoints.reserve( hdr.i_seekpoints );
+        cached_ranges.reserve( hdr.i_ranges );
+    }
+    catch( std::bad_alloc const& )
+    {
+        goto end;
+    }
+
+    for( uint64_t i = 0; i < hdr.i_clusters; i++ )
+    {
+        cache_cluster_t entry;
+        if( fread( &entry, sizeof(entry), 1, p_file ) != 1 || entry.i_fpos >= i_file_size )
+            goto end;
+
+        SegmentSeeker::Cluster cinfo = { entry.i_fpos, entry.i_pts, -1, entry.i_size };
+        cached_clusters.push_back( cinfo );
+    }
+
+    for( uint64_t i = 0; i < hdr.i_seekpoints; i++ )
+    {
+        cache_seekpoint_t entry;
+        if( fread( &entry, sizeof(entry), 1, p_file ) != 1 || entry.i_fpos >= i_file_size )
+            goto end;
+
+        cached_seekpoints.push_back( track_seekpoint_t( track_id_t( entry.i_track ),
+                                     SegmentSeeker::Seekpoint( entry.i_fpos, entry.i_pts ) ) );
+    }
+
+    for( uint64_t i = 0; i < hdr.i_ranges; i++ )
+    {
+        cache_range_t entry;
+        if( fread( &entry, sizeof(entry), 1, p_file ) != 1 ||
+            entry.i_start >= entry.i_end || entry.i_end > i_file_size )
+            goto end;
+
+        cached_ranges.push_back( SegmentSeeker::Range( entry.i_start, entry.i_end ) );
+    }
+
+    clusters.swap( cached_clusters );
+    seekpoints.swap( cached_seekpoints );
+    ranges.swap( cached_ranges );
+    b_ok = true;
+
+    msg_Dbg( &demuxer, "loaded %zu clusters and %zu key frames from index cache",
+             clusters.size(), seekpoints.size() );
+
+end:
+    fclose( p_file );
+    return b_ok;
+}
+
+void SegmentIndexer::CacheStore()
+{
+    index_cache_writer_t writer;
+    if( index_cache_Begin( &writer, "mkv", psz_url ) )
+    {
+        msg_Warn( &demuxer, "cannot create clusters index cache" );
+        return;
+    }
+
+    /* the scan is over, no need to lock */
+    cache_header_t hdr;
+    memset( &hdr, 0, sizeof(hdr) );
+    memcpy( hdr.magic, MKV_INDEX_CACHE_MAGIC, sizeof(hdr.magic) );
+    hdr.i_version    = MKV_INDEX_CACHE_VERSION;
+    hdr.i_url        = strlen( psz_url );
+    hdr.i_size       = i_file_size;
+    hdr.i_mtime      = i_file_mtime;
+    hdr.i_timescale  = i_timescale;
+    hdr.i_start      = i_start;
+    hdr.i_clusters   = clusters.size();
+    hdr.i_seekpoints = seekpoints.size();
+    hdr.i_ranges     = ranges.size();
+
+    FILE *p_file = writer.p_file;
+    bool b_ok = fwrite( &hdr, sizeof(hdr), 1, p_file ) == 1 &&
+                fwrite( psz_url, 1, hdr.i_url, p_file ) == hdr.i_url;
+
+    for( size_t i = 0; b_ok && i < clusters.size(); i++ )
+    {
+        cache_cluster_t entry = { clusters[i].fpos, clusters[i].pts, clusters[i].size };
+        b_ok = fwrite( &entry, sizeof(entry), 1, p_file ) == 1;
+    }
+
+    for( size_t i = 0; b_ok && i < seekpoints.size(); i++ )
+    {
+        cache_seekpoint_t entry = { seekpoints[i].first, seekpoints[i].second.fpos,
+                                    seekpoints[i].second.pts };
+        b_ok = fwrite( &entry, sizeof(entry), 1, p_file ) == 1;
+    }
+
+    for( size_t i = 0; b_ok && i < ranges.size(); i++ )
+    {
+        cache_range_t entry = { ranges[i].start, ranges[i].end };
+        b_ok = fwrite( &entry, sizeof(entry), 1, p_file ) == 1;
+    }
+
+    if( index_cache_End( &writer, b_ok ) == VLC_SUCCESS )
+        msg_Dbg( &demuxer, "stored clusters index cache" );
+    else
+        msg_Warn( &demuxer, "cannot write clusters index cache" );
+}
@@ -0,0 +1,91 @@
+/*****************************************************************************
+ * matroska_segment_indexer.hpp : matroska demuxer
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef MKV_MATROSKA_SEGMENT_INDEXER_HPP_
+#define MKV_MATROSKA_SEGMENT_INDEXER_HPP_
+
+#include "mkv.hpp"
+#include "matroska_segment_seeker.hpp"
+
+#include <vlc_threads.h>
+
+#include <vector>
+#include <utility>
+
+/* Builds the cluster and key frame index of a segment without Cues, from a
+ * separate stream and thread, reading only element headers and skipping
+ * block payloads. The demux thread pulls the results with Merge(). */
+class SegmentIndexer
+{
+    public:
+        typedef SegmentSeeker::fptr_t fptr_t;
+        typedef SegmentSeeker::track_id_t track_id_t;
+
+        SegmentIndexer( demux_t & demuxer, const char * psz_url,
+                        SegmentSeeker::track_ids_t const& tracks,
+                        uint64_t i_timescale, fptr_t i_start, fptr_t i_end );
+        ~SegmentIndexer();
+
+        bool Start();
+        void Merge( SegmentSeeker & );
+
+    private:
+        typedef std::pair<track_id_t, SegmentSeeker::Seekpoint> track_seekpoint_t;
+
+        static void *Run( void * );
+        void Run();
+
+        fptr_t ScanCluster( fptr_t i_start, fptr_t i_end, bool b_unknown_size );
+        void   AddSearchedRange( fptr_t i_start, fptr_t i_end );
+
+        bool   CacheLoad();
+        void   CacheStore();
+
+        demux_t            & demuxer;
+        char               * psz_url;
+        stream_t           * s;           /* our own stream */
+        SegmentSeeker::track_ids_t tracks;
+        uint64_t             i_timescale;
+        fptr_t               i_start;
+        fptr_t               i_end;
+
+        bool                 b_cache;
+        uint64_t             i_file_size;
+        int64_t              i_file_mtime;
+
+        bool                 is_running;
+        vlc_thread_t         thread;
+
+        /* filled by the scanning thread, for the current cluster */
+        SegmentSeeker::Cluster         cluster;
+        std::vector<track_seekpoint_t> cluster_seekpoints;
+
+        vlc_mutex_t          lock;
+        bool                 b_abort;
+        bool                 b_done;
+        std::vector<SegmentSeeker::Cluster> clusters;
+        std::vector<track_seekpoint_t>      seekpoints;
+        SegmentSeeker::ranges_t             ranges; /* fully indexed areas */
+        size_t               i_merged_clusters;
+        size_t               i_merged_seekpoints;
+        size_t               i_merged_ranges;
+};
+
+#endif /* include-guard */
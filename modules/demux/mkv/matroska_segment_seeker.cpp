@@ -58,6 +58,9 @@ SegmentSeeker::add_cluster_position( fptr_t fpos )
       fpos
     );
 
+    if( insertion_point != _cluster_positions.begin() && *prev_( insertion_point ) == fpos )
+        return prev_( insertion_point ); // already known
+
     return _cluster_positions.insert( insertion_point, fpos );
 }
 
@@ -73,6 +76,12 @@ SegmentSeeker::add_cluster( KaxCluster * const p_cluster )
             : UINT64_MAX
     };
 
+    return add_cluster( cinfo );
+}
+
+SegmentSeeker::cluster_map_t::iterator
+SegmentSeeker::add_cluster( Cluster const& cinfo )
+{
     add_cluster_position( cinfo.fpos );
 
     cluster_map_t::iterator it = _clusters.lower_bound( cinfo.pts );
@@ -76,6 +76,14 @@ vlc_module_begin ()
             N_("Preload clusters"),
             N_("Find all cluster positions by jumping cluster-to-cluster before playback"), true );
 
+    add_bool( "mkv-index-clusters", true,
+            N_("Index clusters in background"),
+            N_("Find the cluster positions and key frames of local files without cues in a background thread, to speed up seeking"), true );
+
+    add_bool( "mkv-index-cache", false,
+            N_("Cache clusters index"),
+            N_("Keep the clusters index of files without cues on disk, so they can be reopened and seeked without a rescan"), true );
+
     add_shortcut( "mka", "mkv" )
 vlc_module_end ()
 
@@ -491,20 +499,26 @@ static int Seek( demux_t *p_demux, mtime_t i_mk_date, double f_percent, virtual_
     return p_vsegment->Seek( *p_demux, i_mk_date, p_vchapter, b_precise ) ? VLC_SUCCESS : VLC_EGENERIC;
 }
 
-/* Needed by matroska_segment::Seek() and Seek */
+/* Needed by matroska_segment::Seek() and Seek
+ * p_frames are the block frames, as read by matroska_segment_c::BlockGet() */
 void BlockDecode( demux_t *p_demux, KaxBlock *block, KaxSimpleBlock *simpleblock,
-                  mtime_t i_pts, mtime_t i_duration, bool b_key_picture,
-                  bool b_discardable_picture )
+                  block_t *p_frames, mtime_t i_pts, mtime_t i_duration,
+                  bool b_key_picture, bool b_discardable_picture )
 {
     demux_sys_t        *p_sys = p_demux->p_sys;
     matroska_segment_c *p_segment = p_sys->p_current_vsegment->CurrentSegment();
 
-    if( !p_segment ) return;
+    if( !p_segment )
+    {
+        block_ChainRelease( p_frames );
+        return;
+    }
 
     mkv_track_t *p_track = p_segment->FindTrackByBlock( block, simpleblock );
     if( p_track == NULL )
     {
         msg_Err( p_demux, "invalid track number" );
+        block_ChainRelease( p_frames );
         return;
     }
 
@@ -513,6 +527,7 @@ void BlockDecode( demux_t *p_demux, KaxBlock *block, KaxSimpleBlock *simpleblock
     if( track.fmt.i_cat != DATA_ES && track.p_es == NULL )
     {
         msg_Err( p_demux, "unknown track number" );
+        block_ChainRelease( p_frames );
         return;
     }
 
@@ -527,51 +542,34 @@ void BlockDecode( demux_t *p_demux, KaxBlock *block, KaxSimpleBlock *simpleblock
         {
             if( track.fmt.i_cat == VIDEO_ES || track.fmt.i_cat == AUDIO_ES )
                 track.i_last_dts = VLC_TS_INVALID;
+            block_ChainRelease( p_frames );
             return;
         }
     }
 
-    size_t frame_size = 0;
-    size_t block_size = 0;
-
-    if( simpleblock != NULL )
-        block_size = simpleblock->GetSize();
-    else
-        block_size = block->GetSize();
-
     const unsigned int i_number_frames = block != NULL ? block->NumberFrames() :
             ( simpleblock != NULL ? simpleblock->NumberFrames() : 0 );
 
-    for( unsigned int i_frame = 0; i_frame < i_number_frames; i_frame++ )
+    for( block_t *p_next; p_frames != NULL; p_frames = p_next )
     {
-        block_t *p_block;
-        DataBuffer *data;
-        if( simpleblock != NULL )
-        {
-            data = &simpleblock->GetBuffer(i_frame);
-        }
-        else
+        block_t *p_block = p_frames;
+        p_next = p_block->p_next;
+        p_block->p_next = NULL;
+
+        /* frames of header compressed tracks keep their headroom, see below */
+        if( unlikely( track.fmt.i_codec == VLC_CODEC_WAVPACK ) &&
+            !( track.i_compression_type == MATROSKA_COMPRESSION_HEADER &&
+               track.p_compression_data != NULL &&
+               track.i_encoding_scope & MATROSKA_ENCODING_SCOPE_ALL_FRAMES ) )
         {
-            data = &block->GetBuffer(i_frame);
+            block_t *p_wavpack = packetize_wavpack( track, p_block->p_buffer, p_block->i_buffer );
+            block_Release( p_block );
+            p_block = p_wavpack;
         }
-        frame_size += data->Size();
-        if( !data->Buffer() || data->Size() > frame_size || frame_size > block_size  )
-        {
-            msg_Warn( p_demux, "Cannot read frame (too long or no frame)" );
-            break;
-        }
-
-        if( track.i_compression_type == MATROSKA_COMPRESSION_HEADER &&
-            track.p_compression_data != NULL &&
-            track.i_encoding_scope & MATROSKA_ENCODING_SCOPE_ALL_FRAMES )
-            p_block = MemToBlock( data->Buffer(), data->Size(), track.p_compression_data->GetSize() );
-        else if( unlikely( track.fmt.i_codec == VLC_CODEC_WAVPACK ) )
-            p_block = packetize_wavpack( track, data->Buffer(), data->Size() );
-        else
-            p_block = MemToBlock( data->Buffer(), data->Size(), 0 );
 
         if( p_block == NULL )
         {
+            block_ChainRelease( p_next );
             break;
         }
 
@@ -581,7 +579,10 @@ void BlockDecode( demux_t *p_demux, KaxBlock *block, KaxSimpleBlock *simpleblock
         {
             p_block = block_zlib_decompress( VLC_OBJECT(p_demux), p_block );
             if( p_block == NULL )
+            {
+                block_ChainRelease( p_next );
                 break;
+            }
         }
         else
 #endif
@@ -623,6 +624,7 @@ void BlockDecode( demux_t *p_demux, KaxBlock *block, KaxSimpleBlock *simpleblock
                 // TODO handle the start/stop times of this packet
                 p_sys->p_ev->SetPci( (const pci_t *)&p_block->p_buffer[1]);
                 block_Release( p_block );
+                block_ChainRelease( p_next );
                 return;
             }
             p_block->i_dts = p_block->i_pts = i_pts;
@@ -691,8 +693,9 @@ static int Demux( demux_t *p_demux)
     int64_t i_block_duration = 0;
     bool b_key_picture;
     bool b_discardable_picture;
+    block_t *p_frames;
 
-    if( p_segment->BlockGet( block, simpleblock, &b_key_picture, &b_discardable_picture, &i_block_duration ) )
+    if( p_segment->BlockGet( block, simpleblock, &b_key_picture, &b_discardable_picture, &i_block_duration, &p_frames ) )
     {
         if ( p_vsegment->CurrentEdition() && p_vsegment->CurrentEdition()->b_ordered )
         {
@@ -719,6 +722,7 @@ static int Demux( demux_t *p_demux)
         if( p_track == NULL )
         {
             msg_Err( p_demux, "invalid track number" );
+            block_ChainRelease( p_frames );
             delete block;
             return 0;
         }
@@ -735,6 +739,7 @@ static int Demux( demux_t *p_demux)
 
             if ( track.i_skip_until_fpos > block_fpos )
             {
+                block_ChainRelease( p_frames );
                 delete block;
                 return 1; // this block shall be ignored
             }
@@ -790,11 +795,12 @@ static int Demux( demux_t *p_demux)
          p_vsegment->CurrentChapter() == NULL )
     {
         /* nothing left to read in this ordered edition */
+        block_ChainRelease( p_frames );
         delete block;
         return 0;
     }
 
-    BlockDecode( p_demux, block, simpleblock, p_sys->i_pts, i_block_duration, b_key_picture, b_discardable_picture );
+    BlockDecode( p_demux, block, simpleblock, p_frames, p_sys->i_pts, i_block_duration, b_key_picture, b_discardable_picture );
 
     delete block;
 
@@ -120,8 +120,8 @@ enum
 using namespace LIBMATROSKA_NAMESPACE;
 
 void BlockDecode( demux_t *p_demux, KaxBlock *block, KaxSimpleBlock *simpleblock,
-                  mtime_t i_pts, mtime_t i_duration, bool b_key_picture,
-                  bool b_discardable_picture );
+                  block_t *p_frames, mtime_t i_pts, mtime_t i_duration,
+                  bool b_key_picture, bool b_discardable_picture );
 
 class attachment_c
 {
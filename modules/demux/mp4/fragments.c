@@ -22,6 +22,7 @@
 #endif
 
 #include "fragments.h"
+#include "../index_cache.h"
 #include <limits.h>
 
 void MP4_Fragments_Index_Delete( mp4_fragments_index_t *p_index )
@@ -93,6 +94,122 @@ bool MP4_Fragments_Index_Lookup( mp4_fragments_index_t *p_index, stime_t *pi_tim
     return true;
 }
 
+#define MP4_FRAGS_CACHE_MAGIC   "VLCMP4FI"
+#define MP4_FRAGS_CACHE_VERSION 1
+
+typedef struct
+{
+    char     magic[8];
+    uint32_t i_version;
+    uint32_t i_tracks;
+    uint32_t i_entries;
+    uint32_t i_url;
+    uint64_t i_size;
+    int64_t  i_mtime;
+    int64_t  i_last_time;
+} mp4_fragments_cache_header_t;
+
+static bool MP4_Fragments_Index_Check( const mp4_fragments_index_t *p_index,
+                                       uint64_t i_size )
+{
+    for( size_t i=0; i<p_index->i_entries; i++ )
+    {
+        if( p_index->pi_pos[i] >= i_size ||
+            ( i > 0 && p_index->pi_pos[i] <= p_index->pi_pos[i - 1] ) )
+            return false;
+    }
+    return true;
+}
+
+mp4_fragments_index_t * MP4_Fragments_Index_Load( vlc_object_t *p_obj, const char *psz_url,
+                                                  uint64_t i_size, int64_t i_mtime,
+                                                  unsigned i_tracks )
+{
+    FILE *p_file = index_cache_Open( "mp4", psz_url );
+    if( !p_file )
+        return NULL;
+
+    mp4_fragments_index_t *p_index = NULL;
+    char *psz_cached_url = NULL;
+    mp4_fragments_cache_header_t hdr;
+
+    /* every moof being at least a box header */
+    if( fread( &hdr, sizeof(hdr), 1, p_file ) != 1 ||
+        memcmp( hdr.magic, MP4_FRAGS_CACHE_MAGIC, sizeof(hdr.magic) ) ||
+        hdr.i_version != MP4_FRAGS_CACHE_VERSION ||
+        hdr.i_tracks != i_tracks || hdr.i_size != i_size || hdr.i_mtime != i_mtime ||
+        hdr.i_url != strlen( psz_url ) || hdr.i_entries > i_size / 8 )
+        goto end;
+
+    psz_cached_url = malloc( hdr.i_url );
+    if( !psz_cached_url ||
+        fread( psz_cached_url, 1, hdr.i_url, p_file ) != hdr.i_url ||
+        memcmp( psz_cached_url, psz_url, hdr.i_url ) )
+        goto end;
+
+    p_index = MP4_Fragments_Index_New( i_tracks, hdr.i_entries );
+    if( !p_index )
+        goto end;
+
+    const size_t i_times = (size_t) hdr.i_entries * i_tracks;
+    if( fread( p_index->pi_pos, sizeof(*p_index->pi_pos), hdr.i_entries,
+               p_file ) != hdr.i_entries ||
+        fread( p_index->p_times, sizeof(*p_index->p_times), i_times,
+               p_file ) != i_times ||
+        !MP4_Fragments_Index_Check( p_index, i_size ) )
+    {
+        MP4_Fragments_Index_Delete( p_index );
+        p_index = NULL;
+        goto end;
+    }
+    p_index->i_last_time = hdr.i_last_time;
+
+    msg_Dbg( p_obj, "loaded %u fragments from index cache", p_index->i_entries );
+
+end:
+    free( psz_cached_url );
+    fclose( p_file );
+    return p_index;
+}
+
+int MP4_Fragments_Index_Store( vlc_object_t *p_obj, const mp4_fragments_index_t *p_index,
+                               const char *psz_url, uint64_t i_size, int64_t i_mtime )
+{
+    index_cache_writer_t writer;
+    if( index_cache_Begin( &writer, "mp4", psz_url ) )
+    {
+        msg_Warn( p_obj, "cannot create fragments index cache" );
+        return VLC_EGENERIC;
+    }
+
+    mp4_fragments_cache_header_t hdr;
+    memset( &hdr, 0, sizeof(hdr) );
+    memcpy( hdr.magic, MP4_FRAGS_CACHE_MAGIC, sizeof(hdr.magic) );
+    hdr.i_version = MP4_FRAGS_CACHE_VERSION;
+    hdr.i_tracks = p_index->i_tracks;
+    hdr.i_entries = p_index->i_entries;
+    hdr.i_url = strlen( psz_url );
+    hdr.i_size = i_size;
+    hdr.i_mtime = i_mtime;
+    hdr.i_last_time = p_index->i_last_time;
+
+    const size_t i_times = (size_t) p_index->i_entries * p_index->i_tracks;
+    bool b_ok =
+        fwrite( &hdr, sizeof(hdr), 1, writer.p_file ) == 1 &&
+        fwrite( psz_url, 1, hdr.i_url, writer.p_file ) == hdr.i_url &&
+        fwrite( p_index->pi_pos, sizeof(*p_index->pi_pos), p_index->i_entries,
+                writer.p_file ) == p_index->i_entries &&
+        fwrite( p_index->p_times, sizeof(*p_index->p_times), i_times,
+                writer.p_file ) == i_times;
+
+    int i_ret = index_cache_End( &writer, b_ok );
+    if( i_ret == VLC_SUCCESS )
+        msg_Dbg( p_obj, "stored %u fragments in index cache", p_index->i_entries );
+    else
+        msg_Warn( p_obj, "cannot write fragments index cache" );
+    return i_ret;
+}
+
 #ifdef MP4_VERBOSE
 void MP4_Fragments_Index_Dump( vlc_object_t *p_obj, const mp4_fragments_index_t *p_index,
                                uint32_t i_movie_timescale )
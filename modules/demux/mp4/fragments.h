@@ -42,6 +42,13 @@ stime_t MP4_Fragment_Index_GetTrackDuration( mp4_fragments_index_t *p_index, uns
 bool MP4_Fragments_Index_Lookup( mp4_fragments_index_t *p_index,
                                  stime_t *pi_time, uint64_t *pi_pos, unsigned i_track_index );
 
+/* On disk cache, keyed by the file url, size and modification time */
+mp4_fragments_index_t * MP4_Fragments_Index_Load( vlc_object_t *p_obj, const char *psz_url,
+                                                  uint64_t i_size, int64_t i_mtime,
+                                                  unsigned i_tracks );
+int MP4_Fragments_Index_Store( vlc_object_t *p_obj, const mp4_fragments_index_t *p_index,
+                               const char *psz_url, uint64_t i_size, int64_t i_mtime );
+
 #ifdef MP4_VERBOSE
 void MP4_Fragments_Index_Dump( vlc_object_t *p_obj, const mp4_fragments_index_t *p_index,
                                 uint32_t i_movie_timescale );
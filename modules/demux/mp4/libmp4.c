@@ -442,6 +442,175 @@ static int MP4_ReadBoxContainer( stream_t *p_stream, MP4_Box_t *p_container )
     return MP4_ReadBoxContainerChildren( p_stream, p_container, NULL );
 }
 
+/* moov is fetched at once up to that size, then parsed from memory */
+#define MP4_MOOV_PRELOAD_MAX (128 * 1024 * 1024)
+#define MP4_MOOV_MAX_THREADS 4
+
+typedef struct
+{
+    const uint8_t *p_data;
+    uint64_t       i_size;
+    uint64_t       i_pos;   /* absolute position in the file */
+    uint32_t       i_type;
+    MP4_Box_t     *p_box;   /* parsed child */
+} mp4_moov_child_t;
+
+typedef struct
+{
+    stream_t         *p_stream;
+    uint32_t          i_father_type;
+    mp4_moov_child_t *p_children;
+    size_t            i_children;
+    size_t            i_next;  /* next child to parse */
+    vlc_mutex_t       lock;
+} mp4_moov_parser_t;
+
+static void MP4_ReadMoovChild( mp4_moov_parser_t *p_parser, mp4_moov_child_t *p_child )
+{
+    stream_t *p_substream = vlc_stream_MemoryNew( p_parser->p_stream,
+                                                  (uint8_t *) p_child->p_data,
+                                                  p_child->i_size, true );
+    if( !p_substream )
+        return;
+
+    /* Detached father, as the real one can't be modified concurrently */
+    MP4_Box_t father = { 0 };
+    father.i_type = p_parser->i_father_type;
+    father.i_size = p_child->i_size;
+
+    bool b_hit = false;
+    MP4_Box_t *p_box = MP4_ReadBoxRestricted( p_substream, &father, NULL, NULL, &b_hit );
+    vlc_stream_Delete( p_substream );
+
+    if( p_box )
+    {
+        p_box->p_father = NULL;
+        MP4_BoxOffsetUp( p_box, p_child->i_pos );
+        p_child->p_box = p_box;
+    }
+}
+
+static void *MP4_MoovParserThread( void *p_data )
+{
+    mp4_moov_parser_t *p_parser = p_data;
+
+    for( ;; )
+    {
+        vlc_mutex_lock( &p_parser->lock );
+        size_t i_child = p_parser->i_next++;
+        vlc_mutex_unlock( &p_parser->lock );
+
+        if( i_child >= p_parser->i_children )
+            break;
+        MP4_ReadMoovChild( p_parser, &p_parser->p_children[i_child] );
+    }
+
+    return NULL;
+}
+
+/* Fetches the whole moov with a single read, instead of many small ones
+ * costly on network streams, then parses its independent subtrees (trak
+ * mostly) concurrently from memory */
+static int MP4_ReadBoxMoov( stream_t *p_stream, MP4_Box_t *p_container )
+{
+    const size_t i_header = mp4_box_headersize( p_container );
+    if( p_container->i_size <= i_header + 8 ||
+        p_container->i_size > MP4_MOOV_PRELOAD_MAX )
+        return MP4_ReadBoxContainer( p_stream, p_container );
+
+    const size_t i_size = p_container->i_size;
+    uint8_t *p_buffer = malloc( i_size );
+    if( !p_buffer || MP4_Seek( p_stream, p_container->i_pos ) ||
+        vlc_stream_Read( p_stream, p_buffer, i_size ) != (ssize_t) i_size )
+    {
+        free( p_buffer );
+        return MP4_ReadBoxContainer( p_stream, p_container );
+    }
+
+    mp4_moov_parser_t parser;
+    parser.p_stream = p_stream;
+    parser.i_father_type = p_container->i_type;
+    parser.p_children = NULL;
+    parser.i_children = 0;
+    parser.i_next = 0;
+    vlc_mutex_init( &parser.lock );
+
+    /* list the children */
+    unsigned i_traks = 0;
+    size_t i_offset = i_header;
+    while( i_offset + 8 <= i_size )
+    {
+        uint64_t i_child = GetDWBE( &p_buffer[i_offset] );
+        if( i_child == 1 )
+        {
+            if( i_offset + 16 > i_size )
+                break;
+            i_child = GetQWBE( &p_buffer[i_offset + 8] );
+        }
+        else if( i_child == 0 )
+        {
+            i_child = i_size - i_offset;
+        }
+        if( i_child < 8 || i_child > i_size - i_offset )
+            break;
+
+        if( ( parser.i_children % 16 ) == 0 )
+        {
+            mp4_moov_child_t *p_realloc =
+                realloc( parser.p_children,
+                         ( parser.i_children + 16 ) * sizeof(*p_realloc) );
+            if( !p_realloc )
+                break;
+            parser.p_children = p_realloc;
+        }
+
+        mp4_moov_child_t *p_child = &parser.p_children[parser.i_children++];
+        p_child->p_data = &p_buffer[i_offset];
+        p_child->i_size = i_child;
+        p_child->i_pos = p_container->i_pos + i_offset;
+        p_child->i_type = VLC_FOURCC( p_buffer[i_offset + 4], p_buffer[i_offset + 5],
+                                      p_buffer[i_offset + 6], p_buffer[i_offset + 7] );
+        p_child->p_box = NULL;
+        if( p_child->i_type == ATOM_trak )
+            i_traks++;
+
+        i_offset += i_child;
+    }
+
+    /* parse, with helper threads if there are several tracks */
+    vlc_thread_t threads[MP4_MOOV_MAX_THREADS - 1];
+    unsigned i_threads = 0;
+    for( unsigned i = 1; i < __MIN( i_traks, MP4_MOOV_MAX_THREADS ); i++ )
+    {
+        if( vlc_clone( &threads[i_threads], MP4_MoovParserThread, &parser,
+                       VLC_THREAD_PRIORITY_INPUT ) )
+            break;
+        i_threads++;
+    }
+    MP4_MoovParserThread( &parser );
+    for( unsigned i = 0; i < i_threads; i++ )
+        vlc_join( threads[i], NULL );
+
+    msg_Dbg( p_stream, "read %4.4s in one request, %zu children using %u threads",
+             (char *) &p_container->i_type, parser.i_children, i_threads + 1 );
+
+    /* attach in file order */
+    for( size_t i = 0; i < parser.i_children; i++ )
+    {
+        if( parser.p_children[i].p_box )
+            MP4_BoxAddChild( p_container, parser.p_children[i].p_box );
+        else
+            msg_Warn( p_stream, "cannot read one %4.4s child box",
+                      (char *) &p_container->i_type );
+    }
+
+    vlc_mutex_destroy( &parser.lock );
+    free( parser.p_children );
+    free( p_buffer );
+
+    return 1;
+}
+
 static int MP4_ReadBoxSkip( stream_t *p_stream, MP4_Box_t *p_box )
 {
     /* XXX sometime moov is hiden in a free box */
@@ -4209,7 +4378,7 @@ static const struct
 } MP4_Box_Function [] =
 {
     /* Containers */
-    { ATOM_moov,    MP4_ReadBoxContainer,     0 },
+    { ATOM_moov,    MP4_ReadBoxMoov,          0 },
     { ATOM_foov,    MP4_ReadBoxContainer,     0 },
     { ATOM_trak,    MP4_ReadBoxContainer,     ATOM_moov },
     { ATOM_trak,    MP4_ReadBoxContainer,     ATOM_foov },
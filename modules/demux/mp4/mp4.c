@@ -34,8 +34,10 @@
 #include <vlc_aout.h>
 #include <vlc_plugin.h>
 #include <vlc_dialog.h>
+#include <vlc_fs.h>
 #include <assert.h>
 #include <limits.h>
+#include <sys/stat.h>
 #include "../codec/cc.h"
 
 /*****************************************************************************
@@ -49,6 +51,11 @@ static void Close( vlc_object_t * );
 #define MP4_M4A_TEXT     "M4A audio only"
 #define MP4_M4A_LONGTEXT "Ignore non audio tracks from iTunes audio files"
 
+#define MP4_FRAGS_CACHE_TEXT     N_("Cache fragments index")
+#define MP4_FRAGS_CACHE_LONGTEXT N_("Keep the index built by scanning fragmented " \
+                                    "files without sidx or mfra on disk, so they " \
+                                    "can be reopened and seeked without a rescan.")
+
 vlc_module_begin ()
     set_category( CAT_INPUT )
     set_subcategory( SUBCAT_INPUT_DEMUX )
@@ -59,6 +66,8 @@ vlc_module_begin ()
 
     add_category_hint("Hacks", NULL, true)
     add_bool( CFG_PREFIX"m4a-audioonly", false, MP4_M4A_TEXT, MP4_M4A_LONGTEXT, true )
+    add_bool( CFG_PREFIX"fragments-cache", false, MP4_FRAGS_CACHE_TEXT,
+              MP4_FRAGS_CACHE_LONGTEXT, true )
 vlc_module_end ()
 
 /*****************************************************************************
@@ -292,32 +301,46 @@ static es_out_id_t * MP4_AddTrackES( es_out_t *out, mp4_track_t *p_track )
     return p_es;
 }
 
-/* Return time in microsecond of a track */
-static inline int64_t MP4_TrackGetDTS( demux_t *p_demux, mp4_track_t *p_track )
+/* Returns the dts of the i_sample th sample of the chunk, in track timescale,
+ * walking the stts entries from the one covering the chunk first sample */
+static uint64_t MP4_ChunkGetDTS( const mp4_track_t *p_track,
+                                 const mp4_chunk_t *p_chunk, uint32_t i_sample )
 {
-    demux_sys_t *p_sys = p_demux->p_sys;
-    const mp4_chunk_t *p_chunk = &p_track->chunk[p_track->i_chunk];
+    const MP4_Box_data_stts_t *stts = p_track->p_stts;
+    uint64_t i_dts = p_chunk->i_first_dts;
+    uint32_t i_skip = p_chunk->i_skip_dts;
 
-    unsigned int i_index = 0;
-    unsigned int i_sample = p_track->i_sample - p_chunk->i_sample_first;
-    int64_t i_dts = p_chunk->i_first_dts;
-
-    while( i_sample > 0 && i_index < p_chunk->i_entries_dts )
+    for( uint32_t i_index = p_chunk->i_index_dts;
+         i_sample > 0 && i_index < stts->i_entry_count; i_index++ )
     {
-        if( i_sample > p_chunk->p_sample_count_dts[i_index] )
+        const uint32_t i_count = stts->pi_sample_count[i_index] - i_skip;
+        const uint32_t i_delta = stts->pi_sample_delta[i_index];
+        i_skip = 0;
+
+        if( i_sample > i_count )
         {
-            i_dts += p_chunk->p_sample_count_dts[i_index] *
-                p_chunk->p_sample_delta_dts[i_index];
-            i_sample -= p_chunk->p_sample_count_dts[i_index];
-            i_index++;
+            i_dts += (uint64_t) i_count * i_delta;
+            i_sample -= i_count;
         }
         else
         {
-            i_dts += i_sample * p_chunk->p_sample_delta_dts[i_index];
+            i_dts += (uint64_t) i_sample * i_delta;
             break;
         }
     }
 
+    return i_dts;
+}
+
+/* Return time in microsecond of a track */
+static inline int64_t MP4_TrackGetDTS( demux_t *p_demux, mp4_track_t *p_track )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    const mp4_chunk_t *p_chunk = &p_track->chunk[p_track->i_chunk];
+
+    int64_t i_dts = MP4_ChunkGetDTS( p_track, p_chunk,
+                                     p_track->i_sample - p_chunk->i_sample_first );
+
     /* now handle elst */
     if( p_track->p_elst )
     {
@@ -344,24 +367,28 @@ static inline bool MP4_TrackGetPTSDelta( demux_t *p_demux, mp4_track_t *p_track,
                                          int64_t *pi_delta )
 {
     VLC_UNUSED( p_demux );
-    mp4_chunk_t *ck = &p_track->chunk[p_track->i_chunk];
+    const MP4_Box_data_ctts_t *ctts = p_track->p_ctts;
+    const mp4_chunk_t *ck = &p_track->chunk[p_track->i_chunk];
 
-    unsigned int i_index = 0;
     unsigned int i_sample = p_track->i_sample - ck->i_sample_first;
+    uint32_t i_skip = ck->i_skip_pts;
 
-    if( ck->p_sample_count_pts == NULL || ck->p_sample_offset_pts == NULL )
+    if( ctts == NULL )
         return false;
 
-    for( i_index = 0; i_index < ck->i_entries_pts ; i_index++ )
+    for( uint32_t i_index = ck->i_index_pts; i_index < ctts->i_entry_count; i_index++ )
     {
-        if( i_sample < ck->p_sample_count_pts[i_index] )
+        const uint32_t i_count = ctts->pi_sample_count[i_index] - i_skip;
+        i_skip = 0;
+
+        if( i_sample < i_count )
         {
-            *pi_delta = MP4_rescale( ck->p_sample_offset_pts[i_index],
+            *pi_delta = MP4_rescale( ctts->pi_sample_offset[i_index] + p_track->i_cts_shift,
                                      p_track->i_timescale, CLOCK_FREQ );
             return true;
         }
 
-        i_sample -= ck->p_sample_count_pts[i_index];
+        i_sample -= i_count;
     }
     return false;
 }
@@ -2310,14 +2337,6 @@ static int TrackCreateChunksIndex( demux_t *p_demux,
         mp4_chunk_t *ck = &p_demux_track->chunk[i_chunk];
 
         ck->i_offset = BOXDATA(p_co64)->i_chunk_offset[i_chunk];
-
-        ck->i_first_dts = 0;
-        ck->i_entries_dts = 0;
-        ck->p_sample_count_dts = NULL;
-        ck->p_sample_delta_dts = NULL;
-        ck->i_entries_pts = 0;
-        ck->p_sample_count_pts = NULL;
-        ck->p_sample_offset_pts = NULL;
     }
 
     /* now we read index for SampleEntry( soun vide mp4a mp4v ...)
@@ -2379,52 +2398,30 @@ static int TrackCreateChunksIndex( demux_t *p_demux,
     return VLC_SUCCESS;
 }
 
-static int xTTS_CountEntries( demux_t *p_demux, uint32_t *pi_entry /* out */,
-                              const uint32_t i_index,
-                              uint32_t i_index_samples_left,
-                              uint32_t i_sample_count,
-                              const uint32_t *pi_index_sample_count,
-                              const uint32_t i_table_count )
+/* Moves forward by i_samples in a stts/ctts run-length table, returns the
+ * duration of the skipped samples when the deltas are given */
+static uint64_t xTTS_Skip( const uint32_t *pi_sample_count, const int32_t *pi_delta,
+                           uint32_t i_entry_count, uint32_t *pi_index,
+                           uint32_t *pi_skip, uint32_t i_samples )
 {
-    uint32_t i_array_offset;
-    while( i_sample_count > 0 )
-    {
-        if ( likely((UINT32_MAX - i_index) >= *pi_entry) )
-            i_array_offset = i_index + *pi_entry;
-        else
-            return VLC_EGENERIC;
-
-        if ( i_array_offset >= i_table_count )
-        {
-            msg_Err( p_demux, "invalid index counting total samples %u %u", i_array_offset,  i_table_count );
-            return VLC_ENOVAR;
-        }
+    uint64_t i_duration = 0;
 
-        if ( i_index_samples_left )
-        {
-            if ( i_index_samples_left > i_sample_count )
-            {
-                i_index_samples_left -= i_sample_count;
-                i_sample_count = 0;
-                *pi_entry +=1; /* No samples left, go copy */
-                break;
-            }
-            else
-            {
-                i_sample_count -= i_index_samples_left;
-                i_index_samples_left = 0;
-                *pi_entry += 1;
-                continue;
-            }
-        }
-        else
+    while( i_samples > 0 && *pi_index < i_entry_count )
+    {
+        const uint32_t i_count = __MIN( pi_sample_count[*pi_index] - *pi_skip,
+                                        i_samples );
+        if( pi_delta )
+            i_duration += (uint64_t) i_count * (uint32_t) pi_delta[*pi_index];
+        i_samples -= i_count;
+        *pi_skip += i_count;
+        if( *pi_skip >= pi_sample_count[*pi_index] )
         {
-            i_sample_count -= __MIN( i_sample_count, pi_index_sample_count[i_array_offset] );
-            *pi_entry += 1;
+            *pi_index += 1;
+            *pi_skip = 0;
         }
     }
 
-    return VLC_SUCCESS;
+    return i_duration;
 }
 
 static int TrackCreateSamplesIndex( demux_t *p_demux,
@@ -2464,18 +2461,9 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
     }
     else
     {
-        /* 2: each sample can have a different size */
+        /* 2: each sample can have a different size, use the box table */
         p_demux_track->i_sample_size = 0;
-        p_demux_track->p_sample_size =
-            calloc( p_demux_track->i_sample_count, sizeof( uint32_t ) );
-        if( p_demux_track->p_sample_size == NULL )
-            return VLC_ENOMEM;
-
-        for( uint32_t i_sample = 0; i_sample < p_demux_track->i_sample_count; i_sample++ )
-        {
-            p_demux_track->p_sample_size[i_sample] =
-                    stsz->i_entry_size[i_sample];
-        }
+        p_demux_track->p_sample_size = stsz->i_entry_size;
     }
 
     if ( p_demux_track->i_chunk_count && p_demux_track->i_sample_size == 0 )
@@ -2488,219 +2476,71 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
         }
     }
 
-    /* Use stts table to create a sample number -> dts table.
-     * XXX: if we don't want to waste too much memory, we can't expand
-     *  the box! so each chunk will contain an "extract" of this table
-     *  for fast research (problem with raw stream where a sample is sometime
-     *  just channels*bits_per_sample/8 */
-
-     /* FIXME: refactor STTS & CTTS, STTS having now only few extra lines and
-      *        differing in 2/2 fields and 1 signedness */
-
-    mtime_t i_next_dts = 0;
+    /* The stts and ctts tables are already run-length encoded, so they are
+     * not expanded: each chunk only records the entry covering its first
+     * sample, and the timings of the others are decoded on demand. */
+    uint64_t i_next_dts = 0;
     /* Find stts
      *  Gives mapping between sample and decoding time
      */
     p_box = MP4_BoxGet( p_demux_track->p_stbl, "stts" );
-    if( !p_box )
+    if( !p_box || !p_box->data.p_stts )
     {
         msg_Warn( p_demux, "cannot find STTS box" );
         return VLC_EGENERIC;
     }
     else
     {
-        MP4_Box_data_stts_t *stts = p_box->data.p_stts;
+        const MP4_Box_data_stts_t *stts = p_box->data.p_stts;
 
         msg_Warn( p_demux, "STTS table of %"PRIu32" entries", stts->i_entry_count );
 
-        /* Create sample -> dts table per chunk */
+        p_demux_track->p_stts = stts;
+
         uint32_t i_index = 0;
-        uint32_t i_current_index_samples_left = 0;
+        uint32_t i_skip = 0;
 
         for( uint32_t i_chunk = 0; i_chunk < p_demux_track->i_chunk_count; i_chunk++ )
         {
             mp4_chunk_t *ck = &p_demux_track->chunk[i_chunk];
-            uint32_t i_sample_count;
 
-            /* save first dts */
             ck->i_first_dts = i_next_dts;
-
-            /* count how many entries are needed for this chunk
-             * for p_sample_delta_dts and p_sample_count_dts */
-            ck->i_entries_dts = 0;
-
-            int i_ret = xTTS_CountEntries( p_demux, &ck->i_entries_dts, i_index,
-                                           i_current_index_samples_left,
-                                           ck->i_sample_count,
-                                           stts->pi_sample_count,
-                                           stts->i_entry_count );
-            if ( i_ret == VLC_EGENERIC )
-                return i_ret;
-
-            /* allocate them */
-            ck->p_sample_count_dts = calloc( ck->i_entries_dts, sizeof( uint32_t ) );
-            ck->p_sample_delta_dts = calloc( ck->i_entries_dts, sizeof( uint32_t ) );
-            if( !ck->p_sample_count_dts || !ck->p_sample_delta_dts )
-            {
-                free( ck->p_sample_count_dts );
-                free( ck->p_sample_delta_dts );
-                msg_Err( p_demux, "can't allocate memory for i_entry=%"PRIu32, ck->i_entries_dts );
-                ck->i_entries_dts = 0;
-                return VLC_ENOMEM;
-            }
-
-            /* now copy */
-            i_sample_count = ck->i_sample_count;
-
-            for( uint32_t i = 0; i < ck->i_entries_dts; i++ )
-            {
-                if ( i_current_index_samples_left )
-                {
-                    if ( i_current_index_samples_left > i_sample_count )
-                    {
-                        ck->p_sample_count_dts[i] = i_sample_count;
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( i_sample_count ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_current_index_samples_left -= i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_dts - 1 );
-                        break;
-                    }
-                    else
-                    {
-                        ck->p_sample_count_dts[i] = i_current_index_samples_left;
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( i_current_index_samples_left ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_sample_count -= i_current_index_samples_left;
-                        i_current_index_samples_left = 0;
-                        i_index++;
-                    }
-                }
-                else
-                {
-                    if ( stts->pi_sample_count[i_index] > i_sample_count )
-                    {
-                        ck->p_sample_count_dts[i] = i_sample_count;
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( i_sample_count ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_current_index_samples_left = stts->pi_sample_count[i_index] - i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_dts - 1 );
-                        // keep building from same index
-                    }
-                    else
-                    {
-                        ck->p_sample_count_dts[i] = stts->pi_sample_count[i_index];
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( stts->pi_sample_count[i_index] ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_sample_count -= stts->pi_sample_count[i_index];
-                        i_index++;
-                    }
-                }
-
-            }
+            ck->i_index_dts = i_index;
+            ck->i_skip_dts = i_skip;
+            ck->i_duration = xTTS_Skip( stts->pi_sample_count, stts->pi_sample_delta,
+                                        stts->i_entry_count, &i_index, &i_skip,
+                                        ck->i_sample_count );
+            i_next_dts += ck->i_duration;
         }
     }
 
-
     /* Find ctts
      *  Gives the delta between decoding time (dts) and composition table (pts)
      */
     p_box = MP4_BoxGet( p_demux_track->p_stbl, "ctts" );
     if( p_box && p_box->data.p_ctts )
     {
-        MP4_Box_data_ctts_t *ctts = p_box->data.p_ctts;
+        const MP4_Box_data_ctts_t *ctts = p_box->data.p_ctts;
 
         msg_Warn( p_demux, "CTTS table of %"PRIu32" entries", ctts->i_entry_count );
 
-        int64_t i_cts_shift = 0;
         const MP4_Box_t *p_cslg = MP4_BoxGet( p_demux_track->p_stbl, "cslg" );
         if( p_cslg && BOXDATA(p_cslg) )
-            i_cts_shift = BOXDATA(p_cslg)->ct_to_dts_shift;
+            p_demux_track->i_cts_shift = BOXDATA(p_cslg)->ct_to_dts_shift;
+
+        p_demux_track->p_ctts = ctts;
 
-        /* Create pts-dts table per chunk */
         uint32_t i_index = 0;
-        uint32_t i_current_index_samples_left = 0;
+        uint32_t i_skip = 0;
 
         for( uint32_t i_chunk = 0; i_chunk < p_demux_track->i_chunk_count; i_chunk++ )
         {
             mp4_chunk_t *ck = &p_demux_track->chunk[i_chunk];
-            uint32_t i_sample_count;
-
-            /* count how many entries are needed for this chunk
-             * for p_sample_offset_pts and p_sample_count_pts */
-            ck->i_entries_pts = 0;
-            int i_ret = xTTS_CountEntries( p_demux, &ck->i_entries_pts, i_index,
-                                           i_current_index_samples_left,
-                                           ck->i_sample_count,
-                                           ctts->pi_sample_count,
-                                           ctts->i_entry_count );
-            if ( i_ret == VLC_EGENERIC )
-                return i_ret;
-
-            /* allocate them */
-            ck->p_sample_count_pts = calloc( ck->i_entries_pts, sizeof( uint32_t ) );
-            ck->p_sample_offset_pts = calloc( ck->i_entries_pts, sizeof( int32_t ) );
-            if( !ck->p_sample_count_pts || !ck->p_sample_offset_pts )
-            {
-                free( ck->p_sample_count_pts );
-                free( ck->p_sample_offset_pts );
-                msg_Err( p_demux, "can't allocate memory for i_entry=%"PRIu32, ck->i_entries_pts );
-                ck->i_entries_pts = 0;
-                return VLC_ENOMEM;
-            }
-
-            /* now copy */
-            i_sample_count = ck->i_sample_count;
-
-            for( uint32_t i = 0; i < ck->i_entries_pts; i++ )
-            {
-                if ( i_current_index_samples_left )
-                {
-                    if ( i_current_index_samples_left > i_sample_count )
-                    {
-                        ck->p_sample_count_pts[i] = i_sample_count;
-                        ck->p_sample_offset_pts[i] = ctts->pi_sample_offset[i_index] + i_cts_shift;
-                        i_current_index_samples_left -= i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_pts - 1 );
-                        break;
-                    }
-                    else
-                    {
-                        ck->p_sample_count_pts[i] = i_current_index_samples_left;
-                        ck->p_sample_offset_pts[i] = ctts->pi_sample_offset[i_index] + i_cts_shift;
-                        i_sample_count -= i_current_index_samples_left;
-                        i_current_index_samples_left = 0;
-                        i_index++;
-                    }
-                }
-                else
-                {
-                    if ( ctts->pi_sample_count[i_index] > i_sample_count )
-                    {
-                        ck->p_sample_count_pts[i] = i_sample_count;
-                        ck->p_sample_offset_pts[i] = ctts->pi_sample_offset[i_index] + i_cts_shift;
-                        i_current_index_samples_left = ctts->pi_sample_count[i_index] - i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_pts - 1 );
-                        // keep building from same index
-                    }
-                    else
-                    {
-                        ck->p_sample_count_pts[i] = ctts->pi_sample_count[i_index];
-                        ck->p_sample_offset_pts[i] = ctts->pi_sample_offset[i_index] + i_cts_shift;
-                        i_sample_count -= ctts->pi_sample_count[i_index];
-                        i_index++;
-                    }
-                }
 
-
-            }
+            ck->i_index_pts = i_index;
+            ck->i_skip_pts = i_skip;
+            xTTS_Skip( ctts->pi_sample_count, NULL, ctts->i_entry_count,
+                       &i_index, &i_skip, ck->i_sample_count );
         }
     }
 
@@ -2950,7 +2790,6 @@ static int TrackTimeToSampleChunk( demux_t *p_demux, mp4_track_t *p_track,
     uint64_t     i_dts;
     unsigned int i_sample;
     unsigned int i_chunk;
-    int          i_index;
 
     /* FIXME see if it's needed to check p_track->i_chunk_count */
     if( p_track->i_chunk_count == 0 )
@@ -2994,49 +2833,44 @@ static int TrackTimeToSampleChunk( demux_t *p_demux, mp4_track_t *p_track,
         i_start = MP4_rescale( i_start, CLOCK_FREQ, p_track->i_timescale );
     }
 
-    /* we start from sample 0/chunk 0, hope it won't take too much time */
-    /* *** find good chunk *** */
-    for( i_chunk = 0; ; i_chunk++ )
+    /* *** find good chunk ***, chunks dts are increasing */
+    uint32_t i_low = 0;
+    uint32_t i_high = p_track->i_chunk_count - 1;
+    while( i_low < i_high )
     {
-        if( i_chunk + 1 >= p_track->i_chunk_count )
-        {
-            /* at the end and can't check if i_start in this chunk,
-               it will be check while searching i_sample */
-            i_chunk = p_track->i_chunk_count - 1;
-            break;
-        }
-
-        if( (uint64_t)i_start >= p_track->chunk[i_chunk].i_first_dts &&
-            (uint64_t)i_start <  p_track->chunk[i_chunk + 1].i_first_dts )
-        {
-            break;
-        }
+        uint32_t i_mid = i_low + ( i_high - i_low + 1 ) / 2;
+        if( (uint64_t)i_start >= p_track->chunk[i_mid].i_first_dts )
+            i_low = i_mid;
+        else
+            i_high = i_mid - 1;
     }
+    i_chunk = i_low;
 
     /* *** find sample in the chunk *** */
-    i_sample = p_track->chunk[i_chunk].i_sample_first;
-    i_dts    = p_track->chunk[i_chunk].i_first_dts;
-    for( i_index = 0; i_sample < p_track->chunk[i_chunk].i_sample_count; )
+    const MP4_Box_data_stts_t *stts = p_track->p_stts;
+    const mp4_chunk_t *ck = &p_track->chunk[i_chunk];
+    uint32_t i_left = ck->i_sample_count;
+    uint32_t i_skip = ck->i_skip_dts;
+
+    i_sample = ck->i_sample_first;
+    i_dts    = ck->i_first_dts;
+    for( uint32_t i_index = ck->i_index_dts;
+         i_left > 0 && i_index < stts->i_entry_count; i_index++ )
     {
-        if( i_dts +
-            p_track->chunk[i_chunk].p_sample_count_dts[i_index] *
-            p_track->chunk[i_chunk].p_sample_delta_dts[i_index] < (uint64_t)i_start )
-        {
-            i_dts    +=
-                p_track->chunk[i_chunk].p_sample_count_dts[i_index] *
-                p_track->chunk[i_chunk].p_sample_delta_dts[i_index];
+        const uint32_t i_count = __MIN( stts->pi_sample_count[i_index] - i_skip, i_left );
+        const uint32_t i_delta = stts->pi_sample_delta[i_index];
+        i_skip = 0;
 
-            i_sample += p_track->chunk[i_chunk].p_sample_count_dts[i_index];
-            i_index++;
+        if( i_dts + (uint64_t) i_count * i_delta < (uint64_t)i_start )
+        {
+            i_dts    += (uint64_t) i_count * i_delta;
+            i_sample += i_count;
+            i_left   -= i_count;
         }
         else
         {
-            if( p_track->chunk[i_chunk].p_sample_delta_dts[i_index] <= 0 )
-            {
-                break;
-            }
-            i_sample += ( i_start - i_dts ) /
-                p_track->chunk[i_chunk].p_sample_delta_dts[i_index];
+            if( i_delta > 0 )
+                i_sample += ( i_start - i_dts ) / i_delta;
             break;
         }
     }
@@ -3466,15 +3300,6 @@ static void MP4_TrackSetup( demux_t *p_demux, mp4_track_t *p_track,
     p_track->b_ok = true;
 }
 
-static void DestroyChunk( mp4_chunk_t *ck )
-{
-    free( ck->p_sample_count_dts );
-    free( ck->p_sample_delta_dts );
-    free( ck->p_sample_count_pts );
-    free( ck->p_sample_offset_pts );
-    free( ck->p_sample_size );
-}
-
 /****************************************************************************
  * MP4_TrackClean:
  ****************************************************************************
@@ -3487,16 +3312,8 @@ static void MP4_TrackClean( es_out_t *out, mp4_track_t *p_track )
     if( p_track->p_es )
         es_out_Del( out, p_track->p_es );
 
-    if( p_track->chunk )
-    {
-        for( unsigned int i_chunk = 0; i_chunk < p_track->i_chunk_count; i_chunk++ )
-            DestroyChunk( &p_track->chunk[i_chunk] );
-    }
     free( p_track->chunk );
 
-    if( !p_track->i_sample_size )
-        free( p_track->p_sample_size );
-
     if ( p_track->asfinfo.p_frame )
         block_ChainRelease( p_track->asfinfo.p_frame );
 
@@ -4096,6 +3913,28 @@ static bool GetMoofTrackDuration( MP4_Box_t *p_moov, MP4_Box_t *p_moof,
     return true;
 }
 
+/* Returns the fragments index cache key, or NULL if it can't be used */
+static char * GetFragmentsCacheKey( demux_t *p_demux, uint64_t *pi_size, int64_t *pi_mtime )
+{
+    if( !var_InheritBool( p_demux, CFG_PREFIX"fragments-cache" ) ||
+        !p_demux->psz_access || !p_demux->psz_location ||
+        vlc_stream_GetSize( p_demux->s, pi_size ) != VLC_SUCCESS || *pi_size == 0 )
+        return NULL;
+
+    *pi_mtime = 0;
+    if( p_demux->psz_file )
+    {
+        struct stat st;
+        if( vlc_stat( p_demux->psz_file, &st ) == 0 )
+            *pi_mtime = st.st_mtime;
+    }
+
+    char *psz_url;
+    if( asprintf( &psz_url, "%s://%s", p_demux->psz_access, p_demux->psz_location ) < 0 )
+        return NULL;
+    return psz_url;
+}
+
 static int ProbeFragments( demux_t *p_demux, bool b_force, bool *pb_fragmented )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
@@ -4108,7 +3947,32 @@ static int ProbeFragments( demux_t *p_demux, bool b_force, bool *pb_fragmented )
     if( !p_vroot )
         return VLC_EGENERIC;
 
+    uint64_t i_cache_size;
+    int64_t i_cache_mtime;
+    char *psz_cache_key = NULL;
+    mp4_fragments_index_t *p_cached = NULL;
+
     if( p_sys->b_seekable && (p_sys->b_fastseekable || b_force) )
+    {
+        psz_cache_key = GetFragmentsCacheKey( p_demux, &i_cache_size, &i_cache_mtime );
+        if( psz_cache_key )
+            p_cached = MP4_Fragments_Index_Load( VLC_OBJECT(p_demux), psz_cache_key,
+                                                 i_cache_size, i_cache_mtime,
+                                                 p_sys->i_tracks );
+    }
+
+    if( p_cached )
+    {
+        /* Skips the whole file scan */
+        MP4_Fragments_Index_Delete( p_sys->p_fragsindex );
+        p_sys->p_fragsindex = p_cached;
+        *pb_fragmented = true;
+        p_sys->b_fragments_probed = true;
+#ifdef MP4_VERBOSE
+        MP4_Fragments_Index_Dump( VLC_OBJECT(p_demux), p_sys->p_fragsindex, p_sys->i_timescale );
+#endif
+    }
+    else if( p_sys->b_seekable && (p_sys->b_fastseekable || b_force) )
     {
         MP4_ReadBoxContainerChildren( p_demux->s, p_vroot, NULL ); /* Get the rest of the file */
         p_sys->b_fragments_probed = true;
@@ -4121,6 +3985,7 @@ static int ProbeFragments( demux_t *p_demux, bool b_force, bool *pb_fragmented )
             if( !p_sys->p_fragsindex )
             {
                 MP4_BoxFree( p_vroot );
+                free( psz_cache_key );
                 return VLC_EGENERIC;
             }
 
@@ -4130,6 +3995,7 @@ static int ProbeFragments( demux_t *p_demux, bool b_force, bool *pb_fragmented )
                 MP4_Fragments_Index_Delete( p_sys->p_fragsindex );
                 p_sys->p_fragsindex = NULL;
                 MP4_BoxFree( p_vroot );
+                free( psz_cache_key );
                 return VLC_EGENERIC;
             }
 
@@ -4183,6 +4049,11 @@ static int ProbeFragments( demux_t *p_demux, bool b_force, bool *pb_fragmented )
 #ifdef MP4_VERBOSE
             MP4_Fragments_Index_Dump( VLC_OBJECT(p_demux), p_sys->p_fragsindex, p_sys->i_timescale );
 #endif
+            /* Don't keep an index from an interrupted scan */
+            const MP4_Box_t *p_last = p_vroot->p_last;
+            if( psz_cache_key && p_last->i_pos + p_last->i_size == i_cache_size )
+                MP4_Fragments_Index_Store( VLC_OBJECT(p_demux), p_sys->p_fragsindex,
+                                           psz_cache_key, i_cache_size, i_cache_mtime );
         }
     }
     else
@@ -4200,6 +4071,7 @@ static int ProbeFragments( demux_t *p_demux, bool b_force, bool *pb_fragmented )
     }
 
     MP4_BoxFree( p_vroot );
+    free( psz_cache_key );
 
     MP4_Box_t *p_mehd = MP4_BoxGet( p_sys->p_moov, "mvex/mehd");
     if ( !p_mehd )
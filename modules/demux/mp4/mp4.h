@@ -40,24 +40,15 @@ typedef struct
     uint32_t     i_sample; /* index of the next sample to read in this chunk */
     uint32_t     i_virtual_run_number; /* chunks interleaving sequence */
 
-    /* now provide way to calculate pts, dts, and offset without too
-        much memory and with fast access */
-
-    /* with this we can calculate dts/pts without waste memory */
+    /* dts and pts are decoded on demand from the run-length encoded stts
+       and ctts tables, starting at the entry covering the first sample */
     uint64_t     i_first_dts;   /* DTS of the first sample */
     uint64_t     i_duration;    /* total duration of all samples */
 
-    uint32_t     i_entries_dts;
-    uint32_t     *p_sample_count_dts;
-    uint32_t     *p_sample_delta_dts;   /* dts delta */
-
-    uint32_t     i_entries_pts;
-    uint32_t     *p_sample_count_pts;
-    int32_t      *p_sample_offset_pts;  /* pts-dts */
-
-    uint32_t     *p_sample_size;
-    /* TODO if needed add pts
-        but quickly *add* support for edts and seeking */
+    uint32_t     i_index_dts;   /* stts entry of the first sample */
+    uint32_t     i_skip_dts;    /* samples of that entry in previous chunks */
+    uint32_t     i_index_pts;   /* same for ctts */
+    uint32_t     i_skip_pts;
 
 } mp4_chunk_t;
 
@@ -120,8 +111,12 @@ typedef struct
     /* sample size, p_sample_size defined only if i_sample_size == 0
         else i_sample_size is size for all sample */
     uint32_t         i_sample_size;
-    uint32_t         *p_sample_size; /* XXX perhaps add file offset if take
-//                                    too much time to do sumations each time*/
+    const uint32_t   *p_sample_size; /* points to the stsz table */
+
+    /* timing tables, referenced by the chunks */
+    const MP4_Box_data_stts_t *p_stts;
+    const MP4_Box_data_ctts_t *p_ctts; /* could be NULL */
+    int64_t          i_cts_shift;
 
     uint32_t     i_sample_first; /* i_sample_first value
                                                    of the next chunk */
@@ -191,6 +191,7 @@ static void PCRFixHandle( demux_t *, ts_pmt_t *, block_t * );
 #define TS_PACKET_SIZE_204 204
 #define TS_PACKET_SIZE_MAX 204
 #define TS_HEADER_SIZE 4
+#define TS_SCAN_MAX_PACKETS 64
 
 static int DetectPacketSize( demux_t *p_demux, unsigned *pi_header_size, int i_offset )
 {
@@ -611,7 +612,10 @@ static int Demux( demux_t *p_demux )
         p_sys->patfix.status = PAT_FIXTRIED;
     }
 
-    /* We read at most 100 TS packet or until a frame is completed */
+    /* We read at most 100 TS packet or until a frame is completed.
+     * All PIDs, PES reassembly and PSI/SI parsing included, are processed
+     * in this thread: the table decoders set up programs and ES directly,
+     * and the es_out calls must not depend on thread scheduling. */
     for( unsigned i_pkt = 0; i_pkt < p_sys->i_ts_read; i_pkt++ )
     {
         bool         b_frame = false;
@@ -668,9 +672,12 @@ static int Demux( demux_t *p_demux )
         }
 
         /* Adaptation field cannot be scrambled */
-        mtime_t i_pcr = GetPCR( p_pkt );
-        if( i_pcr > VLC_TS_INVALID )
-            PCRHandle( p_demux, p_pid, i_pcr );
+        if( p_sys->scan.b_pcr )
+        {
+            mtime_t i_pcr = GetPCR( p_pkt );
+            if( i_pcr > VLC_TS_INVALID )
+                PCRHandle( p_demux, p_pid, i_pcr );
+        }
 
         /* Probe streams to build PAT/PMT after MIN_PAT_INTERVAL in case we don't see any PAT */
         if( !SEEN( GetPID( p_sys, 0 ) ) &&
@@ -1684,12 +1691,83 @@ static bool PushPESBlock( demux_t *p_demux, ts_pid_t *pid, block_t *p_pkt, bool
     return b_ret;
 }
 
+/* Checks the sync bytes of a run of packets at once, four at a time, and
+ * flags the packets whose adaptation field carries a PCR.
+ * Returns the number of consecutive synchronized packets. */
+static unsigned ScanTSPackets( const uint8_t *p_peek, size_t i_peek,
+                               unsigned i_packet_size, unsigned i_header,
+                               uint64_t *pi_pcr )
+{
+#define TS_HAS_PCR(p) ( ((p)[3] & 0x20) && (p)[4] >= 7 && ((p)[5] & 0x10) )
+    unsigned i_count = __MIN( i_peek / i_packet_size, TS_SCAN_MAX_PACKETS );
+    uint64_t i_pcr = 0;
+    unsigned i = 0;
+
+    p_peek += i_header;
+    for( ; i + 4 <= i_count; i += 4 )
+    {
+        const uint8_t *p0 = &p_peek[i * i_packet_size];
+        const uint8_t *p1 = p0 + i_packet_size;
+        const uint8_t *p2 = p1 + i_packet_size;
+        const uint8_t *p3 = p2 + i_packet_size;
+
+        if( ( (p0[0] ^ 0x47) | (p1[0] ^ 0x47) |
+              (p2[0] ^ 0x47) | (p3[0] ^ 0x47) ) != 0 )
+            break;
+
+        i_pcr |= ( (uint64_t) TS_HAS_PCR(p0) << i ) |
+                 ( (uint64_t) TS_HAS_PCR(p1) << (i + 1) ) |
+                 ( (uint64_t) TS_HAS_PCR(p2) << (i + 2) ) |
+                 ( (uint64_t) TS_HAS_PCR(p3) << (i + 3) );
+    }
+    for( ; i < i_count; i++ )
+    {
+        const uint8_t *p = &p_peek[i * i_packet_size];
+        if( p[0] != 0x47 )
+            break;
+        i_pcr |= (uint64_t) TS_HAS_PCR(p) << i;
+    }
+#undef TS_HAS_PCR
+
+    *pi_pcr = i_pcr;
+    return i;
+}
+
 static block_t* ReadTSPacket( demux_t *p_demux )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
 
     block_t     *p_pkt;
 
+    /* Validate packets by runs, so that the per packet path does not need
+     * to look at sync byte nor at adaptation field for PCR */
+    uint64_t i_pos = vlc_stream_Tell( p_sys->stream );
+    if( p_sys->scan.i_left == 0 || p_sys->scan.i_next != i_pos ||
+        p_sys->scan.p_stream != p_sys->stream )
+    {
+        const uint8_t *p_peek;
+        ssize_t i_peek = vlc_stream_Peek( p_sys->stream, &p_peek,
+                                          p_sys->i_packet_size * TS_SCAN_MAX_PACKETS );
+        p_sys->scan.p_stream = p_sys->stream;
+        p_sys->scan.i_next = i_pos;
+        p_sys->scan.i_left = ( i_peek > 0 ) ?
+            ScanTSPackets( p_peek, i_peek, p_sys->i_packet_size,
+                           p_sys->i_packet_header_size, &p_sys->scan.i_pcr ) : 0;
+    }
+
+    if( p_sys->scan.i_left > 0 )
+    {
+        p_sys->scan.b_pcr = p_sys->scan.i_pcr & 1;
+        p_sys->scan.i_pcr >>= 1;
+        p_sys->scan.i_left--;
+        p_sys->scan.i_next += p_sys->i_packet_size;
+    }
+    else
+    {
+        /* unscanned (partial, or out of sync) packet */
+        p_sys->scan.b_pcr = true;
+    }
+
     /* Get a new TS packet */
     if( !( p_pkt = vlc_stream_Block( p_sys->stream, p_sys->i_packet_size ) ) )
     {
@@ -1719,6 +1797,7 @@ static block_t* ReadTSPacket( demux_t *p_demux )
     {
         msg_Warn( p_demux, "lost synchro" );
         block_Release( p_pkt );
+        p_sys->scan.i_left = 0;
         for( ;; )
         {
             const uint8_t *p_peek;
@@ -1733,20 +1812,27 @@ static block_t* ReadTSPacket( demux_t *p_demux )
                 return NULL;
             }
 
-            while( i_skip < i_peek - p_sys->i_packet_size )
+            const unsigned i_end = i_peek - p_sys->i_packet_size;
+            while( i_skip < i_end )
             {
-                if( p_peek[i_skip + p_sys->i_packet_header_size] == 0x47 &&
-                        p_peek[i_skip + p_sys->i_packet_header_size + p_sys->i_packet_size] == 0x47 )
+                /* let memchr do the wide search for candidates */
+                const uint8_t *p_sync = memchr( &p_peek[i_skip + p_sys->i_packet_header_size],
+                                                0x47, i_end - i_skip );
+                if( p_sync == NULL )
                 {
+                    i_skip = i_end;
                     break;
                 }
+                i_skip = p_sync - p_peek - p_sys->i_packet_header_size;
+                if( p_peek[i_skip + p_sys->i_packet_header_size + p_sys->i_packet_size] == 0x47 )
+                    break;
                 i_skip++;
             }
             msg_Dbg( p_demux, "skipping %d bytes of garbage", i_skip );
             if (vlc_stream_Read( p_sys->stream, NULL, i_skip ) != i_skip)
                 return NULL;
 
-            if( i_skip < i_peek - p_sys->i_packet_size )
+            if( i_skip < i_end )
             {
                 break;
             }
@@ -60,6 +60,16 @@ struct demux_sys_t
     /* how many TS packet we read at once */
     unsigned    i_ts_read;
 
+    /* run of packets already checked by the batch scanner */
+    struct
+    {
+        stream_t *p_stream;
+        uint64_t  i_next;   /* stream offset of the next scanned packet */
+        unsigned  i_left;   /* scanned packets not yet read */
+        uint64_t  i_pcr;    /* bit n set if packet n of the run has a PCR */
+        bool      b_pcr;    /* last returned packet may carry a PCR */
+    } scan;
+
     bool        b_ignore_time_for_positions;
 
     ts_standards_e standard;
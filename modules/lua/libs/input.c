@@ -208,6 +208,9 @@ static int vlclua_input_item_stats( lua_State *L )
         STATS_FLOAT( average_demux_bitrate )
         STATS_INT( demux_corrupted )
         STATS_INT( demux_discontinuity )
+        STATS_INT( prefetch_hits )
+        STATS_INT( prefetch_stalls )
+        STATS_INT( prefetch_wasted_bytes )
         STATS_INT( decoded_audio )
         STATS_INT( decoded_video )
         STATS_INT( displayed_pictures )
@@ -47,8 +47,20 @@ typedef struct vlc_tls_gnutls
     vlc_tls_t tls;
     gnutls_session_t session;
     vlc_object_t *obj;
+    char *host; /**< Authenticated server name (client only) */
 } vlc_tls_gnutls_t;
 
+/**
+ * Client-side TLS credentials private data
+ */
+typedef struct vlc_tls_gnutls_client
+{
+    gnutls_certificate_credentials_t x509_cred;
+    vlc_mutex_t lock;
+    char *session_host; /**< Server name of the resumable session */
+    gnutls_datum_t session_data; /**< Session resumption parameters */
+} vlc_tls_gnutls_client_t;
+
 static int gnutls_Init (vlc_object_t *obj)
 {
     const char *version = gnutls_check_version ("3.3.0");
@@ -209,10 +221,42 @@ static int gnutls_Shutdown(vlc_tls_t *tls, bool duplex)
     return 0;
 }
 
+/**
+ * Remembers the session parameters, so that the next connection to the same
+ * server can resume it and skip the full handshake.
+ */
+static void gnutls_SaveSession(vlc_tls_creds_t *crd, vlc_tls_gnutls_t *priv)
+{
+    vlc_tls_gnutls_client_t *sys = crd->sys;
+    gnutls_datum_t data;
+
+    if (gnutls_session_get_data2(priv->session, &data) != 0)
+        return;
+
+    char *host = strdup(priv->host);
+
+    vlc_mutex_lock(&sys->lock);
+    free(sys->session_host);
+    gnutls_free(sys->session_data.data);
+    sys->session_host = host;
+    sys->session_data.data = NULL;
+    sys->session_data.size = 0;
+    if (likely(host != NULL))
+        sys->session_data = data;
+    else
+        gnutls_free(data.data);
+    vlc_mutex_unlock(&sys->lock);
+}
+
 static void gnutls_Close (vlc_tls_t *tls)
 {
     vlc_tls_gnutls_t *priv = (vlc_tls_gnutls_t *)tls;
 
+    if (priv->host != NULL)
+    {   /* TLS 1.3 tickets are only received after the handshake */
+        gnutls_SaveSession((vlc_tls_creds_t *)priv->obj, priv);
+        free(priv->host);
+    }
     gnutls_deinit(priv->session);
     free(priv);
 }
@@ -295,6 +339,7 @@ static vlc_tls_gnutls_t *gnutls_SessionOpen(vlc_tls_creds_t *creds, int type,
 
     priv->session = session;
     priv->obj = VLC_OBJECT(creds);
+    priv->host = NULL;
 
     vlc_tls_t *tls = &priv->tls;
 
@@ -391,9 +436,10 @@ static vlc_tls_t *gnutls_ClientSessionOpen(vlc_tls_creds_t *crd,
                                            vlc_tls_t *sk, const char *hostname,
                                            const char *const *alpn)
 {
+    vlc_tls_gnutls_client_t *sys = crd->sys;
     vlc_tls_gnutls_t *priv;
 
-    priv = gnutls_SessionOpen(crd, GNUTLS_CLIENT, crd->sys, sk, alpn);
+    priv = gnutls_SessionOpen(crd, GNUTLS_CLIENT, sys->x509_cred, sk, alpn);
     if (priv == NULL)
         return NULL;
 
@@ -403,10 +449,19 @@ static vlc_tls_t *gnutls_ClientSessionOpen(vlc_tls_creds_t *crd,
     gnutls_dh_set_prime_bits (session, 1024);
 
     if (likely(hostname != NULL))
+    {
         /* fill Server Name Indication */
         gnutls_server_name_set (session, GNUTLS_NAME_DNS,
                                 hostname, strlen (hostname));
 
+        /* resume the last session with the same server, if any */
+        vlc_mutex_lock(&sys->lock);
+        if (sys->session_host != NULL && !strcmp(sys->session_host, hostname))
+            gnutls_session_set_data(session, sys->session_data.data,
+                                    sys->session_data.size);
+        vlc_mutex_unlock(&sys->lock);
+    }
+
     return &priv->tls;
 }
 
@@ -424,6 +479,9 @@ static int gnutls_ClientHandshake(vlc_tls_creds_t *creds, vlc_tls_t *tls,
     gnutls_session_t session = priv->session;
     unsigned status;
 
+    if (gnutls_session_is_resumed(session))
+        msg_Dbg(creds, " - resumed session");
+
     val = gnutls_certificate_verify_peers3 (session, host, &status);
     if (val)
     {
@@ -433,7 +491,17 @@ static int gnutls_ClientHandshake(vlc_tls_creds_t *creds, vlc_tls_t *tls,
     }
 
     if (status == 0) /* Good certificate */
+    {
+        /* Only sessions with trusted servers are resumed */
+        priv->host = (host != NULL) ? strdup(host) : NULL;
+        if (priv->host != NULL
+#if (GNUTLS_VERSION_NUMBER >= 0x030600)
+         && gnutls_protocol_get_version(session) != GNUTLS_TLS1_3
+#endif
+           )
+            gnutls_SaveSession(creds, priv);
         return 0;
+    }
 
     /* Bad certificate */
     gnutls_datum_t desc;
@@ -553,11 +621,16 @@ static int OpenClient (vlc_tls_creds_t *crd)
     if (gnutls_Init (VLC_OBJECT(crd)))
         return VLC_EGENERIC;
 
+    vlc_tls_gnutls_client_t *sys = malloc (sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return VLC_ENOMEM;
+
     int val = gnutls_certificate_allocate_credentials (&x509);
     if (val != 0)
     {
         msg_Err (crd, "cannot allocate credentials: %s",
                  gnutls_strerror (val));
+        free (sys);
         return VLC_EGENERIC;
     }
 
@@ -587,7 +660,13 @@ static int OpenClient (vlc_tls_creds_t *crd)
     gnutls_certificate_set_verify_flags (x509,
                                          GNUTLS_VERIFY_ALLOW_X509_V1_CA_CRT);
 
-    crd->sys = x509;
+    sys->x509_cred = x509;
+    vlc_mutex_init (&sys->lock);
+    sys->session_host = NULL;
+    sys->session_data.data = NULL;
+    sys->session_data.size = 0;
+
+    crd->sys = sys;
     crd->open = gnutls_ClientSessionOpen;
     crd->handshake = gnutls_ClientHandshake;
 
@@ -596,9 +675,13 @@ static int OpenClient (vlc_tls_creds_t *crd)
 
 static void CloseClient (vlc_tls_creds_t *crd)
 {
-    gnutls_certificate_credentials_t x509 = crd->sys;
+    vlc_tls_gnutls_client_t *sys = crd->sys;
 
-    gnutls_certificate_free_credentials (x509);
+    gnutls_free (sys->session_data.data);
+    free (sys->session_host);
+    vlc_mutex_destroy (&sys->lock);
+    gnutls_certificate_free_credentials (sys->x509_cred);
+    free (sys);
 }
 
 #ifdef ENABLE_SOUT
@@ -34,6 +34,7 @@
 #include <vlc_stream.h>
 #include <vlc_fs.h>
 #include <vlc_interrupt.h>
+#include <vlc_input.h>
 
 struct stream_sys_t
 {
@@ -61,6 +62,28 @@ struct stream_sys_t
     char        *buffer;
     size_t       read_size;
     size_t       seek_threshold;
+
+    /* Amount of unread data to keep ahead, adapted within
+     * [read_size, buffer_size] from the bandwidth model */
+    size_t       window;
+
+    /* Bandwidth model, over the current measurement period */
+    mtime_t      period_start;
+    uint64_t     consumed;     /* Bytes read downstream */
+    uint64_t     fetched;      /* Bytes read upstream */
+    mtime_t      fetch_time;   /* Time spent reading upstream */
+    unsigned     seeks;        /* Seeks outside of the buffer */
+    unsigned     stalls;
+    double       consume_rate; /* Smoothed rates (bytes per second) */
+    double       source_rate;
+
+    /* Statistics not yet reported to the input item */
+    struct
+    {
+        uint64_t hits;
+        uint64_t stalls;
+        uint64_t wasted;
+    } stats;
 };
 
 static ssize_t ThreadRead(stream_t *stream, void *buf, size_t length)
@@ -71,9 +94,16 @@ static ssize_t ThreadRead(stream_t *stream, void *buf, size_t length)
     vlc_mutex_unlock(&sys->lock);
     assert(length > 0);
 
+    mtime_t start = mdate();
     ssize_t val = vlc_stream_ReadPartial(stream->p_source, buf, length);
+    mtime_t duration = mdate() - start;
 
     vlc_mutex_lock(&sys->lock);
+    if (val > 0)
+    {
+        sys->fetched += val;
+        sys->fetch_time += duration;
+    }
     vlc_restorecancel(canc);
     return val;
 }
@@ -174,6 +204,17 @@ static void *Thread(void *data)
          * ("historical") data. The data can be used if/when seeking backward.
          * Unread data is however given precedence if the buffer is full. */
         uint64_t history = stream_offset - sys->buffer_offset;
+        size_t unread = (history < sys->buffer_length)
+                      ? sys->buffer_length - history : 0;
+
+        /* Only read ahead as much as the bandwidth model asks for, and
+         * do not bother upstream for less than a quarter of a read. */
+        if (unread >= sys->window
+         || (unread > 0 && sys->window - unread < sys->read_size / 4))
+        {
+            vlc_cond_wait(&sys->wait_space, &sys->lock);
+            continue;
+        }
 
         /* If upstream supports seeking and if the downstream offset is far
          * beyond the upstream offset, then attempt to skip forward.
@@ -229,6 +270,8 @@ static void *Thread(void *data)
              * blocking for too long. */
             if (len > sys->read_size)
                 len = sys->read_size;
+            if (len > sys->window - unread)
+                len = sys->window - unread;
         }
 
         size_t offset = (sys->buffer_offset + sys->buffer_length)
@@ -264,6 +307,15 @@ static int Seek(stream_t *stream, uint64_t offset)
     stream_sys_t *sys = stream->p_sys;
 
     vlc_mutex_lock(&sys->lock);
+    if (offset < sys->buffer_offset
+     || offset > sys->buffer_offset + sys->buffer_length)
+    {   /* Whatever was prefetched past the read position is lost */
+        if (sys->stream_offset >= sys->buffer_offset
+         && sys->stream_offset < sys->buffer_offset + sys->buffer_length)
+            sys->stats.wasted += sys->buffer_offset + sys->buffer_length
+                               - sys->stream_offset;
+        sys->seeks++;
+    }
     sys->stream_offset = offset;
     sys->error = false;
     vlc_cond_signal(&sys->wait_space);
@@ -287,11 +339,102 @@ static size_t BufferLevel(const stream_t *stream, bool *eof)
     return sys->buffer_offset + sys->buffer_length - sys->stream_offset;
 }
 
+static void ReportStats(stream_t *stream)
+{
+    stream_sys_t *sys = stream->p_sys;
+    input_thread_t *input = stream->p_input;
+
+    if (input == NULL)
+        return;
+
+    input_stats_t *stats = input_GetItem(input)->p_stats;
+    if (stats != NULL)
+    {
+        vlc_mutex_lock(&stats->lock);
+        stats->i_prefetch_hits += sys->stats.hits;
+        stats->i_prefetch_stalls += sys->stats.stalls;
+        stats->i_prefetch_wasted_bytes += sys->stats.wasted;
+        vlc_mutex_unlock(&stats->lock);
+    }
+    sys->stats.hits = sys->stats.stalls = sys->stats.wasted = 0;
+}
+
+#define MODEL_PERIOD CLOCK_FREQ
+
+static void ResetPeriod(stream_sys_t *sys, mtime_t now)
+{
+    sys->period_start = now;
+    sys->consumed = sys->fetched = 0;
+    sys->fetch_time = 0;
+    sys->seeks = sys->stalls = 0;
+}
+
+/**
+ * Adapts the read-ahead window once per period. The window covers a couple
+ * of seconds of consumption, more when the source is barely faster than the
+ * consumer. Stalls double it, repeated seeks (scrubbing) halve it.
+ */
+static void UpdateModel(stream_t *stream, mtime_t now)
+{
+    stream_sys_t *sys = stream->p_sys;
+    mtime_t period = now - sys->period_start;
+
+    if (period < MODEL_PERIOD)
+        return;
+
+    /* The period covers a pause (or the reader did not need any data):
+     * keep the last estimate rather than collapsing the window */
+    if (period > 4 * MODEL_PERIOD)
+    {
+        ResetPeriod(sys, now);
+        return;
+    }
+
+    double consume_rate = (double)sys->consumed * CLOCK_FREQ / period;
+    sys->consume_rate = (3. * sys->consume_rate + consume_rate) / 4.;
+    if (sys->fetch_time > 0)
+    {
+        double source_rate = (double)sys->fetched * CLOCK_FREQ
+                           / sys->fetch_time;
+        sys->source_rate = (sys->source_rate > 0.)
+            ? (3. * sys->source_rate + source_rate) / 4. : source_rate;
+    }
+
+    double window;
+    if (sys->seeks > 1)
+        window = sys->window / 2.;
+    else
+    {
+        double load = 1.;
+        if (sys->source_rate > 0.)
+            load = sys->consume_rate / sys->source_rate;
+        if (load > 1.)
+            load = 1.;
+
+        window = sys->consume_rate * (2. + 8. * load);
+        if (sys->stalls > 0 && window < 2. * sys->window)
+            window = 2. * sys->window;
+    }
+
+    if (window > sys->buffer_size)
+        window = sys->buffer_size;
+    if (window < sys->read_size)
+        window = sys->read_size;
+    if ((size_t)window != sys->window)
+    {
+        sys->window = window;
+        vlc_cond_signal(&sys->wait_space);
+    }
+
+    ResetPeriod(sys, now);
+    ReportStats(stream);
+}
+
 static ssize_t Read(stream_t *stream, void *buf, size_t buflen)
 {
     stream_sys_t *sys = stream->p_sys;
     size_t copy, offset;
-    bool eof;
+    bool eof, stalled = false;
 
     if (buflen == 0)
         return buflen;
@@ -301,6 +444,7 @@ static ssize_t Read(stream_t *stream, void *buf, size_t buflen)
     {
         msg_Err(stream, "reading while paused (buggy demux?)");
         sys->paused = false;
+        ResetPeriod(sys, mdate());
         vlc_cond_signal(&sys->wait_space);
     }
 
@@ -317,8 +461,17 @@ static ssize_t Read(stream_t *stream, void *buf, size_t buflen)
         vlc_interrupt_forward_start(sys->interrupt, data);
         vlc_cond_wait(&sys->wait_data, &sys->lock);
         vlc_interrupt_forward_stop(data);
+        stalled = true;
     }
 
+    if (stalled)
+    {
+        sys->stats.stalls++;
+        sys->stalls++;
+    }
+    else
+        sys->stats.hits++;
+
     offset = sys->stream_offset % sys->buffer_size;
     if (copy > buflen)
         copy = buflen;
@@ -328,6 +481,8 @@ static ssize_t Read(stream_t *stream, void *buf, size_t buflen)
 
     memcpy(buf, sys->buffer + offset, copy);
     sys->stream_offset += copy;
+    sys->consumed += copy;
+    UpdateModel(stream, mdate());
     vlc_cond_signal(&sys->wait_space);
     vlc_mutex_unlock(&sys->lock);
     return copy;
@@ -385,6 +540,9 @@ static int Control(stream_t *stream, int query, va_list args)
 
             vlc_mutex_lock(&sys->lock);
             sys->paused = paused;
+            /* Do not account the pause in the bandwidth model */
+            if (!paused)
+                ResetPeriod(sys, mdate());
             vlc_cond_signal(&sys->wait_space);
             vlc_mutex_unlock (&sys->lock);
             break;
@@ -464,6 +622,12 @@ static int Open(vlc_object_t *obj)
     if (sys->buffer_size < sys->read_size)
         sys->buffer_size = sys->read_size;
 
+    /* Start small and let the model grow the window if needed */
+    sys->window = __MAX(sys->buffer_size / 4, sys->read_size);
+    ResetPeriod(sys, mdate());
+    sys->consume_rate = sys->source_rate = 0.;
+    sys->stats.hits = sys->stats.stalls = sys->stats.wasted = 0;
+
     sys->buffer = malloc(sys->buffer_size);
     if (sys->buffer == NULL)
         goto error;
@@ -514,6 +678,7 @@ static void Close (vlc_object_t *obj)
     vlc_interrupt_kill(sys->interrupt);
     vlc_join(sys->thread, NULL);
     vlc_interrupt_destroy(sys->interrupt);
+    ReportStats(stream);
     vlc_cond_destroy(&sys->wait_space);
     vlc_cond_destroy(&sys->wait_data);
     vlc_mutex_destroy(&sys->lock);
@@ -532,7 +697,7 @@ vlc_module_begin()
     set_callbacks(Open, Close)
 
     add_integer("prefetch-buffer-size", 1 << 14, N_("Buffer size"),
-                N_("Prefetch buffer size (KiB)"), false)
+                N_("Maximum prefetch buffer size (KiB)"), false)
         change_integer_range(4, 1 << 20)
     add_integer("prefetch-read-size", 1 << 14, N_("Read size"),
                 N_("Prefetch background read size (bytes)"), true)
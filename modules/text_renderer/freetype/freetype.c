@@ -70,6 +70,7 @@
 #include "platform_fonts.h"
 #include "freetype.h"
 #include "text_layout.h"
+#include "text_cache.h"
 
 /*****************************************************************************
  * Module descriptor
@@ -125,6 +126,9 @@ static const char *const ppsz_sizes_text[] = {
 #define YUVP_TEXT N_("Use YUVP renderer")
 #define YUVP_LONGTEXT N_("This renders the font using \"paletized YUV\". " \
   "This option is only needed if you want to encode into DVB subtitles" )
+#define CACHE_TEXT N_("Glyph cache size")
+#define CACHE_LONGTEXT N_("Memory (in KiB) used to keep the rendered glyphs " \
+  "and the laid out lines from one subtitle to the next. 0 disables it." )
 
 static const int pi_color_values[] = {
   0x00000000, 0x00808080, 0x00C0C0C0, 0x00FFFFFF, 0x00800000,
@@ -233,6 +237,9 @@ vlc_module_begin ()
     add_bool( "freetype-yuvp", false, YUVP_TEXT,
               YUVP_LONGTEXT, true )
 
+    add_integer_with_range( "freetype-cache-size", 4096, 0, 1048576,
+                            CACHE_TEXT, CACHE_LONGTEXT, true )
+
 #ifdef HAVE_FRIBIDI
     add_integer_with_range( "freetype-text-direction", 0, 0, 2, TEXT_DIRECTION_TEXT,
                             TEXT_DIRECTION_LONGTEXT, false )
@@ -1074,6 +1081,24 @@ static uni_char_t* SegmentsToTextAndStyles( filter_t *p_filter, const text_segme
  * needed glyphs into memory. It is used as pf_add_string callback in
  * the vout method by this module
  */
+/* Names of the variables holding the glyph and paragraph cache statistics */
+static const char *const ppsz_cache_stats[] = {
+    "freetype-glyph-hits", "freetype-glyph-misses",
+    "freetype-paragraph-hits", "freetype-paragraph-misses",
+};
+
+static void PublishCacheStats( filter_t *p_filter )
+{
+    const filter_sys_t *p_sys = p_filter->p_sys;
+    const unsigned pi_values[] = {
+        p_sys->i_glyph_hits, p_sys->i_glyph_misses,
+        p_sys->i_paragraph_hits, p_sys->i_paragraph_misses,
+    };
+
+    for( size_t i = 0; i < ARRAY_SIZE(ppsz_cache_stats); i++ )
+        var_SetInteger( p_filter, ppsz_cache_stats[i], pi_values[i] );
+}
+
 static int Render( filter_t *p_filter, subpicture_region_t *p_region_out,
                          subpicture_region_t *p_region_in,
                          const vlc_fourcc_t *p_chroma_list )
@@ -1197,6 +1222,9 @@ static int Render( filter_t *p_filter, subpicture_region_t *p_region_out,
     FreeStylesArray( pp_styles, i_styles );
     free( pi_k_durations );
 
+    if( p_sys->p_cache )
+        PublishCacheStats( p_filter );
+
     return rv;
 }
 
@@ -1243,6 +1271,13 @@ static int Create( vlc_object_t *p_this )
 
     p_sys->i_scale = 100;
 
+    int64_t i_cache_size = var_InheritInteger( p_filter, "freetype-cache-size" );
+    if( i_cache_size > 0 )
+        p_sys->p_cache = TextCacheNew( i_cache_size * 1024 );
+    if( p_sys->p_cache )
+        for( size_t i = 0; i < ARRAY_SIZE(ppsz_cache_stats); i++ )
+            var_Create( p_filter, ppsz_cache_stats[i], VLC_VAR_INTEGER );
+
     /* default style to apply to uncomplete segmeents styles */
     p_sys->p_default_style = text_style_Create( STYLE_FULLY_SET );
     if(unlikely(!p_sys->p_default_style))
@@ -1361,6 +1396,18 @@ static void Destroy( vlc_object_t *p_this )
     DumpDictionary( p_filter, &p_sys->fallback_map, true, -1 );
 #endif
 
+    /* Glyph and paragraph cache, before the faces it refers to */
+    if( p_sys->p_cache )
+    {
+        msg_Dbg( p_filter, "glyph cache: %u hits, %u misses; "
+                 "paragraph cache: %u hits, %u misses",
+                 p_sys->i_glyph_hits, p_sys->i_glyph_misses,
+                 p_sys->i_paragraph_hits, p_sys->i_paragraph_misses );
+        for( size_t i = 0; i < ARRAY_SIZE(ppsz_cache_stats); i++ )
+            var_Destroy( p_filter, ppsz_cache_stats[i] );
+        TextCacheDelete( p_sys->p_cache );
+    }
+
     /* Text styles */
     text_style_Delete( p_sys->p_default_style );
     text_style_Delete( p_sys->p_forced_style );
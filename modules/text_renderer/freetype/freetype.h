@@ -73,6 +73,7 @@ typedef uint32_t uni_char_t;
  * It describes the freetype specific properties of an output thread.
  *****************************************************************************/
 typedef struct vlc_family_t vlc_family_t;
+typedef struct text_cache_t text_cache_t;
 struct filter_sys_t
 {
     FT_Library     p_library;       /* handle to library     */
@@ -116,6 +117,15 @@ struct filter_sys_t
     /* Current scaling of the text, default is 100 (%) */
     int               i_scale;
 
+    /** Rendered glyphs and laid out paragraphs, NULL if disabled */
+    text_cache_t     *p_cache;
+    /* Cache statistics, published as the freetype-*-hits and -misses
+     * integer variables of the filter after each rendering */
+    unsigned          i_glyph_hits;
+    unsigned          i_glyph_misses;
+    unsigned          i_paragraph_hits;
+    unsigned          i_paragraph_misses;
+
     /**
      * Select a font, based on the family, the styles and the codepoint
      */
@@ -0,0 +1,214 @@
+/*****************************************************************************
+ * text_cache.c : Cache of rendered glyphs and laid out text
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+
+#include "text_cache.h"
+
+typedef struct text_cache_entry_t text_cache_entry_t;
+struct text_cache_entry_t
+{
+    text_cache_entry_t *p_next;     /* next entry in the hash bucket */
+    text_cache_entry_t *p_older;    /* LRU list */
+    text_cache_entry_t *p_newer;
+
+    uint32_t            i_hash;
+    size_t              i_size;
+    void               *p_data;
+    void              (*pf_release)( void * );
+
+    size_t              i_key_size;
+    uint8_t             p_key[];
+};
+
+struct text_cache_t
+{
+    text_cache_entry_t **pp_buckets;
+    uint32_t             i_buckets_mask;
+
+    text_cache_entry_t  *p_oldest;
+    text_cache_entry_t  *p_newest;
+
+    size_t               i_size;
+    size_t               i_max_size;
+};
+
+/* About one bucket per KiB of cap keeps the chains short, even with
+ * small glyphs */
+#define TEXT_CACHE_MIN_BUCKETS 64
+#define TEXT_CACHE_MAX_BUCKETS 65536
+
+static uint32_t Hash( const void *p_key, size_t i_key_size )
+{
+    const uint8_t *p = p_key;
+    uint32_t i_hash = 2166136261u; /* FNV-1a */
+
+    for( size_t i = 0; i < i_key_size; i++ )
+        i_hash = ( i_hash ^ p[i] ) * 16777619u;
+    return i_hash;
+}
+
+text_cache_t *TextCacheNew( size_t i_max_size )
+{
+    text_cache_t *p_cache = malloc( sizeof( *p_cache ) );
+    if( !p_cache )
+        return NULL;
+
+    uint32_t i_buckets = TEXT_CACHE_MIN_BUCKETS;
+    while( i_buckets < TEXT_CACHE_MAX_BUCKETS && i_buckets < i_max_size / 1024 )
+        i_buckets <<= 1;
+
+    p_cache->pp_buckets = calloc( i_buckets, sizeof( *p_cache->pp_buckets ) );
+    if( !p_cache->pp_buckets )
+    {
+        free( p_cache );
+        return NULL;
+    }
+    p_cache->i_buckets_mask = i_buckets - 1;
+    p_cache->p_oldest = p_cache->p_newest = NULL;
+    p_cache->i_size = 0;
+    p_cache->i_max_size = i_max_size;
+    return p_cache;
+}
+
+static void Unlink( text_cache_t *p_cache, text_cache_entry_t *p_entry )
+{
+    if( p_entry->p_older )
+        p_entry->p_older->p_newer = p_entry->p_newer;
+    else
+        p_cache->p_oldest = p_entry->p_newer;
+    if( p_entry->p_newer )
+        p_entry->p_newer->p_older = p_entry->p_older;
+    else
+        p_cache->p_newest = p_entry->p_older;
+}
+
+static void LinkNewest( text_cache_t *p_cache, text_cache_entry_t *p_entry )
+{
+    p_entry->p_newer = NULL;
+    p_entry->p_older = p_cache->p_newest;
+    if( p_cache->p_newest )
+        p_cache->p_newest->p_newer = p_entry;
+    else
+        p_cache->p_oldest = p_entry;
+    p_cache->p_newest = p_entry;
+}
+
+static void Evict( text_cache_t *p_cache, text_cache_entry_t *p_entry )
+{
+    text_cache_entry_t **pp =
+        &p_cache->pp_buckets[p_entry->i_hash & p_cache->i_buckets_mask];
+    while( *pp != p_entry )
+        pp = &(*pp)->p_next;
+    *pp = p_entry->p_next;
+
+    Unlink( p_cache, p_entry );
+    p_cache->i_size -= p_entry->i_size;
+
+    p_entry->pf_release( p_entry->p_data );
+    free( p_entry );
+}
+
+void TextCacheDelete( text_cache_t *p_cache )
+{
+    while( p_cache->p_oldest )
+        Evict( p_cache, p_cache->p_oldest );
+    assert( p_cache->i_size == 0 );
+
+    free( p_cache->pp_buckets );
+    free( p_cache );
+}
+
+static text_cache_entry_t *Lookup( text_cache_t *p_cache, uint32_t i_hash,
+                                   const void *p_key, size_t i_key_size )
+{
+    text_cache_entry_t *p_entry =
+        p_cache->pp_buckets[i_hash & p_cache->i_buckets_mask];
+
+    for( ; p_entry; p_entry = p_entry->p_next )
+        if( p_entry->i_hash == i_hash && p_entry->i_key_size == i_key_size
+         && !memcmp( p_entry->p_key, p_key, i_key_size ) )
+            break;
+    return p_entry;
+}
+
+void *TextCacheGet( text_cache_t *p_cache,
+                    const void *p_key, size_t i_key_size )
+{
+    text_cache_entry_t *p_entry =
+        Lookup( p_cache, Hash( p_key, i_key_size ), p_key, i_key_size );
+    if( !p_entry )
+        return NULL;
+
+    if( p_entry != p_cache->p_newest )
+    {
+        Unlink( p_cache, p_entry );
+        LinkNewest( p_cache, p_entry );
+    }
+    return p_entry->p_data;
+}
+
+void TextCachePut( text_cache_t *p_cache,
+                   const void *p_key, size_t i_key_size,
+                   void *p_data, size_t i_size,
+                   void (*pf_release)( void * ) )
+{
+    const uint32_t i_hash = Hash( p_key, i_key_size );
+
+    i_size += sizeof( text_cache_entry_t ) + i_key_size;
+    if( i_size > p_cache->i_max_size
+     || Lookup( p_cache, i_hash, p_key, i_key_size ) )
+    {
+        pf_release( p_data );
+        return;
+    }
+
+    text_cache_entry_t *p_entry = malloc( sizeof( *p_entry ) + i_key_size );
+    if( !p_entry )
+    {
+        pf_release( p_data );
+        return;
+    }
+
+    while( p_cache->i_size + i_size > p_cache->i_max_size )
+        Evict( p_cache, p_cache->p_oldest );
+
+    p_entry->i_hash = i_hash;
+    p_entry->i_size = i_size;
+    p_entry->p_data = p_data;
+    p_entry->pf_release = pf_release;
+    p_entry->i_key_size = i_key_size;
+    memcpy( p_entry->p_key, p_key, i_key_size );
+
+    text_cache_entry_t **pp_bucket =
+        &p_cache->pp_buckets[i_hash & p_cache->i_buckets_mask];
+    p_entry->p_next = *pp_bucket;
+    *pp_bucket = p_entry;
+    LinkNewest( p_cache, p_entry );
+    p_cache->i_size += i_size;
+}
@@ -0,0 +1,73 @@
+/*****************************************************************************
+ * text_cache.h : Cache of rendered glyphs and laid out text
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef TEXT_CACHE_H
+#define TEXT_CACHE_H
+
+/** \ingroup freetype
+ * @{
+ * \file
+ * Least recently used cache with a memory cap
+ *
+ * Entries are opaque data identified by a binary key. When adding an entry
+ * would go over the memory cap, the least recently used entries are
+ * released first.
+ */
+
+typedef struct text_cache_t text_cache_t;
+
+/**
+ * Creates a cache holding at most \p i_max_size bytes of data
+ */
+text_cache_t *TextCacheNew( size_t i_max_size );
+
+/**
+ * Releases all the entries and the cache itself
+ */
+void TextCacheDelete( text_cache_t *p_cache );
+
+/**
+ * Looks up an entry and marks it as the most recently used one.
+ *
+ * The returned data belong to the cache and are only valid until the next
+ * call to TextCachePut().
+ *
+ * \return the data of the entry matching the key, or NULL
+ */
+void *TextCacheGet( text_cache_t *p_cache,
+                    const void *p_key, size_t i_key_size );
+
+/**
+ * Adds an entry, evicting the least recently used ones if needed.
+ *
+ * The cache takes ownership of \p p_data in any case, and calls
+ * \p pf_release on it when the entry is evicted or when it cannot be
+ * stored.
+ *
+ * \param i_size memory accounted for the data, in bytes
+ */
+void TextCachePut( text_cache_t *p_cache,
+                   const void *p_key, size_t i_key_size,
+                   void *p_data, size_t i_size,
+                   void (*pf_release)( void * ) );
+
+/** @} */
+
+#endif
@@ -42,6 +42,7 @@
 #include <vlc_common.h>
 #include <vlc_filter.h>
 #include <vlc_text_style.h>
+#include <vlc_memstream.h>
 
 /* Freetype */
 #include <ft2build.h>
@@ -64,6 +65,7 @@
 
 #include "freetype.h"
 #include "text_layout.h"
+#include "text_cache.h"
 #include "platform_fonts.h"
 
 /* Win32 */
@@ -115,6 +117,51 @@ typedef struct run_desc_t
 
 } run_desc_t;
 
+/**
+ * Kinds of entries stored in the text cache
+ */
+enum
+{
+    CACHE_GLYPH,            /**< Loaded glyph, outline and advance */
+    CACHE_GLYPH_BITMAP,     /**< Rendered glyph */
+    CACHE_OUTLINE_BITMAP,   /**< Rendered outline */
+    CACHE_PARAGRAPH,        /**< Laid out lines of a paragraph */
+};
+
+#define GLYPH_EMBOLDEN  0x1
+#define GLYPH_OBLIQUE   0x2
+
+/**
+ * Cache key of a glyph: the face at its current size, the glyph and the
+ * synthesized styles. Rendered bitmaps are also keyed by the subpixel
+ * part of their origin, 26.6 values
+ */
+typedef struct glyph_key_t
+{
+    int      i_type;
+    FT_Face  p_face;            /**< NULL if the glyph cannot be cached */
+    FT_Fixed i_x_scale;
+    FT_Fixed i_y_scale;
+    FT_UInt  i_glyph_index;
+    int      i_flags;
+    FT_Fixed i_radius;          /**< Outline stroker radius */
+    FT_Pos   i_x;
+    FT_Pos   i_y;
+} glyph_key_t;
+
+typedef struct cached_glyph_t
+{
+    FT_Glyph  p_glyph;
+    FT_Glyph  p_outline;
+    FT_Vector advance;
+} cached_glyph_t;
+
+typedef struct cached_paragraph_t
+{
+    line_desc_t *p_lines;
+    int         *pi_styles;     /**< Paragraph index of each character style */
+} cached_paragraph_t;
+
 /**
  * Glyph bitmaps. Advance and offset are 26.6 values
  */
@@ -130,6 +177,7 @@ typedef struct glyph_bitmaps_t
     int      i_y_offset;
     int      i_x_advance;
     int      i_y_advance;
+    glyph_key_t key;
 } glyph_bitmaps_t;
 
 typedef struct paragraph_t
@@ -240,6 +288,125 @@ static void BBoxEnlarge( FT_BBox *p_max, const FT_BBox *p )
     p_max->yMax = __MAX(p_max->yMax, p->yMax);
 }
 
+static size_t GlyphSize( FT_Glyph glyph )
+{
+    if( glyph->format == FT_GLYPH_FORMAT_BITMAP )
+    {
+        const FT_Bitmap *p_bitmap = &((FT_BitmapGlyph)glyph)->bitmap;
+        return sizeof( FT_BitmapGlyphRec )
+             + p_bitmap->rows * (size_t)abs( p_bitmap->pitch );
+    }
+    if( glyph->format == FT_GLYPH_FORMAT_OUTLINE )
+    {
+        const FT_Outline *p_outline = &((FT_OutlineGlyph)glyph)->outline;
+        return sizeof( FT_OutlineGlyphRec )
+             + p_outline->n_points * ( sizeof( FT_Vector ) + 1 )
+             + p_outline->n_contours * sizeof( short );
+    }
+    return sizeof( FT_GlyphRec );
+}
+
+static void ReleaseCachedGlyph( void *p_data )
+{
+    cached_glyph_t *p_cached = p_data;
+
+    FT_Done_Glyph( p_cached->p_glyph );
+    if( p_cached->p_outline )
+        FT_Done_Glyph( p_cached->p_outline );
+    free( p_cached );
+}
+
+static void ReleaseCachedBitmap( void *p_data )
+{
+    FT_Done_Glyph( p_data );
+}
+
+static void CacheGlyph( text_cache_t *p_cache, const glyph_key_t *p_key,
+                        const glyph_bitmaps_t *p_bitmaps,
+                        const FT_Vector *p_advance )
+{
+    cached_glyph_t *p_cached = malloc( sizeof( *p_cached ) );
+    if( !p_cached )
+        return;
+
+    p_cached->p_outline = NULL;
+    p_cached->advance = *p_advance;
+    if( FT_Glyph_Copy( p_bitmaps->p_glyph, &p_cached->p_glyph ) )
+    {
+        free( p_cached );
+        return;
+    }
+    size_t i_size = sizeof( *p_cached ) + GlyphSize( p_cached->p_glyph );
+
+    if( p_bitmaps->p_outline )
+    {
+        if( FT_Glyph_Copy( p_bitmaps->p_outline, &p_cached->p_outline ) )
+        {
+            ReleaseCachedGlyph( p_cached );
+            return;
+        }
+        i_size += GlyphSize( p_cached->p_outline );
+    }
+
+    TextCachePut( p_cache, p_key, sizeof( *p_key ), p_cached, i_size,
+                  ReleaseCachedGlyph );
+}
+
+/**
+ * Converts a glyph to a bitmap at the pen position, like
+ * FT_Glyph_To_Bitmap(). The cached bitmaps are rendered at the subpixel
+ * part of the position only, then moved by whole pixels, which gives the
+ * same result.
+ */
+static FT_Error RenderGlyph( filter_t *p_filter, const glyph_key_t *p_glyph_key,
+                             int i_type, FT_Glyph *pp_glyph,
+                             FT_Vector *p_pen, bool b_destroy )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+
+    if( !p_sys->p_cache || !p_glyph_key->p_face )
+        return FT_Glyph_To_Bitmap( pp_glyph, FT_RENDER_MODE_NORMAL,
+                                   p_pen, b_destroy );
+
+    glyph_key_t key;
+    memcpy( &key, p_glyph_key, sizeof( key ) );
+    key.i_type = i_type;
+    key.i_x = p_pen->x & 63;
+    key.i_y = p_pen->y & 63;
+
+    FT_Glyph p_bitmap;
+    FT_Glyph p_cached = TextCacheGet( p_sys->p_cache, &key, sizeof( key ) );
+    if( p_cached )
+    {
+        p_sys->i_glyph_hits++;
+        FT_Error error = FT_Glyph_Copy( p_cached, &p_bitmap );
+        if( error )
+            return error;
+    }
+    else
+    {
+        p_sys->i_glyph_misses++;
+        FT_Vector origin = { .x = key.i_x, .y = key.i_y };
+        p_bitmap = *pp_glyph;
+        FT_Error error = FT_Glyph_To_Bitmap( &p_bitmap, FT_RENDER_MODE_NORMAL,
+                                             &origin, 0 );
+        if( error )
+            return error;
+        if( !FT_Glyph_Copy( p_bitmap, &p_cached ) )
+            TextCachePut( p_sys->p_cache, &key, sizeof( key ), p_cached,
+                          GlyphSize( p_cached ), ReleaseCachedBitmap );
+    }
+
+    FT_BitmapGlyph p_bitmap_glyph = (FT_BitmapGlyph)p_bitmap;
+    p_bitmap_glyph->left += FT_FLOOR( p_pen->x );
+    p_bitmap_glyph->top  += FT_FLOOR( p_pen->y );
+
+    if( b_destroy )
+        FT_Done_Glyph( *pp_glyph );
+    *pp_glyph = p_bitmap;
+    return 0;
+}
+
 static paragraph_t *NewParagraph( filter_t *p_filter,
                                   int i_size,
                                   const uni_char_t *p_code_points,
@@ -955,18 +1122,27 @@ static int LoadGlyphs( filter_t *p_filter, paragraph_t *p_paragraph,
         else
             p_face = p_run->p_face;
 
+        int i_radius = -1; /* no outline */
         if( p_sys->p_stroker && (p_style->i_style_flags & STYLE_OUTLINE) )
         {
             double f_outline_thickness =
                 var_InheritInteger( p_filter, "freetype-outline-thickness" ) / 100.0;
             f_outline_thickness = VLC_CLIP( f_outline_thickness, 0.0, 0.5 );
-            int i_radius = ( i_live_size << 6 ) * f_outline_thickness;
+            i_radius = ( i_live_size << 6 ) * f_outline_thickness;
             FT_Stroker_Set( p_sys->p_stroker,
                             i_radius,
                             FT_STROKER_LINECAP_ROUND,
                             FT_STROKER_LINEJOIN_ROUND, 0 );
         }
 
+        int i_flags = 0;
+        if( ( p_style->i_style_flags & STYLE_BOLD )
+              && !( p_face->style_flags & FT_STYLE_FLAG_BOLD ) )
+            i_flags |= GLYPH_EMBOLDEN;
+        if( ( p_style->i_style_flags & STYLE_ITALIC )
+              && !( p_face->style_flags & FT_STYLE_FLAG_ITALIC ) )
+            i_flags |= GLYPH_OBLIQUE;
+
         for( int j = p_run->i_start_offset; j < p_run->i_end_offset; ++j )
         {
             int i_glyph_index;
@@ -977,6 +1153,8 @@ static int LoadGlyphs( filter_t *p_filter, paragraph_t *p_paragraph,
                     FT_Get_Char_Index( p_face, p_paragraph->p_code_points[ j ] );
 
             glyph_bitmaps_t *p_bitmaps = p_paragraph->p_glyph_bitmaps + j;
+            glyph_key_t *p_key = &p_bitmaps->key;
+            memset( p_key, 0, sizeof( *p_key ) );
 
 #define SKIP_GLYPH( p_bitmaps ) \
     { \
@@ -1017,39 +1195,76 @@ static int LoadGlyphs( filter_t *p_filter, paragraph_t *p_paragraph,
                     SKIP_GLYPH( p_bitmaps )
             }
 
-            if( FT_Load_Glyph( p_face, i_glyph_index,
-                               FT_LOAD_NO_BITMAP | FT_LOAD_DEFAULT )
-             && FT_Load_Glyph( p_face, i_glyph_index, FT_LOAD_DEFAULT ) )
-                SKIP_GLYPH( p_bitmaps )
+            const cached_glyph_t *p_cached = NULL;
+            if( p_sys->p_cache )
+            {
+                p_key->i_type = CACHE_GLYPH;
+                p_key->p_face = p_face;
+                p_key->i_x_scale = p_face->size->metrics.x_scale;
+                p_key->i_y_scale = p_face->size->metrics.y_scale;
+                p_key->i_glyph_index = i_glyph_index;
+                p_key->i_flags = i_flags;
+                p_key->i_radius = i_radius;
+
+                p_cached = TextCacheGet( p_sys->p_cache, p_key, sizeof( *p_key ) );
+                if( p_cached )
+                    p_sys->i_glyph_hits++;
+                else
+                    p_sys->i_glyph_misses++;
+            }
+
+            FT_Vector advance;
+            if( p_cached )
+            {
+                /* Skips loading, synthesizing and stroking the glyph */
+                if( FT_Glyph_Copy( p_cached->p_glyph, &p_bitmaps->p_glyph ) )
+                    SKIP_GLYPH( p_bitmaps )
+                if( p_cached->p_outline
+                 && FT_Glyph_Copy( p_cached->p_outline, &p_bitmaps->p_outline ) )
+                    p_bitmaps->p_outline = 0;
+                advance = p_cached->advance;
+            }
+            else
+            {
+                if( FT_Load_Glyph( p_face, i_glyph_index,
+                                   FT_LOAD_NO_BITMAP | FT_LOAD_DEFAULT )
+                 && FT_Load_Glyph( p_face, i_glyph_index, FT_LOAD_DEFAULT ) )
+                    SKIP_GLYPH( p_bitmaps )
 
-            if( ( p_style->i_style_flags & STYLE_BOLD )
-                  && !( p_face->style_flags & FT_STYLE_FLAG_BOLD ) )
-                FT_GlyphSlot_Embolden( p_face->glyph );
-            if( ( p_style->i_style_flags & STYLE_ITALIC )
-                  && !( p_face->style_flags & FT_STYLE_FLAG_ITALIC ) )
-                FT_GlyphSlot_Oblique( p_face->glyph );
+                if( i_flags & GLYPH_EMBOLDEN )
+                    FT_GlyphSlot_Embolden( p_face->glyph );
+                if( i_flags & GLYPH_OBLIQUE )
+                    FT_GlyphSlot_Oblique( p_face->glyph );
 
-            if( FT_Get_Glyph( p_face->glyph, &p_bitmaps->p_glyph ) )
-                SKIP_GLYPH( p_bitmaps )
+                if( FT_Get_Glyph( p_face->glyph, &p_bitmaps->p_glyph ) )
+                    SKIP_GLYPH( p_bitmaps )
 
-#undef SKIP_GLYPH
+                if( i_radius >= 0 )
+                {
+                    p_bitmaps->p_outline = p_bitmaps->p_glyph;
+                    if( FT_Glyph_StrokeBorder( &p_bitmaps->p_outline,
+                                               p_sys->p_stroker, 0, 0 ) )
+                        p_bitmaps->p_outline = 0;
+                }
+                advance = p_face->glyph->advance;
 
-            if( p_filter->p_sys->p_stroker && (p_style->i_style_flags & STYLE_OUTLINE) )
-            {
-                p_bitmaps->p_outline = p_bitmaps->p_glyph;
-                if( FT_Glyph_StrokeBorder( &p_bitmaps->p_outline,
-                                           p_filter->p_sys->p_stroker, 0, 0 ) )
-                    p_bitmaps->p_outline = 0;
+                /* Embedded bitmaps cannot be moved by subpixels */
+                if( p_bitmaps->p_glyph->format != FT_GLYPH_FORMAT_OUTLINE )
+                    p_key->p_face = NULL;
+                else if( p_sys->p_cache )
+                    CacheGlyph( p_sys->p_cache, p_key, p_bitmaps, &advance );
             }
 
+#undef SKIP_GLYPH
+
             if( p_style->i_shadow_alpha != STYLE_ALPHA_TRANSPARENT )
                 p_bitmaps->p_shadow = p_bitmaps->p_outline ?
                                       p_bitmaps->p_outline : p_bitmaps->p_glyph;
 
             if( b_overwrite_advance )
             {
-                p_bitmaps->i_x_advance = p_face->glyph->advance.x;
-                p_bitmaps->i_y_advance = p_face->glyph->advance.y;
+                p_bitmaps->i_x_advance = advance.x;
+                p_bitmaps->i_y_advance = advance.y;
             }
         }
 
@@ -1152,8 +1367,10 @@ static int LayoutLine( filter_t *p_filter,
 
         if( p_bitmaps->p_shadow )
         {
-            if( FT_Glyph_To_Bitmap( &p_bitmaps->p_shadow, FT_RENDER_MODE_NORMAL,
-                                    &pen_shadow, 0 ) )
+            if( RenderGlyph( p_filter, &p_bitmaps->key,
+                             p_bitmaps->p_shadow == p_bitmaps->p_outline ?
+                             CACHE_OUTLINE_BITMAP : CACHE_GLYPH_BITMAP,
+                             &p_bitmaps->p_shadow, &pen_shadow, false ) )
                 p_bitmaps->p_shadow = 0;
             else
                 FT_Glyph_Get_CBox( p_bitmaps->p_shadow, ft_glyph_bbox_pixels,
@@ -1161,8 +1378,8 @@ static int LayoutLine( filter_t *p_filter,
         }
         if( p_bitmaps->p_glyph )
         {
-            if( FT_Glyph_To_Bitmap( &p_bitmaps->p_glyph, FT_RENDER_MODE_NORMAL,
-                                    &pen_new, 1 ) )
+            if( RenderGlyph( p_filter, &p_bitmaps->key, CACHE_GLYPH_BITMAP,
+                             &p_bitmaps->p_glyph, &pen_new, true ) )
             {
                 FT_Done_Glyph( p_bitmaps->p_glyph );
                 if( p_bitmaps->p_outline )
@@ -1178,8 +1395,8 @@ static int LayoutLine( filter_t *p_filter,
         }
         if( p_bitmaps->p_outline )
         {
-            if( FT_Glyph_To_Bitmap( &p_bitmaps->p_outline, FT_RENDER_MODE_NORMAL,
-                                    &pen_new, 1 ) )
+            if( RenderGlyph( p_filter, &p_bitmaps->key, CACHE_OUTLINE_BITMAP,
+                             &p_bitmaps->p_outline, &pen_new, true ) )
             {
                 FT_Done_Glyph( p_bitmaps->p_outline );
                 p_bitmaps->p_outline = 0;
@@ -1484,6 +1701,346 @@ error:
     return VLC_EGENERIC;
 }
 
+static int ShapeAndLayoutParagraph( filter_t *p_filter,
+                                    const uni_char_t *p_text,
+                                    text_style_t **pp_styles,
+                                    uint32_t *pi_k_dates, int i_size,
+                                    bool b_grid, bool b_balance,
+                                    unsigned i_max_width,
+                                    line_desc_t **pp_lines )
+{
+    unsigned i_max_advance_x = 0;
+
+    paragraph_t *p_paragraph = NewParagraph( p_filter, i_size, p_text,
+                                             pp_styles, pi_k_dates, 20 );
+    if( !p_paragraph )
+        return VLC_ENOMEM;
+
+#ifdef HAVE_FRIBIDI
+    if( AnalyzeParagraph( p_paragraph ) )
+        goto error;
+#endif
+
+    if( ItemizeParagraph( p_filter, p_paragraph ) )
+        goto error;
+
+#if defined HAVE_HARFBUZZ
+    if( ShapeParagraphHarfBuzz( p_filter, &p_paragraph ) )
+        goto error;
+
+    if( LoadGlyphs( p_filter, p_paragraph, true, false, &i_max_advance_x ) )
+        goto error;
+
+#elif defined HAVE_FRIBIDI
+    if( ShapeParagraphFriBidi( p_filter, p_paragraph ) )
+        goto error;
+    if( LoadGlyphs( p_filter, p_paragraph, false, true, &i_max_advance_x ) )
+        goto error;
+    if( RemoveZeroWidthCharacters( p_paragraph ) )
+        goto error;
+    if( ZeroNsmAdvance( p_paragraph ) )
+        goto error;
+#else
+    if( LoadGlyphs( p_filter, p_paragraph, false, true, &i_max_advance_x ) )
+        goto error;
+#endif
+
+    if( LayoutParagraph( p_filter, p_paragraph,
+                         i_max_width, i_max_advance_x, pp_lines,
+                         b_grid, b_balance ) )
+        goto error;
+
+    FreeParagraph( p_paragraph );
+    return VLC_SUCCESS;
+
+error:
+    FreeParagraph( p_paragraph );
+    return VLC_EGENERIC;
+}
+
+/**
+ * Copies the lines along with their glyphs
+ */
+static int CopyLines( const line_desc_t *p_src, line_desc_t **pp_lines )
+{
+    line_desc_t *p_first_line = NULL;
+    line_desc_t **pp_line = &p_first_line;
+
+    for( ; p_src; p_src = p_src->p_next )
+    {
+        line_desc_t *p_line = NewLine( __MAX( p_src->i_character_count, 1 ) );
+        if( !p_line )
+            goto error;
+
+        line_character_t *p_characters = p_line->p_character;
+        *p_line = *p_src;
+        p_line->p_next = NULL;
+        p_line->p_character = p_characters;
+        p_line->i_character_count = 0;
+        *pp_line = p_line;
+        pp_line = &p_line->p_next;
+
+        for( int i = 0; i < p_src->i_character_count; i++ )
+        {
+            const line_character_t *p_src_ch = &p_src->p_character[i];
+            line_character_t *p_ch = &p_line->p_character[i];
+            FT_Glyph p_glyph;
+
+            *p_ch = *p_src_ch;
+            p_ch->p_outline = NULL;
+            p_ch->p_shadow = NULL;
+
+            if( FT_Glyph_Copy( (FT_Glyph)p_src_ch->p_glyph, &p_glyph ) )
+                goto error;
+            p_ch->p_glyph = (FT_BitmapGlyph)p_glyph;
+            p_line->i_character_count++;
+
+            if( p_src_ch->p_outline )
+            {
+                if( FT_Glyph_Copy( (FT_Glyph)p_src_ch->p_outline, &p_glyph ) )
+                    goto error;
+                p_ch->p_outline = (FT_BitmapGlyph)p_glyph;
+            }
+            if( p_src_ch->p_shadow )
+            {
+                if( FT_Glyph_Copy( (FT_Glyph)p_src_ch->p_shadow, &p_glyph ) )
+                    goto error;
+                p_ch->p_shadow = (FT_BitmapGlyph)p_glyph;
+            }
+        }
+    }
+
+    *pp_lines = p_first_line;
+    return VLC_SUCCESS;
+
+error:
+    FreeLines( p_first_line );
+    return VLC_ENOMEM;
+}
+
+static void ReleaseCachedParagraph( void *p_data )
+{
+    cached_paragraph_t *p_cached = p_data;
+
+    FreeLines( p_cached->p_lines );
+    free( p_cached->pi_styles );
+    free( p_cached );
+}
+
+/**
+ * Writes the style properties used for the layout. The lines taken from
+ * the cache use the styles of the rendered text for everything else.
+ */
+static void WriteStyleKey( struct vlc_memstream *p_stream,
+                           const text_style_t *p_style )
+{
+    const char *const ppsz_names[] = {
+        p_style->psz_fontname, p_style->psz_monofontname
+    };
+    for( size_t i = 0; i < ARRAY_SIZE( ppsz_names ); i++ )
+    {
+        if( ppsz_names[i] )
+            vlc_memstream_write( p_stream, ppsz_names[i],
+                                 strlen( ppsz_names[i] ) + 1 );
+        else
+            vlc_memstream_putc( p_stream, 0xFF ); /* not valid UTF-8 */
+    }
+
+    struct
+    {
+        float    f_font_relsize;
+        int      i_font_size;
+        int      i_wrapinfo;
+        uint16_t i_style_flags;
+        bool     b_shadow;
+    } properties;
+    memset( &properties, 0, sizeof( properties ) );
+    properties.f_font_relsize = p_style->f_font_relsize;
+    properties.i_font_size = p_style->i_font_size;
+    properties.i_wrapinfo = p_style->e_wrapinfo;
+    properties.i_style_flags = p_style->i_style_flags;
+    properties.b_shadow = p_style->i_shadow_alpha != STYLE_ALPHA_TRANSPARENT;
+    vlc_memstream_write( p_stream, &properties, sizeof( properties ) );
+}
+
+/**
+ * Builds the cache key of a paragraph: its text, the styles of each
+ * segment, and the parameters of the layout
+ */
+static char *ParagraphKey( filter_t *p_filter, const uni_char_t *p_text,
+                           text_style_t **pp_styles, int i_size,
+                           bool b_grid, bool b_balance, unsigned i_max_width,
+                           size_t *pi_key_size )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    struct vlc_memstream stream;
+
+    if( vlc_memstream_open( &stream ) )
+        return NULL;
+
+    struct
+    {
+        int      i_type;
+        int      i_size;
+        unsigned i_max_width;
+        unsigned i_height;
+        int      i_scale;
+        int      i_outline_thickness;
+        int      i_text_direction;
+        bool     b_grid;
+        bool     b_balance;
+        FT_Face  p_default_face;
+    } header;
+    memset( &header, 0, sizeof( header ) );
+    header.i_type = CACHE_PARAGRAPH;
+    header.i_size = i_size;
+    header.i_max_width = i_max_width;
+    header.i_height = p_filter->fmt_out.video.i_height;
+    header.i_scale = p_sys->i_scale;
+    header.i_outline_thickness =
+        var_InheritInteger( p_filter, "freetype-outline-thickness" );
+#ifdef HAVE_FRIBIDI
+    header.i_text_direction =
+        var_InheritInteger( p_filter, "freetype-text-direction" );
+#endif
+    header.b_grid = b_grid;
+    header.b_balance = b_balance;
+    header.p_default_face = p_sys->p_face;
+    vlc_memstream_write( &stream, &header, sizeof( header ) );
+
+    vlc_memstream_write( &stream, p_text, i_size * sizeof( *p_text ) );
+    WriteStyleKey( &stream, p_sys->p_default_style );
+    for( int i = 0; i < i_size; i++ )
+        if( i == 0 || pp_styles[i] != pp_styles[i - 1] )
+        {
+            vlc_memstream_write( &stream, &i, sizeof( i ) );
+            WriteStyleKey( &stream, pp_styles[i] );
+        }
+
+    if( vlc_memstream_close( &stream ) )
+        return NULL;
+    *pi_key_size = stream.length;
+    return stream.ptr;
+}
+
+static void CacheParagraph( text_cache_t *p_cache,
+                            const char *p_key, size_t i_key_size,
+                            const line_desc_t *p_lines,
+                            text_style_t **pp_styles, int i_size )
+{
+    cached_paragraph_t *p_cached = malloc( sizeof( *p_cached ) );
+    if( !p_cached )
+        return;
+
+    int i_count = 0;
+    for( const line_desc_t *p_line = p_lines; p_line; p_line = p_line->p_next )
+        i_count += p_line->i_character_count;
+
+    p_cached->pi_styles = malloc( __MAX( i_count, 1 ) * sizeof( int ) );
+    if( !p_cached->pi_styles
+     || CopyLines( p_lines, &p_cached->p_lines ) )
+    {
+        free( p_cached->pi_styles );
+        free( p_cached );
+        return;
+    }
+
+    /* The styles belong to the rendered text: keep their index */
+    size_t i_bytes = sizeof( *p_cached ) + i_count * sizeof( int );
+    int k = 0;
+    for( line_desc_t *p_line = p_cached->p_lines; p_line; p_line = p_line->p_next )
+    {
+        i_bytes += sizeof( *p_line )
+                 + p_line->i_character_count * sizeof( line_character_t );
+
+        for( int i = 0; i < p_line->i_character_count; i++, k++ )
+        {
+            line_character_t *p_ch = &p_line->p_character[i];
+            int j = 0;
+            while( j < i_size && pp_styles[j] != p_ch->p_style )
+                j++;
+            if( j == i_size )
+            {
+                ReleaseCachedParagraph( p_cached );
+                return;
+            }
+            p_cached->pi_styles[k] = j;
+            p_ch->p_style = NULL;
+
+            i_bytes += GlyphSize( (FT_Glyph)p_ch->p_glyph );
+            if( p_ch->p_outline )
+                i_bytes += GlyphSize( (FT_Glyph)p_ch->p_outline );
+            if( p_ch->p_shadow )
+                i_bytes += GlyphSize( (FT_Glyph)p_ch->p_shadow );
+        }
+    }
+
+    TextCachePut( p_cache, p_key, i_key_size, p_cached, i_bytes,
+                  ReleaseCachedParagraph );
+}
+
+static int LoadCachedParagraph( const cached_paragraph_t *p_cached,
+                                text_style_t **pp_styles,
+                                line_desc_t **pp_lines )
+{
+    if( CopyLines( p_cached->p_lines, pp_lines ) )
+        return VLC_ENOMEM;
+
+    int k = 0;
+    for( line_desc_t *p_line = *pp_lines; p_line; p_line = p_line->p_next )
+        for( int i = 0; i < p_line->i_character_count; i++ )
+            p_line->p_character[i].p_style = pp_styles[p_cached->pi_styles[k++]];
+    return VLC_SUCCESS;
+}
+
+/**
+ * Lays out a paragraph, or copies the lines of the same paragraph laid out
+ * earlier. Repeated subtitles, such as scrolling or refreshed marquees,
+ * then skip the shaping and the rendering of the glyphs.
+ */
+static int LayoutCachedParagraph( filter_t *p_filter,
+                                  const uni_char_t *p_text,
+                                  text_style_t **pp_styles,
+                                  uint32_t *pi_k_dates, int i_size,
+                                  bool b_grid, bool b_balance,
+                                  unsigned i_max_width,
+                                  line_desc_t **pp_lines )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    char *p_key = NULL;
+    size_t i_key_size;
+
+    /* Karaoke depends on the playback time */
+    if( p_sys->p_cache && !pi_k_dates )
+        p_key = ParagraphKey( p_filter, p_text, pp_styles, i_size,
+                              b_grid, b_balance, i_max_width, &i_key_size );
+    if( !p_key )
+        return ShapeAndLayoutParagraph( p_filter, p_text, pp_styles,
+                                        pi_k_dates, i_size, b_grid, b_balance,
+                                        i_max_width, pp_lines );
+
+    int i_ret;
+    const cached_paragraph_t *p_cached =
+        TextCacheGet( p_sys->p_cache, p_key, i_key_size );
+    if( p_cached )
+    {
+        p_sys->i_paragraph_hits++;
+        i_ret = LoadCachedParagraph( p_cached, pp_styles, pp_lines );
+    }
+    else
+    {
+        p_sys->i_paragraph_misses++;
+        i_ret = ShapeAndLayoutParagraph( p_filter, p_text, pp_styles,
+                                         pi_k_dates, i_size, b_grid, b_balance,
+                                         i_max_width, pp_lines );
+        if( i_ret == VLC_SUCCESS )
+            CacheParagraph( p_sys->p_cache, p_key, i_key_size, *pp_lines,
+                            pp_styles, i_size );
+    }
+    free( p_key );
+    return i_ret;
+}
+
 int LayoutText( filter_t *p_filter,
                 const uni_char_t *psz_text, text_style_t **pp_styles,
                 uint32_t *pi_k_dates, int i_len,
@@ -1493,10 +2050,8 @@ int LayoutText( filter_t *p_filter,
 {
     line_desc_t *p_first_line = 0;
     line_desc_t **pp_line = &p_first_line;
-    paragraph_t *p_paragraph = 0;
     int i_paragraph_start = 0;
     unsigned i_total_height = 0;
-    unsigned i_max_advance_x = 0;
     int i_max_face_height = 0;
 
     for( int i = 0; i <= i_len; ++i )
@@ -1509,55 +2064,20 @@ int LayoutText( filter_t *p_filter,
                 continue;
             }
 
-            p_paragraph = NewParagraph( p_filter, i - i_paragraph_start,
-                                        psz_text + i_paragraph_start,
-                                        pp_styles + i_paragraph_start,
-                                        pi_k_dates ?
-                                        pi_k_dates + i_paragraph_start : 0,
-                                        20 );
-            if( !p_paragraph )
+            int i_ret = LayoutCachedParagraph( p_filter,
+                                               psz_text + i_paragraph_start,
+                                               pp_styles + i_paragraph_start,
+                                               pi_k_dates ?
+                                               pi_k_dates + i_paragraph_start : 0,
+                                               i - i_paragraph_start,
+                                               b_grid, b_balance, i_max_width,
+                                               pp_line );
+            if( i_ret )
             {
                 if( p_first_line ) FreeLines( p_first_line );
-                return VLC_ENOMEM;
+                return i_ret;
             }
 
-#ifdef HAVE_FRIBIDI
-            if( AnalyzeParagraph( p_paragraph ) )
-                goto error;
-#endif
-
-            if( ItemizeParagraph( p_filter, p_paragraph ) )
-                goto error;
-
-#if defined HAVE_HARFBUZZ
-            if( ShapeParagraphHarfBuzz( p_filter, &p_paragraph ) )
-                goto error;
-
-            if( LoadGlyphs( p_filter, p_paragraph, true, false, &i_max_advance_x ) )
-                goto error;
-
-#elif defined HAVE_FRIBIDI
-            if( ShapeParagraphFriBidi( p_filter, p_paragraph ) )
-                goto error;
-            if( LoadGlyphs( p_filter, p_paragraph, false, true, &i_max_advance_x ) )
-                goto error;
-            if( RemoveZeroWidthCharacters( p_paragraph ) )
-                goto error;
-            if( ZeroNsmAdvance( p_paragraph ) )
-                goto error;
-#else
-            if( LoadGlyphs( p_filter, p_paragraph, false, true, &i_max_advance_x ) )
-                goto error;
-#endif
-
-            if( LayoutParagraph( p_filter, p_paragraph,
-                                 i_max_width, i_max_advance_x, pp_line,
-                                 b_grid, b_balance ) )
-                goto error;
-
-            FreeParagraph( p_paragraph );
-            p_paragraph = 0;
-
             for( ; *pp_line; pp_line = &(*pp_line)->p_next )
             {
                 i_total_height += (*pp_line)->i_height;
@@ -1606,10 +2126,5 @@ int LayoutText( filter_t *p_filter,
     *pp_lines = p_first_line;
     *p_bbox = bbox;
     return VLC_SUCCESS;
-
-error:
-    if( p_first_line ) FreeLines( p_first_line );
-    if( p_paragraph ) FreeParagraph( p_paragraph );
-    return VLC_EGENERIC;
 }
 
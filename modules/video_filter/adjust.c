@@ -125,6 +125,19 @@ struct filter_sys_t
                                     int, int, int );
 };
 
+/* Parameters of a picture, shared by its slices */
+typedef struct
+{
+    picture_t *p_pic;
+    picture_t *p_outpic;
+    const int *pi_luma;
+    bool       b_16bit;
+    int        i_y_offset; /* packed only */
+    bool       b_clip;
+    int        i_sin, i_cos, i_sat, i_x, i_y;
+    atomic_bool b_error;
+} adjust_slice_t;
+
 /*****************************************************************************
  * Create: allocates adjust video filter
  *****************************************************************************/
@@ -225,6 +238,112 @@ static void Destroy( vlc_object_t *p_this )
     free( p_sys );
 }
 
+/*****************************************************************************
+ * Run the filter on one slice of a Planar YUV picture
+ *****************************************************************************/
+static void FilterPlanarSlice( filter_t *p_filter, void *opaque,
+                               unsigned i_slice, unsigned i_slices )
+{
+    const adjust_slice_t *ctx = opaque;
+    filter_sys_t *p_sys = p_filter->p_sys;
+    const int *pi_luma = ctx->pi_luma;
+    const bool b_16bit = ctx->b_16bit;
+    picture_t pic, outpic;
+    picture_t *p_pic = &pic, *p_outpic = &outpic;
+
+    GetSlicePicture( p_pic, ctx->p_pic, i_slice, i_slices );
+    GetSlicePicture( p_outpic, ctx->p_outpic, i_slice, i_slices );
+
+    /*
+     * Do the Y plane
+     */
+    if ( b_16bit )
+    {
+        uint16_t *p_in, *p_in_end, *p_line_end;
+        uint16_t *p_out;
+        p_in = (uint16_t *) p_pic->p[Y_PLANE].p_pixels;
+        p_in_end = p_in + p_pic->p[Y_PLANE].i_visible_lines
+            * (p_pic->p[Y_PLANE].i_pitch >> 1) - 8;
+
+        p_out = (uint16_t *) p_outpic->p[Y_PLANE].p_pixels;
+
+        for( ; p_in < p_in_end ; )
+        {
+            p_line_end = p_in + (p_pic->p[Y_PLANE].i_visible_pitch >> 1) - 8;
+
+            for( ; p_in < p_line_end ; )
+            {
+                /* Do 8 pixels at a time */
+                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
+                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
+                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
+                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
+            }
+
+            p_line_end += 8;
+
+            for( ; p_in < p_line_end ; )
+            {
+                *p_out++ = pi_luma[ *p_in++ ];
+            }
+
+            p_in += (p_pic->p[Y_PLANE].i_pitch >> 1)
+                - (p_pic->p[Y_PLANE].i_visible_pitch >> 1);
+            p_out += (p_outpic->p[Y_PLANE].i_pitch >> 1)
+                - (p_outpic->p[Y_PLANE].i_visible_pitch >> 1);
+        }
+    }
+    else
+    {
+        uint8_t *p_in, *p_in_end, *p_line_end;
+        uint8_t *p_out;
+        p_in = p_pic->p[Y_PLANE].p_pixels;
+        p_in_end = p_in + p_pic->p[Y_PLANE].i_visible_lines
+                 * p_pic->p[Y_PLANE].i_pitch - 8;
+
+        p_out = p_outpic->p[Y_PLANE].p_pixels;
+
+        for( ; p_in < p_in_end ; )
+        {
+            p_line_end = p_in + p_pic->p[Y_PLANE].i_visible_pitch - 8;
+
+            for( ; p_in < p_line_end ; )
+            {
+                /* Do 8 pixels at a time */
+                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
+                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
+                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
+                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
+            }
+
+            p_line_end += 8;
+
+            for( ; p_in < p_line_end ; )
+            {
+                *p_out++ = pi_luma[ *p_in++ ];
+            }
+
+            p_in += p_pic->p[Y_PLANE].i_pitch
+                  - p_pic->p[Y_PLANE].i_visible_pitch;
+            p_out += p_outpic->p[Y_PLANE].i_pitch
+                   - p_outpic->p[Y_PLANE].i_visible_pitch;
+        }
+    }
+
+    /*
+     * Do the U and V planes
+     */
+
+    /* Currently no errors are implemented in the function, if any are added
+     * check them here */
+    if ( ctx->b_clip )
+        p_sys->pf_process_sat_hue_clip( p_pic, p_outpic, ctx->i_sin, ctx->i_cos,
+                                        ctx->i_sat, ctx->i_x, ctx->i_y );
+    else
+        p_sys->pf_process_sat_hue( p_pic, p_outpic, ctx->i_sin, ctx->i_cos,
+                                   ctx->i_sat, ctx->i_x, ctx->i_y );
+}
+
 /*****************************************************************************
  * Run the filter on a Planar YUV picture
  *****************************************************************************/
@@ -317,108 +436,103 @@ static picture_t *FilterPlanar( filter_t *p_filter, picture_t *p_pic )
     }
 
     /*
-     * Do the Y plane
+     * Hue and saturation matrix for the U and V planes
      */
-    if ( b_16bit )
-    {
-        uint16_t *p_in, *p_in_end, *p_line_end;
-        uint16_t *p_out;
-        p_in = (uint16_t *) p_pic->p[Y_PLANE].p_pixels;
-        p_in_end = p_in + p_pic->p[Y_PLANE].i_visible_lines
-            * (p_pic->p[Y_PLANE].i_pitch >> 1) - 8;
+    adjust_slice_t ctx;
 
-        p_out = (uint16_t *) p_outpic->p[Y_PLANE].p_pixels;
+    ctx.i_sin = sinf(f_hue) * f_max;
+    ctx.i_cos = cosf(f_hue) * f_max;
 
-        for( ; p_in < p_in_end ; )
-        {
-            p_line_end = p_in + (p_pic->p[Y_PLANE].i_visible_pitch >> 1) - 8;
+    /* pow(2, (bpp * 2) - 1) */
+    ctx.i_x = ( cosf(f_hue) + sinf(f_hue) ) * f_range * i_mid;
+    ctx.i_y = ( cosf(f_hue) - sinf(f_hue) ) * f_range * i_mid;
 
-            for( ; p_in < p_line_end ; )
-            {
-                /* Do 8 pixels at a time */
-                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
-                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
-                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
-                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
-            }
+    ctx.i_sat = i_sat;
+    ctx.b_clip = i_sat > i_range;
 
-            p_line_end += 8;
+    ctx.p_pic = p_pic;
+    ctx.p_outpic = p_outpic;
+    ctx.pi_luma = pi_luma;
+    ctx.b_16bit = b_16bit;
+    filter_RunSlices( p_filter, p_pic->p[U_PLANE].i_visible_lines / 16,
+                      FilterPlanarSlice, &ctx );
 
-            for( ; p_in < p_line_end ; )
-            {
-                *p_out++ = pi_luma[ *p_in++ ];
-            }
+    return CopyInfoAndRelease( p_outpic, p_pic );
+}
 
-            p_in += (p_pic->p[Y_PLANE].i_pitch >> 1)
-                - (p_pic->p[Y_PLANE].i_visible_pitch >> 1);
-            p_out += (p_outpic->p[Y_PLANE].i_pitch >> 1)
-                - (p_outpic->p[Y_PLANE].i_visible_pitch >> 1);
-        }
-    }
-    else
-    {
-        uint8_t *p_in, *p_in_end, *p_line_end;
-        uint8_t *p_out;
-        p_in = p_pic->p[Y_PLANE].p_pixels;
-        p_in_end = p_in + p_pic->p[Y_PLANE].i_visible_lines
-                 * p_pic->p[Y_PLANE].i_pitch - 8;
+/*****************************************************************************
+ * Run the filter on one slice of a Packed YUV picture
+ *****************************************************************************/
+static void FilterPackedSlice( filter_t *p_filter, void *opaque,
+                               unsigned i_slice, unsigned i_slices )
+{
+    adjust_slice_t *ctx = opaque;
+    filter_sys_t *p_sys = p_filter->p_sys;
+    const int *pi_luma = ctx->pi_luma;
+    const int i_y_offset = ctx->i_y_offset;
+    uint8_t *p_in, *p_in_end, *p_line_end;
+    uint8_t *p_out;
+    picture_t pic, outpic;
+    picture_t *p_pic = &pic, *p_outpic = &outpic;
 
-        p_out = p_outpic->p[Y_PLANE].p_pixels;
+    GetSlicePicture( p_pic, ctx->p_pic, i_slice, i_slices );
+    GetSlicePicture( p_outpic, ctx->p_outpic, i_slice, i_slices );
 
-        for( ; p_in < p_in_end ; )
-        {
-            p_line_end = p_in + p_pic->p[Y_PLANE].i_visible_pitch - 8;
+    const int i_pitch = p_pic->p->i_pitch;
+    const int i_visible_pitch = p_pic->p->i_visible_pitch;
 
-            for( ; p_in < p_line_end ; )
-            {
-                /* Do 8 pixels at a time */
-                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
-                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
-                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
-                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
-            }
+    /*
+     * Do the Y plane
+     */
 
-            p_line_end += 8;
+    p_in = p_pic->p->p_pixels + i_y_offset;
+    p_in_end = p_in + p_pic->p->i_visible_lines * p_pic->p->i_pitch - 8 * 4;
 
-            for( ; p_in < p_line_end ; )
-            {
-                *p_out++ = pi_luma[ *p_in++ ];
-            }
+    p_out = p_outpic->p->p_pixels + i_y_offset;
 
-            p_in += p_pic->p[Y_PLANE].i_pitch
-                  - p_pic->p[Y_PLANE].i_visible_pitch;
-            p_out += p_outpic->p[Y_PLANE].i_pitch
-                   - p_outpic->p[Y_PLANE].i_visible_pitch;
+    for( ; p_in < p_in_end ; )
+    {
+        p_line_end = p_in + i_visible_pitch - 8 * 4;
+
+        for( ; p_in < p_line_end ; )
+        {
+            /* Do 8 pixels at a time */
+            *p_out = pi_luma[ *p_in ]; p_in += 2; p_out += 2;
+            *p_out = pi_luma[ *p_in ]; p_in += 2; p_out += 2;
+            *p_out = pi_luma[ *p_in ]; p_in += 2; p_out += 2;
+            *p_out = pi_luma[ *p_in ]; p_in += 2; p_out += 2;
+            *p_out = pi_luma[ *p_in ]; p_in += 2; p_out += 2;
+            *p_out = pi_luma[ *p_in ]; p_in += 2; p_out += 2;
+            *p_out = pi_luma[ *p_in ]; p_in += 2; p_out += 2;
+            *p_out = pi_luma[ *p_in ]; p_in += 2; p_out += 2;
         }
+
+        p_line_end += 8 * 4;
+
+        for( ; p_in < p_line_end ; )
+        {
+            *p_out = pi_luma[ *p_in ]; p_in += 2; p_out += 2;
+        }
+
+        p_in += i_pitch - p_pic->p->i_visible_pitch;
+        p_out += i_pitch - p_outpic->p->i_visible_pitch;
     }
 
     /*
      * Do the U and V planes
      */
 
-    int i_sin = sinf(f_hue) * f_max;
-    int i_cos = cosf(f_hue) * f_max;
-
-    /* pow(2, (bpp * 2) - 1) */
-    int i_x = ( cosf(f_hue) + sinf(f_hue) ) * f_range * i_mid;
-    int i_y = ( cosf(f_hue) - sinf(f_hue) ) * f_range * i_mid;
-
-    if ( i_sat > i_range )
-    {
-        /* Currently no errors are implemented in the function, if any are added
-         * check them here */
-        p_sys->pf_process_sat_hue_clip( p_pic, p_outpic, i_sin, i_cos, i_sat,
-                                        i_x, i_y );
-    }
+    int i_ret;
+    if ( ctx->b_clip )
+        i_ret = p_sys->pf_process_sat_hue_clip( p_pic, p_outpic, ctx->i_sin,
+                                                ctx->i_cos, ctx->i_sat,
+                                                ctx->i_x, ctx->i_y );
     else
-    {
-        /* Currently no errors are implemented in the function, if any are added
-         * check them here */
-        p_sys->pf_process_sat_hue( p_pic, p_outpic, i_sin, i_cos, i_sat,
-                                        i_x, i_y );
-    }
-
-    return CopyInfoAndRelease( p_outpic, p_pic );
+        i_ret = p_sys->pf_process_sat_hue( p_pic, p_outpic, ctx->i_sin,
+                                           ctx->i_cos, ctx->i_sat,
+                                           ctx->i_x, ctx->i_y );
+    if( i_ret != VLC_SUCCESS )
+        atomic_store( &ctx->b_error, true );
 }
 
 /*****************************************************************************
@@ -430,24 +544,17 @@ static picture_t *FilterPacked( filter_t *p_filter, picture_t *p_pic )
     int pi_gamma[256];
 
     picture_t *p_outpic;
-    uint8_t *p_in, *p_in_end, *p_line_end;
-    uint8_t *p_out;
     int i_y_offset, i_u_offset, i_v_offset;
 
-    int i_pitch, i_visible_pitch;
-
     double  f_hue;
     double  f_gamma;
     int32_t i_cont, i_lum;
-    int i_sat, i_sin, i_cos, i_x, i_y;
+    int i_sat;
 
     filter_sys_t *p_sys = p_filter->p_sys;
 
     if( !p_pic ) return NULL;
 
-    i_pitch = p_pic->p->i_pitch;
-    i_visible_pitch = p_pic->p->i_visible_pitch;
-
     if( GetPackedYuvOffsets( p_pic->format.i_chroma, &i_y_offset,
                              &i_u_offset, &i_v_offset ) != VLC_SUCCESS )
     {
@@ -514,77 +621,36 @@ static picture_t *FilterPacked( filter_t *p_filter, picture_t *p_pic )
     }
 
     /*
-     * Do the Y plane
+     * Hue and saturation matrix for the U and V planes
      */
+    adjust_slice_t ctx;
 
-    p_in = p_pic->p->p_pixels + i_y_offset;
-    p_in_end = p_in + p_pic->p->i_visible_lines * p_pic->p->i_pitch - 8 * 4;
-
-    p_out = p_outpic->p->p_pixels + i_y_offset;
-
-    for( ; p_in < p_in_end ; )
-    {
-        p_line_end = p_in + i_visible_pitch - 8 * 4;
-
-        for( ; p_in < p_line_end ; )
-        {
-            /* Do 8 pixels at a time */
-            *p_out = pi_luma[ *p_in ]; p_in += 2; p_out += 2;
-            *p_out = pi_luma[ *p_in ]; p_in += 2; p_out += 2;
-            *p_out = pi_luma[ *p_in ]; p_in += 2; p_out += 2;
-            *p_out = pi_luma[ *p_in ]; p_in += 2; p_out += 2;
-            *p_out = pi_luma[ *p_in ]; p_in += 2; p_out += 2;
-            *p_out = pi_luma[ *p_in ]; p_in += 2; p_out += 2;
-            *p_out = pi_luma[ *p_in ]; p_in += 2; p_out += 2;
-            *p_out = pi_luma[ *p_in ]; p_in += 2; p_out += 2;
-        }
-
-        p_line_end += 8 * 4;
+    ctx.i_sin = sin(f_hue) * 256;
+    ctx.i_cos = cos(f_hue) * 256;
 
-        for( ; p_in < p_line_end ; )
-        {
-            *p_out = pi_luma[ *p_in ]; p_in += 2; p_out += 2;
-        }
+    ctx.i_x = ( cos(f_hue) + sin(f_hue) ) * 32768;
+    ctx.i_y = ( cos(f_hue) - sin(f_hue) ) * 32768;
 
-        p_in += i_pitch - p_pic->p->i_visible_pitch;
-        p_out += i_pitch - p_outpic->p->i_visible_pitch;
-    }
+    ctx.i_sat = i_sat;
+    ctx.b_clip = i_sat > 256;
 
-    /*
-     * Do the U and V planes
-     */
-
-    i_sin = sin(f_hue) * 256;
-    i_cos = cos(f_hue) * 256;
-
-    i_x = ( cos(f_hue) + sin(f_hue) ) * 32768;
-    i_y = ( cos(f_hue) - sin(f_hue) ) * 32768;
+    ctx.p_pic = p_pic;
+    ctx.p_outpic = p_outpic;
+    ctx.pi_luma = pi_luma;
+    ctx.i_y_offset = i_y_offset;
+    atomic_init( &ctx.b_error, false );
+    filter_RunSlices( p_filter, p_pic->p->i_visible_lines / 16,
+                      FilterPackedSlice, &ctx );
 
-    if ( i_sat > 256 )
+    if( atomic_load( &ctx.b_error ) )
     {
-        if ( p_sys->pf_process_sat_hue_clip( p_pic, p_outpic, i_sin, i_cos, i_sat,
-                                             i_x, i_y ) != VLC_SUCCESS )
-        {
-            /* Currently only one error can happen in the function, but if there
-             * will be more of them, this message must go away */
-            msg_Warn( p_filter, "Unsupported input chroma (%4.4s)",
-                      (char*)&(p_pic->format.i_chroma) );
-            picture_Release( p_pic );
-            return NULL;
-        }
-    }
-    else
-    {
-        if ( p_sys->pf_process_sat_hue( p_pic, p_outpic, i_sin, i_cos, i_sat,
-                                        i_x, i_y ) != VLC_SUCCESS )
-        {
-            /* Currently only one error can happen in the function, but if there
-             * will be more of them, this message must go away */
-            msg_Warn( p_filter, "Unsupported input chroma (%4.4s)",
-                      (char*)&(p_pic->format.i_chroma) );
-            picture_Release( p_pic );
-            return NULL;
-        }
+        /* Currently only one error can happen in the function, but if there
+         * will be more of them, this message must go away */
+        msg_Warn( p_filter, "Unsupported input chroma (%4.4s)",
+                  (char*)&(p_pic->format.i_chroma) );
+        picture_Release( p_outpic );
+        picture_Release( p_pic );
+        return NULL;
     }
 
     return CopyInfoAndRelease( p_outpic, p_pic );
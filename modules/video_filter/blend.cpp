@@ -34,6 +34,11 @@
 #include <vlc_picture.h>
 #include "filter_picture.h"
 
+#ifdef HAVE_SSE2_INTRINSICS
+# include <vlc_cpu.h>
+# include <emmintrin.h>
+#endif
+
 /*****************************************************************************
  * Module descriptor
  *****************************************************************************/
@@ -79,6 +84,14 @@ public:
     {
         return fmt;
     }
+    unsigned getX() const
+    {
+        return x;
+    }
+    CPicture getShifted(unsigned dx) const
+    {
+        return CPicture(picture, fmt, x + dx, y);
+    }
     bool isFull(unsigned) const
     {
         return true;
@@ -509,7 +522,8 @@ struct convertYuvpToRgba : public convertYuvpToAny {
 template <class G, class F>
 struct compose {
     compose(const video_format_t *dst, const video_format_t *src) : f(dst, src), g(dst, src) {}
-    void operator()(CPixel &p)
+    template <typename TPixel>
+    void operator()(TPixel &p)
     {
         f(p);
         g(p);
@@ -548,14 +562,433 @@ void Blend(const CPicture &dst_data, const CPicture &src_data,
     }
 }
 
+#ifdef HAVE_SSE2_INTRINSICS
+/*
+ * SSE2 versions of the most common blendings (subpictures onto the decoded
+ * video). They process 16 pixels at a time using 16 bits per component and
+ * give the exact same results as the generic Blend().
+ */
+struct CPixelSSE2 {
+    __m128i i, j, k;
+    __m128i a;
+};
+
+VLC_SSE2
+static inline __m128i div255_sse2(__m128i v)
+{
+    /* Same as div255(), v must not exceed 255 * 255 */
+    return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(_mm_srli_epi16(v, 8), v),
+                                        _mm_set1_epi16(1)), 8);
+}
+
+VLC_SSE2
+static inline __m128i div255_epi32_sse2(__m128i v)
+{
+    return _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(_mm_srli_epi32(v, 8), v),
+                                        _mm_set1_epi32(1)), 8);
+}
+
+/* Returns the even 16 bits lanes of a and b */
+VLC_SSE2
+static inline __m128i even_sse2(__m128i a, __m128i b)
+{
+    const __m128i mask = _mm_set1_epi32(0xffff);
+    return _mm_packs_epi32(_mm_and_si128(a, mask), _mm_and_si128(b, mask));
+}
+
+VLC_SSE2
+static inline __m128i merge_sse2(__m128i dst, __m128i src, __m128i f)
+{
+    return div255_sse2(_mm_add_epi16(_mm_mullo_epi16(dst, _mm_sub_epi16(_mm_set1_epi16(255), f)),
+                                     _mm_mullo_epi16(src, f)));
+}
+
+/* Merges 8 consecutive 8 bits samples */
+VLC_SSE2
+static inline void merge_sse2(uint8_t *dst, __m128i src, __m128i f)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i d = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)dst), zero);
+
+    d = merge_sse2(d, src, f);
+    _mm_storel_epi64((__m128i *)dst, _mm_packus_epi16(d, d));
+}
+
+/* Merges 8 consecutive samples of at most 10 bits */
+VLC_SSE2
+static inline void merge_sse2(uint16_t *dst, __m128i src, __m128i f)
+{
+    const __m128i d = _mm_loadu_si128((const __m128i *)dst);
+    const __m128i g = _mm_sub_epi16(_mm_set1_epi16(255), f);
+    const __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi16(d, src),
+                                      _mm_unpacklo_epi16(g, f));
+    const __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi16(d, src),
+                                      _mm_unpackhi_epi16(g, f));
+    const __m128i r = _mm_packs_epi32(div255_epi32_sse2(lo), div255_epi32_sse2(hi));
+
+    /* div255() is not exact above 8 bits, so the transparent samples must
+     * be kept as they are */
+    const __m128i transparent = _mm_cmpeq_epi16(f, _mm_setzero_si128());
+    _mm_storeu_si128((__m128i *)dst, _mm_or_si128(_mm_and_si128(transparent, d),
+                                                  _mm_andnot_si128(transparent, r)));
+}
+
+class CPictureYUVASSE2 : public CPicture {
+public:
+    CPictureYUVASSE2(const CPicture &cfg) : CPicture(cfg)
+    {
+        for (unsigned plane = 0; plane < 4; plane++)
+            data[plane] = CPicture::getLine<1>(plane);
+    }
+    VLC_SSE2 void get(CPixelSSE2 px[2], unsigned dx) const
+    {
+        const __m128i zero = _mm_setzero_si128();
+        __m128i v;
+
+        v = _mm_loadu_si128((const __m128i *)&data[0][x + dx]);
+        px[0].i = _mm_unpacklo_epi8(v, zero);
+        px[1].i = _mm_unpackhi_epi8(v, zero);
+        v = _mm_loadu_si128((const __m128i *)&data[1][x + dx]);
+        px[0].j = _mm_unpacklo_epi8(v, zero);
+        px[1].j = _mm_unpackhi_epi8(v, zero);
+        v = _mm_loadu_si128((const __m128i *)&data[2][x + dx]);
+        px[0].k = _mm_unpacklo_epi8(v, zero);
+        px[1].k = _mm_unpackhi_epi8(v, zero);
+        v = _mm_loadu_si128((const __m128i *)&data[3][x + dx]);
+        px[0].a = _mm_unpacklo_epi8(v, zero);
+        px[1].a = _mm_unpackhi_epi8(v, zero);
+    }
+    void nextLine()
+    {
+        y++;
+        for (unsigned plane = 0; plane < 4; plane++)
+            data[plane] += picture->p[plane].i_pitch;
+    }
+private:
+    uint8_t *data[4];
+};
+
+class CPictureRGBASSE2 : public CPicture {
+public:
+    CPictureRGBASSE2(const CPicture &cfg) : CPicture(cfg)
+    {
+        data = CPicture::getLine<1>(0);
+    }
+    VLC_SSE2 void get(CPixelSSE2 px[2], unsigned dx) const
+    {
+        const __m128i mask = _mm_set1_epi32(0xff);
+
+        for (unsigned n = 0; n < 2; n++) {
+            const __m128i *src = (const __m128i *)&data[(x + dx + 8 * n) * 4];
+            const __m128i lo = _mm_loadu_si128(&src[0]);
+            const __m128i hi = _mm_loadu_si128(&src[1]);
+
+            px[n].i = _mm_packs_epi32(_mm_and_si128(lo, mask),
+                                      _mm_and_si128(hi, mask));
+            px[n].j = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(lo, 8), mask),
+                                      _mm_and_si128(_mm_srli_epi32(hi, 8), mask));
+            px[n].k = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(lo, 16), mask),
+                                      _mm_and_si128(_mm_srli_epi32(hi, 16), mask));
+            px[n].a = _mm_packs_epi32(_mm_srli_epi32(lo, 24),
+                                      _mm_srli_epi32(hi, 24));
+        }
+    }
+    void nextLine()
+    {
+        y++;
+        data += picture->p[0].i_pitch;
+    }
+private:
+    uint8_t *data;
+};
+
+/* 4:2:0 planar pictures of 8, 9 or 10 bits */
+template <typename pixel, bool swap_uv>
+class CPictureYUVPlanarSSE2 : public CPicture {
+public:
+    CPictureYUVPlanarSSE2(const CPicture &cfg) : CPicture(cfg)
+    {
+        data[0] = CPicture::getLine<1>(0);
+        data[1] = CPicture::getLine<2>(swap_uv ? 2 : 1);
+        data[2] = CPicture::getLine<2>(swap_uv ? 1 : 2);
+    }
+    bool isSupported() const
+    {
+        return true;
+    }
+    VLC_SSE2 void merge(unsigned dx, const CPixelSSE2 spx[2], const __m128i a[2])
+    {
+        pixel *luma = (pixel *)&data[0][(x + dx) * sizeof(pixel)];
+
+        merge_sse2(&luma[0], spx[0].i, a[0]);
+        merge_sse2(&luma[8], spx[1].i, a[1]);
+        if ((y % 2) == 0) {
+            /* x + dx is even, use the samples of the even pixels */
+            const __m128i ca = even_sse2(a[0], a[1]);
+
+            merge_sse2((pixel *)&data[1][(x + dx) / 2 * sizeof(pixel)],
+                       even_sse2(spx[0].j, spx[1].j), ca);
+            merge_sse2((pixel *)&data[2][(x + dx) / 2 * sizeof(pixel)],
+                       even_sse2(spx[0].k, spx[1].k), ca);
+        }
+    }
+    void nextLine()
+    {
+        y++;
+        data[0] += picture->p[0].i_pitch;
+        if ((y % 2) == 0) {
+            data[1] += picture->p[swap_uv ? 2 : 1].i_pitch;
+            data[2] += picture->p[swap_uv ? 1 : 2].i_pitch;
+        }
+    }
+private:
+    uint8_t *data[3];
+};
+
+template <bool swap_uv>
+class CPictureYUVSemiPlanarSSE2 : public CPicture {
+public:
+    CPictureYUVSemiPlanarSSE2(const CPicture &cfg) : CPicture(cfg)
+    {
+        data[0] = CPicture::getLine<1>(0);
+        data[1] = CPicture::getLine<2>(1);
+    }
+    bool isSupported() const
+    {
+        return true;
+    }
+    VLC_SSE2 void merge(unsigned dx, const CPixelSSE2 spx[2], const __m128i a[2])
+    {
+        merge_sse2(&data[0][x + dx + 0], spx[0].i, a[0]);
+        merge_sse2(&data[0][x + dx + 8], spx[1].i, a[1]);
+        if ((y % 2) == 0) {
+            __m128i *chroma = (__m128i *)&data[1][x + dx];
+            const __m128i uv = _mm_loadu_si128(chroma);
+            const __m128i ca = even_sse2(a[0], a[1]);
+            const __m128i j  = even_sse2(spx[0].j, spx[1].j);
+            const __m128i k  = even_sse2(spx[0].k, spx[1].k);
+            const __m128i lo = merge_sse2(_mm_and_si128(uv, _mm_set1_epi16(0xff)),
+                                          swap_uv ? k : j, ca);
+            const __m128i hi = merge_sse2(_mm_srli_epi16(uv, 8),
+                                          swap_uv ? j : k, ca);
+
+            _mm_storeu_si128(chroma, _mm_or_si128(lo, _mm_slli_epi16(hi, 8)));
+        }
+    }
+    void nextLine()
+    {
+        y++;
+        data[0] += picture->p[0].i_pitch;
+        if ((y % 2) == 0)
+            data[1] += picture->p[1].i_pitch;
+    }
+private:
+    uint8_t *data[2];
+};
+
+class CPictureRGB32SSE2 : public CPicture {
+public:
+    CPictureRGB32SSE2(const CPicture &cfg) : CPicture(cfg)
+    {
+        offset_r = fmt->i_lrshift / 8;
+        offset_g = fmt->i_lgshift / 8;
+        offset_b = fmt->i_lbshift / 8;
+        data = CPicture::getLine<1>(0);
+    }
+    bool isSupported() const
+    {
+        return offset_r != offset_g && offset_g != offset_b && offset_b != offset_r;
+    }
+    VLC_SSE2 void merge(unsigned dx, const CPixelSSE2 spx[2], const __m128i a[2])
+    {
+        const __m128i zero  = _mm_setzero_si128();
+        const __m128i mask  = _mm_set1_epi32(0xff);
+        const __m128i shift_r = _mm_cvtsi32_si128(8 * offset_r);
+        const __m128i shift_g = _mm_cvtsi32_si128(8 * offset_g);
+        const __m128i shift_b = _mm_cvtsi32_si128(8 * offset_b);
+        const __m128i keep  = _mm_set1_epi32(~((0xffu << (8 * offset_r)) |
+                                               (0xffu << (8 * offset_g)) |
+                                               (0xffu << (8 * offset_b))));
+
+        for (unsigned n = 0; n < 2; n++) {
+            __m128i *dst = (__m128i *)&data[(x + dx + 8 * n) * 4];
+            __m128i lo = _mm_loadu_si128(&dst[0]);
+            __m128i hi = _mm_loadu_si128(&dst[1]);
+
+            const __m128i r = merge_sse2(_mm_packs_epi32(_mm_and_si128(_mm_srl_epi32(lo, shift_r), mask),
+                                                         _mm_and_si128(_mm_srl_epi32(hi, shift_r), mask)),
+                                         spx[n].i, a[n]);
+            const __m128i g = merge_sse2(_mm_packs_epi32(_mm_and_si128(_mm_srl_epi32(lo, shift_g), mask),
+                                                         _mm_and_si128(_mm_srl_epi32(hi, shift_g), mask)),
+                                         spx[n].j, a[n]);
+            const __m128i b = merge_sse2(_mm_packs_epi32(_mm_and_si128(_mm_srl_epi32(lo, shift_b), mask),
+                                                         _mm_and_si128(_mm_srl_epi32(hi, shift_b), mask)),
+                                         spx[n].k, a[n]);
+
+            lo = _mm_or_si128(_mm_and_si128(lo, keep),
+                              _mm_or_si128(_mm_sll_epi32(_mm_unpacklo_epi16(r, zero), shift_r),
+                                           _mm_or_si128(_mm_sll_epi32(_mm_unpacklo_epi16(g, zero), shift_g),
+                                                        _mm_sll_epi32(_mm_unpacklo_epi16(b, zero), shift_b))));
+            hi = _mm_or_si128(_mm_and_si128(hi, keep),
+                              _mm_or_si128(_mm_sll_epi32(_mm_unpackhi_epi16(r, zero), shift_r),
+                                           _mm_or_si128(_mm_sll_epi32(_mm_unpackhi_epi16(g, zero), shift_g),
+                                                        _mm_sll_epi32(_mm_unpackhi_epi16(b, zero), shift_b))));
+            _mm_storeu_si128(&dst[0], lo);
+            _mm_storeu_si128(&dst[1], hi);
+        }
+    }
+    void nextLine()
+    {
+        y++;
+        data += picture->p[0].i_pitch;
+    }
+private:
+    unsigned offset_r;
+    unsigned offset_g;
+    unsigned offset_b;
+    uint8_t *data;
+};
+
+typedef CPictureYUVSemiPlanarSSE2<false>          CPictureNV12SSE2;
+typedef CPictureYUVSemiPlanarSSE2<true>           CPictureNV21SSE2;
+
+typedef CPictureYUVPlanarSSE2<uint8_t,  true>     CPictureYV12SSE2;
+typedef CPictureYUVPlanarSSE2<uint8_t,  false>    CPictureI420_8SSE2;
+typedef CPictureYUVPlanarSSE2<uint16_t, false>    CPictureI420_16SSE2;
+
+struct convertNoneSSE2 {
+    convertNoneSSE2(const video_format_t *, const video_format_t *) {}
+    void operator()(CPixelSSE2 &)
+    {
+    }
+};
+
+template <unsigned dst>
+struct convertBitsSSE2 {
+    convertBitsSSE2(const video_format_t *, const video_format_t *) {}
+    VLC_SSE2 void operator()(CPixelSSE2 &p)
+    {
+        p.i = convert(p.i);
+        p.j = convert(p.j);
+        p.k = convert(p.k);
+    }
+private:
+    VLC_SSE2 static __m128i convert(__m128i v)
+    {
+        /* v * m / 255 == q * v + r * v / 255 with m = 255 * q + r */
+        const unsigned q = ((1 << dst) - 1) / 255;
+        const unsigned r = ((1 << dst) - 1) % 255;
+        return _mm_add_epi16(_mm_mullo_epi16(v, _mm_set1_epi16(q)),
+                             div255_sse2(_mm_mullo_epi16(v, _mm_set1_epi16(r))));
+    }
+};
+typedef convertBitsSSE2< 9> convert8To9BitsSSE2;
+typedef convertBitsSSE2<10> convert8To10BitsSSE2;
+
+struct convertRgbToYuv8SSE2 {
+    convertRgbToYuv8SSE2(const video_format_t *, const video_format_t *) {}
+    VLC_SSE2 void operator()(CPixelSSE2 &p)
+    {
+        /* Same as rgb_to_yuv(), the sums fit in 16 bits (unsigned for y) */
+        const __m128i r = p.i, g = p.j, b = p.k;
+        const __m128i c128 = _mm_set1_epi16(128);
+
+        __m128i y = _mm_add_epi16(_mm_mullo_epi16(r, _mm_set1_epi16(66)),
+                                  _mm_mullo_epi16(g, _mm_set1_epi16(129)));
+        y = _mm_add_epi16(y, _mm_mullo_epi16(b, _mm_set1_epi16(25)));
+        p.i = _mm_add_epi16(_mm_srli_epi16(_mm_add_epi16(y, c128), 8),
+                            _mm_set1_epi16(16));
+
+        __m128i u = _mm_sub_epi16(_mm_mullo_epi16(b, _mm_set1_epi16(112)),
+                                  _mm_mullo_epi16(r, _mm_set1_epi16(38)));
+        u = _mm_sub_epi16(u, _mm_mullo_epi16(g, _mm_set1_epi16(74)));
+        p.j = _mm_add_epi16(_mm_srai_epi16(_mm_add_epi16(u, c128), 8), c128);
+
+        __m128i v = _mm_sub_epi16(_mm_mullo_epi16(r, _mm_set1_epi16(112)),
+                                  _mm_mullo_epi16(g, _mm_set1_epi16(94)));
+        v = _mm_sub_epi16(v, _mm_mullo_epi16(b, _mm_set1_epi16(18)));
+        p.k = _mm_add_epi16(_mm_srai_epi16(_mm_add_epi16(v, c128), 8), c128);
+    }
+};
+
+template <class TDst, class TSrc, class TConvert>
+VLC_SSE2
+static bool BlendSSE2(const CPicture &dst_data, const CPicture &src_data,
+                      unsigned width, unsigned height, int alpha)
+{
+    TSrc src(src_data);
+    TDst dst(dst_data);
+    TConvert convert(dst_data.getFormat(), src_data.getFormat());
+
+    if (!dst.isSupported())
+        return false;
+
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i global_alpha = _mm_set1_epi16(alpha);
+
+    for (unsigned y = 0; y < height; y++) {
+        for (unsigned x = 0; x < width; x += 16) {
+            CPixelSSE2 spx[2];
+            __m128i a[2];
+
+            src.get(spx, x);
+            for (unsigned n = 0; n < 2; n++)
+                a[n] = div255_sse2(_mm_mullo_epi16(global_alpha, spx[n].a));
+
+            /* Skip the fully transparent blocks */
+            const __m128i transparent = _mm_cmpeq_epi16(_mm_or_si128(a[0], a[1]), zero);
+            if (_mm_movemask_epi8(transparent) == 0xffff)
+                continue;
+
+            for (unsigned n = 0; n < 2; n++)
+                convert(spx[n]);
+            dst.merge(x, spx, a);
+        }
+        src.nextLine();
+        dst.nextLine();
+    }
+    return true;
+}
+
+/**
+ * It blends the columns multiple of 16 pixels with SSE2, starting on an even
+ * destination column so that the chroma samples are aligned, and the
+ * remaining ones with the generic code.
+ */
+template <class TDst, class TSrc, class TConvert,
+          class TDstSSE2, class TSrcSSE2, class TConvertSSE2>
+void Blend(const CPicture &dst_data, const CPicture &src_data,
+           unsigned width, unsigned height, int alpha)
+{
+    const unsigned x_start = __MIN(dst_data.getX() % 2, width);
+    const unsigned x_end   = x_start + (width - x_start) / 16 * 16;
+
+    if (x_end <= x_start ||
+        !BlendSSE2<TDstSSE2, TSrcSSE2, TConvertSSE2>(dst_data.getShifted(x_start),
+                                                      src_data.getShifted(x_start),
+                                                      x_end - x_start, height, alpha)) {
+        Blend<TDst, TSrc, TConvert>(dst_data, src_data, width, height, alpha);
+        return;
+    }
+    if (x_start > 0)
+        Blend<TDst, TSrc, TConvert>(dst_data, src_data, x_start, height, alpha);
+    if (x_end < width)
+        Blend<TDst, TSrc, TConvert>(dst_data.getShifted(x_end),
+                                    src_data.getShifted(x_end),
+                                    width - x_end, height, alpha);
+}
+#endif
+
 typedef void (*blend_function_t)(const CPicture &dst_data, const CPicture &src_data,
                                  unsigned width, unsigned height, int alpha);
 
-static const struct {
+struct blend_routine_t {
     vlc_fourcc_t     dst;
     vlc_fourcc_t     src;
     blend_function_t blend;
-} blends[] = {
+};
+
+static const blend_routine_t blends[] = {
 #undef RGB
 #undef YUV
 #define RGB(csp, picture, cvt) \
@@ -623,6 +1056,30 @@ static const struct {
 #undef YUV
 };
 
+#ifdef HAVE_SSE2_INTRINSICS
+static const blend_routine_t blends_sse2[] = {
+#define YUV(csp, picture, picture_sse2, cvt, cvt_sse2) \
+    { csp, VLC_CODEC_YUVA, Blend<picture, CPictureYUVA, compose<cvt, convertNone>, \
+                                 picture_sse2, CPictureYUVASSE2, compose<cvt_sse2, convertNoneSSE2> > }, \
+    { csp, VLC_CODEC_RGBA, Blend<picture, CPictureRGBA, compose<cvt, convertRgbToYuv8>, \
+                                 picture_sse2, CPictureRGBASSE2, compose<cvt_sse2, convertRgbToYuv8SSE2> > }
+
+    { VLC_CODEC_RGB32, VLC_CODEC_RGBA,
+      Blend<CPictureRGB32, CPictureRGBA, compose<convertNone, convertNone>,
+            CPictureRGB32SSE2, CPictureRGBASSE2, compose<convertNoneSSE2, convertNoneSSE2> > },
+
+    YUV(VLC_CODEC_YV12,     CPictureYV12,     CPictureYV12SSE2,     convertNone,      convertNoneSSE2),
+    YUV(VLC_CODEC_NV12,     CPictureNV12,     CPictureNV12SSE2,     convertNone,      convertNoneSSE2),
+    YUV(VLC_CODEC_NV21,     CPictureNV21,     CPictureNV21SSE2,     convertNone,      convertNoneSSE2),
+    YUV(VLC_CODEC_J420,     CPictureI420_8,   CPictureI420_8SSE2,   convertNone,      convertNoneSSE2),
+    YUV(VLC_CODEC_I420,     CPictureI420_8,   CPictureI420_8SSE2,   convertNone,      convertNoneSSE2),
+    YUV(VLC_CODEC_I420_9L,  CPictureI420_16,  CPictureI420_16SSE2,  convert8To9Bits,  convert8To9BitsSSE2),
+    YUV(VLC_CODEC_I420_10L, CPictureI420_16,  CPictureI420_16SSE2,  convert8To10Bits, convert8To10BitsSSE2),
+
+#undef YUV
+};
+#endif
+
 struct filter_sys_t {
     filter_sys_t() : blend(NULL)
     {
@@ -671,7 +1128,15 @@ static int Open(vlc_object_t *object)
     const vlc_fourcc_t dst = filter->fmt_out.video.i_chroma;
 
     filter_sys_t *sys = new filter_sys_t();
-    for (size_t i = 0; i < sizeof(blends) / sizeof(*blends); i++) {
+#ifdef HAVE_SSE2_INTRINSICS
+    if (vlc_CPU_SSE2()) {
+        for (size_t i = 0; i < sizeof(blends_sse2) / sizeof(*blends_sse2); i++) {
+            if (blends_sse2[i].src == src && blends_sse2[i].dst == dst)
+                sys->blend = blends_sse2[i].blend;
+        }
+    }
+#endif
+    for (size_t i = 0; !sys->blend && i < sizeof(blends) / sizeof(*blends); i++) {
         if (blends[i].src == src && blends[i].dst == dst)
             sys->blend = blends[i].blend;
     }
@@ -69,6 +69,19 @@ static picture_t *Filter( filter_t *, picture_t * );
 #define BLEND_CHROMA_LONGTEXT N_("Chroma which the blend image will be loaded" \
                                  " in")
 
+#define ALL_TEXT N_("Benchmark all chromas")
+#define ALL_LONGTEXT N_("Blend generated pictures for every pair of " \
+                        "chromas supported by the blending modules instead " \
+                        "of the base and blend images")
+
+#define WIDTH_TEXT N_("Width of the generated pictures")
+#define WIDTH_LONGTEXT N_("Width of the pictures generated when no image " \
+                          "is given")
+
+#define HEIGHT_TEXT N_("Height of the generated pictures")
+#define HEIGHT_LONGTEXT N_("Height of the pictures generated when no image " \
+                           "is given")
+
 #define CFG_PREFIX "blendbench-"
 
 vlc_module_begin ()
@@ -83,6 +96,11 @@ vlc_module_begin ()
               LOOPS_LONGTEXT, false )
     add_integer_with_range( CFG_PREFIX "alpha", 128, 0, 255, ALPHA_TEXT,
               ALPHA_LONGTEXT, false )
+    add_bool( CFG_PREFIX "all", false, ALL_TEXT, ALL_LONGTEXT, false )
+    add_integer_with_range( CFG_PREFIX "width", 1280, 16, 8192, WIDTH_TEXT,
+              WIDTH_LONGTEXT, false )
+    add_integer_with_range( CFG_PREFIX "height", 720, 16, 8192, HEIGHT_TEXT,
+              HEIGHT_LONGTEXT, false )
 
     set_section( N_("Base image"), NULL )
     add_loadfile( CFG_PREFIX "base-image", NULL, BASE_IMAGE_TEXT,
@@ -100,8 +118,39 @@ vlc_module_begin ()
 vlc_module_end ()
 
 static const char *const ppsz_filter_options[] = {
-    "loops", "alpha", "base-image", "base-chroma", "blend-image",
-    "blend-chroma", NULL
+    "loops", "alpha", "all", "width", "height", "base-image", "base-chroma",
+    "blend-image", "blend-chroma", NULL
+};
+
+/* Chromas handled by the blending modules */
+static const vlc_fourcc_t p_base_chromas[] = {
+    VLC_CODEC_RGB15, VLC_CODEC_RGB16, VLC_CODEC_RGB24, VLC_CODEC_RGB32,
+    VLC_CODEC_RGBA, VLC_CODEC_BGRA,
+    VLC_CODEC_YV9, VLC_CODEC_I410, VLC_CODEC_I411,
+    VLC_CODEC_YV12, VLC_CODEC_NV12, VLC_CODEC_NV21, VLC_CODEC_J420,
+    VLC_CODEC_I420,
+#ifdef WORDS_BIGENDIAN
+    VLC_CODEC_I420_9B, VLC_CODEC_I420_10B,
+#else
+    VLC_CODEC_I420_9L, VLC_CODEC_I420_10L,
+#endif
+    VLC_CODEC_J422, VLC_CODEC_I422,
+#ifdef WORDS_BIGENDIAN
+    VLC_CODEC_I422_9B, VLC_CODEC_I422_10B,
+#else
+    VLC_CODEC_I422_9L, VLC_CODEC_I422_10L,
+#endif
+    VLC_CODEC_J444, VLC_CODEC_I444,
+#ifdef WORDS_BIGENDIAN
+    VLC_CODEC_I444_9B, VLC_CODEC_I444_10B, VLC_CODEC_I444_16B,
+#else
+    VLC_CODEC_I444_9L, VLC_CODEC_I444_10L, VLC_CODEC_I444_16L,
+#endif
+    VLC_CODEC_YUYV, VLC_CODEC_UYVY, VLC_CODEC_YVYU, VLC_CODEC_VYUY,
+};
+
+static const vlc_fourcc_t p_blend_chromas[] = {
+    VLC_CODEC_YUVA, VLC_CODEC_RGBA, VLC_CODEC_YUVP,
 };
 
 /*****************************************************************************
@@ -110,13 +159,17 @@ static const char *const ppsz_filter_options[] = {
 struct filter_sys_t
 {
     bool b_done;
+    bool b_all;
     int i_loops, i_alpha;
+    int i_width, i_height;
 
     picture_t *p_base_image;
     picture_t *p_blend_image;
 
     vlc_fourcc_t i_base_chroma;
     vlc_fourcc_t i_blend_chroma;
+
+    video_palette_t palette;
 };
 
 static int blendbench_LoadImage( vlc_object_t *p_this, picture_t **pp_pic,
@@ -146,6 +199,121 @@ static int blendbench_LoadImage( vlc_object_t *p_this, picture_t **pp_pic,
     return VLC_SUCCESS;
 }
 
+/* Subtitle like coverage: a band of glyphs with anti-aliased edges at the
+ * bottom of the picture, and transparent elsewhere */
+static unsigned blendbench_Alpha( int x, int y, int i_width, int i_height )
+{
+    if( y < i_height * 3 / 4 || x < i_width / 8 || x >= i_width * 7 / 8 )
+        return 0;
+
+    unsigned i_stroke = (x * 7 + y * 3) % 32;
+    return i_stroke < 8 ? 255 : i_stroke < 10 ? 128 : 0;
+}
+
+static unsigned blendbench_Sample( vlc_fourcc_t i_chroma, int i_plane,
+                                   int x, int y, int i_width, int i_height )
+{
+    switch( i_chroma )
+    {
+        case VLC_CODEC_YUVA:
+            if( i_plane == A_PLANE )
+                return blendbench_Alpha( x, y, i_width, i_height );
+            break;
+        case VLC_CODEC_RGBA:
+            if( x % 4 == 3 )
+                return blendbench_Alpha( x / 4, y, i_width, i_height );
+            break;
+        case VLC_CODEC_YUVP:
+            return blendbench_Alpha( x, y, i_width, i_height ) ? 1 + x % 15 : 0;
+    }
+    return x + 2 * y + 64 * i_plane;
+}
+
+static picture_t *blendbench_NewPicture( filter_t *p_filter,
+                                         vlc_fourcc_t i_chroma )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    const vlc_chroma_description_t *p_dsc =
+        vlc_fourcc_GetChromaDescription( i_chroma );
+    video_format_t fmt;
+
+    video_format_Init( &fmt, i_chroma );
+    video_format_Setup( &fmt, i_chroma, p_sys->i_width, p_sys->i_height,
+                        p_sys->i_width, p_sys->i_height, 1, 1 );
+    if( i_chroma == VLC_CODEC_YUVP )
+        fmt.p_palette = &p_sys->palette;
+
+    picture_t *p_pic = picture_NewFromFormat( &fmt );
+    if( p_pic == NULL )
+        return NULL;
+
+    const bool b_16bits = p_dsc != NULL && p_dsc->pixel_size == 2;
+    const unsigned i_max = b_16bits ? (1 << p_dsc->pixel_bits) - 1 : 255;
+
+    for( int i = 0; i < p_pic->i_planes; i++ )
+    {
+        plane_t *p = &p_pic->p[i];
+
+        for( int y = 0; y < p->i_lines; y++ )
+        {
+            uint8_t *p_line = &p->p_pixels[y * p->i_pitch];
+
+            if( b_16bits )
+                for( int x = 0; x < p->i_pitch / 2; x++ )
+                    ((uint16_t *)p_line)[x] =
+                        4 * blendbench_Sample( i_chroma, i, x, y,
+                                               p->i_visible_pitch / 2,
+                                               p->i_visible_lines ) & i_max;
+            else
+                for( int x = 0; x < p->i_pitch; x++ )
+                    p_line[x] = blendbench_Sample( i_chroma, i, x, y,
+                                                   p->i_visible_pitch,
+                                                   p->i_visible_lines );
+        }
+    }
+    return p_pic;
+}
+
+static int blendbench_Blend( filter_t *p_filter,
+                             picture_t *p_base, picture_t *p_blend )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    filter_t *p_blender;
+
+    p_blender = vlc_object_create( p_filter, sizeof(filter_t) );
+    if( !p_blender )
+        return VLC_ENOMEM;
+    p_blender->fmt_out.video = p_base->format;
+    p_blender->fmt_in.video = p_blend->format;
+    p_blender->p_module = module_need( p_blender, "video blending", NULL, false );
+    if( !p_blender->p_module )
+    {
+        vlc_object_release( p_blender );
+        return VLC_EGENERIC;
+    }
+
+    mtime_t time = mdate();
+    for( int i_iter = 0; i_iter < p_sys->i_loops; ++i_iter )
+    {
+        p_blender->pf_video_blend( p_blender, p_base, p_blend,
+                                   0, 0, p_sys->i_alpha );
+    }
+    time = mdate() - time;
+
+    msg_Info( p_filter, "Blended %d %4.4s images onto %4.4s in %f sec",
+              p_sys->i_loops, (const char *)&p_blend->format.i_chroma,
+              (const char *)&p_base->format.i_chroma, time / 1000000.0f );
+    msg_Info( p_filter, "Speed is: %f images/second, %f pixels/second",
+              (float) p_sys->i_loops / time * 1000000,
+              (float) p_sys->i_loops / time * 1000000 *
+                  p_blend->format.i_visible_width *
+                  p_blend->format.i_visible_height );
+
+    module_unneed( p_blender, p_blender->p_module );
+    vlc_object_release( p_blender );
+    return VLC_SUCCESS;
+}
+
 /*****************************************************************************
  * Create: allocates video thread output method
  *****************************************************************************/
@@ -175,13 +343,41 @@ static int Create( vlc_object_t *p_this )
                                                   CFG_PREFIX "loops" );
     p_sys->i_alpha = var_CreateGetIntegerCommand( p_filter,
                                                   CFG_PREFIX "alpha" );
+    p_sys->b_all = var_CreateGetBoolCommand( p_filter, CFG_PREFIX "all" );
+    p_sys->i_width = var_CreateGetIntegerCommand( p_filter,
+                                                  CFG_PREFIX "width" );
+    p_sys->i_height = var_CreateGetIntegerCommand( p_filter,
+                                                   CFG_PREFIX "height" );
+    p_sys->p_base_image = NULL;
+    p_sys->p_blend_image = NULL;
+
+    /* Palette of the generated YUVP pictures: the first entry is
+     * transparent, the others are opaque or translucent colors */
+    p_sys->palette.i_entries = 16;
+    for( int i = 0; i < p_sys->palette.i_entries; i++ )
+    {
+        p_sys->palette.palette[i][0] = 16 + 13 * i;
+        p_sys->palette.palette[i][1] = 128 + 7 * i;
+        p_sys->palette.palette[i][2] = 128 - 7 * i;
+        p_sys->palette.palette[i][3] = i == 0 ? 0 : i % 4 ? 255 : 128;
+    }
+
+    if( p_sys->b_all )
+        return VLC_SUCCESS;
 
     psz_temp = var_CreateGetStringCommand( p_filter, CFG_PREFIX "base-chroma" );
     p_sys->i_base_chroma = !psz_temp || strlen( psz_temp ) != 4 ? 0 :
         VLC_FOURCC( psz_temp[0], psz_temp[1], psz_temp[2], psz_temp[3] );
     psz_cmd = var_CreateGetStringCommand( p_filter, CFG_PREFIX "base-image" );
-    i_ret = blendbench_LoadImage( p_this, &p_sys->p_base_image,
-                                  p_sys->i_base_chroma, psz_cmd, "Base" );
+    if( psz_cmd && *psz_cmd )
+        i_ret = blendbench_LoadImage( p_this, &p_sys->p_base_image,
+                                      p_sys->i_base_chroma, psz_cmd, "Base" );
+    else if( p_sys->i_base_chroma &&
+             (p_sys->p_base_image = blendbench_NewPicture( p_filter,
+                                                p_sys->i_base_chroma )) )
+        i_ret = VLC_SUCCESS;
+    else
+        i_ret = VLC_EGENERIC;
     free( psz_temp );
     free( psz_cmd );
     if( i_ret != VLC_SUCCESS )
@@ -195,8 +391,15 @@ static int Create( vlc_object_t *p_this )
     p_sys->i_blend_chroma = !psz_temp || strlen( psz_temp ) != 4
         ? 0 : VLC_FOURCC( psz_temp[0], psz_temp[1], psz_temp[2], psz_temp[3] );
     psz_cmd = var_CreateGetStringCommand( p_filter, CFG_PREFIX "blend-image" );
-    i_ret = blendbench_LoadImage( p_this, &p_sys->p_blend_image, p_sys->i_blend_chroma,
-                                  psz_cmd, "Blend" );
+    if( psz_cmd && *psz_cmd )
+        i_ret = blendbench_LoadImage( p_this, &p_sys->p_blend_image,
+                                      p_sys->i_blend_chroma, psz_cmd, "Blend" );
+    else if( p_sys->i_blend_chroma &&
+             (p_sys->p_blend_image = blendbench_NewPicture( p_filter,
+                                                p_sys->i_blend_chroma )) )
+        i_ret = VLC_SUCCESS;
+    else
+        i_ret = VLC_EGENERIC;
 
     free( psz_temp );
     free( psz_cmd );
@@ -220,8 +423,11 @@ static void Destroy( vlc_object_t *p_this )
     filter_t *p_filter = (filter_t *)p_this;
     filter_sys_t *p_sys = p_filter->p_sys;
 
-    picture_Release( p_sys->p_base_image );
-    picture_Release( p_sys->p_blend_image );
+    if( p_sys->p_base_image )
+        picture_Release( p_sys->p_base_image );
+    if( p_sys->p_blend_image )
+        picture_Release( p_sys->p_blend_image );
+    free( p_sys );
 }
 
 /*****************************************************************************
@@ -230,47 +436,40 @@ static void Destroy( vlc_object_t *p_this )
 static picture_t *Filter( filter_t *p_filter, picture_t *p_pic )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
-    filter_t *p_blend;
 
     if( p_sys->b_done )
         return p_pic;
 
-    p_blend = vlc_object_create( p_filter, sizeof(filter_t) );
-    if( !p_blend )
+    if( !p_sys->b_all )
     {
-        picture_Release( p_pic );
-        return NULL;
-    }
-    p_blend->fmt_out.video = p_sys->p_base_image->format;
-    p_blend->fmt_in.video = p_sys->p_blend_image->format;
-    p_blend->p_module = module_need( p_blend, "video blending", NULL, false );
-    if( !p_blend->p_module )
-    {
-        picture_Release( p_pic );
-        vlc_object_release( p_blend );
-        return NULL;
-    }
-
-    mtime_t time = mdate();
-    for( int i_iter = 0; i_iter < p_sys->i_loops; ++i_iter )
-    {
-        p_blend->pf_video_blend( p_blend,
-                                 p_sys->p_base_image, p_sys->p_blend_image,
-                                 0, 0, p_sys->i_alpha );
+        if( blendbench_Blend( p_filter, p_sys->p_base_image,
+                              p_sys->p_blend_image ) != VLC_SUCCESS )
+        {
+            picture_Release( p_pic );
+            return NULL;
+        }
+        p_sys->b_done = true;
+        return p_pic;
     }
-    time = mdate() - time;
-
-    msg_Info( p_filter, "Blended %d images in %f sec", p_sys->i_loops,
-              time / 1000000.0f );
-    msg_Info( p_filter, "Speed is: %f images/second, %f pixels/second",
-              (float) p_sys->i_loops / time * 1000000,
-              (float) p_sys->i_loops / time * 1000000 *
-                  p_sys->p_blend_image->p[Y_PLANE].i_visible_pitch *
-                  p_sys->p_blend_image->p[Y_PLANE].i_visible_lines );
-
-    module_unneed( p_blend, p_blend->p_module );
 
-    vlc_object_release( p_blend );
+    for( size_t i = 0; i < ARRAY_SIZE(p_base_chromas); i++ )
+        for( size_t j = 0; j < ARRAY_SIZE(p_blend_chromas); j++ )
+        {
+            picture_t *p_base = blendbench_NewPicture( p_filter,
+                                                       p_base_chromas[i] );
+            picture_t *p_blend = blendbench_NewPicture( p_filter,
+                                                        p_blend_chromas[j] );
+
+            if( p_base == NULL || p_blend == NULL ||
+                blendbench_Blend( p_filter, p_base, p_blend ) != VLC_SUCCESS )
+                msg_Warn( p_filter, "Cannot blend %4.4s images onto %4.4s",
+                          (const char *)&p_blend_chromas[j],
+                          (const char *)&p_base_chromas[i] );
+            if( p_base )
+                picture_Release( p_base );
+            if( p_blend )
+                picture_Release( p_blend );
+        }
 
     p_sys->b_done = true;
     return p_pic;
@@ -30,6 +30,10 @@
 #   include <stdalign.h>
 #endif
 
+#ifdef HAVE_AVX2_INTRINSICS
+#   include <immintrin.h>
+#endif
+
 #include <stdint.h>
 #include <assert.h>
 
@@ -272,6 +276,99 @@ static void DarkenFieldMMX( picture_t *p_dst,
 }
 #endif
 
+#ifdef HAVE_AVX2_INTRINSICS
+VLC_AVX2
+static void DarkenFieldAVX2( picture_t *p_dst,
+                             const int i_field, const int i_strength,
+                             bool process_chroma )
+{
+    assert( p_dst != NULL );
+    assert( i_field == 0 || i_field == 1 );
+    assert( i_strength >= 1 && i_strength <= 3 );
+
+    const uint8_t  remove_high_u8 = 0xFF >> i_strength;
+    const __m128i  strength = _mm_cvtsi32_si128( i_strength );
+    const __m256i  remove_high = _mm256_set1_epi8( remove_high_u8 );
+    const __m256i  b128 = _mm256_set1_epi8( (char)128 );
+
+    int i_plane = Y_PLANE;
+    uint8_t *p_out, *p_out_end;
+    int w = p_dst->p[i_plane].i_visible_pitch;
+    p_out = p_dst->p[i_plane].p_pixels;
+    p_out_end = p_out + p_dst->p[i_plane].i_pitch
+                      * p_dst->p[i_plane].i_visible_lines;
+
+    /* skip first line for bottom field */
+    if( i_field == 1 )
+        p_out += p_dst->p[i_plane].i_pitch;
+
+    for( ; p_out < p_out_end ; p_out += 2*p_dst->p[i_plane].i_pitch )
+    {
+        int x = 0;
+
+        for( ; x + 32 <= w; x += 32 )
+        {
+            __m256i *po = (__m256i *)&p_out[x];
+            __m256i data = _mm256_loadu_si256( po );
+
+            data = _mm256_srl_epi16( data, strength );
+            _mm256_storeu_si256( po, _mm256_and_si256( data, remove_high ) );
+        }
+
+        /* handle the width remainder */
+        for( ; x < w; ++x )
+            p_out[x] = ( (p_out[x] >> i_strength) & remove_high_u8 );
+    }
+
+    /* Process chroma if the field chromas are independent.
+
+       The origin (black) is at YUV = (0, 128, 128) in the uint8 format.
+       As in the MMX version, the positive and negative parts are shifted
+       separately, which rounds towards zero like the C division.
+    */
+    if( process_chroma )
+    {
+        for( i_plane++ /* luma already handled */;
+             i_plane < p_dst->i_planes;
+             i_plane++ )
+        {
+            w = p_dst->p[i_plane].i_visible_pitch;
+            p_out = p_dst->p[i_plane].p_pixels;
+            p_out_end = p_out + p_dst->p[i_plane].i_pitch
+                              * p_dst->p[i_plane].i_visible_lines;
+
+            /* skip first line for bottom field */
+            if( i_field == 1 )
+                p_out += p_dst->p[i_plane].i_pitch;
+
+            for( ; p_out < p_out_end ; p_out += 2*p_dst->p[i_plane].i_pitch )
+            {
+                int x = 0;
+
+                for( ; x + 32 <= w; x += 32 )
+                {
+                    __m256i *po = (__m256i *)&p_out[x];
+                    __m256i data = _mm256_loadu_si256( po );
+                    __m256i pos = _mm256_subs_epu8( data, b128 );
+                    __m256i neg = _mm256_subs_epu8( b128, data );
+
+                    pos = _mm256_and_si256( _mm256_srl_epi16( pos, strength ),
+                                            remove_high );
+                    neg = _mm256_and_si256( _mm256_srl_epi16( neg, strength ),
+                                            remove_high );
+                    data = _mm256_add_epi8( _mm256_sub_epi8( pos, neg ), b128 );
+                    _mm256_storeu_si256( po, data );
+                }
+
+                /* C version - handle the width remainder */
+                for( ; x < w; ++x )
+                    p_out[x] = 128 + ( (p_out[x] - 128) / (1 << i_strength) );
+            } /* for p_out... */
+        } /* for i_plane... */
+    } /* if process_chroma */
+}
+#endif
+
 /*****************************************************************************
  * Public functions
  *****************************************************************************/
@@ -358,6 +455,13 @@ int RenderPhosphor( filter_t *p_filter,
     */
     if( p_sys->phosphor.i_dimmer_strength > 0 )
     {
+#ifdef HAVE_AVX2_INTRINSICS
+        if( vlc_CPU_AVX2() )
+            DarkenFieldAVX2( p_dst, !i_field, p_sys->phosphor.i_dimmer_strength,
+                p_sys->chroma->p[1].h.num == p_sys->chroma->p[1].h.den &&
+                p_sys->chroma->p[2].h.num == p_sys->chroma->p[2].h.den );
+        else
+#endif
 #ifdef CAN_COMPILE_MMXEXT
         if( vlc_CPU_MMXEXT() )
             DarkenFieldMMX( p_dst, !i_field, p_sys->phosphor.i_dimmer_strength,
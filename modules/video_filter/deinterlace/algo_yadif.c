@@ -47,6 +47,82 @@
    Necessary preprocessor macros are defined in common.h. */
 #include "yadif.h"
 
+typedef struct
+{
+    picture_t *p_dst;
+    const picture_t *p_prev;
+    const picture_t *p_cur;
+    const picture_t *p_next;
+    int i_field;
+    int i_parity;
+    void (*filter)(uint8_t *dst, uint8_t *prev, uint8_t *cur, uint8_t *next,
+                   int w, int prefs, int mrefs, int parity, int mode);
+} yadif_slice_t;
+
+static void RenderYadifSlice( filter_t *p_filter, void *opaque,
+                              unsigned i_slice, unsigned i_slices )
+{
+    const yadif_slice_t *ctx = opaque;
+    const int i_field = ctx->i_field;
+    const int yadif_parity = ctx->i_parity;
+
+    VLC_UNUSED(p_filter);
+
+    for( int n = 0; n < ctx->p_dst->i_planes; n++ )
+    {
+        const plane_t *prevp = &ctx->p_prev->p[n];
+        const plane_t *curp  = &ctx->p_cur->p[n];
+        const plane_t *nextp = &ctx->p_next->p[n];
+        plane_t *dstp        = &ctx->p_dst->p[n];
+        int y_first, y_last;
+
+        /* The first and last lines are duplicated from their neighbour */
+        filter_GetSliceLines( i_slice, i_slices, dstp->i_visible_lines - 2,
+                              &y_first, &y_last );
+
+        for( int y = 1 + y_first; y < 1 + y_last; y++ )
+        {
+            if( (y % 2) == i_field  ||  yadif_parity == 2 )
+            {
+                memcpy( &dstp->p_pixels[y * dstp->i_pitch],
+                            &curp->p_pixels[y * curp->i_pitch], dstp->i_visible_pitch );
+            }
+            else
+            {
+                int mode;
+                /* Spatial checks only when enough data */
+                mode = (y >= 2 && y < dstp->i_visible_lines - 2) ? 0 : 2;
+
+                assert( prevp->i_pitch == curp->i_pitch && curp->i_pitch == nextp->i_pitch );
+                ctx->filter( &dstp->p_pixels[y * dstp->i_pitch],
+                             &prevp->p_pixels[y * prevp->i_pitch],
+                             &curp->p_pixels[y * curp->i_pitch],
+                             &nextp->p_pixels[y * nextp->i_pitch],
+                             dstp->i_visible_pitch,
+                             y < dstp->i_visible_lines - 2  ? curp->i_pitch : -curp->i_pitch,
+                             y  - 1  ?  -curp->i_pitch : curp->i_pitch,
+                             yadif_parity,
+                             mode );
+            }
+
+            /* We duplicate the first and last lines */
+            if( y == 1 )
+                memcpy(&dstp->p_pixels[(y-1) * dstp->i_pitch],
+                           &dstp->p_pixels[ y    * dstp->i_pitch],
+                           dstp->i_pitch);
+            else if( y == dstp->i_visible_lines - 2 )
+                memcpy(&dstp->p_pixels[(y+1) * dstp->i_pitch],
+                           &dstp->p_pixels[ y    * dstp->i_pitch],
+                           dstp->i_pitch);
+        }
+    }
+#if defined(HAVE_YADIF_MMX)
+    /* The slice may have run on a thread shared with other filters */
+    if( ctx->filter == yadif_filter_line_mmx )
+        __asm__ __volatile__ ("emms");
+#endif
+}
+
 int RenderYadifSingle( filter_t *p_filter, picture_t *p_dst, picture_t *p_src )
 {
     return RenderYadif( p_filter, p_dst, p_src, 0, 0 );
@@ -109,73 +185,43 @@ int RenderYadif( filter_t *p_filter, picture_t *p_dst, picture_t *p_src,
     /* Filter if we have all the pictures we need */
     if( p_prev && p_cur && p_next )
     {
-        /* */
-        void (*filter)(uint8_t *dst, uint8_t *prev, uint8_t *cur, uint8_t *next,
-                       int w, int prefs, int mrefs, int parity, int mode);
-
+        yadif_slice_t ctx = {
+            .p_dst = p_dst,
+            .p_prev = p_prev,
+            .p_cur = p_cur,
+            .p_next = p_next,
+            .i_field = i_field,
+            .i_parity = yadif_parity,
+        };
+
+#if defined(HAVE_YADIF_AVX2)
+        if( vlc_CPU_AVX2() )
+            ctx.filter = yadif_filter_line_avx2;
+        else
+#endif
 #if defined(HAVE_YADIF_SSSE3)
         if( vlc_CPU_SSSE3() )
-            filter = yadif_filter_line_ssse3;
+            ctx.filter = yadif_filter_line_ssse3;
         else
 #endif
 #if defined(HAVE_YADIF_SSE2)
         if( vlc_CPU_SSE2() )
-            filter = yadif_filter_line_sse2;
+            ctx.filter = yadif_filter_line_sse2;
         else
 #endif
 #if defined(HAVE_YADIF_MMX)
         if( vlc_CPU_MMX() )
-            filter = yadif_filter_line_mmx;
+            ctx.filter = yadif_filter_line_mmx;
         else
 #endif
-            filter = yadif_filter_line_c;
+            ctx.filter = yadif_filter_line_c;
 
         if( p_sys->chroma->pixel_size == 2 )
-            filter = yadif_filter_line_c_16bit;
-
-        for( int n = 0; n < p_dst->i_planes; n++ )
-        {
-            const plane_t *prevp = &p_prev->p[n];
-            const plane_t *curp  = &p_cur->p[n];
-            const plane_t *nextp = &p_next->p[n];
-            plane_t *dstp        = &p_dst->p[n];
+            ctx.filter = yadif_filter_line_c_16bit;
 
-            for( int y = 1; y < dstp->i_visible_lines - 1; y++ )
-            {
-                if( (y % 2) == i_field  ||  yadif_parity == 2 )
-                {
-                    memcpy( &dstp->p_pixels[y * dstp->i_pitch],
-                                &curp->p_pixels[y * curp->i_pitch], dstp->i_visible_pitch );
-                }
-                else
-                {
-                    int mode;
-                    /* Spatial checks only when enough data */
-                    mode = (y >= 2 && y < dstp->i_visible_lines - 2) ? 0 : 2;
-
-                    assert( prevp->i_pitch == curp->i_pitch && curp->i_pitch == nextp->i_pitch );
-                    filter( &dstp->p_pixels[y * dstp->i_pitch],
-                            &prevp->p_pixels[y * prevp->i_pitch],
-                            &curp->p_pixels[y * curp->i_pitch],
-                            &nextp->p_pixels[y * nextp->i_pitch],
-                            dstp->i_visible_pitch,
-                            y < dstp->i_visible_lines - 2  ? curp->i_pitch : -curp->i_pitch,
-                            y  - 1  ?  -curp->i_pitch : curp->i_pitch,
-                            yadif_parity,
-                            mode );
-                }
-
-                /* We duplicate the first and last lines */
-                if( y == 1 )
-                    memcpy(&dstp->p_pixels[(y-1) * dstp->i_pitch],
-                               &dstp->p_pixels[ y    * dstp->i_pitch],
-                               dstp->i_pitch);
-                else if( y == dstp->i_visible_lines - 2 )
-                    memcpy(&dstp->p_pixels[(y+1) * dstp->i_pitch],
-                               &dstp->p_pixels[ y    * dstp->i_pitch],
-                               dstp->i_pitch);
-            }
-        }
+        /* Each line only depends on the history pictures */
+        filter_RunSlices( p_filter, p_dst->p[0].i_visible_lines / 16,
+                          RenderYadifSlice, &ctx );
 
         p_sys->context.i_frame_offset = 1; /* p_cur will be rendered at next frame, too */
 
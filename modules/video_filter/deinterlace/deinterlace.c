@@ -332,6 +332,14 @@ notsupp:
         p_sys->pf_merge = MergeAltivec;
     else
 #endif
+#if defined(HAVE_AVX2_INTRINSICS)
+    if( vlc_CPU_AVX2() )
+    {
+        p_sys->pf_merge = pixel_size == 1 ? Merge8BitAVX2 : Merge16BitAVX2;
+        p_sys->pf_end_merge = NULL;
+    }
+    else
+#endif
 #if defined(CAN_COMPILE_SSE2)
     if( vlc_CPU_SSE2() )
     {
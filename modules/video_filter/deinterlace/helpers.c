@@ -30,6 +30,11 @@
 #   include <stdalign.h>
 #endif
 
+#ifdef HAVE_AVX2_INTRINSICS
+#   include <immintrin.h>
+#   include <stdalign.h>
+#endif
+
 #include <stdint.h>
 #include <assert.h>
 
@@ -246,6 +251,74 @@ static int TestForMotionInBlockMMX( uint8_t *p_pix_p, uint8_t *p_pix_c,
     return (i_motion >= 8);
 }
 #endif
+
+#ifdef HAVE_AVX2_INTRINSICS
+/**
+ * Internal helper function for EstimateNumBlocksWithMotion():
+ * AVX2 version of TestForMotionInBlock() for four horizontally adjacent
+ * 8x8 blocks. The results are the sums of those of the four blocks.
+ *
+ * @param[in] p_pix_p Base pointer to the first block in previous picture
+ * @param[in] p_pix_c Base pointer to the same block in current picture
+ * @param i_pitch_prev i_pitch of previous picture
+ * @param i_pitch_curr i_pitch of current picture
+ * @param[out] pi_top Number of blocks whose top field had motion
+ * @param[out] pi_bot Number of blocks whose bottom field had motion
+ * @return Number of blocks that had motion
+ * @see TestForMotionInBlock()
+ */
+VLC_AVX2
+static int TestForMotionIn4BlocksAVX2( uint8_t *p_pix_p, uint8_t *p_pix_c,
+                                       int i_pitch_prev, int i_pitch_curr,
+                                       int* pi_top, int* pi_bot )
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i thr  = _mm256_set1_epi8( T + 1 );
+    __m256i top = zero;
+    __m256i bot = zero;
+
+    for( int y = 0; y < 8; ++y )
+    {
+        __m256i c = _mm256_loadu_si256( (const __m256i *)p_pix_c );
+        __m256i p = _mm256_loadu_si256( (const __m256i *)p_pix_p );
+        __m256i diff = _mm256_or_si256( _mm256_subs_epu8( c, p ),
+                                        _mm256_subs_epu8( p, c ) );
+        /* 0xFF where abs(C - P) > T, psadbw then counts score * 255
+           for each 8 pixels, i.e. for each block */
+        __m256i moved = _mm256_cmpeq_epi8( _mm256_max_epu8( diff, thr ),
+                                           diff );
+        __m256i score = _mm256_sad_epu8( moved, zero );
+
+        if( y % 2 == 0 )
+            top = _mm256_add_epi64( top, score );
+        else
+            bot = _mm256_add_epi64( bot, score );
+
+        p_pix_c += i_pitch_curr;
+        p_pix_p += i_pitch_prev;
+    }
+
+    alignas (32) uint64_t top_motion[4];
+    alignas (32) uint64_t bot_motion[4];
+    _mm256_store_si256( (__m256i *)top_motion, top );
+    _mm256_store_si256( (__m256i *)bot_motion, bot );
+
+    int i_motion = 0;
+    (*pi_top) = 0;
+    (*pi_bot) = 0;
+    for( int i = 0; i < 4; i++ )
+    {
+        /* Same thresholds as TestForMotionInBlock() */
+        int i_top_motion = top_motion[i] / 255;
+        int i_bot_motion = bot_motion[i] / 255;
+
+        (*pi_top) += ( i_top_motion >= 8 );
+        (*pi_bot) += ( i_bot_motion >= 8 );
+        i_motion  += ( i_top_motion + i_bot_motion >= 8 );
+    }
+    return i_motion;
+}
+#endif
 #undef T
 
 /*****************************************************************************
@@ -400,6 +473,9 @@ int EstimateNumBlocksWithMotion( const picture_t* p_prev,
     if (vlc_CPU_MMXEXT())
         motion_in_block = TestForMotionInBlockMMX;
 #endif
+#ifdef HAVE_AVX2_INTRINSICS
+    const bool b_avx2 = vlc_CPU_AVX2();
+#endif
 
     int i_score = 0;
     for( int i_plane = 0 ; i_plane < p_prev->i_planes ; i_plane++ )
@@ -424,7 +500,23 @@ int EstimateNumBlocksWithMotion( const picture_t* p_prev,
             uint8_t *p_pix_p = &p_prev->p[i_plane].p_pixels[i_pitch_prev*8*by];
             uint8_t *p_pix_c = &p_curr->p[i_plane].p_pixels[i_pitch_curr*8*by];
 
-            for( int bx = 0; bx < i_mbx; ++bx )
+            int bx = 0;
+#ifdef HAVE_AVX2_INTRINSICS
+            if( b_avx2 )
+                for( ; bx + 4 <= i_mbx; bx += 4 )
+                {
+                    int i_top_temp, i_bot_temp;
+                    i_score += TestForMotionIn4BlocksAVX2( p_pix_p, p_pix_c,
+                                                 i_pitch_prev, i_pitch_curr,
+                                                 &i_top_temp, &i_bot_temp );
+                    i_score_top += i_top_temp;
+                    i_score_bot += i_bot_temp;
+
+                    p_pix_p += 32;
+                    p_pix_c += 32;
+                }
+#endif
+            for( ; bx < i_mbx; ++bx )
             {
                 int i_top_temp, i_bot_temp;
                 i_score += motion_in_block( p_pix_p, p_pix_c,
@@ -450,6 +542,99 @@ int EstimateNumBlocksWithMotion( const picture_t* p_prev,
 /* Threshold (value from Transcode 1.1.5) */
 #define T 100
 
+/**
+ * Internal helper function for CalculateInterlaceScore():
+ * counts the combed pixels of one line.
+ *
+ * @param p_c Line to test
+ * @param p_p Previous line, from the other field
+ * @param p_n Next line, from the other field
+ * @param w Number of pixels to test
+ * @return Number of pixels that look interlaced
+ * @see CalculateInterlaceScore()
+ */
+static int CalculateInterlaceLineScore( const uint8_t *p_c,
+                                        const uint8_t *p_p,
+                                        const uint8_t *p_n, int w )
+{
+    int i_score = 0;
+
+    for( int x = 0; x < w; ++x )
+    {
+        /* Worst case: need 17 bits for "comb". */
+        int_fast32_t C = *p_c;
+        int_fast32_t P = *p_p;
+        int_fast32_t N = *p_n;
+
+        /* Comments in Transcode's filter_ivtc.c attribute this
+           combing metric to Gunnar Thalin.
+
+            The idea is that if the picture is interlaced, both
+            expressions will have the same sign, and this comes
+            up positive. The value T = 100 has been chosen such
+            that a pixel difference of 10 (on average) will
+            trigger the detector.
+        */
+        int_fast32_t comb = (P - C) * (N - C);
+        if( comb > T )
+            ++i_score;
+
+        ++p_c;
+        ++p_p;
+        ++p_n;
+    }
+    return i_score;
+}
+
+#ifdef HAVE_AVX2_INTRINSICS
+/**
+ * Internal helper function for CalculateInterlaceScore():
+ * AVX2 version of CalculateInterlaceLineScore().
+ *
+ * Unlike the MMX version, the score is exactly that of the C version.
+ *
+ * @see CalculateInterlaceLineScore()
+ */
+VLC_AVX2
+static int CalculateInterlaceLineScoreAVX2( const uint8_t *p_c,
+                                            const uint8_t *p_p,
+                                            const uint8_t *p_n, int w )
+{
+    const __m256i thr = _mm256_set1_epi16( T + 1 );
+    const __m256i minus1 = _mm256_set1_epi16( -1 );
+    int i_score = 0;
+    int x = 0;
+
+    for( ; x + 16 <= w; x += 16 )
+    {
+        __m256i C = _mm256_cvtepu8_epi16(
+                        _mm_loadu_si128( (const __m128i *)&p_c[x] ) );
+        __m256i P = _mm256_cvtepu8_epi16(
+                        _mm_loadu_si128( (const __m128i *)&p_p[x] ) );
+        __m256i N = _mm256_cvtepu8_epi16(
+                        _mm_loadu_si128( (const __m128i *)&p_n[x] ) );
+        __m256i pc = _mm256_sub_epi16( P, C );
+        __m256i nc = _mm256_sub_epi16( N, C );
+
+        /* abs(P - C) * abs(N - C) < 65536, so the unsigned product fits in
+           16 bits; "comb" is that product if both differences have the
+           same sign, and is <= 0 otherwise. */
+        __m256i comb = _mm256_mullo_epi16( _mm256_abs_epi16( pc ),
+                                           _mm256_abs_epi16( nc ) );
+        __m256i above = _mm256_cmpeq_epi16( _mm256_max_epu16( comb, thr ),
+                                            comb );
+        __m256i same_sign = _mm256_cmpgt_epi16(
+                                _mm256_xor_si256( pc, nc ), minus1 );
+        __m256i mask = _mm256_and_si256( above, same_sign );
+
+        i_score += popcount( _mm256_movemask_epi8( mask ) ) / 2;
+    }
+
+    return i_score + CalculateInterlaceLineScore( &p_c[x], &p_p[x], &p_n[x],
+                                                  w - x );
+}
+#endif
+
 #ifdef CAN_COMPILE_MMXEXT
 VLC_MMX
 static int CalculateInterlaceScoreMMX( const picture_t* p_pic_top,
@@ -606,10 +791,19 @@ int CalculateInterlaceScore( const picture_t* p_pic_top,
     if( p_pic_top->i_planes != p_pic_bot->i_planes )
         return -1;
 
+    int (*line_score)( const uint8_t *, const uint8_t *, const uint8_t *,
+                       int );
+#ifdef HAVE_AVX2_INTRINSICS
+    if( vlc_CPU_AVX2() )
+        line_score = CalculateInterlaceLineScoreAVX2;
+    else
+#endif
 #ifdef CAN_COMPILE_MMXEXT
     if (vlc_CPU_MMXEXT())
         return CalculateInterlaceScoreMMX( p_pic_top, p_pic_bot );
+    else
 #endif
+        line_score = CalculateInterlaceLineScore;
 
     int32_t i_score = 0;
 
@@ -640,30 +834,7 @@ int CalculateInterlaceScore( const picture_t* p_pic_top,
             uint8_t *p_p = &ngh->p[i_plane].p_pixels[(y-1)*wn]; /* prev line */
             uint8_t *p_n = &ngh->p[i_plane].p_pixels[(y+1)*wn]; /* next line */
 
-            for( int x = 0; x < w; ++x )
-            {
-                /* Worst case: need 17 bits for "comb". */
-                int_fast32_t C = *p_c;
-                int_fast32_t P = *p_p;
-                int_fast32_t N = *p_n;
-
-                /* Comments in Transcode's filter_ivtc.c attribute this
-                   combing metric to Gunnar Thalin.
-
-                    The idea is that if the picture is interlaced, both
-                    expressions will have the same sign, and this comes
-                    up positive. The value T = 100 has been chosen such
-                    that a pixel difference of 10 (on average) will
-                    trigger the detector.
-                */
-                int_fast32_t comb = (P - C) * (N - C);
-                if( comb > T )
-                    ++i_score;
-
-                ++p_c;
-                ++p_p;
-                ++p_n;
-            }
+            i_score += line_score( p_c, p_p, p_n, w );
 
             /* Now the other field - swap current and neighbour pictures */
             const picture_t *tmp = cur;
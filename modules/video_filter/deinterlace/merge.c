@@ -42,6 +42,10 @@
 #   include <altivec.h>
 #endif
 
+#ifdef HAVE_AVX2_INTRINSICS
+#   include <immintrin.h>
+#endif
+
 /*****************************************************************************
  * Merge (line blending) routines
  *****************************************************************************/
@@ -178,6 +182,62 @@ void Merge16BitSSE2( void *_p_dest, const void *_p_s1, const void *_p_s2,
 
 #endif
 
+#if defined(HAVE_AVX2_INTRINSICS)
+VLC_AVX2
+void Merge8BitAVX2( void *_p_dest, const void *_p_s1, const void *_p_s2,
+                    size_t i_bytes )
+{
+    uint8_t *p_dest = _p_dest;
+    const uint8_t *p_s1 = _p_s1;
+    const uint8_t *p_s2 = _p_s2;
+    const __m256i one = _mm256_set1_epi8( 1 );
+
+    for( ; i_bytes >= 32; i_bytes -= 32 )
+    {
+        __m256i a = _mm256_loadu_si256( (const __m256i *)p_s1 );
+        __m256i b = _mm256_loadu_si256( (const __m256i *)p_s2 );
+        /* pavgb rounds up: (a + b + 1) >> 1, remove the carry */
+        __m256i carry = _mm256_and_si256( _mm256_xor_si256( a, b ), one );
+
+        _mm256_storeu_si256( (__m256i *)p_dest,
+                             _mm256_sub_epi8( _mm256_avg_epu8( a, b ), carry ) );
+        p_dest += 32;
+        p_s1 += 32;
+        p_s2 += 32;
+    }
+
+    for( ; i_bytes > 0; i_bytes-- )
+        *p_dest++ = ( *p_s1++ + *p_s2++ ) >> 1;
+}
+
+VLC_AVX2
+void Merge16BitAVX2( void *_p_dest, const void *_p_s1, const void *_p_s2,
+                     size_t i_bytes )
+{
+    uint16_t *p_dest = _p_dest;
+    const uint16_t *p_s1 = _p_s1;
+    const uint16_t *p_s2 = _p_s2;
+    const __m256i one = _mm256_set1_epi16( 1 );
+
+    size_t i_words = i_bytes / 2;
+    for( ; i_words >= 16; i_words -= 16 )
+    {
+        __m256i a = _mm256_loadu_si256( (const __m256i *)p_s1 );
+        __m256i b = _mm256_loadu_si256( (const __m256i *)p_s2 );
+        __m256i carry = _mm256_and_si256( _mm256_xor_si256( a, b ), one );
+
+        _mm256_storeu_si256( (__m256i *)p_dest,
+                             _mm256_sub_epi16( _mm256_avg_epu16( a, b ), carry ) );
+        p_dest += 16;
+        p_s1 += 16;
+        p_s2 += 16;
+    }
+
+    for( ; i_words > 0; i_words-- )
+        *p_dest++ = ( *p_s1++ + *p_s2++ ) >> 1;
+}
+#endif
+
 #ifdef CAN_COMPILE_C_ALTIVEC
 void MergeAltivec( void *_p_dest, const void *_p_s1,
                    const void *_p_s2, size_t i_bytes )
@@ -147,3 +147,117 @@ static void yadif_filter_line_c_16bit(uint16_t *dst, uint16_t *prev, uint16_t *c
     prefs /= 2;
     FILTER
 }
+
+#ifdef HAVE_AVX2_INTRINSICS
+// ================= AVX2 =================
+#define HAVE_YADIF_AVX2
+#include <immintrin.h>
+
+/* Loads 16 pixels, widened to 16 bits */
+#define LOAD16(p) _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(p)))
+#define ABSDIFF(a,b) _mm256_abs_epi16(_mm256_sub_epi16(a, b))
+
+VLC_AVX2
+static inline __m256i yadif_check_avx2(const uint8_t *cur, int prefs, int mrefs,
+                                       int j, __m256i *pred)
+{
+    *pred = _mm256_srli_epi16(_mm256_add_epi16(LOAD16(&cur[mrefs  +j]),
+                                               LOAD16(&cur[prefs  -j])), 1);
+    return _mm256_add_epi16(_mm256_add_epi16(
+                ABSDIFF(LOAD16(&cur[mrefs-1+j]), LOAD16(&cur[prefs-1-j])),
+                ABSDIFF(LOAD16(&cur[mrefs  +j]), LOAD16(&cur[prefs  -j]))),
+                ABSDIFF(LOAD16(&cur[mrefs+1+j]), LOAD16(&cur[prefs+1-j])));
+}
+
+/* Same as the C FILTER, 16 pixels at a time: the result is bit-exact */
+VLC_AVX2
+static void yadif_filter_line_avx2(uint8_t *dst, uint8_t *prev, uint8_t *cur, uint8_t *next, int w, int prefs, int mrefs, int parity, int mode)
+{
+    uint8_t *prev2= parity ? prev : cur ;
+    uint8_t *next2= parity ? cur  : next;
+    const __m256i one = _mm256_set1_epi16(1);
+    int x;
+
+#define CHECK_AVX2(j, mask) \
+    { \
+        __m256i pred; \
+        __m256i score = yadif_check_avx2(cur, prefs, mrefs, j, &pred); \
+        mask = _mm256_and_si256(mask, _mm256_cmpgt_epi16(spatial_score, score)); \
+        spatial_score = _mm256_blendv_epi8(spatial_score, score, mask); \
+        spatial_pred  = _mm256_blendv_epi8(spatial_pred, pred, mask); \
+    }
+
+    for (x = 0; x + 16 <= w; x += 16) {
+        __m256i c = LOAD16(&cur[mrefs]);
+        __m256i e = LOAD16(&cur[prefs]);
+        __m256i p2 = LOAD16(prev2);
+        __m256i n2 = LOAD16(next2);
+        __m256i d = _mm256_srli_epi16(_mm256_add_epi16(p2, n2), 1);
+        __m256i temporal_diff0 = ABSDIFF(p2, n2);
+        __m256i temporal_diff1 = _mm256_srli_epi16(_mm256_add_epi16(
+                    ABSDIFF(LOAD16(&prev[mrefs]), c),
+                    ABSDIFF(LOAD16(&prev[prefs]), e)), 1);
+        __m256i temporal_diff2 = _mm256_srli_epi16(_mm256_add_epi16(
+                    ABSDIFF(LOAD16(&next[mrefs]), c),
+                    ABSDIFF(LOAD16(&next[prefs]), e)), 1);
+        __m256i diff = _mm256_max_epi16(_mm256_max_epi16(
+                    _mm256_srli_epi16(temporal_diff0, 1), temporal_diff1),
+                    temporal_diff2);
+        __m256i spatial_pred = _mm256_srli_epi16(_mm256_add_epi16(c, e), 1);
+        __m256i spatial_score = _mm256_sub_epi16(_mm256_add_epi16(
+                    _mm256_add_epi16(
+                        ABSDIFF(LOAD16(&cur[mrefs-1]), LOAD16(&cur[prefs-1])),
+                        ABSDIFF(c, e)),
+                    ABSDIFF(LOAD16(&cur[mrefs+1]), LOAD16(&cur[prefs+1]))),
+                    one);
+        __m256i mask;
+
+        /* direction 2 is only checked if direction 1 was better */
+        mask = _mm256_set1_epi16(-1);
+        CHECK_AVX2(-1, mask)
+        CHECK_AVX2(-2, mask)
+        mask = _mm256_set1_epi16(-1);
+        CHECK_AVX2( 1, mask)
+        CHECK_AVX2( 2, mask)
+
+        if (mode < 2) {
+            __m256i b = _mm256_srli_epi16(_mm256_add_epi16(
+                        LOAD16(&prev2[2*mrefs]), LOAD16(&next2[2*mrefs])), 1);
+            __m256i f = _mm256_srli_epi16(_mm256_add_epi16(
+                        LOAD16(&prev2[2*prefs]), LOAD16(&next2[2*prefs])), 1);
+            __m256i dc = _mm256_sub_epi16(d, c);
+            __m256i de = _mm256_sub_epi16(d, e);
+            __m256i bc = _mm256_sub_epi16(b, c);
+            __m256i fe = _mm256_sub_epi16(f, e);
+            __m256i max = _mm256_max_epi16(_mm256_max_epi16(de, dc),
+                                           _mm256_min_epi16(bc, fe));
+            __m256i min = _mm256_min_epi16(_mm256_min_epi16(de, dc),
+                                           _mm256_max_epi16(bc, fe));
+
+            diff = _mm256_max_epi16(_mm256_max_epi16(diff, min),
+                                    _mm256_sub_epi16(_mm256_setzero_si256(), max));
+        }
+
+        /* diff >= 0, so this is the same clipping as the C version */
+        spatial_pred = _mm256_max_epi16(spatial_pred, _mm256_sub_epi16(d, diff));
+        spatial_pred = _mm256_min_epi16(spatial_pred, _mm256_add_epi16(d, diff));
+
+        _mm_storeu_si128((__m128i *)dst,
+                         _mm_packus_epi16(_mm256_castsi256_si128(spatial_pred),
+                                          _mm256_extracti128_si256(spatial_pred, 1)));
+
+        dst   += 16;
+        cur   += 16;
+        prev  += 16;
+        next  += 16;
+        prev2 += 16;
+        next2 += 16;
+    }
+#undef CHECK_AVX2
+
+    /* Width remainder */
+    yadif_filter_line_c(dst, prev, cur, next, w - x, prefs, mrefs, parity, mode);
+}
+#undef ABSDIFF
+#undef LOAD16
+#endif
@@ -163,3 +163,36 @@ static inline picture_t *CopyInfoAndRelease( picture_t *p_outpic, picture_t *p_i
 
     return p_outpic;
 }
+
+/*****************************************************************************
+ * Restrict a copy of a picture to the lines of one slice, so that a whole
+ * picture routine can run on it from a filter_RunSlices() callback.
+ * The copy shares the pixels of the picture and must not be released.
+ *****************************************************************************/
+static inline void GetSlicePicture( picture_t *p_slice, const picture_t *p_pic,
+                                    unsigned i_slice, unsigned i_slices )
+{
+    *p_slice = *p_pic;
+
+    /* Cut on the lines of the most subsampled plane, so that the bands
+     * of all the planes match the same part of the picture */
+    int i_lines = p_pic->p[0].i_visible_lines;
+    for( int i = 1; i < p_pic->i_planes; i++ )
+        if( p_pic->p[i].i_visible_lines < i_lines )
+            i_lines = p_pic->p[i].i_visible_lines;
+    if( i_lines <= 0 )
+        return;
+
+    int i_first, i_last;
+    filter_GetSliceLines( i_slice, i_slices, i_lines, &i_first, &i_last );
+
+    for( int i = 0; i < p_pic->i_planes; i++ )
+    {
+        plane_t *p = &p_slice->p[i];
+        const int i_plane_first = (int64_t)i_first * p->i_visible_lines / i_lines;
+        const int i_plane_last = (int64_t)i_last * p->i_visible_lines / i_lines;
+
+        p->p_pixels += i_plane_first * p->i_pitch;
+        p->i_lines = p->i_visible_lines = i_plane_last - i_plane_first;
+    }
+}
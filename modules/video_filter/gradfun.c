@@ -74,6 +74,7 @@ vlc_module_end()
  * Local prototypes
  *****************************************************************************/
 #define FFMAX(a,b) __MAX(a,b)
+#define FFMIN(a,b) __MIN(a,b)
 #ifdef CAN_COMPILE_MMXEXT
 #   define HAVE_MMX2 1
 #else
@@ -99,6 +100,8 @@ vlc_module_end()
 #include <stdalign.h>
 #include "gradfun.h"
 
+#define GRADFUN_MAX_SLICES (16)
+
 static picture_t *Filter(filter_t *, picture_t *);
 static int Callback(vlc_object_t *, char const *, vlc_value_t, vlc_value_t, void *);
 
@@ -137,6 +140,7 @@ static int Open(vlc_object_t *object)
     cfg->thresh      = 0.0;
     cfg->radius      = 0;
     cfg->buf         = NULL;
+    cfg->buf_size    = 0;
 
 #if HAVE_SSE2 && HAVE_6REGS
     if (vlc_CPU_SSE2())
@@ -173,6 +177,41 @@ static void Close(vlc_object_t *object)
     free(sys);
 }
 
+static void FilterSlice(filter_t *filter, void *opaque,
+                        unsigned slice, unsigned slices)
+{
+    picture_t *const *pics = opaque;
+    const picture_t *src = pics[0];
+    picture_t *dst = pics[1];
+    filter_sys_t *sys = filter->p_sys;
+    const video_format_t *fmt = &filter->fmt_in.video;
+    struct vf_priv_s *cfg = &sys->cfg;
+
+    for (int i = 0; i < dst->i_planes; i++) {
+        const plane_t *srcp = &src->p[i];
+        plane_t       *dstp = &dst->p[i];
+
+        const vlc_chroma_description_t *chroma = sys->chroma;
+        int w = fmt->i_width  * chroma->p[i].w.num / chroma->p[i].w.den;
+        int h = fmt->i_height * chroma->p[i].h.num / chroma->p[i].h.den;
+        int r = (cfg->radius  * chroma->p[i].w.num / chroma->p[i].w.den +
+                 cfg->radius  * chroma->p[i].h.num / chroma->p[i].h.den) / 2;
+        r = VLC_CLIP((r + 1) & ~1, RADIUS_MIN, RADIUS_MAX);
+        if (__MIN(w, h) > 2 * r && cfg->buf) {
+            /* Start the slices on even lines: they are blurred by pairs */
+            int first, last;
+
+            filter_GetSliceLines(slice, slices, (h + 1) / 2, &first, &last);
+            filter_plane(cfg, cfg->buf + slice * cfg->buf_size,
+                         dstp->p_pixels, srcp->p_pixels,
+                         w, h, dstp->i_pitch, srcp->i_pitch, r,
+                         2 * first, 2 * last);
+        } else if (slice == 0) {
+            plane_CopyPixels(dstp, srcp);
+        }
+    }
+}
+
 static picture_t *Filter(filter_t *filter, picture_t *src)
 {
     filter_sys_t *sys = filter->p_sys;
@@ -194,27 +233,19 @@ static picture_t *Filter(filter_t *filter, picture_t *src)
     cfg->thresh = (1 << 15) / strength;
     if (cfg->radius != radius) {
         cfg->radius = radius;
-        cfg->buf    = aligned_alloc(16,
-                                   (((fmt->i_width + 15) & ~15) * (cfg->radius + 1) / 2 + 32) * sizeof(*cfg->buf));
+        cfg->buf_size = ((fmt->i_width + 15) & ~15) * (cfg->radius + 1) / 2 + 32;
+        aligned_free(cfg->buf);
+        /* one buffer per slice, so that the slices can be filtered at once */
+        cfg->buf    = aligned_alloc(16, GRADFUN_MAX_SLICES *
+                                        cfg->buf_size * sizeof(*cfg->buf));
     }
 
-    for (int i = 0; i < dst->i_planes; i++) {
-        const plane_t *srcp = &src->p[i];
-        plane_t       *dstp = &dst->p[i];
-
-        const vlc_chroma_description_t *chroma = sys->chroma;
-        int w = fmt->i_width  * chroma->p[i].w.num / chroma->p[i].w.den;
-        int h = fmt->i_height * chroma->p[i].h.num / chroma->p[i].h.den;
-        int r = (cfg->radius  * chroma->p[i].w.num / chroma->p[i].w.den +
-                 cfg->radius  * chroma->p[i].h.num / chroma->p[i].h.den) / 2;
-        r = VLC_CLIP((r + 1) & ~1, RADIUS_MIN, RADIUS_MAX);
-        if (__MIN(w, h) > 2 * r && cfg->buf) {
-            filter_plane(cfg, dstp->p_pixels, srcp->p_pixels,
-                         w, h, dstp->i_pitch, srcp->i_pitch, r);
-        } else {
-            plane_CopyPixels(dstp, srcp);
-        }
-    }
+    /* Each slice first sums the radius lines above its own lines: keep
+     * the slices large enough for that not to dominate */
+    unsigned slices = VLC_CLIP(fmt->i_height / (4 * radius),
+                               1, GRADFUN_MAX_SLICES);
+    picture_t *pics[2] = { src, dst };
+    filter_RunSlices(filter, slices, FilterSlice, pics);
 
     picture_CopyProperties(dst, src);
     picture_Release(src);
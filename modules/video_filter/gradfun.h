@@ -32,6 +32,7 @@ struct vf_priv_s {
     int thresh;
     int radius;
     uint16_t *buf;
+    size_t buf_size; /* per slice */
     void (*filter_line)(uint8_t *dst, uint8_t *src, uint16_t *dc,
                         int width, int thresh, const uint16_t *dithers);
     void (*blur_line)(uint16_t *dc, uint16_t *buf, uint16_t *buf1,
@@ -222,19 +223,29 @@ static void blur_line_sse2(uint16_t *dc, uint16_t *buf, uint16_t *buf1,
 }
 #endif // HAVE_6REGS && HAVE_SSE2
 
-static void filter_plane(struct vf_priv_s *ctx, uint8_t *dst, uint8_t *src,
-                         int width, int height, int dstride, int sstride, int r)
+static void filter_plane(struct vf_priv_s *ctx, uint16_t *buffer,
+                         uint8_t *dst, uint8_t *src,
+                         int width, int height, int dstride, int sstride, int r,
+                         int y_start, int y_end)
 {
     int bstride = ((width+15)&~15)/2;
-    int y;
+    int y, b;
     uint32_t dc_factor = (1<<21)/(r*r);
-    uint16_t *dc = ctx->buf+16;
-    uint16_t *buf = ctx->buf+bstride+32;
+    uint16_t *dc = buffer+16;
+    uint16_t *buf = buffer+bstride+32;
     int thresh = ctx->thresh;
 
+    /* The column sums are kept modulo 2^16 and only their differences over
+     * r lines are used: starting them at the first line of the window of
+     * the first output lines gives the same result as from the top. */
+    y_end = FFMIN(y_end, height);
+    y = FFMIN(FFMAX(r, y_start), (height-r-1)&~1);
+    b = (y+r)/2;
     memset(dc, 0, (bstride+16)*sizeof(*buf));
-    for (y=0; y<r; y++)
-        ctx->blur_line(dc, buf+y*bstride, buf+(y-1)*bstride, src+2*y*sstride, sstride, width/2);
+    for (int i=b-r; i<b; i++)
+        ctx->blur_line(dc, buf+(i%r)*bstride,
+                       i==b-r ? buf-bstride : buf+((i+r-1)%r)*bstride,
+                       src+2*i*sstride, sstride, width/2);
     for (;;) {
         if (y < height-r) {
             int mod = ((y+r)/2)%r;
@@ -254,13 +265,13 @@ static void filter_plane(struct vf_priv_s *ctx, uint8_t *dst, uint8_t *src,
                 dc[x] = dc[0];
         }
         if (y == r) {
-            for (y=0; y<r; y++)
-                ctx->filter_line(dst+y*dstride, src+y*sstride, dc-r/2, width, thresh, dither[y&7]);
+            for (int i=y_start; i<FFMIN(r, y_end); i++)
+                ctx->filter_line(dst+i*dstride, src+i*sstride, dc-r/2, width, thresh, dither[i&7]);
         }
-        ctx->filter_line(dst+y*dstride, src+y*sstride, dc-r/2, width, thresh, dither[y&7]);
-        if (++y >= height) break;
-        ctx->filter_line(dst+y*dstride, src+y*sstride, dc-r/2, width, thresh, dither[y&7]);
-        if (++y >= height) break;
+        for (int i=FFMAX(y, y_start); i<FFMIN(y+2, y_end); i++)
+            ctx->filter_line(dst+i*dstride, src+i*sstride, dc-r/2, width, thresh, dither[i&7]);
+        y += 2;
+        if (y >= y_end) break;
     }
 }
 
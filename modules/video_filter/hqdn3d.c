@@ -110,7 +110,6 @@ static int Open(vlc_object_t *this)
     const video_format_t *fmt_out = &filter->fmt_out.video;
     const vlc_fourcc_t fourcc_in  = fmt_in->i_chroma;
     const vlc_fourcc_t fourcc_out = fmt_out->i_chroma;
-    int wmax = 0;
 
     const vlc_chroma_description_t *chroma =
             vlc_fourcc_GetChromaDescription(fourcc_in);
@@ -135,13 +134,19 @@ static int Open(vlc_object_t *this)
 
     for (int i = 0; i < 3; ++i) {
         sys->w[i] = fmt_in->i_width  * chroma->p[i].w.num / chroma->p[i].w.den;
-        if (sys->w[i] > wmax) wmax = sys->w[i];
         sys->h[i] = fmt_out->i_height * chroma->p[i].h.num / chroma->p[i].h.den;
-    }
-    cfg->Line = malloc(wmax*sizeof(unsigned int));
-    if (!cfg->Line) {
-        free(sys);
-        return VLC_ENOMEM;
+        /* The horizontal pass is kept whole, so that the vertical pass
+         * can be split by columns */
+        cfg->Line[i] = malloc(sys->w[i]*sizeof(unsigned int));
+        cfg->Horiz[i] = malloc((size_t)sys->w[i]*sys->h[i]*sizeof(unsigned int));
+        if (!cfg->Line[i] || !cfg->Horiz[i]) {
+            for (int j = 0; j <= i; ++j) {
+                free(cfg->Line[j]);
+                free(cfg->Horiz[j]);
+            }
+            free(sys);
+            return VLC_ENOMEM;
+        }
     }
 
     config_ChainParse(filter, FILTER_PREFIX, filter_options,
@@ -184,14 +189,59 @@ static void Close(vlc_object_t *this)
 
     for (int i = 0; i < 3; ++i) {
         free(cfg->Frame[i]);
+        free(cfg->Line[i]);
+        free(cfg->Horiz[i]);
     }
-    free(cfg->Line);
     free(sys);
 }
 
 /*****************************************************************************
  * Filter
  *****************************************************************************/
+static void FilterHorizontal(filter_t *filter, void *opaque,
+                             unsigned slice, unsigned slices)
+{
+    picture_t *const *pics = opaque;
+    const picture_t *src = pics[0];
+    filter_sys_t *sys = filter->p_sys;
+    struct vf_priv_s *cfg = &sys->cfg;
+
+    /* The lines are filtered independently */
+    for (int i = 0; i < 3; ++i) {
+        int first, last;
+
+        filter_GetSliceLines(slice, slices, sys->h[i], &first, &last);
+        deNoiseHorizontal(src->p[i].p_pixels, cfg->Horiz[i], sys->w[i],
+                          first, last, src->p[i].i_pitch,
+                          cfg->Coefs[i == 0 ? 0 : 2],
+                          cfg->Coefs[i == 0 ? 1 : 3][0] != 0);
+    }
+}
+
+static void FilterVertical(filter_t *filter, void *opaque,
+                           unsigned slice, unsigned slices)
+{
+    picture_t *const *pics = opaque;
+    const picture_t *src = pics[0];
+    picture_t *dst = pics[1];
+    filter_sys_t *sys = filter->p_sys;
+    struct vf_priv_s *cfg = &sys->cfg;
+
+    /* The vertical and temporal recursions are per column */
+    for (int i = 0; i < 3; ++i) {
+        int *spat = cfg->Coefs[i == 0 ? 0 : 2];
+        int *temp = cfg->Coefs[i == 0 ? 1 : 3];
+        int first, last;
+
+        filter_GetSliceLines(slice, slices, sys->w[i], &first, &last);
+        deNoiseVertical(src->p[i].p_pixels, dst->p[i].p_pixels,
+                        cfg->Horiz[i], cfg->Line[i], cfg->Frame[i],
+                        sys->w[i], sys->h[i], first, last,
+                        src->p[i].i_pitch, dst->p[i].i_pitch,
+                        spat, temp, spat[0] != 0);
+    }
+}
+
 static picture_t *Filter(filter_t *filter, picture_t *src)
 {
     picture_t *dst;
@@ -221,32 +271,24 @@ static picture_t *Filter(filter_t *filter, picture_t *src)
     }
     vlc_mutex_unlock( &sys->coefs_mutex );
 
-    deNoise(src->p[0].p_pixels, dst->p[0].p_pixels,
-            cfg->Line, &cfg->Frame[0], sys->w[0], sys->h[0],
-            src->p[0].i_pitch, dst->p[0].i_pitch,
-            cfg->Coefs[0],
-            cfg->Coefs[0],
-            cfg->Coefs[1]);
-    deNoise(src->p[1].p_pixels, dst->p[1].p_pixels,
-            cfg->Line, &cfg->Frame[1], sys->w[1], sys->h[1],
-            src->p[1].i_pitch, dst->p[1].i_pitch,
-            cfg->Coefs[2],
-            cfg->Coefs[2],
-            cfg->Coefs[3]);
-    deNoise(src->p[2].p_pixels, dst->p[2].p_pixels,
-            cfg->Line, &cfg->Frame[2], sys->w[2], sys->h[2],
-            src->p[2].i_pitch, dst->p[2].i_pitch,
-            cfg->Coefs[2],
-            cfg->Coefs[2],
-            cfg->Coefs[3]);
-
-    if(unlikely(!cfg->Frame[0] || !cfg->Frame[1] || !cfg->Frame[2]))
-    {
-        picture_Release( src );
-        picture_Release( dst );
-        return NULL;
+    for (int i = 0; i < 3; ++i) {
+        if (cfg->Frame[i] == NULL)
+            cfg->Frame[i] = deNoiseInitFrame(src->p[i].p_pixels, sys->w[i],
+                                             sys->h[i], src->p[i].i_pitch);
+        if (unlikely(cfg->Frame[i] == NULL)) {
+            picture_Release( src );
+            picture_Release( dst );
+            return NULL;
+        }
     }
 
+    /* The spatial filter is recursive on both axes: run the horizontal
+     * pass by bands of lines, then the vertical one by bands of columns */
+    picture_t *pics[2] = { src, dst };
+    if (cfg->Coefs[0][0] || cfg->Coefs[2][0])
+        filter_RunSlices(filter, sys->h[0] / 16, FilterHorizontal, pics);
+    filter_RunSlices(filter, sys->w[0] / 64, FilterVertical, pics);
+
     return CopyInfoAndRelease(dst, src);
 }
 
@@ -23,6 +23,7 @@
 #include <string.h>
 #include <inttypes.h>
 #include <math.h>
+#include <stdbool.h>
 
 #define PARAM1_DEFAULT 4.0
 #define PARAM2_DEFAULT 3.0
@@ -32,7 +33,8 @@
 
 struct vf_priv_s {
         int Coefs[4][512*16];
-        unsigned int *Line;
+        unsigned int *Line[3];
+        unsigned int *Horiz[3];
         unsigned short *Frame[3];
 };
 
@@ -46,136 +48,82 @@ static /*inline*/ unsigned int LowPassMul(unsigned int PrevMul, unsigned int Cur
     return CurrMul + Coef[d];
 }
 
-static void deNoiseTemporal(
-                    unsigned char *Frame,        // mpi->planes[x]
-                    unsigned char *FrameDest,    // dmpi->planes[x]
-                    unsigned short *FrameAnt,
-                    int W, int H, int sStride, int dStride,
-                    int *Temporal)
+/* Horizontal pass of the spatial filter, on lines [Y0, Y1) */
+static void deNoiseHorizontal(
+                    const unsigned char *Frame,  // mpi->planes[x]
+                    unsigned int *Horiz,         // W * H
+                    int W, int Y0, int Y1, int sStride,
+                    int *Horizontal, bool Temporal)
 {
-    unsigned int PixelDst;
+    for (long Y = Y0; Y < Y1; Y++){
+        const unsigned char *Line = &Frame[Y*sStride];
+        unsigned int *LineDst = &Horiz[Y*W];
+        unsigned int PixelAnt;
 
-    for (long Y = 0; Y < H; Y++){
-        for (long X = 0; X < W; X++){
-            PixelDst = LowPassMul(FrameAnt[X]<<8, Frame[X]<<16, Temporal);
-            FrameAnt[X] = ((PixelDst+0x1000007F)>>8);
-            FrameDest[X]= ((PixelDst+0x10007FFF)>>16);
+        /* First pixel on each line doesn't have previous pixel */
+        PixelAnt = LineDst[0] = Line[0]<<16;
+        if (Y == 0 && !Temporal){
+            /* The spatial-only filter always smoothed the first line against
+             * its first pixel: keep its output unchanged */
+            for (long X = 1; X < W; X++)
+                LineDst[X] = LowPassMul(PixelAnt, Line[X]<<16, Horizontal);
+            continue;
         }
-        Frame += sStride;
-        FrameDest += dStride;
-        FrameAnt += W;
+        for (long X = 1; X < W; X++)
+            PixelAnt = LineDst[X] = LowPassMul(PixelAnt, Line[X]<<16, Horizontal);
     }
 }
 
-static void deNoiseSpacial(
-                    unsigned char *Frame,        // mpi->planes[x]
+/* Vertical pass of the spatial filter and temporal filter, on columns
+ * [X0, X1). Without spatial filtering, Horiz and LineAnt are unused. */
+static void deNoiseVertical(
+                    const unsigned char *Frame,  // mpi->planes[x]
                     unsigned char *FrameDest,    // dmpi->planes[x]
-                    unsigned int *LineAnt,       // vf->priv->Line (width bytes)
-                    int W, int H, int sStride, int dStride,
-                    int *Horizontal, int *Vertical)
+                    const unsigned int *Horiz,   // W * H
+                    unsigned int *LineAnt,       // vf->priv->Line[x] (width)
+                    unsigned short *FrameAnt,
+                    int W, int H, int X0, int X1, int sStride, int dStride,
+                    int *Vertical, int *Temporal, bool Spatial)
 {
-    long sLineOffs = 0, dLineOffs = 0;
-    unsigned int PixelAnt;
-    unsigned int PixelDst;
-
-    /* First pixel has no left nor top neighbor. */
-    PixelDst = LineAnt[0] = PixelAnt = Frame[0]<<16;
-    FrameDest[0]= ((PixelDst+0x10007FFF)>>16);
-
-    /* First line has no top neighbor, only left. */
-    for (long X = 1; X < W; X++){
-        PixelDst = LineAnt[X] = LowPassMul(PixelAnt, Frame[X]<<16, Horizontal);
-        FrameDest[X]= ((PixelDst+0x10007FFF)>>16);
-    }
-
-    for (long Y = 1; Y < H; Y++){
-        unsigned int PixelAnt;
-        sLineOffs += sStride, dLineOffs += dStride;
-        /* First pixel on each line doesn't have previous pixel */
-        PixelAnt = Frame[sLineOffs]<<16;
-        PixelDst = LineAnt[0] = LowPassMul(LineAnt[0], PixelAnt, Vertical);
-        FrameDest[dLineOffs]= ((PixelDst+0x10007FFF)>>16);
+    const bool Temp = !Spatial || Temporal[0];
 
-        for (long X = 1; X < W; X++){
+    for (long Y = 0; Y < H; Y++){
+        for (long X = X0; X < X1; X++){
             unsigned int PixelDst;
-            /* The rest are normal */
-            PixelAnt = LowPassMul(PixelAnt, Frame[sLineOffs+X]<<16, Horizontal);
-            PixelDst = LineAnt[X] = LowPassMul(LineAnt[X], PixelAnt, Vertical);
-            FrameDest[dLineOffs+X]= ((PixelDst+0x10007FFF)>>16);
+
+            if (Spatial){
+                /* First line has no top neighbor */
+                PixelDst = Y ? LowPassMul(LineAnt[X], Horiz[X], Vertical)
+                             : Horiz[X];
+                LineAnt[X] = PixelDst;
+            }else
+                PixelDst = Frame[X]<<16;
+
+            if (Temp){
+                PixelDst = LowPassMul(FrameAnt[X]<<8, PixelDst, Temporal);
+                FrameAnt[X] = ((PixelDst+0x1000007F)>>8);
+            }
+            FrameDest[X]= ((PixelDst+0x10007FFF)>>16);
         }
+        Frame += sStride;
+        FrameDest += dStride;
+        Horiz += W;
+        FrameAnt += W;
     }
 }
 
-static void deNoise(unsigned char *Frame,        // mpi->planes[x]
-                    unsigned char *FrameDest,    // dmpi->planes[x]
-                    unsigned int *LineAnt,      // vf->priv->Line (width bytes)
-                    unsigned short **FrameAntPtr,
-                    int W, int H, int sStride, int dStride,
-                    int *Horizontal, int *Vertical, int *Temporal)
+static unsigned short *deNoiseInitFrame(const unsigned char *Frame,
+                                        int W, int H, int sStride)
 {
-    long sLineOffs = 0, dLineOffs = 0;
-    unsigned int PixelAnt;
-    unsigned int PixelDst;
-    unsigned short* FrameAnt=(*FrameAntPtr);
-
-    if(!FrameAnt){
-        (*FrameAntPtr)=FrameAnt=malloc(W*H*sizeof(unsigned short));
-        if(!FrameAnt)
-            return;
-        for (long Y = 0; Y < H; Y++){
-            unsigned short* dst=&FrameAnt[Y*W];
-            unsigned char* src=Frame+Y*sStride;
-            for (long X = 0; X < W; X++) dst[X]=src[X]<<8;
-        }
-    }
-
-    if(!Horizontal[0] && !Vertical[0]){
-        deNoiseTemporal(Frame, FrameDest, FrameAnt,
-                        W, H, sStride, dStride, Temporal);
-        return;
-    }
-    if(!Temporal[0]){
-        deNoiseSpacial(Frame, FrameDest, LineAnt,
-                       W, H, sStride, dStride, Horizontal, Vertical);
-        return;
-    }
-
-    /* First pixel has no left nor top neighbor. Only previous frame */
-    LineAnt[0] = PixelAnt = Frame[0]<<16;
-    PixelDst = LowPassMul(FrameAnt[0]<<8, PixelAnt, Temporal);
-    FrameAnt[0] = ((PixelDst+0x1000007F)>>8);
-    FrameDest[0]= ((PixelDst+0x10007FFF)>>16);
-
-    /* First line has no top neighbor. Only left one for each pixel and
-     * last frame */
-    for (long X = 1; X < W; X++){
-        LineAnt[X] = PixelAnt = LowPassMul(PixelAnt, Frame[X]<<16, Horizontal);
-        PixelDst = LowPassMul(FrameAnt[X]<<8, PixelAnt, Temporal);
-        FrameAnt[X] = ((PixelDst+0x1000007F)>>8);
-        FrameDest[X]= ((PixelDst+0x10007FFF)>>16);
-    }
-
-    for (long Y = 1; Y < H; Y++){
-        unsigned int PixelAnt;
-        unsigned short* LinePrev=&FrameAnt[Y*W];
-        sLineOffs += sStride, dLineOffs += dStride;
-        /* First pixel on each line doesn't have previous pixel */
-        PixelAnt = Frame[sLineOffs]<<16;
-        LineAnt[0] = LowPassMul(LineAnt[0], PixelAnt, Vertical);
-        PixelDst = LowPassMul(LinePrev[0]<<8, LineAnt[0], Temporal);
-        LinePrev[0] = ((PixelDst+0x1000007F)>>8);
-        FrameDest[dLineOffs]= ((PixelDst+0x10007FFF)>>16);
-
-        for (long X = 1; X < W; X++){
-            unsigned int PixelDst;
-            /* The rest are normal */
-            PixelAnt = LowPassMul(PixelAnt, Frame[sLineOffs+X]<<16, Horizontal);
-            LineAnt[X] = LowPassMul(LineAnt[X], PixelAnt, Vertical);
-            PixelDst = LowPassMul(LinePrev[X]<<8, LineAnt[X], Temporal);
-            LinePrev[X] = ((PixelDst+0x1000007F)>>8);
-            FrameDest[dLineOffs+X]= ((PixelDst+0x10007FFF)>>16);
-        }
+    unsigned short *FrameAnt = malloc(W*H*sizeof(unsigned short));
+    if(!FrameAnt)
+        return NULL;
+    for (long Y = 0; Y < H; Y++){
+        unsigned short* dst=&FrameAnt[Y*W];
+        const unsigned char* src=Frame+Y*sStride;
+        for (long X = 0; X < W; X++) dst[X]=src[X]<<8;
     }
+    return FrameAnt;
 }
 
 
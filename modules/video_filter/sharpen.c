@@ -168,11 +168,13 @@ static void Destroy( vlc_object_t *p_this )
         const unsigned data_sz = sizeof(data_t);                        \
         const int i_src_line_len = p_outpic->p[Y_PLANE].i_pitch / data_sz; \
         const int i_out_line_len = p_pic->p[Y_PLANE].i_pitch / data_sz; \
-        const int sigma = atomic_load(&p_filter->p_sys->sigma);         \
+        const int sigma = ctx->sigma;                                   \
                                                                         \
-        memcpy(p_out, p_src, i_visible_pitch);                          \
+        if( i_first == 0 )                                              \
+            memcpy(p_out, p_src, i_visible_pitch);                      \
                                                                         \
-        for( unsigned i = 1; i < i_visible_lines - 1; i++ )             \
+        for( unsigned i = __MAX(i_first, 1);                            \
+             i < __MIN(i_last, i_visible_lines - 1); i++ )              \
         {                                                               \
             p_out[i * i_out_line_len] = p_src[i * i_src_line_len];      \
                                                                         \
@@ -199,18 +201,47 @@ static void Destroy( vlc_object_t *p_this )
             p_out[i * i_out_line_len + i_visible_pitch / 2 - 1] =       \
                 p_src[i * i_src_line_len + i_visible_pitch / 2 - 1];    \
         }                                                               \
-        memcpy(&p_out[(i_visible_lines - 1) * i_out_line_len],          \
-               &p_src[(i_visible_lines - 1) * i_src_line_len],          \
-               i_visible_pitch);                                        \
+        if( i_last == i_visible_lines )                                 \
+            memcpy(&p_out[(i_visible_lines - 1) * i_out_line_len],      \
+                   &p_src[(i_visible_lines - 1) * i_src_line_len],      \
+                   i_visible_pitch);                                    \
     } while (0)
 
-static picture_t *Filter( filter_t *p_filter, picture_t *p_pic )
+typedef struct
 {
+    picture_t *p_pic;
     picture_t *p_outpic;
+    int        sigma;
+} sharpen_slice_t;
+
+static void FilterSlice( filter_t *p_filter, void *opaque,
+                         unsigned i_slice, unsigned i_slices )
+{
+    const sharpen_slice_t *ctx = opaque;
+    const picture_t *p_pic = ctx->p_pic;
+    picture_t *p_outpic = ctx->p_outpic;
     const int v1 = -1;
     const int v2 = 3; /* 2^3 = 8 */
     const unsigned i_visible_lines = p_pic->p[Y_PLANE].i_visible_lines;
     const unsigned i_visible_pitch = p_pic->p[Y_PLANE].i_visible_pitch;
+    int first, last;
+
+    VLC_UNUSED(p_filter);
+    filter_GetSliceLines( i_slice, i_slices, i_visible_lines, &first, &last );
+    if( first == last )
+        return;
+
+    const unsigned i_first = first, i_last = last;
+
+    if (!IS_YUV_420_10BITS(p_pic->format.i_chroma))
+        SHARPEN_FRAME(255, uint8_t);
+    else
+        SHARPEN_FRAME(1023, uint16_t);
+}
+
+static picture_t *Filter( filter_t *p_filter, picture_t *p_pic )
+{
+    picture_t *p_outpic;
 
     p_outpic = filter_NewPicture( p_filter );
     if( !p_outpic )
@@ -219,10 +250,14 @@ static picture_t *Filter( filter_t *p_filter, picture_t *p_pic )
         return NULL;
     }
 
-    if (!IS_YUV_420_10BITS(p_pic->format.i_chroma))
-        SHARPEN_FRAME(255, uint8_t);
-    else
-        SHARPEN_FRAME(1023, uint16_t);
+    /* The luma lines only depend on the input, share them out */
+    sharpen_slice_t ctx = {
+        .p_pic = p_pic,
+        .p_outpic = p_outpic,
+        .sigma = atomic_load(&p_filter->p_sys->sigma),
+    };
+    filter_RunSlices( p_filter, p_pic->p[Y_PLANE].i_visible_lines / 16,
+                      FilterSlice, &ctx );
 
     plane_CopyPixels( &p_outpic->p[U_PLANE], &p_pic->p[U_PLANE] );
     plane_CopyPixels( &p_outpic->p[V_PLANE], &p_pic->p[V_PLANE] );
@@ -114,9 +114,12 @@ static void R270(int *sx, int *sy, int w, int h, int dx, int dy)
     *sy = dx;
 }
 typedef void (*convert_t)(int *, int *, int, int, int, int);
+/* Transforms the lines [y_first, y_last) of the destination plane */
+typedef void (*plane_transform_t)(plane_t *, const plane_t *, int, int);
 
 #define PLANE(f,bits) \
-static void Plane##bits##_##f(plane_t *restrict dst, const plane_t *restrict src) \
+static void Plane##bits##_##f(plane_t *restrict dst, const plane_t *restrict src, \
+                              int y_first, int y_last) \
 { \
     const uint##bits##_t *src_pixels = (const void *)src->p_pixels; \
     uint##bits##_t *restrict dst_pixels = (void *)dst->p_pixels; \
@@ -124,7 +127,7 @@ static void Plane##bits##_##f(plane_t *restrict dst, const plane_t *restrict src
     const unsigned dst_width = dst->i_pitch / sizeof (*dst_pixels); \
     const unsigned dst_visible_width = dst->i_visible_pitch / sizeof (*dst_pixels); \
  \
-    for (int y = 0; y < dst->i_visible_lines; y++) { \
+    for (int y = y_first; y < y_last; y++) { \
         for (unsigned x = 0; x < dst_visible_width; x++) { \
             int sx, sy; \
             (f)(&sx, &sy, dst_visible_width, dst->i_visible_lines, x, y); \
@@ -134,23 +137,26 @@ static void Plane##bits##_##f(plane_t *restrict dst, const plane_t *restrict src
     } \
 }
 
-static void Plane_VFlip(plane_t *restrict dst, const plane_t *restrict src)
+static void Plane_VFlip(plane_t *restrict dst, const plane_t *restrict src,
+                        int y_first, int y_last)
 {
     const uint8_t *src_pixels = src->p_pixels;
     uint8_t *restrict dst_pixels = dst->p_pixels;
 
-    dst_pixels += dst->i_pitch * dst->i_visible_lines;
-    for (int y = 0; y < dst->i_visible_lines; y++) {
-        dst_pixels -= dst->i_pitch;
+    src_pixels += src->i_pitch * (dst->i_visible_lines - y_first);
+    dst_pixels += dst->i_pitch * y_first;
+    for (int y = y_first; y < y_last; y++) {
+        src_pixels -= src->i_pitch;
         memcpy(dst_pixels, src_pixels, dst->i_visible_pitch);
-        src_pixels += src->i_pitch;
+        dst_pixels += dst->i_pitch;
     }
 }
 
 #define I422(f) \
-static void Plane422_##f(plane_t *restrict dst, const plane_t *restrict src) \
+static void Plane422_##f(plane_t *restrict dst, const plane_t *restrict src, \
+                         int y_first, int y_last) \
 { \
-    for (int y = 0; y < dst->i_visible_lines; y += 2) { \
+    for (int y = y_first; y < y_last; y += 2) { \
         for (int x = 0; x < dst->i_visible_pitch; x++) { \
             int sx, sy, uv; \
             (f)(&sx, &sy, dst->i_visible_pitch, dst->i_visible_lines / 2, \
@@ -164,11 +170,12 @@ static void Plane422_##f(plane_t *restrict dst, const plane_t *restrict src) \
 }
 
 #define YUY2(f) \
-static void PlaneYUY2_##f(plane_t *restrict dst, const plane_t *restrict src) \
+static void PlaneYUY2_##f(plane_t *restrict dst, const plane_t *restrict src, \
+                          int y_first, int y_last) \
 { \
     unsigned dst_visible_width = dst->i_visible_pitch / 2; \
  \
-    for (int y = 0; y < dst->i_visible_lines; y += 2) { \
+    for (int y = y_first; y < y_last; y += 2) { \
         for (unsigned x = 0; x < dst_visible_width; x+= 2) { \
             int sx0, sy0, sx1, sy1; \
             (f)(&sx0, &sy0, dst_visible_width, dst->i_visible_lines, x, y); \
@@ -232,11 +239,11 @@ typedef struct {
     convert_t convert;
     convert_t iconvert;
     video_transform_t operation;
-    void      (*plane8) (plane_t *dst, const plane_t *src);
-    void      (*plane16)(plane_t *dst, const plane_t *src);
-    void      (*plane32)(plane_t *dst, const plane_t *src);
-    void      (*i422)(plane_t *dst, const plane_t *src);
-    void      (*yuyv)(plane_t *dst, const plane_t *src);
+    plane_transform_t plane8;
+    plane_transform_t plane16;
+    plane_transform_t plane32;
+    plane_transform_t i422;
+    plane_transform_t yuyv;
 } transform_description_t;
 
 #define DESC(str, f, invf, op) \
@@ -263,23 +270,41 @@ static const size_t n_transforms =
 
 struct filter_sys_t {
     const vlc_chroma_description_t *chroma;
-    void (*plane[PICTURE_PLANE_MAX])(plane_t *, const plane_t *);
+    plane_transform_t plane[PICTURE_PLANE_MAX];
     convert_t convert;
 };
 
-static picture_t *Filter(filter_t *filter, picture_t *src)
+static void FilterSlice(filter_t *filter, void *opaque,
+                        unsigned slice, unsigned slices)
 {
-    filter_sys_t *sys = filter->p_sys;
+    picture_t *const *pics = opaque;
+    const picture_t *src = pics[0];
+    picture_t *dst = pics[1];
+    const filter_sys_t *sys = filter->p_sys;
+
+    const vlc_chroma_description_t *chroma = sys->chroma;
+    for (unsigned i = 0; i < chroma->plane_count; i++) {
+        const int lines = dst->p[i].i_visible_lines;
+        int first, last;
+
+        /* By pairs of lines: 4:2:2 and YUY2 rotations write two at once */
+        filter_GetSliceLines(slice, slices, (lines + 1) / 2, &first, &last);
+        (sys->plane[i])(&dst->p[i], &src->p[i],
+                        2 * first, __MIN(2 * last, lines));
+    }
+}
 
+static picture_t *Filter(filter_t *filter, picture_t *src)
+{
     picture_t *dst = filter_NewPicture(filter);
     if (!dst) {
         picture_Release(src);
         return NULL;
     }
 
-    const vlc_chroma_description_t *chroma = sys->chroma;
-    for (unsigned i = 0; i < chroma->plane_count; i++)
-         (sys->plane[i])(&dst->p[i], &src->p[i]);
+    /* Every destination line only depends on the source picture */
+    picture_t *pics[2] = { src, dst };
+    filter_RunSlices(filter, dst->p[0].i_visible_lines / 16, FilterSlice, pics);
 
     picture_CopyProperties(dst, src);
     picture_Release(src);
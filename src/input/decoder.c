@@ -1688,8 +1688,8 @@ static decoder_t * CreateDecoder( vlc_object_t *p_parent,
 
     es_format_Init( &p_owner->fmt, fmt->i_cat, 0 );
 
-    /* decoder fifo */
-    p_owner->p_fifo = block_FifoNew();
+    /* decoder fifo: fed by the input thread, consumed by the decoder thread */
+    p_owner->p_fifo = block_FifoNewMPSC();
     if( unlikely(p_owner->p_fifo == NULL) )
     {
         free( p_owner );
@@ -2016,6 +2016,16 @@ void input_DecoderDecode( decoder_t *p_dec, block_t *p_block, bool b_do_pace )
 {
     decoder_owner_sys_t *p_owner = p_dec->p_owner;
 
+    /* Fast path: queue without locking if no limit is reached. The counters
+     * can only shrink behind our back, as the input thread is the producer. */
+    if( b_do_pace ? ( p_owner->b_waiting
+                   || vlc_fifo_GetCount( p_owner->p_fifo ) < 10 )
+                  : vlc_fifo_GetBytes( p_owner->p_fifo ) <= 400*1024*1024 )
+    {
+        block_FifoPut( p_owner->p_fifo, p_block );
+        return;
+    }
+
     vlc_fifo_Lock( p_owner->p_fifo );
     if( !b_do_pace )
     {
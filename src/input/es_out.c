@@ -2691,6 +2691,13 @@ static int EsOutControlLocked( es_out_t *out, int i_query, va_list args )
         return VLC_SUCCESS;
     }
 
+    case ES_OUT_GET_DELAYED:
+    {
+        bool *pb = va_arg( args, bool* );
+        *pb = false;
+        return VLC_SUCCESS;
+    }
+
     case ES_OUT_GET_EMPTY:
     {
         bool *pb = va_arg( args, bool* );
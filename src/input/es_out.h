@@ -53,6 +53,10 @@ enum es_out_query_private_e
     /* Get buffering state */
     ES_OUT_GET_BUFFERING,                           /* arg1=bool*               res=cannot fail */
 
+    /* Get timeshift state: true while the output is read back from the
+     * timeshift buffer */
+    ES_OUT_GET_DELAYED,                             /* arg1=bool*               res=cannot fail */
+
     /* Set delay for a ES category */
     ES_OUT_SET_DELAY,                               /* arg1=es_category_e,      res=cannot fail */
 
@@ -65,7 +69,8 @@ enum es_out_query_private_e
     /* Set rate */
     ES_OUT_SET_RATE,                                /* arg1=int i_source_rate arg2=int i_rate                  res=can fail */
 
-    /* Set a new time */
+    /* Set a new time: -1 resets the decoders before a demuxer seek, a
+     * stream time seeks inside the timeshift buffer */
     ES_OUT_SET_TIME,                                /* arg1=mtime_t             res=can fail */
 
     /* Set next frame */
@@ -105,6 +110,14 @@ static inline bool es_out_GetBuffering( es_out_t *p_out )
     assert( !i_ret );
     return b;
 }
+static inline bool es_out_GetDelayed( es_out_t *p_out )
+{
+    bool b;
+    int i_ret = es_out_Control( p_out, ES_OUT_GET_DELAYED, &b );
+
+    assert( !i_ret );
+    return b;
+}
 static inline bool es_out_GetEmpty( es_out_t *p_out )
 {
     bool b;
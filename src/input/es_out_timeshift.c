@@ -161,6 +161,19 @@ typedef struct attribute_packed
     } u;
 } ts_cmd_t;
 
+/* Seek point inside a storage */
+typedef struct
+{
+    int     i_cmd;  /* Index of the first command to replay */
+    mtime_t i_date; /* Date of that command */
+    mtime_t i_time; /* Stream time (as reported by ES_OUT_SET_TIMES) */
+} ts_index_t;
+
+/* Keyframes are preferred as seek points, but a marker is forced when none
+ * has been seen for a while (demuxers do not always flag them) */
+#define TS_INDEX_MIN_INTERVAL (CLOCK_FREQ/5)
+#define TS_INDEX_MAX_INTERVAL (2*CLOCK_FREQ)
+
 typedef struct ts_storage_t ts_storage_t;
 struct ts_storage_t
 {
@@ -176,10 +189,16 @@ struct ts_storage_t
     FILE    *p_filer;   /* FILE handle for data reading */
 
     /* */
+    int      i_cmd_first; /* Commands before it are not valid anymore */
     int      i_cmd_r;
     int      i_cmd_w;
     int      i_cmd_max;
     ts_cmd_t *p_cmd;
+
+    /* Time index */
+    int        i_index;
+    int        i_index_max;
+    ts_index_t *p_index;
 };
 
 typedef struct
@@ -188,6 +207,7 @@ typedef struct
     input_thread_t *p_input;
     es_out_t       *p_out;
     int64_t        i_tmp_size_max;
+    int64_t        i_history_max;
     const char     *psz_tmp_path;
 
     /* Lock for all following fields */
@@ -207,12 +227,27 @@ typedef struct
     /* */
     mtime_t        i_buffering_delay;
 
-    /* */
+    /* Storages are chained from the oldest one kept for seeking back
+     * (p_storage_h) to the one being written (p_storage_w) */
+    ts_storage_t   *p_storage_h;
     ts_storage_t   *p_storage_r;
     ts_storage_t   *p_storage_w;
 
     mtime_t        i_cmd_delay;
 
+    /* Time index state */
+    mtime_t        i_index_time;
+    mtime_t        i_index_date;
+
+    /* Pending seek, applied by the timeshift thread */
+    struct
+    {
+        bool         b_pending;
+        ts_storage_t *p_storage; /* Forward target, NULL when backward */
+        int          i_cmd;
+        mtime_t      i_date;
+    } seek;
+
 } ts_thread_t;
 
 struct es_out_id_t
@@ -227,6 +262,7 @@ struct es_out_sys_t
 
     /* Configuration */
     int64_t        i_tmp_size_max;    /* Maximal temporary file size in byte */
+    int64_t        i_history_max;     /* Played data kept for seeking back */
     char           *psz_tmp_path;     /* Path for temporary files */
 
     /* Lock for all following fields */
@@ -263,6 +299,11 @@ static bool         TsHasCmd( ts_thread_t * );
 static bool         TsIsUnused( ts_thread_t * );
 static int          TsChangePause( ts_thread_t *, bool b_source_paused, bool b_paused, mtime_t i_date );
 static int          TsChangeRate( ts_thread_t *, int i_src_rate, int i_rate );
+static int          TsSeek( ts_thread_t *, mtime_t i_time );
+static int          TsSeekPopLocked( ts_thread_t *, ts_cmd_t **pp_cmd );
+static void         TsSeekReplay( es_out_t *, ts_cmd_t *p_cmd, int i_cmd );
+static void         TsSeekRestartLocked( ts_thread_t *, mtime_t i_date );
+static void         TsTrimHistoryLocked( ts_thread_t * );
 
 static void         *TsRun( void * );
 
@@ -273,9 +314,19 @@ static bool         TsStorageIsFull( ts_storage_t *, const ts_cmd_t *p_cmd );
 static bool         TsStorageIsEmpty( ts_storage_t * );
 static void         TsStoragePushCmd( ts_storage_t *, const ts_cmd_t *p_cmd, bool b_flush );
 static void         TsStoragePopCmd( ts_storage_t *p_storage, ts_cmd_t *p_cmd, bool b_flush );
+static void         TsStorageDiscard( ts_storage_t *, int i_cmd );
+static void         TsStorageIndex( ts_storage_t *, const ts_index_t * );
+static const ts_index_t *TsStorageFindIndex( ts_storage_t *, mtime_t i_time );
 
 static void CmdClean( ts_cmd_t * );
-static void cmd_cleanup_routine( void *p ) { CmdClean( p ); }
+static void CmdCleanSend( ts_cmd_t * );
+/* Popped commands only own their block, the rest belongs to the storage */
+static void cmd_cleanup_routine( void *p )
+{
+    ts_cmd_t *p_cmd = p;
+    if( p_cmd->i_type == C_SEND )
+        CmdCleanSend( p_cmd );
+}
 
 static int  CmdInitAdd    ( ts_cmd_t *, es_out_id_t *, const es_format_t *, bool b_copy );
 static void CmdInitSend   ( ts_cmd_t *, es_out_id_t *, block_t * );
@@ -284,7 +335,6 @@ static int  CmdInitControl( ts_cmd_t *, int i_query, va_list, bool b_copy );
 
 /* */
 static void CmdCleanAdd    ( ts_cmd_t * );
-static void CmdCleanSend   ( ts_cmd_t * );
 static void CmdCleanControl( ts_cmd_t *p_cmd );
 
 /* XXX these functions will take the destination es_out_t */
@@ -344,6 +394,12 @@ es_out_t *input_EsOutTimeshiftNew( input_thread_t *p_input, es_out_t *p_next_out
     msg_Dbg( p_input, "using timeshift granularity of %d MiB",
              (int)p_sys->i_tmp_size_max/(1024*1024) );
 
+    const int64_t i_history_max = var_InheritInteger( p_input, "input-timeshift-history" );
+    p_sys->i_history_max = __MAX( i_history_max, 0 );
+    if( p_sys->i_history_max > 0 )
+        msg_Dbg( p_input, "keeping up to %"PRId64" MiB of timeshift history",
+                 p_sys->i_history_max/(1024*1024) );
+
     p_sys->psz_tmp_path = var_InheritString( p_input, "input-timeshift-path" );
 #if defined (_WIN32) && !VLC_WINSTORE_APP
     if( p_sys->psz_tmp_path == NULL )
@@ -429,7 +485,7 @@ static es_out_id_t *Add( es_out_t *p_out, const es_format_t *p_fmt )
     es_out_sys_t *p_sys = p_out->p_sys;
     ts_cmd_t cmd;
 
-    es_out_id_t *p_es = malloc( sizeof( *p_es ) );
+    es_out_id_t *p_es = calloc( 1, sizeof( *p_es ) );
     if( !p_es )
         return NULL;
 
@@ -609,7 +665,15 @@ static int ControlLockedSetTime( es_out_t *p_out, mtime_t i_date )
     es_out_sys_t *p_sys = p_out->p_sys;
 
     if( !p_sys->b_delayed )
+    {
+        /* Nothing buffered to seek into */
+        if( i_date >= 0 )
+            return VLC_EGENERIC;
         return es_out_SetTime( p_sys->p_out, i_date );
+    }
+
+    if( i_date >= 0 )
+        return TsSeek( p_sys->p_ts, i_date );
 
     /* TODO */
     msg_Err( p_sys->p_input, "EsOutTimeshift does not yet support time change" );
@@ -693,6 +757,12 @@ static int ControlLocked( es_out_t *p_out, int i_query, va_list args )
         bool *pb_buffering = (bool *)va_arg( args, bool* );
         return ControlLockedGetBuffering( p_out, pb_buffering );
     }
+    case ES_OUT_GET_DELAYED:
+    {
+        bool *pb_delayed = (bool *)va_arg( args, bool* );
+        *pb_delayed = p_sys->b_delayed;
+        return VLC_SUCCESS;
+    }
     case ES_OUT_SET_PAUSE_STATE:
     {
         const bool b_source_paused = (bool)va_arg( args, int );
@@ -787,6 +857,7 @@ static int TsStart( es_out_t *p_out )
         return VLC_EGENERIC;
 
     p_ts->i_tmp_size_max = p_sys->i_tmp_size_max;
+    p_ts->i_history_max = p_sys->i_history_max;
     p_ts->psz_tmp_path = p_sys->psz_tmp_path;
     p_ts->p_input = p_sys->p_input;
     p_ts->p_out = p_sys->p_out;
@@ -800,8 +871,12 @@ static int TsStart( es_out_t *p_out )
     p_ts->i_rate_delay = 0;
     p_ts->i_buffering_delay = 0;
     p_ts->i_cmd_delay = 0;
+    p_ts->p_storage_h = NULL;
     p_ts->p_storage_r = NULL;
     p_ts->p_storage_w = NULL;
+    p_ts->i_index_time = -1;
+    p_ts->i_index_date = -1;
+    p_ts->seek.b_pending = false;
 
     p_sys->b_delayed = true;
     if( vlc_clone( &p_ts->thread, TsRun, p_ts, VLC_THREAD_PRIORITY_INPUT ) )
@@ -820,6 +895,16 @@ static void TsAutoStop( es_out_t *p_out )
 {
     es_out_sys_t *p_sys = p_out->p_sys;
 
+    if( p_sys->i_history_max > 0 )
+    {
+        /* Keep spooling live streams so that they can be rewound at any
+         * time, even if they were never paused */
+        if( !p_sys->b_delayed && !input_priv(p_sys->p_input)->b_can_pace_control
+         && TsStart( p_out ) )
+            p_sys->i_history_max = 0;
+        return;
+    }
+
     if( !p_sys->b_delayed || !TsIsUnused( p_sys->p_ts ) )
         return;
 
@@ -834,18 +919,13 @@ static void TsStop( ts_thread_t *p_ts )
     vlc_join( p_ts->thread, NULL );
 
     vlc_mutex_lock( &p_ts->lock );
-    for( ;; )
+    while( p_ts->p_storage_h )
     {
-        ts_cmd_t cmd;
+        ts_storage_t *p_next = p_ts->p_storage_h->p_next;
 
-        if( TsPopCmdLocked( p_ts, &cmd, true ) )
-            break;
-
-        CmdClean( &cmd );
+        TsStorageDelete( p_ts->p_storage_h );
+        p_ts->p_storage_h = p_next;
     }
-    assert( !p_ts->p_storage_r || !p_ts->p_storage_r->p_next );
-    if( p_ts->p_storage_r )
-        TsStorageDelete( p_ts->p_storage_r );
     vlc_mutex_unlock( &p_ts->lock );
 
     TsDestroy( p_ts );
@@ -868,19 +948,45 @@ static void TsPushCmd( ts_thread_t *p_ts, ts_cmd_t *p_cmd )
 
         if( !p_ts->p_storage_w )
         {
-            p_ts->p_storage_r = p_ts->p_storage_w = p_storage;
+            p_ts->p_storage_h = p_ts->p_storage_r = p_ts->p_storage_w = p_storage;
         }
         else
         {
             TsStoragePack( p_ts->p_storage_w );
+            /* The storage may be read back at any time from now on */
+            fflush( p_ts->p_storage_w->p_filew );
             p_ts->p_storage_w->p_next = p_storage;
             p_ts->p_storage_w = p_storage;
         }
     }
 
+    /* Track the stream time and choose the seek points */
+    ts_index_t index = { .i_cmd = p_ts->p_storage_w->i_cmd_w, .i_date = p_cmd->i_date,
+                         .i_time = p_ts->i_index_time };
+    bool b_index = false;
+
+    if( p_cmd->i_type == C_CONTROL && p_cmd->u.control.i_query == ES_OUT_SET_TIMES )
+    {
+        p_ts->i_index_time = p_cmd->u.control.u.times.i_time;
+    }
+    else if( p_cmd->i_type == C_SEND && p_ts->i_index_time > 0 )
+    {
+        const mtime_t i_elapsed = p_cmd->i_date - p_ts->i_index_date;
+
+        b_index = p_ts->i_index_date < 0 || i_elapsed >= TS_INDEX_MAX_INTERVAL ||
+                  ( i_elapsed >= TS_INDEX_MIN_INTERVAL &&
+                    ( p_cmd->u.send.p_block->i_flags & BLOCK_FLAG_TYPE_I ) );
+    }
+
     /* TODO return error and warn the user (but only once) */
     TsStoragePushCmd( p_ts->p_storage_w, p_cmd, p_ts->p_storage_r == p_ts->p_storage_w );
 
+    if( b_index && p_ts->p_storage_w->i_cmd_w > index.i_cmd )
+    {
+        TsStorageIndex( p_ts->p_storage_w, &index );
+        p_ts->i_index_date = index.i_date;
+    }
+
     vlc_cond_signal( &p_ts->wait );
 
     vlc_mutex_unlock( &p_ts->lock );
@@ -894,24 +1000,60 @@ static int TsPopCmdLocked( ts_thread_t *p_ts, ts_cmd_t *p_cmd, bool b_flush )
 
     TsStoragePopCmd( p_ts->p_storage_r, p_cmd, b_flush );
 
+    if( p_cmd->i_type == C_DEL )
+    {
+        /* The es_out_id_t is about to be freed: older commands may refer to
+         * it and must not be replayed anymore */
+        while( p_ts->p_storage_h != p_ts->p_storage_r )
+        {
+            ts_storage_t *p_next = p_ts->p_storage_h->p_next;
+
+            TsStorageDelete( p_ts->p_storage_h );
+            p_ts->p_storage_h = p_next;
+        }
+        TsStorageDiscard( p_ts->p_storage_r, p_ts->p_storage_r->i_cmd_r );
+    }
+
     while( p_ts->p_storage_r && TsStorageIsEmpty( p_ts->p_storage_r ) )
     {
         ts_storage_t *p_next = p_ts->p_storage_r->p_next;
         if( !p_next )
             break;
 
-        TsStorageDelete( p_ts->p_storage_r );
         p_ts->p_storage_r = p_next;
+        if( p_next == p_ts->p_storage_w )
+            fflush( p_next->p_filew );
+        TsTrimHistoryLocked( p_ts );
     }
 
     return VLC_SUCCESS;
 }
+static void TsTrimHistoryLocked( ts_thread_t *p_ts )
+{
+    int64_t i_size = 0;
+
+    vlc_assert_locked( &p_ts->lock );
+
+    for( ts_storage_t *p = p_ts->p_storage_h; p != p_ts->p_storage_r; p = p->p_next )
+        i_size += p->i_file_size;
+
+    /* Drop the oldest played storages first */
+    while( p_ts->p_storage_h != p_ts->p_storage_r &&
+           ( p_ts->i_history_max <= 0 || i_size > p_ts->i_history_max ) )
+    {
+        ts_storage_t *p_next = p_ts->p_storage_h->p_next;
+
+        i_size -= p_ts->p_storage_h->i_file_size;
+        TsStorageDelete( p_ts->p_storage_h );
+        p_ts->p_storage_h = p_next;
+    }
+}
 static bool TsHasCmd( ts_thread_t *p_ts )
 {
     bool b_cmd;
 
     vlc_mutex_lock( &p_ts->lock );
-    b_cmd =  TsStorageIsEmpty( p_ts->p_storage_r );
+    b_cmd = !TsStorageIsEmpty( p_ts->p_storage_r );
     vlc_mutex_unlock( &p_ts->lock );
 
     return b_cmd;
@@ -977,6 +1119,158 @@ static int TsChangeRate( ts_thread_t *p_ts, int i_src_rate, int i_rate )
 
     return i_ret;
 }
+static int TsSeek( ts_thread_t *p_ts, mtime_t i_time )
+{
+    ts_storage_t *p_storage = NULL;
+    const ts_index_t *p_index = NULL;
+
+    vlc_mutex_lock( &p_ts->lock );
+
+    /* Find the last seek point not after the requested time */
+    for( ts_storage_t *p = p_ts->p_storage_h; p != NULL; p = p->p_next )
+    {
+        const ts_index_t *p_found = TsStorageFindIndex( p, i_time );
+        if( p_found )
+        {
+            p_storage = p;
+            p_index = p_found;
+        }
+    }
+
+    if( !p_index || i_time > p_ts->i_index_time )
+    {
+        vlc_mutex_unlock( &p_ts->lock );
+        msg_Dbg( p_ts->p_input, "es out timeshift: %"PRId64" is outside "
+                 "of the buffer", i_time );
+        return VLC_EGENERIC;
+    }
+
+    /* Is the seek point before the next command to be played? */
+    bool b_backward = p_storage == p_ts->p_storage_r &&
+                      p_index->i_cmd < p_storage->i_cmd_r;
+    for( ts_storage_t *p = p_ts->p_storage_h; p != p_ts->p_storage_r; p = p->p_next )
+        if( p == p_storage )
+            b_backward = true;
+
+    if( b_backward )
+    {
+        /* Already played commands are still there, simply rewind */
+        for( ts_storage_t *p = p_storage->p_next; p != NULL; p = p->p_next )
+            p->i_cmd_r = p->i_cmd_first;
+        p_storage->i_cmd_r = p_index->i_cmd;
+        p_ts->p_storage_r = p_storage;
+        p_ts->seek.p_storage = NULL;
+    }
+    else
+    {
+        p_ts->seek.p_storage = p_storage;
+        p_ts->seek.i_cmd = p_index->i_cmd;
+    }
+    p_ts->seek.i_date = p_index->i_date;
+    p_ts->seek.b_pending = true;
+
+    vlc_cond_signal( &p_ts->wait );
+    vlc_mutex_unlock( &p_ts->lock );
+
+    msg_Dbg( p_ts->p_input, "es out timeshift: seeking %s to %"PRId64,
+             b_backward ? "backward" : "forward", p_index->i_time );
+    return VLC_SUCCESS;
+}
+/* Pops the commands skipped by the pending seek. Data and clock updates are
+ * dropped, the others still change the state of the next es_out: they are
+ * returned to be replayed without the lock held. */
+static int TsSeekPopLocked( ts_thread_t *p_ts, ts_cmd_t **pp_cmd )
+{
+    ts_cmd_t *p_cmd = NULL;
+    int i_cmd = 0;
+    int i_cmd_max = 0;
+
+    vlc_assert_locked( &p_ts->lock );
+
+    while( p_ts->seek.p_storage &&
+           ( p_ts->p_storage_r != p_ts->seek.p_storage ||
+             p_ts->p_storage_r->i_cmd_r < p_ts->seek.i_cmd ) )
+    {
+        if( i_cmd >= i_cmd_max )
+        {
+            const int i_max = __MAX( 2 * i_cmd_max, 64 );
+            ts_cmd_t *p_new = realloc( p_cmd, i_max * sizeof(*p_new) );
+
+            /* The remaining commands will simply be played */
+            if( unlikely(!p_new) )
+                break;
+            p_cmd = p_new;
+            i_cmd_max = i_max;
+        }
+
+        ts_cmd_t *p = &p_cmd[i_cmd];
+        if( TsPopCmdLocked( p_ts, p, true ) )
+            break;
+
+        switch( p->i_type )
+        {
+        case C_SEND:
+            CmdCleanSend( p );
+            continue;
+        case C_CONTROL:
+            switch( p->u.control.i_query )
+            {
+            case ES_OUT_SET_PCR:
+            case ES_OUT_SET_GROUP_PCR:
+            case ES_OUT_RESET_PCR:
+            case ES_OUT_SET_NEXT_DISPLAY_TIME:
+            case ES_OUT_SET_TIMES:
+            case ES_OUT_SET_EOS:
+                continue;
+            }
+            break;
+        }
+        i_cmd++;
+    }
+    p_ts->seek.p_storage = NULL;
+    p_ts->seek.b_pending = false;
+
+    *pp_cmd = p_cmd;
+    return i_cmd;
+}
+static void TsSeekReplay( es_out_t *p_out, ts_cmd_t *p_cmd, int i_cmd )
+{
+    for( int i = 0; i < i_cmd; i++ )
+    {
+        switch( p_cmd[i].i_type )
+        {
+        case C_ADD:
+            CmdExecuteAdd( p_out, &p_cmd[i] );
+            break;
+        case C_CONTROL:
+            CmdExecuteControl( p_out, &p_cmd[i] );
+            break;
+        case C_DEL:
+            CmdExecuteDel( p_out, &p_cmd[i] );
+            break;
+        default:
+            vlc_assert_unreachable();
+            break;
+        }
+    }
+    free( p_cmd );
+
+    /* Flush the decoders */
+    es_out_SetTime( p_out, -1 );
+}
+static void TsSeekRestartLocked( ts_thread_t *p_ts, mtime_t i_date )
+{
+    vlc_assert_locked( &p_ts->lock );
+
+    /* Restart the clock from the seek point */
+    const mtime_t i_now = mdate();
+    p_ts->i_cmd_delay = i_now - i_date;
+    p_ts->i_buffering_delay = 0;
+    p_ts->i_rate_date = -1;
+    p_ts->i_rate_delay = 0;
+    if( p_ts->b_paused )
+        p_ts->i_pause_date = i_now;
+}
 
 static void *TsRun( void *p_data )
 {
@@ -996,6 +1290,20 @@ static void *TsRun( void *p_data )
         for( ;; )
         {
             const int canc = vlc_savecancel();
+            if( p_ts->seek.b_pending )
+            {
+                const mtime_t i_date = p_ts->seek.i_date;
+                ts_cmd_t *p_cmd;
+                const int i_cmd = TsSeekPopLocked( p_ts, &p_cmd );
+
+                /* The next es_out may call back into the timeshift */
+                vlc_mutex_unlock( &p_ts->lock );
+                TsSeekReplay( p_ts->p_out, p_cmd, i_cmd );
+                vlc_mutex_lock( &p_ts->lock );
+
+                TsSeekRestartLocked( p_ts, i_date );
+                i_buffering_date = -1;
+            }
             b_buffering = es_out_GetBuffering( p_ts->p_out );
 
             if( ( !p_ts->b_paused || b_buffering ) && !TsPopCmdLocked( p_ts, &cmd, false ) )
@@ -1074,7 +1382,6 @@ static void *TsRun( void *p_data )
         {
         case C_ADD:
             CmdExecuteAdd( p_ts->p_out, &cmd );
-            CmdCleanAdd( &cmd );
             break;
         case C_SEND:
             CmdExecuteSend( p_ts->p_out, &cmd );
@@ -1082,7 +1389,6 @@ static void *TsRun( void *p_data )
             break;
         case C_CONTROL:
             CmdExecuteControl( p_ts->p_out, &cmd );
-            CmdCleanControl( &cmd );
             break;
         case C_DEL:
             CmdExecuteDel( p_ts->p_out, &cmd );
@@ -1143,9 +1449,13 @@ static ts_storage_t *TsStorageNew( const char *psz_tmp_path, int64_t i_tmp_size_
     p_storage->i_file_size = 0;
 
     /* */
+    p_storage->i_cmd_first = 0;
     p_storage->i_cmd_w = 0;
     p_storage->i_cmd_r = 0;
     p_storage->i_cmd_max = 30000;
+    p_storage->i_index = 0;
+    p_storage->i_index_max = 0;
+    p_storage->p_index = NULL;
     p_storage->p_cmd = malloc( p_storage->i_cmd_max * sizeof(*p_storage->p_cmd) );
     //fprintf( stderr, "\nSTORAGE name=%s size=%d KiB\n", p_storage->psz_file, p_storage->i_cmd_max * sizeof(*p_storage->p_cmd) /1024 );
 
@@ -1163,15 +1473,10 @@ error:
 
 static void TsStorageDelete( ts_storage_t *p_storage )
 {
-    while( p_storage->i_cmd_r < p_storage->i_cmd_w )
-    {
-        ts_cmd_t cmd;
-
-        TsStoragePopCmd( p_storage, &cmd, true );
-
-        CmdClean( &cmd );
-    }
+    if( p_storage->p_cmd )
+        TsStorageDiscard( p_storage, p_storage->i_cmd_w );
     free( p_storage->p_cmd );
+    free( p_storage->p_index );
 
     fclose( p_storage->p_filer );
     fclose( p_storage->p_filew );
@@ -1244,6 +1549,54 @@ static void TsStoragePushCmd( ts_storage_t *p_storage, const ts_cmd_t *p_cmd, bo
     }
     p_storage->p_cmd[p_storage->i_cmd_w++] = cmd;
 }
+static void TsStorageDiscard( ts_storage_t *p_storage, int i_cmd )
+{
+    /* Stored commands own their format, meta and EPG copies */
+    for( int i = p_storage->i_cmd_first; i < i_cmd; i++ )
+        CmdClean( &p_storage->p_cmd[i] );
+    p_storage->i_cmd_first = i_cmd;
+
+    int i_drop = 0;
+    while( i_drop < p_storage->i_index && p_storage->p_index[i_drop].i_cmd < i_cmd )
+        i_drop++;
+    if( i_drop > 0 )
+    {
+        p_storage->i_index -= i_drop;
+        memmove( p_storage->p_index, &p_storage->p_index[i_drop],
+                 p_storage->i_index * sizeof(*p_storage->p_index) );
+    }
+}
+static void TsStorageIndex( ts_storage_t *p_storage, const ts_index_t *p_index )
+{
+    if( p_storage->i_index >= p_storage->i_index_max )
+    {
+        const int i_max = __MAX( 2 * p_storage->i_index_max, 64 );
+        ts_index_t *p_new = realloc( p_storage->p_index, i_max * sizeof(*p_new) );
+        if( !p_new )
+            return;
+        p_storage->p_index = p_new;
+        p_storage->i_index_max = i_max;
+    }
+    p_storage->p_index[p_storage->i_index++] = *p_index;
+}
+static const ts_index_t *TsStorageFindIndex( ts_storage_t *p_storage, mtime_t i_time )
+{
+    if( p_storage->i_index <= 0 || p_storage->p_index[0].i_time > i_time )
+        return NULL;
+
+    /* Last entry whose time is not after i_time */
+    int i_low = 0;
+    int i_high = p_storage->i_index - 1;
+    while( i_low < i_high )
+    {
+        const int i_mid = (i_low + i_high + 1) / 2;
+        if( p_storage->p_index[i_mid].i_time <= i_time )
+            i_low = i_mid;
+        else
+            i_high = i_mid - 1;
+    }
+    return &p_storage->p_index[i_low];
+}
 static void TsStoragePopCmd( ts_storage_t *p_storage, ts_cmd_t *p_cmd, bool b_flush )
 {
     assert( !TsStorageIsEmpty( p_storage ) );
@@ -1321,6 +1674,9 @@ static int CmdInitAdd( ts_cmd_t *p_cmd, es_out_id_t *p_es, const es_format_t *p_
 }
 static void CmdExecuteAdd( es_out_t *p_out, ts_cmd_t *p_cmd )
 {
+    /* Already added if replayed after a seek back */
+    if( p_cmd->u.add.p_es->p_es )
+        return;
     p_cmd->u.add.p_es->p_es = es_out_Add( p_out, p_cmd->u.add.p_fmt );
 }
 static void CmdCleanAdd( ts_cmd_t *p_cmd )
@@ -1968,6 +1968,15 @@ static bool Control( input_thread_t *p_input,
             if( i_time < 0 )
                 i_time = 0;
 
+            /* While timeshifting, seek inside the timeshift buffer: it does
+             * not depend on the demuxer and works with live streams */
+            if( es_out_GetDelayed( input_priv(p_input)->p_es_out )
+             && !es_out_SetTime( input_priv(p_input)->p_es_out, i_time ) )
+            {
+                b_force_update = true;
+                break;
+            }
+
             /* Reset the decoders states and clock sync (before calling the demuxer */
             es_out_SetTime( input_priv(p_input)->p_es_out, -1 );
 
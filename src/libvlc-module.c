@@ -388,6 +388,12 @@ static const char *const ppsz_pos_descriptions[] =
     "picture quality, for instance deinterlacing, or distort " \
     "the video.")
 
+#define VIDEO_FILTER_THREADS_TEXT N_("Video filter threads")
+#define VIDEO_FILTER_THREADS_LONGTEXT N_( \
+    "Number of threads the video filters can split each picture across. " \
+    "0 uses one thread per CPU, 1 runs the filters on the video thread " \
+    "alone.")
+
 #define SNAP_PATH_TEXT N_("Video snapshot directory (or filename)")
 #define SNAP_PATH_LONGTEXT N_( \
     "Directory where the video snapshots will be stored.")
@@ -689,6 +695,12 @@ static const char *const ppsz_prefres[] = {
     "This is the maximum size in bytes of the temporary files " \
     "that will be used to store the timeshifted streams." )
 
+#define INPUT_TIMESHIFT_HISTORY_TEXT N_("Timeshift history")
+#define INPUT_TIMESHIFT_HISTORY_LONGTEXT N_( \
+    "This is the maximum size in bytes of already played data that is " \
+    "kept in the temporary files, so that live streams can be rewound. " \
+    "When not zero, live streams are always timeshifted." )
+
 #define INPUT_TITLE_FORMAT_TEXT N_( "Change title according to current media" )
 #define INPUT_TITLE_FORMAT_LONGTEXT N_( "This option allows you to set the title according to what's being played<br>"  \
     "$a: Artist<br>$b: Album<br>$c: Copyright<br>$t: Title<br>$g: Genre<br>"  \
@@ -714,6 +726,11 @@ static const char *const ppsz_prefres[] = {
 #define SUB_TEXT_SCALE_TEXT N_("Subtitles text scaling factor")
 #define SUB_TEXT_SCALE_LONGTEXT N_("Set value to alter subtitles size where possible")
 
+#define SUB_CACHE_SIZE_TEXT N_("Subpicture cache size")
+#define SUB_CACHE_SIZE_LONGTEXT N_("Memory (in KiB) used to keep the " \
+    "rendered text and the scaled subpicture regions from one video frame " \
+    "to the next. 0 disables it.")
+
 #define SPU_TEXT N_("Enable sub-pictures")
 #define SPU_LONGTEXT N_( \
     "You can completely disable the sub-picture processing.")
@@ -1032,6 +1049,14 @@ static const char *const ppsz_prefres[] = {
     "priorities. You can use it to tune VLC priority against other " \
     "programs, or against other VLC instances.")
 
+#define BLOCK_POOL_TEXT N_("Data block pool size (kB)")
+#define BLOCK_POOL_LONGTEXT N_( \
+    "Maximum amount of memory kept aside to recycle data blocks instead " \
+    "of freeing and reallocating them. This reduces the memory allocation " \
+    "overhead of high bit rate streams. The pool is shared by all the " \
+    "instances of the process, and uses the largest of their sizes. " \
+    "0 disables the pool.")
+
 #define USE_STREAM_IMMEDIATE_LONGTEXT N_( \
      "This option is useful if you want to lower the latency when " \
      "reading a stream")
@@ -1655,6 +1680,9 @@ vlc_module_begin ()
     set_subcategory( SUBCAT_VIDEO_VFILTER )
     add_module_list( "video-filter", "video filter", NULL,
                      VIDEO_FILTER_TEXT, VIDEO_FILTER_LONGTEXT, false )
+    add_integer( "filter-threads", 0, VIDEO_FILTER_THREADS_TEXT,
+                 VIDEO_FILTER_THREADS_LONGTEXT, true )
+        change_integer_range( 0, 64 )
 
     set_subcategory( SUBCAT_VIDEO_SPLITTER )
     add_module_list( "video-splitter", "video splitter", NULL,
@@ -1695,6 +1723,8 @@ vlc_module_begin ()
     add_integer_with_range( "sub-text-scale", 100, 10, 500,
                SUB_TEXT_SCALE_TEXT, SUB_TEXT_SCALE_LONGTEXT, false )
         change_volatile  ()
+    add_integer_with_range( "sub-cache-size", 16384, 0, 1048576,
+               SUB_CACHE_SIZE_TEXT, SUB_CACHE_SIZE_LONGTEXT, true )
     set_section( N_( "Overlays" ) , NULL )
     add_module_list( "sub-source", "sub source", NULL,
                      SUB_SOURCE_TEXT, SUB_SOURCE_LONGTEXT, false )
@@ -1909,6 +1939,8 @@ vlc_module_begin ()
                 INPUT_TIMESHIFT_PATH_LONGTEXT, true )
     add_integer( "input-timeshift-granularity", -1, INPUT_TIMESHIFT_GRANULARITY_TEXT,
                  INPUT_TIMESHIFT_GRANULARITY_LONGTEXT, true )
+    add_integer( "input-timeshift-history", 0, INPUT_TIMESHIFT_HISTORY_TEXT,
+                 INPUT_TIMESHIFT_HISTORY_LONGTEXT, true )
 
     add_string( "input-title-format", "$Z", INPUT_TITLE_FORMAT_TEXT, INPUT_TITLE_FORMAT_LONGTEXT, false );
 
@@ -2030,6 +2062,9 @@ vlc_module_begin ()
     add_integer( "rt-offset", 0, RT_OFFSET_TEXT,
                  RT_OFFSET_LONGTEXT, true )
 #endif
+    add_integer( "block-pool-size", 32768, BLOCK_POOL_TEXT,
+                 BLOCK_POOL_LONGTEXT, true )
+        change_integer_range( 0, 1 << 21 )
 
 #if defined(HAVE_DBUS)
     add_bool( "inhibit", 1, INHIBIT_TEXT,
@@ -93,6 +93,9 @@ libvlc_int_t * libvlc_InternalCreate( void )
     priv = libvlc_priv (p_libvlc);
     priv->playlist = NULL;
     priv->p_vlm = NULL;
+    priv->filter_slices = NULL;
+    priv->block_pool_limit = 0;
+    priv->b_block_pool = false;
 
     vlc_ExitInit( &priv->exit );
 
@@ -231,6 +234,13 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
 
     priv->b_stats = var_InheritBool( p_libvlc, "stats" );
 
+    /* The block pool is shared by the whole process: it caches up to the
+     * largest limit of the live instances. */
+    priv->block_pool_limit = var_InheritInteger( p_libvlc,
+                                                 "block-pool-size" ) << 10;
+    block_PoolInit( priv->block_pool_limit );
+    priv->b_block_pool = true;
+
     /*
      * Initialize hotkey handling
      */
@@ -244,6 +254,17 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
     if( !priv->parser )
         goto error;
 
+    /* Created after the last initialization step that can fail.
+     * Threads are only started by the first filter running slices. */
+    {
+        unsigned threads = var_InheritInteger( p_libvlc, "filter-threads" );
+        if( threads == 0 )
+            threads = vlc_GetCPUCount();
+        if( threads > 1 )
+            priv->filter_slices = filter_SlicesNew( VLC_OBJECT(p_libvlc),
+                                                    threads - 1 );
+    }
+
     /* Create a variable for showing the fullscreen interface */
     var_Create( p_libvlc, "intf-toggle-fscontrol", VLC_VAR_BOOL );
     var_SetBool( p_libvlc, "intf-toggle-fscontrol", true );
@@ -418,6 +439,12 @@ void libvlc_InternalCleanup( libvlc_int_t *p_libvlc )
 
     libvlc_InternalActionsClean( p_libvlc );
 
+    if( priv->filter_slices != NULL )
+    {
+        filter_SlicesDelete( priv->filter_slices );
+        priv->filter_slices = NULL;
+    }
+
     /* Save the configuration */
     if( !var_InheritBool( p_libvlc, "ignore-config" ) )
         config_AutoSaveConfigFile( VLC_OBJECT(p_libvlc) );
@@ -442,6 +469,8 @@ void libvlc_InternalDestroy( libvlc_int_t *p_libvlc )
     libvlc_priv_t *priv = libvlc_priv( p_libvlc );
 
     vlc_ExitDestroy( &priv->exit );
+    if( priv->b_block_pool )
+        block_PoolDeinit( priv->block_pool_limit );
 
     assert( atomic_load(&(vlc_internals(p_libvlc)->refs)) == 1 );
     vlc_object_release( p_libvlc );
@@ -72,6 +72,12 @@ int vlc_LogPreinit(libvlc_int_t *);
 int vlc_LogInit(libvlc_int_t *);
 void vlc_LogDeinit(libvlc_int_t *);
 
+/*
+ * Block pool
+ */
+void block_PoolInit(size_t limit);
+void block_PoolDeinit(size_t limit);
+
 /*
  * LibVLC exit event handling
  */
@@ -189,6 +195,9 @@ typedef struct libvlc_priv_t
     struct playlist_t *playlist; ///< Playlist for interfaces
     struct playlist_preparser_t *parser; ///< Input item meta data handler
     vlc_actions_t *actions; ///< Hotkeys handler
+    struct filter_slices *filter_slices; ///< Filters slice threads
+    size_t           block_pool_limit; ///< Block pool size allowed
+    bool             b_block_pool; ///< Registered with the block pool
 
     /* Exit callback */
     vlc_exit_t       exit;
@@ -205,6 +214,12 @@ void intf_DestroyAll( libvlc_int_t * );
 
 #define libvlc_stats( o ) (libvlc_priv((VLC_OBJECT(o))->obj.libvlc)->b_stats)
 
+/*
+ * Filters slice threads
+ */
+struct filter_slices *filter_SlicesNew( vlc_object_t *, unsigned threads );
+void filter_SlicesDelete( struct filter_slices * );
+
 /*
  * Variables stuff
  */
@@ -34,6 +34,7 @@
 #include <vlc_common.h>
 #include <vlc_block.h>
 #include <vlc_fs.h>
+#include <vlc_atomic.h>
 
 #ifndef NDEBUG
 static void BlockNoRelease( block_t *b )
@@ -117,17 +118,426 @@ static void BlockMetaCopy( block_t *restrict out, const block_t *in )
 /** Initial reserved header and footer size. */
 #define BLOCK_PADDING      32
 
+/*****************************************************************************
+ * Size-class block pool
+ *****************************************************************************
+ * Small and medium blocks are rounded up to a power-of-two allocation size
+ * and recycled on release instead of being handed back to the C allocator.
+ * Each thread keeps a short free list per size class; when it overflows, half
+ * of it is moved to a shared depot, from which other threads refill. This
+ * matters because blocks are typically allocated by one thread (access,
+ * demux) and released by another (decoder, output).
+ *
+ * A thread cache is only ever accessed by its owning thread, without locking.
+ * It is emptied into the depot when the thread exits, and when the limit is
+ * lowered: immediately for the calling thread, on their next allocation or
+ * release for the other threads.
+ *
+ * The pool is shared by the whole process. Its limit is the largest of those
+ * of the live LibVLC instances, unless overridden by block_PoolSetLimit().
+ *****************************************************************************/
+#define BLOCK_POOL_MIN_SHIFT   10 /* 1 KiB */
+#define BLOCK_POOL_CLASSES     8  /* up to 128 KiB */
+#define BLOCK_POOL_MAX_SIZE    ((size_t)1 << (BLOCK_POOL_MIN_SHIFT + BLOCK_POOL_CLASSES - 1))
+/** Blocks cached per thread and per size class before spilling to the depot */
+#define BLOCK_POOL_CACHE_DEPTH 16
+/** Default cap on the memory held by the pool (all threads) */
+#define BLOCK_POOL_DEFAULT_LIMIT (32 << 20)
+
+struct block_cache
+{
+    block_t *heads[BLOCK_POOL_CLASSES];
+    unsigned counts[BLOCK_POOL_CLASSES];
+    unsigned trims; /**< Value of depot.trims when last emptied */
+};
+
+/** Cache of the calling thread, for lookup without a function call */
+static thread_local struct block_cache *block_cache_self = NULL;
+
+static struct
+{
+    vlc_mutex_t lock;
+    block_t *heads[BLOCK_POOL_CLASSES];
+    unsigned counts[BLOCK_POOL_CLASSES];
+    atomic_uint trims; /**< Bumped to have the thread caches emptied */
+    bool key_created;
+    vlc_threadvar_t key; /**< Thread exit hook, kept for the process life */
+    size_t *limits; /**< Limits of the live LibVLC instances */
+    unsigned instances;
+} depot = { .lock = VLC_STATIC_MUTEX };
+
+static struct
+{
+    atomic_size_t limit;
+    atomic_size_t held;
+    atomic_uint_least64_t hits;
+    atomic_uint_least64_t misses;
+    atomic_uint_least64_t drops;
+} pool_stats = {
+    ATOMIC_VAR_INIT(BLOCK_POOL_DEFAULT_LIMIT), ATOMIC_VAR_INIT(0),
+    ATOMIC_VAR_INIT(0), ATOMIC_VAR_INIT(0), ATOMIC_VAR_INIT(0),
+};
+
+static unsigned block_pool_Class (size_t alloc)
+{
+    unsigned cls = 0;
+
+    while (((size_t)1 << (BLOCK_POOL_MIN_SHIFT + cls)) < alloc)
+        cls++;
+    return cls;
+}
+
+static size_t block_pool_ClassSize (unsigned cls)
+{
+    return (size_t)1 << (BLOCK_POOL_MIN_SHIFT + cls);
+}
+
+/** Frees the first block of a free list. */
+static void block_pool_Free (block_t **restrict headp, unsigned *countp,
+                             unsigned cls)
+{
+    block_t *b = *headp;
+
+    *headp = b->p_next;
+    (*countp)--;
+    atomic_fetch_sub_explicit (&pool_stats.held, block_pool_ClassSize (cls),
+                               memory_order_relaxed);
+    free (b);
+}
+
+/** Detaches up to count blocks from the head of a free list.
+ * \return the number of blocks in the [*firstp, *lastp] chain */
+static unsigned block_pool_Detach (block_t **restrict headp, unsigned *countp,
+                                   unsigned count, block_t **restrict firstp,
+                                   block_t **restrict lastp)
+{
+    if (count > *countp)
+        count = *countp;
+    if (count == 0)
+        return 0;
+
+    block_t *first = *headp, *last = first;
+    for (unsigned i = 1; i < count; i++)
+        last = last->p_next;
+
+    *headp = last->p_next;
+    *countp -= count;
+    last->p_next = NULL;
+    *firstp = first;
+    *lastp = last;
+    return count;
+}
+
+/** Moves a chain of count blocks to the depot. Depot lock held. */
+static void block_pool_SpillLocked (block_t *first, block_t *last,
+                                    unsigned cls, unsigned count)
+{
+    last->p_next = depot.heads[cls];
+    depot.heads[cls] = first;
+    depot.counts[cls] += count;
+}
+
+static bool block_pool_Over (size_t limit)
+{
+    return atomic_load_explicit (&pool_stats.held,
+                                 memory_order_relaxed) > limit;
+}
+
+/** Frees depot blocks, largest first, until the pool fits its limit.
+ * Depot lock held. */
+static void block_pool_TrimLocked (void)
+{
+    size_t limit = atomic_load_explicit (&pool_stats.limit,
+                                         memory_order_relaxed);
+
+    for (unsigned cls = BLOCK_POOL_CLASSES; cls-- > 0;)
+        while (depot.heads[cls] != NULL && block_pool_Over (limit))
+            block_pool_Free (&depot.heads[cls], &depot.counts[cls], cls);
+}
+
+/** Moves all the blocks of a thread cache to the depot, then trims it. */
+static void block_cache_Empty (struct block_cache *cache)
+{
+    vlc_mutex_lock (&depot.lock);
+    for (unsigned cls = 0; cls < BLOCK_POOL_CLASSES; cls++)
+    {
+        block_t *first, *last;
+        unsigned count = block_pool_Detach (&cache->heads[cls],
+                                            &cache->counts[cls],
+                                            cache->counts[cls], &first, &last);
+        if (count > 0)
+            block_pool_SpillLocked (first, last, cls, count);
+    }
+    block_pool_TrimLocked ();
+    vlc_mutex_unlock (&depot.lock);
+}
+
+/** Thread exit: runs in the owning thread. */
+static void block_cache_Destroy (void *data)
+{
+    struct block_cache *cache = data;
+
+    assert (cache == block_cache_self);
+    block_cache_self = NULL;
+    block_cache_Empty (cache);
+    free (cache);
+}
+
+static struct block_cache *block_cache_Create (void)
+{
+    vlc_mutex_lock (&depot.lock);
+    if (!depot.key_created
+     && vlc_threadvar_create (&depot.key, block_cache_Destroy) == 0)
+        depot.key_created = true;
+    bool ok = depot.key_created;
+    vlc_mutex_unlock (&depot.lock);
+
+    if (unlikely(!ok))
+        return NULL;
+
+    struct block_cache *cache = calloc (1, sizeof (*cache));
+    if (unlikely(cache == NULL))
+        return NULL;
+
+    cache->trims = atomic_load_explicit (&depot.trims, memory_order_relaxed);
+    if (unlikely(vlc_threadvar_set (depot.key, cache)))
+    {
+        free (cache);
+        return NULL;
+    }
+    block_cache_self = cache;
+    return cache;
+}
+
+static struct block_cache *block_cache_Get (void)
+{
+    struct block_cache *cache = block_cache_self;
+
+    if (unlikely(cache == NULL))
+        return block_cache_Create ();
+
+    unsigned trims = atomic_load_explicit (&depot.trims, memory_order_relaxed);
+    if (unlikely(cache->trims != trims))
+    {   /* The limit was lowered */
+        cache->trims = trims;
+        block_cache_Empty (cache);
+    }
+    return cache;
+}
+
+static block_t *block_pool_Get (unsigned cls)
+{
+    struct block_cache *cache = block_cache_Get ();
+    if (unlikely(cache == NULL))
+        return NULL;
+
+    block_t *b = cache->heads[cls];
+    if (b != NULL)
+    {
+        cache->heads[cls] = b->p_next;
+        cache->counts[cls]--;
+    }
+    else
+    {   /* Refill from the depot */
+        block_t *last;
+
+        vlc_mutex_lock (&depot.lock);
+        unsigned count = block_pool_Detach (&depot.heads[cls],
+                                            &depot.counts[cls],
+                                            BLOCK_POOL_CACHE_DEPTH / 2,
+                                            &b, &last);
+        vlc_mutex_unlock (&depot.lock);
+
+        if (count == 0)
+        {
+            atomic_fetch_add_explicit (&pool_stats.misses, 1,
+                                       memory_order_relaxed);
+            return NULL;
+        }
+
+        if (count > 1)
+        {
+            last->p_next = cache->heads[cls];
+            cache->heads[cls] = b->p_next;
+            cache->counts[cls] += count - 1;
+        }
+    }
+
+    atomic_fetch_sub_explicit (&pool_stats.held, block_pool_ClassSize (cls),
+                               memory_order_relaxed);
+    atomic_fetch_add_explicit (&pool_stats.hits, 1, memory_order_relaxed);
+    return b;
+}
+
+static void block_pool_Release (block_t *block)
+{
+    assert (block->p_start == (unsigned char *)(block + 1));
+    block_Invalidate (block);
+
+    const size_t alloc = sizeof (*block) + block->i_size;
+    const unsigned cls = block_pool_Class (alloc);
+    assert (block_pool_ClassSize (cls) == alloc);
+
+    struct block_cache *cache = block_cache_Get ();
+    if (unlikely(cache == NULL))
+        goto drop;
+
+    size_t held = atomic_fetch_add_explicit (&pool_stats.held, alloc,
+                                             memory_order_relaxed);
+    if (held + alloc > atomic_load_explicit (&pool_stats.limit,
+                                             memory_order_relaxed))
+    {
+        atomic_fetch_sub_explicit (&pool_stats.held, alloc,
+                                   memory_order_relaxed);
+        goto drop;
+    }
+
+    block->p_next = cache->heads[cls];
+    cache->heads[cls] = block;
+    if (++cache->counts[cls] > BLOCK_POOL_CACHE_DEPTH)
+    {
+        block_t *first, *last;
+        unsigned count = block_pool_Detach (&cache->heads[cls],
+                                            &cache->counts[cls],
+                                            BLOCK_POOL_CACHE_DEPTH / 2,
+                                            &first, &last);
+        vlc_mutex_lock (&depot.lock);
+        block_pool_SpillLocked (first, last, cls, count);
+        vlc_mutex_unlock (&depot.lock);
+    }
+    return;
+
+drop:
+    atomic_fetch_add_explicit (&pool_stats.drops, 1, memory_order_relaxed);
+    free (block);
+}
+
+/** Applies a new limit. Depot lock held. */
+static void block_pool_SetLimitLocked (size_t limit)
+{
+    size_t old = atomic_exchange_explicit (&pool_stats.limit, limit,
+                                           memory_order_relaxed);
+    if (limit < old)
+        atomic_fetch_add_explicit (&depot.trims, 1, memory_order_relaxed);
+    block_pool_TrimLocked ();
+}
+
+void block_PoolSetLimit (size_t limit)
+{
+    vlc_mutex_lock (&depot.lock);
+    block_pool_SetLimitLocked (limit);
+    vlc_mutex_unlock (&depot.lock);
+
+    /* Other threads empty their cache on their next pool operation */
+    block_cache_Get ();
+}
+
+/** Sets the limit to the largest of the live instances. Depot lock held. */
+static void block_pool_UpdateLimitLocked (void)
+{
+    size_t limit = 0;
+
+    for (unsigned i = 0; i < depot.instances; i++)
+        if (depot.limits[i] > limit)
+            limit = depot.limits[i];
+    block_pool_SetLimitLocked (limit);
+}
+
+/**
+ * Registers a LibVLC instance with the pool.
+ * \param limit memory the instance allows the pool to cache
+ */
+void block_PoolInit (size_t limit)
+{
+    vlc_mutex_lock (&depot.lock);
+    size_t *tab = realloc (depot.limits,
+                           (depot.instances + 1) * sizeof (*tab));
+    if (likely(tab != NULL))
+    {
+        depot.limits = tab;
+        depot.limits[depot.instances++] = limit;
+        block_pool_UpdateLimitLocked ();
+    }
+    vlc_mutex_unlock (&depot.lock);
+}
+
+/**
+ * Unregisters a LibVLC instance from the pool. The last one frees the blocks
+ * of the depot and of the calling thread; those cached by other threads are
+ * freed when they exit.
+ */
+void block_PoolDeinit (size_t limit)
+{
+    vlc_mutex_lock (&depot.lock);
+    for (unsigned i = 0; i < depot.instances; i++)
+        if (depot.limits[i] == limit)
+        {
+            depot.limits[i] = depot.limits[--depot.instances];
+            break;
+        }
+
+    if (depot.instances > 0)
+    {
+        block_pool_UpdateLimitLocked ();
+        vlc_mutex_unlock (&depot.lock);
+        return;
+    }
+
+    free (depot.limits);
+    depot.limits = NULL;
+    vlc_mutex_unlock (&depot.lock);
+
+    if (block_cache_self != NULL)
+        block_cache_Empty (block_cache_self);
+
+    vlc_mutex_lock (&depot.lock);
+    for (unsigned cls = 0; cls < BLOCK_POOL_CLASSES; cls++)
+        while (depot.heads[cls] != NULL)
+            block_pool_Free (&depot.heads[cls], &depot.counts[cls], cls);
+    vlc_mutex_unlock (&depot.lock);
+}
+
+void block_PoolGetStats (block_pool_stats_t *stats)
+{
+    stats->i_hits = atomic_load_explicit (&pool_stats.hits,
+                                          memory_order_relaxed);
+    stats->i_misses = atomic_load_explicit (&pool_stats.misses,
+                                            memory_order_relaxed);
+    stats->i_drops = atomic_load_explicit (&pool_stats.drops,
+                                           memory_order_relaxed);
+    stats->i_bytes_held = atomic_load_explicit (&pool_stats.held,
+                                                memory_order_relaxed);
+    stats->i_bytes_limit = atomic_load_explicit (&pool_stats.limit,
+                                                 memory_order_relaxed);
+}
+
 block_t *block_Alloc (size_t size)
 {
     /* 2 * BLOCK_PADDING: pre + post padding */
-    const size_t alloc = sizeof (block_t) + BLOCK_ALIGN + (2 * BLOCK_PADDING)
-                       + size;
+    size_t alloc = sizeof (block_t) + BLOCK_ALIGN + (2 * BLOCK_PADDING)
+                 + size;
     if (unlikely(alloc <= size))
         return NULL;
 
-    block_t *b = malloc (alloc);
-    if (unlikely(b == NULL))
-        return NULL;
+    block_t *b = NULL;
+    block_free_t release = block_generic_Release;
+
+    if (alloc <= BLOCK_POOL_MAX_SIZE
+     && atomic_load_explicit (&pool_stats.limit, memory_order_relaxed) > 0)
+    {
+        const unsigned cls = block_pool_Class (alloc);
+
+        alloc = block_pool_ClassSize (cls);
+        release = block_pool_Release;
+        b = block_pool_Get (cls);
+    }
+
+    if (b == NULL)
+    {
+        b = malloc (alloc);
+        if (unlikely(b == NULL))
+            return NULL;
+    }
 
     block_Init (b, b + 1, alloc - sizeof (*b));
     static_assert ((BLOCK_PADDING % BLOCK_ALIGN) == 0,
@@ -135,7 +545,7 @@ block_t *block_Alloc (size_t size)
     b->p_buffer += BLOCK_PADDING + BLOCK_ALIGN - 1;
     b->p_buffer = (void *)(((uintptr_t)b->p_buffer) & ~(BLOCK_ALIGN - 1));
     b->i_buffer = size;
-    b->pf_release = block_generic_Release;
+    b->pf_release = release;
     return b;
 }
 
@@ -281,7 +691,7 @@ block_t *block_mmap_Alloc (void *addr, size_t length)
     block_t *block = malloc (sizeof (*block));
     if (block == NULL)
     {
-        munmap (addr, length);
+        munmap (((char *)addr) - left, left + length + right);
         return NULL;
     }
 
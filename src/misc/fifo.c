@@ -30,6 +30,7 @@
 
 #include <vlc_common.h>
 #include <vlc_block.h>
+#include <vlc_atomic.h>
 #include "libvlc.h"
 
 /**
@@ -44,8 +45,129 @@ struct block_fifo_t
     block_t             **pp_last;
     size_t              i_depth;
     size_t              i_size;
+
+    /* Lock-free mode: producers push onto a LIFO stack; the consumer detaches
+     * the whole stack at once and appends it, reversed, to the list above,
+     * which is then only accessed by the consumer side. The consumer
+     * announces that it goes to sleep by setting the empty stack to
+     * VLC_FIFO_SLEEPING, so that the producer that replaces it wakes it up:
+     * the wake-up state and the queue cannot be observed out of order. */
+    bool                b_mpsc;
+    atomic_uintptr_t    stack;
+    /* Producers account blocks once published, the consumer once removed.
+     * The difference never exceeds what the consumer can dequeue. */
+    atomic_size_t       pushed_depth;
+    atomic_size_t       pushed_size;
+    atomic_size_t       popped_depth;
+    atomic_size_t       popped_size;
 };
 
+#define VLC_FIFO_SLEEPING ((uintptr_t)1)
+
+/**
+ * Pushes a block chain on the lock-free stack.
+ * @return whether the consumer needs to be woken up
+ */
+static bool vlc_fifo_Push(vlc_fifo_t *fifo, block_t *block)
+{
+    block_t *first = NULL, *last = block;
+    size_t depth = 0, size = 0;
+
+    /* Reverse the chain, so that the stack pops it in order */
+    while (block != NULL)
+    {
+        block_t *next = block->p_next;
+
+        block->p_next = first;
+        first = block;
+        depth++;
+        size += block->i_buffer;
+        block = next;
+    }
+
+    if (first == NULL)
+        return false;
+
+    uintptr_t head = atomic_load_explicit(&fifo->stack, memory_order_relaxed);
+    do
+        last->p_next = (head != VLC_FIFO_SLEEPING) ? (block_t *)head : NULL;
+    while (!atomic_compare_exchange_weak(&fifo->stack, &head,
+                                         (uintptr_t)first));
+
+    /* Account only once published, so that the counters never announce
+     * blocks that the consumer cannot dequeue yet. */
+    atomic_fetch_add_explicit(&fifo->pushed_depth, depth, memory_order_release);
+    atomic_fetch_add_explicit(&fifo->pushed_size, size, memory_order_release);
+
+    return head == VLC_FIFO_SLEEPING;
+}
+
+/**
+ * Moves the lock-free stack at the end of the consumer list.
+ */
+static void vlc_fifo_Splice(vlc_fifo_t *fifo)
+{
+    uintptr_t head = atomic_load(&fifo->stack);
+
+    /* Leave the sleeping mark in place: the consumer may be waiting while
+     * another thread dequeues with the lock held. */
+    do
+        if (head == 0 || head == VLC_FIFO_SLEEPING)
+            return;
+    while (!atomic_compare_exchange_weak(&fifo->stack, &head, 0));
+
+    block_t *block = (block_t *)head, *first = NULL, **pp_last = fifo->pp_last;
+
+    fifo->pp_last = &block->p_next;
+    while (block != NULL)
+    {
+        block_t *next = block->p_next;
+
+        block->p_next = first;
+        first = block;
+        fifo->i_depth++;
+        fifo->i_size += block->i_buffer;
+        block = next;
+    }
+    *pp_last = first;
+}
+
+static block_t *vlc_fifo_Pop(vlc_fifo_t *fifo)
+{
+    if (fifo->p_first == NULL)
+        vlc_fifo_Splice(fifo);
+
+    block_t *block = fifo->p_first;
+    if (block == NULL)
+        return NULL;
+
+    fifo->p_first = block->p_next;
+    if (block->p_next == NULL)
+        fifo->pp_last = &fifo->p_first;
+    block->p_next = NULL;
+
+    assert(fifo->i_depth > 0);
+    fifo->i_depth--;
+    fifo->i_size -= block->i_buffer;
+    atomic_fetch_add_explicit(&fifo->popped_depth, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&fifo->popped_size, block->i_buffer,
+                              memory_order_relaxed);
+    return block;
+}
+
+/**
+ * Returns the difference of the producer and consumer counters. A producer
+ * may still have to account a block already removed by the consumer.
+ */
+static size_t vlc_fifo_Counter(const atomic_size_t *pushed,
+                               const atomic_size_t *popped)
+{
+    size_t out = atomic_load_explicit(popped, memory_order_relaxed);
+    size_t in = atomic_load_explicit(pushed, memory_order_acquire);
+
+    return (in > out) ? in - out : 0;
+}
+
 void vlc_fifo_Lock(vlc_fifo_t *fifo)
 {
     vlc_mutex_lock(&fifo->lock);
@@ -63,6 +185,27 @@ void vlc_fifo_Signal(vlc_fifo_t *fifo)
 
 void vlc_fifo_Wait(vlc_fifo_t *fifo)
 {
+    if (fifo->b_mpsc)
+    {
+        uintptr_t head = 0;
+
+        vlc_assert_locked(&fifo->lock);
+        /* A producer may have pushed without the lock after the caller
+         * checked the FIFO. Then collect it and return as a spurious
+         * wake-up. Otherwise, the next producer sees the sleeping mark, and
+         * cannot signal before the condition wait releases the lock. */
+        if (!atomic_compare_exchange_strong(&fifo->stack, &head,
+                                            VLC_FIFO_SLEEPING))
+        {
+            vlc_fifo_Splice(fifo);
+            return;
+        }
+        vlc_fifo_WaitCond(fifo, &fifo->wait);
+        /* Clear the mark, unless a producer already replaced it */
+        head = VLC_FIFO_SLEEPING;
+        atomic_compare_exchange_strong(&fifo->stack, &head, 0);
+        return;
+    }
     vlc_fifo_WaitCond(fifo, &fifo->wait);
 }
 
@@ -78,17 +221,29 @@ int vlc_fifo_TimedWaitCond(vlc_fifo_t *fifo, vlc_cond_t *condvar, mtime_t deadli
 
 size_t vlc_fifo_GetCount(const vlc_fifo_t *fifo)
 {
+    if (fifo->b_mpsc)
+        return vlc_fifo_Counter(&fifo->pushed_depth, &fifo->popped_depth);
     return fifo->i_depth;
 }
 
 size_t vlc_fifo_GetBytes(const vlc_fifo_t *fifo)
 {
+    if (fifo->b_mpsc)
+        return vlc_fifo_Counter(&fifo->pushed_size, &fifo->popped_size);
     return fifo->i_size;
 }
 
 void vlc_fifo_QueueUnlocked(block_fifo_t *fifo, block_t *block)
 {
     vlc_assert_locked(&fifo->lock);
+
+    if (fifo->b_mpsc)
+    {
+        vlc_fifo_Push(fifo, block);
+        vlc_fifo_Signal(fifo);
+        return;
+    }
+
     assert(*(fifo->pp_last) == NULL);
 
     *(fifo->pp_last) = block;
@@ -109,6 +264,9 @@ block_t *vlc_fifo_DequeueUnlocked(block_fifo_t *fifo)
 {
     vlc_assert_locked(&fifo->lock);
 
+    if (fifo->b_mpsc)
+        return vlc_fifo_Pop(fifo);
+
     block_t *block = fifo->p_first;
 
     if (block == NULL)
@@ -131,6 +289,15 @@ block_t *vlc_fifo_DequeueAllUnlocked(block_fifo_t *fifo)
 {
     vlc_assert_locked(&fifo->lock);
 
+    if (fifo->b_mpsc)
+    {
+        vlc_fifo_Splice(fifo);
+        atomic_fetch_add_explicit(&fifo->popped_depth, fifo->i_depth,
+                                  memory_order_relaxed);
+        atomic_fetch_add_explicit(&fifo->popped_size, fifo->i_size,
+                                  memory_order_relaxed);
+    }
+
     block_t *block = fifo->p_first;
 
     fifo->p_first = NULL;
@@ -152,12 +319,28 @@ block_fifo_t *block_FifoNew( void )
     p_fifo->p_first = NULL;
     p_fifo->pp_last = &p_fifo->p_first;
     p_fifo->i_depth = p_fifo->i_size = 0;
+    p_fifo->b_mpsc = false;
+    atomic_init( &p_fifo->stack, 0 );
+    atomic_init( &p_fifo->pushed_depth, 0 );
+    atomic_init( &p_fifo->pushed_size, 0 );
+    atomic_init( &p_fifo->popped_depth, 0 );
+    atomic_init( &p_fifo->popped_size, 0 );
 
     return p_fifo;
 }
 
+block_fifo_t *block_FifoNewMPSC( void )
+{
+    block_fifo_t *p_fifo = block_FifoNew();
+    if( p_fifo != NULL )
+        p_fifo->b_mpsc = true;
+    return p_fifo;
+}
+
 void block_FifoRelease( block_fifo_t *p_fifo )
 {
+    if( p_fifo->b_mpsc )
+        vlc_fifo_Splice( p_fifo );
     block_ChainRelease( p_fifo->p_first );
     vlc_cond_destroy( &p_fifo->wait );
     vlc_mutex_destroy( &p_fifo->lock );
@@ -176,6 +359,17 @@ void block_FifoEmpty(block_fifo_t *fifo)
 
 void block_FifoPut(block_fifo_t *fifo, block_t *block)
 {
+    if (fifo->b_mpsc)
+    {   /* Only take the lock if the consumer is asleep */
+        if (vlc_fifo_Push(fifo, block))
+        {
+            vlc_fifo_Lock(fifo);
+            vlc_fifo_Signal(fifo);
+            vlc_fifo_Unlock(fifo);
+        }
+        return;
+    }
+
     vlc_fifo_Lock(fifo);
     vlc_fifo_QueueUnlocked(fifo, block);
     vlc_fifo_Unlock(fifo);
@@ -187,6 +381,21 @@ block_t *block_FifoGet(block_fifo_t *fifo)
 
     vlc_testcancel();
 
+    if (fifo->b_mpsc)
+    {
+        block = vlc_fifo_Pop(fifo);
+        if (likely(block != NULL))
+            return block;
+
+        vlc_fifo_Lock(fifo);
+        vlc_fifo_CleanupPush(fifo);
+        while ((block = vlc_fifo_Pop(fifo)) == NULL)
+            vlc_fifo_Wait(fifo);
+        vlc_cleanup_pop();
+        vlc_fifo_Unlock(fifo);
+        return block;
+    }
+
     vlc_fifo_Lock(fifo);
     while (vlc_fifo_IsEmpty(fifo))
     {
@@ -205,6 +414,8 @@ block_t *block_FifoShow( block_fifo_t *p_fifo )
     block_t *b;
 
     vlc_mutex_lock( &p_fifo->lock );
+    if( p_fifo->b_mpsc && p_fifo->p_first == NULL )
+        vlc_fifo_Splice( p_fifo );
     assert(p_fifo->p_first != NULL);
     b = p_fifo->p_first;
     vlc_mutex_unlock( &p_fifo->lock );
@@ -217,6 +428,9 @@ size_t block_FifoSize (block_fifo_t *fifo)
 {
     size_t size;
 
+    if (fifo->b_mpsc)
+        return vlc_fifo_GetBytes(fifo);
+
     vlc_mutex_lock (&fifo->lock);
     size = fifo->i_size;
     vlc_mutex_unlock (&fifo->lock);
@@ -228,6 +442,9 @@ size_t block_FifoCount (block_fifo_t *fifo)
 {
     size_t depth;
 
+    if (fifo->b_mpsc)
+        return vlc_fifo_GetCount(fifo);
+
     vlc_mutex_lock (&fifo->lock);
     depth = fifo->i_depth;
     vlc_mutex_unlock (&fifo->lock);
@@ -180,6 +180,168 @@ void filter_DeleteBlend( filter_t *p_blend )
     vlc_object_release( p_blend );
 }
 
+/* */
+
+struct filter_slice_job
+{
+    struct filter_slice_job *next;
+    filter_t *filter;
+    filter_slice_cb cb;
+    void *opaque;
+    unsigned slices; /* number of slices */
+    unsigned started; /* number of slices handed out */
+    unsigned pending; /* number of slices not yet completed */
+};
+
+struct filter_slices
+{
+    vlc_object_t *obj;
+    vlc_mutex_t lock;
+    vlc_cond_t wait; /* a job was queued, or quit */
+    vlc_cond_t done; /* a job was completed */
+    struct filter_slice_job *jobs;
+    bool quit;
+    unsigned count; /* number of threads wanted */
+    unsigned running; /* number of threads started */
+    vlc_thread_t threads[];
+};
+
+/* Runs the next slice of a job, with the pool lock held */
+static void filter_SliceRun( struct filter_slices *pool,
+                             struct filter_slice_job *job )
+{
+    const unsigned slice = job->started++;
+
+    if( job->started == job->slices )
+    {   /* Last slice handed out: nobody else needs to see the job */
+        struct filter_slice_job **pp = &pool->jobs;
+        while( *pp != job )
+            pp = &(*pp)->next;
+        *pp = job->next;
+    }
+
+    vlc_mutex_unlock( &pool->lock );
+    job->cb( job->filter, job->opaque, slice, job->slices );
+    vlc_mutex_lock( &pool->lock );
+
+    if( --job->pending == 0 )
+        vlc_cond_broadcast( &pool->done );
+}
+
+static void *filter_SliceThread( void *data )
+{
+    struct filter_slices *pool = data;
+
+    vlc_mutex_lock( &pool->lock );
+    for( ;; )
+    {
+        while( pool->jobs == NULL && !pool->quit )
+            vlc_cond_wait( &pool->wait, &pool->lock );
+        if( pool->jobs == NULL )
+            break;
+        filter_SliceRun( pool, pool->jobs );
+    }
+    vlc_mutex_unlock( &pool->lock );
+    return NULL;
+}
+
+struct filter_slices *filter_SlicesNew( vlc_object_t *obj, unsigned threads )
+{
+    struct filter_slices *pool =
+        malloc( sizeof(*pool) + threads * sizeof(pool->threads[0]) );
+    if( unlikely(pool == NULL) )
+        return NULL;
+
+    pool->obj = obj;
+    vlc_mutex_init( &pool->lock );
+    vlc_cond_init( &pool->wait );
+    vlc_cond_init( &pool->done );
+    pool->jobs = NULL;
+    pool->quit = false;
+    pool->count = threads;
+    pool->running = 0;
+    return pool;
+}
+
+void filter_SlicesDelete( struct filter_slices *pool )
+{
+    vlc_mutex_lock( &pool->lock );
+    assert( pool->jobs == NULL );
+    pool->quit = true;
+    vlc_cond_broadcast( &pool->wait );
+    vlc_mutex_unlock( &pool->lock );
+
+    for( unsigned i = 0; i < pool->running; i++ )
+        vlc_join( pool->threads[i], NULL );
+
+    vlc_cond_destroy( &pool->done );
+    vlc_cond_destroy( &pool->wait );
+    vlc_mutex_destroy( &pool->lock );
+    free( pool );
+}
+
+void filter_RunSlices( filter_t *p_filter, unsigned i_max_slices,
+                       filter_slice_cb cb, void *opaque )
+{
+    struct filter_slices *pool =
+        libvlc_priv( p_filter->obj.libvlc )->filter_slices;
+    unsigned slices = 1;
+
+    if( pool != NULL )
+    {
+        slices = pool->count + 1;
+        if( slices > i_max_slices )
+            slices = i_max_slices;
+    }
+
+    if( slices <= 1 )
+    {
+        cb( p_filter, opaque, 0, 1 );
+        return;
+    }
+
+    struct filter_slice_job job = {
+        .next = NULL,
+        .filter = p_filter,
+        .cb = cb,
+        .opaque = opaque,
+        .slices = slices,
+        .started = 0,
+        .pending = slices,
+    };
+
+    /* The job lives on this stack: do not leave before it is completed */
+    int canc = vlc_savecancel();
+
+    vlc_mutex_lock( &pool->lock );
+    while( pool->running < pool->count )
+    {
+        if( vlc_clone( &pool->threads[pool->running], filter_SliceThread,
+                       pool, VLC_THREAD_PRIORITY_VIDEO ) )
+        {
+            msg_Err( pool->obj, "cannot start filter thread" );
+            pool->count = pool->running;
+            break;
+        }
+        pool->running++;
+    }
+
+    struct filter_slice_job **pp = &pool->jobs;
+    while( *pp != NULL )
+        pp = &(*pp)->next;
+    *pp = &job;
+    vlc_cond_broadcast( &pool->wait );
+
+    /* Take part in the work, then wait for the slices run by the threads */
+    while( job.started < job.slices )
+        filter_SliceRun( pool, &job );
+    while( job.pending > 0 )
+        vlc_cond_wait( &pool->done, &pool->lock );
+    vlc_mutex_unlock( &pool->lock );
+
+    vlc_restorecancel( canc );
+}
+
 /* */
 #include <vlc_video_splitter.h>
 
@@ -29,3 +29,9 @@ struct subpicture_region_private_t {
 subpicture_region_private_t *subpicture_region_private_New(video_format_t *);
 void subpicture_region_private_Delete(subpicture_region_private_t *);
 
+/**
+ * Same as subpicture_Update(), also telling whether the regions were rebuilt.
+ */
+bool subpicture_UpdateChanged(subpicture_t *, const video_format_t *src,
+                              const video_format_t *dst, mtime_t);
+
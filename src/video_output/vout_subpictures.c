@@ -61,11 +61,73 @@ typedef struct {
     spu_heap_entry_t entry[VOUT_MAX_SUBPICTURES];
 } spu_heap_t;
 
+/* Number of rendered text regions and scaled regions kept across frames */
+#define SPU_CACHE_TEXT_COUNT   (8)
+#define SPU_CACHE_REGION_COUNT (8)
+/* Number of renderings after which an unused entry is dropped */
+#define SPU_CACHE_MAX_AGE      (250)
+#define SPU_CACHE_MAX_CHROMAS  (16)
+
+typedef struct {
+    /* What was given to the text renderer */
+    text_segment_t *text;
+    video_format_t fmt_text;
+    int            x;
+    int            y;
+    int            align;
+    int            text_align;
+    bool           noregionbg;
+    bool           gridmode;
+    bool           balanced_text;
+    int            max_width;
+    int            max_height;
+    unsigned       width;           /* text renderer output size */
+    unsigned       height;
+    int            text_scale;
+    vlc_fourcc_t   chroma_list[SPU_CACHE_MAX_CHROMAS];
+
+    /* Rendered text, NULL if the entry is unused */
+    video_format_t fmt;
+    picture_t      *picture;
+    size_t         size;            /* bytes held by the entry */
+    unsigned       last_use;
+} spu_cache_text_t;
+
+typedef struct {
+    /* Key */
+    int            channel;
+    int64_t        order;
+    mtime_t        start;
+    unsigned       index;           /* region index inside the subpicture */
+    unsigned       width;           /* scaled size */
+    unsigned       height;
+    vlc_fourcc_t   chroma;          /* converted chroma, 0 if not converted */
+
+    /* Source region */
+    video_format_t fmt_src;
+    picture_t      *src;
+
+    /* Scaled region, NULL if the entry is unused */
+    video_format_t fmt;
+    picture_t      *picture;
+    size_t         size;            /* bytes held by the entry */
+    unsigned       last_use;
+} spu_cache_region_t;
+
+typedef struct {
+    unsigned           date;        /* incremented on every rendering */
+    size_t             size;        /* bytes held by all the entries */
+    size_t             max_size;
+    spu_cache_text_t   text[SPU_CACHE_TEXT_COUNT];
+    spu_cache_region_t region[SPU_CACHE_REGION_COUNT];
+} spu_cache_t;
+
 struct spu_private_t {
     vlc_mutex_t  lock;            /* lock to protect all followings fields */
     vlc_object_t *input;
 
     spu_heap_t   heap;
+    spu_cache_t  cache;       /**< rendered and scaled regions */
 
     int channel;             /**< number of subpicture channels registered */
     filter_t *text;                              /**< text renderer module */
@@ -159,6 +221,318 @@ static void SpuHeapClean(spu_heap_t *heap)
     }
 }
 
+/*****************************************************************************
+ * render cache management
+ *****************************************************************************
+ * Subpictures are often rebuilt with the same content (subtitle updaters,
+ * OSD, decoders repeating a page), which used to render the text and scale
+ * the regions again. The cache keeps the last rendered text and scaled
+ * regions so that they can be reused, and when a region only partially
+ * changed, only the modified lines are converted again. The memory held by
+ * the entries is bounded by "sub-cache-size".
+ *****************************************************************************/
+static size_t SpuCachePictureSize(const picture_t *picture)
+{
+    size_t size = 0;
+    for (int i = 0; i < picture->i_planes; i++)
+        size += (size_t)picture->p[i].i_pitch * picture->p[i].i_lines;
+    return size;
+}
+
+static void SpuCacheTextClean(spu_cache_t *cache, spu_cache_text_t *e)
+{
+    if (e->picture)
+        picture_Release(e->picture);
+    if (e->text)
+        text_segment_ChainDelete(e->text);
+    video_format_Clean(&e->fmt);
+    video_format_Clean(&e->fmt_text);
+    e->picture = NULL;
+    e->text    = NULL;
+    cache->size -= e->size;
+    e->size     = 0;
+}
+
+static void SpuCacheRegionClean(spu_cache_t *cache, spu_cache_region_t *e)
+{
+    if (e->picture)
+        picture_Release(e->picture);
+    if (e->src)
+        picture_Release(e->src);
+    video_format_Clean(&e->fmt);
+    video_format_Clean(&e->fmt_src);
+    e->picture = NULL;
+    e->src     = NULL;
+    cache->size -= e->size;
+    e->size     = 0;
+}
+
+static void SpuCacheInit(spu_cache_t *cache, size_t max_size)
+{
+    cache->date     = 0;
+    cache->size     = 0;
+    cache->max_size = max_size;
+    for (int i = 0; i < SPU_CACHE_TEXT_COUNT; i++) {
+        spu_cache_text_t *e = &cache->text[i];
+
+        e->text    = NULL;
+        e->picture = NULL;
+        e->size    = 0;
+        video_format_Init(&e->fmt_text, 0);
+        video_format_Init(&e->fmt, 0);
+    }
+    for (int i = 0; i < SPU_CACHE_REGION_COUNT; i++) {
+        spu_cache_region_t *e = &cache->region[i];
+
+        e->src     = NULL;
+        e->picture = NULL;
+        e->size    = 0;
+        video_format_Init(&e->fmt_src, 0);
+        video_format_Init(&e->fmt, 0);
+    }
+}
+
+static void SpuCacheClean(spu_cache_t *cache)
+{
+    for (int i = 0; i < SPU_CACHE_TEXT_COUNT; i++)
+        SpuCacheTextClean(cache, &cache->text[i]);
+    for (int i = 0; i < SPU_CACHE_REGION_COUNT; i++)
+        SpuCacheRegionClean(cache, &cache->region[i]);
+    assert(cache->size == 0);
+}
+
+/* Starts a new rendering, dropping the entries unused for too long */
+static void SpuCacheAge(spu_cache_t *cache)
+{
+    cache->date++;
+    for (int i = 0; i < SPU_CACHE_TEXT_COUNT; i++) {
+        spu_cache_text_t *e = &cache->text[i];
+        if (e->picture && cache->date - e->last_use > SPU_CACHE_MAX_AGE)
+            SpuCacheTextClean(cache, e);
+    }
+    for (int i = 0; i < SPU_CACHE_REGION_COUNT; i++) {
+        spu_cache_region_t *e = &cache->region[i];
+        if (e->picture && cache->date - e->last_use > SPU_CACHE_MAX_AGE)
+            SpuCacheRegionClean(cache, e);
+    }
+}
+
+/* Drops the least recently used entries, the largest first, until the
+ * cache fits in its budget */
+static void SpuCacheTrim(spu_cache_t *cache)
+{
+    while (cache->size > cache->max_size) {
+        spu_cache_text_t   *text   = NULL;
+        spu_cache_region_t *region = NULL;
+        unsigned age  = 0;
+        size_t   size = 0;
+
+        for (int i = 0; i < SPU_CACHE_TEXT_COUNT; i++) {
+            spu_cache_text_t *e = &cache->text[i];
+            if (e->picture &&
+                (cache->date - e->last_use > age ||
+                 (cache->date - e->last_use == age && e->size > size))) {
+                text = e;
+                age  = cache->date - e->last_use;
+                size = e->size;
+            }
+        }
+        for (int i = 0; i < SPU_CACHE_REGION_COUNT; i++) {
+            spu_cache_region_t *e = &cache->region[i];
+            if (e->picture &&
+                (cache->date - e->last_use > age ||
+                 (cache->date - e->last_use == age && e->size > size))) {
+                region = e;
+                age    = cache->date - e->last_use;
+                size   = e->size;
+            }
+        }
+        if (region)
+            SpuCacheRegionClean(cache, region);
+        else if (text)
+            SpuCacheTextClean(cache, text);
+        else
+            break;
+    }
+}
+
+/* Drops the scaled regions of a subpicture whose regions were rebuilt: a
+ * source picture may have been updated in place since it was cached */
+static void SpuCacheInvalidate(spu_cache_t *cache, int64_t order)
+{
+    for (int i = 0; i < SPU_CACHE_REGION_COUNT; i++) {
+        spu_cache_region_t *e = &cache->region[i];
+        if (e->picture && e->order == order)
+            SpuCacheRegionClean(cache, e);
+    }
+}
+
+static bool SpuStringIsEqual(const char *a, const char *b)
+{
+    if (!a || !b)
+        return a == b;
+    return !strcmp(a, b);
+}
+
+static bool SpuTextStyleIsEqual(const text_style_t *a, const text_style_t *b)
+{
+    if (!a || !b)
+        return a == b;
+    return SpuStringIsEqual(a->psz_fontname, b->psz_fontname) &&
+           SpuStringIsEqual(a->psz_monofontname, b->psz_monofontname) &&
+           a->i_features                 == b->i_features &&
+           a->i_style_flags              == b->i_style_flags &&
+           a->f_font_relsize             == b->f_font_relsize &&
+           a->i_font_size                == b->i_font_size &&
+           a->i_font_color               == b->i_font_color &&
+           a->i_font_alpha               == b->i_font_alpha &&
+           a->i_spacing                  == b->i_spacing &&
+           a->i_outline_color            == b->i_outline_color &&
+           a->i_outline_alpha            == b->i_outline_alpha &&
+           a->i_outline_width            == b->i_outline_width &&
+           a->i_shadow_color             == b->i_shadow_color &&
+           a->i_shadow_alpha             == b->i_shadow_alpha &&
+           a->i_shadow_width             == b->i_shadow_width &&
+           a->i_background_color         == b->i_background_color &&
+           a->i_background_alpha         == b->i_background_alpha &&
+           a->i_karaoke_background_color == b->i_karaoke_background_color &&
+           a->i_karaoke_background_alpha == b->i_karaoke_background_alpha &&
+           a->e_wrapinfo                 == b->e_wrapinfo;
+}
+
+static bool SpuTextIsEqual(const text_segment_t *a, const text_segment_t *b)
+{
+    for (; a && b; a = a->p_next, b = b->p_next) {
+        if (!SpuStringIsEqual(a->psz_text, b->psz_text) ||
+            !SpuTextStyleIsEqual(a->style, b->style))
+            return false;
+    }
+    return !a && !b;
+}
+
+static bool SpuCacheTextMatch(const spu_cache_text_t *e,
+                              const subpicture_region_t *region,
+                              const filter_t *text, int text_scale,
+                              const vlc_fourcc_t *chroma_list)
+{
+    const video_format_t *fmt = &region->fmt;
+
+    if (e->x             != region->i_x ||
+        e->y             != region->i_y ||
+        e->align         != region->i_align ||
+        e->text_align    != region->i_text_align ||
+        e->noregionbg    != region->b_noregionbg ||
+        e->gridmode      != region->b_gridmode ||
+        e->balanced_text != region->b_balanced_text ||
+        e->max_width     != region->i_max_width ||
+        e->max_height    != region->i_max_height ||
+        e->width         != text->fmt_out.video.i_width ||
+        e->height        != text->fmt_out.video.i_height ||
+        e->text_scale    != text_scale)
+        return false;
+
+    if (e->fmt_text.i_width          != fmt->i_width ||
+        e->fmt_text.i_height         != fmt->i_height ||
+        e->fmt_text.i_visible_width  != fmt->i_visible_width ||
+        e->fmt_text.i_visible_height != fmt->i_visible_height ||
+        e->fmt_text.i_x_offset       != fmt->i_x_offset ||
+        e->fmt_text.i_y_offset       != fmt->i_y_offset ||
+        e->fmt_text.i_sar_num        != fmt->i_sar_num ||
+        e->fmt_text.i_sar_den        != fmt->i_sar_den)
+        return false;
+
+    for (int i = 0; i < SPU_CACHE_MAX_CHROMAS; i++) {
+        if (e->chroma_list[i] != chroma_list[i])
+            return false;
+        if (!chroma_list[i])
+            break;
+    }
+    return SpuTextIsEqual(e->text, region->p_text);
+}
+
+/**
+ * It replaces the text of the region with a previously rendered one.
+ */
+static bool SpuCacheGetText(spu_cache_t *cache, subpicture_region_t *region,
+                            const filter_t *text, int text_scale,
+                            const vlc_fourcc_t *chroma_list)
+{
+    for (int i = 0; i < SPU_CACHE_TEXT_COUNT; i++) {
+        spu_cache_text_t *e = &cache->text[i];
+
+        if (!e->picture ||
+            !SpuCacheTextMatch(e, region, text, text_scale, chroma_list))
+            continue;
+
+        video_format_t fmt;
+        if (video_format_Copy(&fmt, &e->fmt))
+            return false;
+        video_format_Clean(&region->fmt);
+        region->fmt = fmt;
+        if (region->p_picture)
+            picture_Release(region->p_picture);
+        region->p_picture = picture_Hold(e->picture);
+        e->last_use = cache->date;
+        return true;
+    }
+    return false;
+}
+
+static void SpuCachePutText(spu_cache_t *cache,
+                            const subpicture_region_t *region,
+                            const video_format_t *fmt_text,
+                            const filter_t *text, int text_scale,
+                            const vlc_fourcc_t *chroma_list)
+{
+    int chroma_count = 0;
+    while (chroma_list[chroma_count])
+        if (++chroma_count >= SPU_CACHE_MAX_CHROMAS)
+            return;
+
+    const size_t size = SpuCachePictureSize(region->p_picture);
+    if (size > cache->max_size)
+        return;
+
+    /* Use a free entry or the least recently used one */
+    spu_cache_text_t *e = &cache->text[0];
+    for (int i = 0; i < SPU_CACHE_TEXT_COUNT && e->picture; i++) {
+        if (!cache->text[i].picture ||
+            cache->date - cache->text[i].last_use > cache->date - e->last_use)
+            e = &cache->text[i];
+    }
+    SpuCacheTextClean(cache, e);
+
+    e->text = text_segment_Copy(region->p_text);
+    if (!e->text ||
+        video_format_Copy(&e->fmt, &region->fmt)) {
+        SpuCacheTextClean(cache, e);
+        return;
+    }
+    e->fmt_text = *fmt_text;
+    e->fmt_text.p_palette = NULL;
+
+    e->x             = region->i_x;
+    e->y             = region->i_y;
+    e->align         = region->i_align;
+    e->text_align    = region->i_text_align;
+    e->noregionbg    = region->b_noregionbg;
+    e->gridmode      = region->b_gridmode;
+    e->balanced_text = region->b_balanced_text;
+    e->max_width     = region->i_max_width;
+    e->max_height    = region->i_max_height;
+    e->width         = text->fmt_out.video.i_width;
+    e->height        = text->fmt_out.video.i_height;
+    e->text_scale    = text_scale;
+    memcpy(e->chroma_list, chroma_list,
+           (chroma_count + 1) * sizeof(*chroma_list));
+
+    e->picture  = picture_Hold(region->p_picture);
+    e->size     = size;
+    e->last_use = cache->date;
+    cache->size += size;
+    SpuCacheTrim(cache);
+}
+
 static void FilterRelease(filter_t *filter)
 {
     if (filter->p_module)
@@ -649,7 +1023,356 @@ static void SpuSelectSubpictures(spu_t *spu,
     sys->last_sort_date = render_subtitle_date;
 }
 
+/**
+ * It converts the picture of a region to chroma_list[0] if requested and
+ * scales it to the given size. The provided picture is released.
+ */
+static picture_t *SpuRenderScale(spu_t *spu, picture_t *picture,
+                                 const video_format_t *fmt,
+                                 unsigned dst_width, unsigned dst_height,
+                                 bool convert_chroma,
+                                 const vlc_fourcc_t *chroma_list)
+{
+    spu_private_t *sys = spu->p;
+    filter_t *scale = sys->scale;
+    const bool using_palette = fmt->i_chroma == VLC_CODEC_YUVP;
+
+    /* Convert YUVP to YUVA/RGBA first for better scaling quality */
+    if (using_palette) {
+        filter_t *scale_yuvp = sys->scale_yuvp;
+
+        scale_yuvp->fmt_in.video = *fmt;
 
+        scale_yuvp->fmt_out.video = *fmt;
+        scale_yuvp->fmt_out.video.i_chroma = chroma_list[0];
+
+        picture = scale_yuvp->pf_video_filter(scale_yuvp, picture);
+        if (!picture) {
+            /* Well we will try conversion+scaling */
+            msg_Warn(spu, "%4.4s to %4.4s conversion failed",
+                     (const char*)&scale_yuvp->fmt_in.video.i_chroma,
+                     (const char*)&scale_yuvp->fmt_out.video.i_chroma);
+        }
+    }
+
+    /* Conversion(except from YUVP)/Scaling */
+    if (picture &&
+        (picture->format.i_visible_width  != dst_width ||
+         picture->format.i_visible_height != dst_height ||
+         (convert_chroma && !using_palette)))
+    {
+        scale->fmt_in.video  = picture->format;
+        scale->fmt_out.video = picture->format;
+        if (using_palette)
+            scale->fmt_in.video.i_chroma = chroma_list[0];
+        if (convert_chroma)
+            scale->fmt_out.i_codec        =
+            scale->fmt_out.video.i_chroma = chroma_list[0];
+
+        scale->fmt_out.video.i_width  = dst_width;
+        scale->fmt_out.video.i_height = dst_height;
+
+        scale->fmt_out.video.i_visible_width  = dst_width;
+        scale->fmt_out.video.i_visible_height = dst_height;
+
+        picture = scale->pf_video_filter(scale, picture);
+        if (!picture)
+            msg_Err(spu, "scaling failed");
+    }
+    return picture;
+}
+
+/**
+ * It creates the private data of a region from a scaled picture.
+ * The picture is released on failure.
+ */
+static subpicture_region_private_t *SpuRegionPrivateNew(picture_t *picture)
+{
+    subpicture_region_private_t *private =
+        subpicture_region_private_New(&picture->format);
+    if (private)
+        private->p_picture = picture;
+    else
+        picture_Release(picture);
+    return private;
+}
+
+static bool SpuCacheFormatIsEqual(const video_format_t *a,
+                                  const video_format_t *b)
+{
+    if (!video_format_IsSimilar(a, b))
+        return false;
+    if (a->i_chroma != VLC_CODEC_YUVP)
+        return true;
+    if (!a->p_palette || !b->p_palette)
+        return a->p_palette == b->p_palette;
+    return a->p_palette->i_entries == b->p_palette->i_entries &&
+           !memcmp(a->p_palette->palette, b->p_palette->palette,
+                   a->p_palette->i_entries * sizeof(*a->p_palette->palette));
+}
+
+/* The pixels of a region are compared from the top left corner */
+static bool SpuCacheCanStore(const subpicture_region_t *region)
+{
+    return !region->fmt.i_x_offset && !region->fmt.i_y_offset &&
+           !region->p_picture->format.i_x_offset &&
+           !region->p_picture->format.i_y_offset;
+}
+
+/**
+ * It returns the range [*first, *end) of the lines which differ between
+ * two pictures of the same format, the range is empty if they are equal.
+ */
+static void SpuPictureDiff(const picture_t *a, const picture_t *b,
+                           unsigned *first, unsigned *end)
+{
+    const unsigned lines = a->format.i_visible_height;
+
+    *first = lines;
+    *end   = 0;
+    for (int i = 0; i < a->i_planes; i++) {
+        const plane_t *pa = &a->p[i];
+        const plane_t *pb = &b->p[i];
+        const int count = pa->i_visible_lines;
+        int top, bottom;
+
+        for (top = 0; top < count; top++)
+            if (memcmp(&pa->p_pixels[top * pa->i_pitch],
+                       &pb->p_pixels[top * pb->i_pitch], pa->i_visible_pitch))
+                break;
+        if (top >= count)
+            continue;
+        for (bottom = count - 1; bottom > top; bottom--)
+            if (memcmp(&pa->p_pixels[bottom * pa->i_pitch],
+                       &pb->p_pixels[bottom * pb->i_pitch], pa->i_visible_pitch))
+                break;
+
+        /* Convert to lines of the picture for subsampled planes */
+        *first = __MIN(*first, top * lines / count);
+        *end   = __MAX(*end, ((bottom + 1) * lines + count - 1) / count);
+    }
+}
+
+static bool SpuChromaIsSubsampled(vlc_fourcc_t chroma)
+{
+    const vlc_chroma_description_t *dsc =
+        vlc_fourcc_GetChromaDescription(chroma);
+    if (!dsc)
+        return true;
+    for (unsigned i = 0; i < dsc->plane_count; i++)
+        if (dsc->p[i].h.num != dsc->p[i].h.den)
+            return true;
+    return false;
+}
+
+/**
+ * It converts again the lines [first, end) of the region into a copy of
+ * the cached picture. It only works when the region is not resized, as
+ * the lines of the source and the destination then match.
+ */
+static picture_t *SpuCacheUpdateLines(spu_t *spu, const spu_cache_region_t *e,
+                                      const subpicture_region_t *region,
+                                      unsigned first, unsigned end,
+                                      bool convert_chroma,
+                                      const vlc_fourcc_t *chroma_list)
+{
+    picture_t *src = region->p_picture;
+    const unsigned lines = region->fmt.i_visible_height;
+
+    if (e->width  != region->fmt.i_visible_width  ||
+        e->height != region->fmt.i_visible_height ||
+        src->format.i_visible_width  != e->width  ||
+        src->format.i_visible_height != e->height ||
+        SpuChromaIsSubsampled(region->fmt.i_chroma) ||
+        SpuChromaIsSubsampled(e->fmt.i_chroma))
+        return NULL;
+
+    /* Keep the converters working on whole blocks of lines, and convert
+     * the whole region when most of it changed anyway */
+    first &= ~15;
+    end = __MIN((end + 15) & ~15, lines);
+    if (2 * (end - first) > lines)
+        return NULL;
+
+    video_format_t fmt = region->fmt;
+    fmt.i_height         =
+    fmt.i_visible_height = end - first;
+
+    picture_resource_t rsc = { .p_sys = NULL, .pf_destroy = NULL };
+    for (int i = 0; i < src->i_planes; i++) {
+        rsc.p[i].p_pixels = &src->p[i].p_pixels[first * src->p[i].i_pitch];
+        rsc.p[i].i_lines  = end - first;
+        rsc.p[i].i_pitch  = src->p[i].i_pitch;
+    }
+    picture_t *view = picture_NewFromResource(&fmt, &rsc);
+    if (!view)
+        return NULL;
+
+    picture_t *lines_pic = SpuRenderScale(spu, view, &fmt, e->width,
+                                          end - first, convert_chroma,
+                                          chroma_list);
+    if (!lines_pic)
+        return NULL;
+
+    picture_t *picture = NULL;
+    if (lines_pic->format.i_chroma == e->fmt.i_chroma &&
+        lines_pic->i_planes == e->picture->i_planes)
+        picture = picture_NewFromFormat(&e->fmt);
+    if (picture) {
+        picture_CopyPixels(picture, e->picture);
+        for (int i = 0; i < picture->i_planes; i++) {
+            plane_t *dst = &picture->p[i];
+            const plane_t *band = &lines_pic->p[i];
+            const int pitch = __MIN(dst->i_visible_pitch,
+                                    band->i_visible_pitch);
+
+            for (int y = 0; y < band->i_visible_lines; y++)
+                memcpy(&dst->p_pixels[(first + y) * dst->i_pitch],
+                       &band->p_pixels[y * band->i_pitch], pitch);
+        }
+    }
+    picture_Release(lines_pic);
+    return picture;
+}
+
+/**
+ * It looks for a scaled picture of the region in the cache, either one
+ * of the same content, or one of the same region of the channel whose
+ * changed lines can be updated.
+ */
+static subpicture_region_private_t *SpuCacheGetRegion(spu_t *spu,
+                                                      const subpicture_t *subpic,
+                                                      unsigned index,
+                                                      const subpicture_region_t *region,
+                                                      unsigned width, unsigned height,
+                                                      bool convert_chroma,
+                                                      const vlc_fourcc_t *chroma_list)
+{
+    spu_cache_t *cache = &spu->p->cache;
+    const vlc_fourcc_t chroma = convert_chroma ? chroma_list[0] : 0;
+    picture_t *src = region->p_picture;
+    spu_cache_region_t *same = NULL;
+    spu_cache_region_t *changed = NULL;
+    unsigned first = 0, end = 0;
+
+    if (!SpuCacheCanStore(region))
+        return NULL;
+
+    for (int i = 0; i < SPU_CACHE_REGION_COUNT && !same; i++) {
+        spu_cache_region_t *e = &cache->region[i];
+
+        if (!e->picture ||
+            e->width  != width || e->height != height || e->chroma != chroma ||
+            !SpuCacheFormatIsEqual(&e->fmt_src, &region->fmt) ||
+            !video_format_IsSimilar(&e->src->format, &src->format))
+            continue;
+
+        /* The same picture can only be trusted for the same subpicture,
+         * as its content is not compared */
+        if (e->src == src) {
+            if (e->order == subpic->i_order && e->start == subpic->i_start)
+                same = e;
+            continue;
+        }
+
+        unsigned diff_first, diff_end;
+        SpuPictureDiff(e->src, src, &diff_first, &diff_end);
+        if (diff_first >= diff_end)
+            same = e;
+        else if (e->channel == subpic->i_channel && e->index == index &&
+                 (!changed || cache->date - e->last_use <
+                              cache->date - changed->last_use)) {
+            /* Most likely the previous version of the region, as
+             * decoders create a new subpicture for every update */
+            changed = e;
+            first   = diff_first;
+            end     = diff_end;
+        }
+    }
+
+    picture_t *picture = NULL;
+    if (same) {
+        picture = picture_Hold(same->picture);
+        same->last_use = cache->date;
+    } else if (changed) {
+        picture = SpuCacheUpdateLines(spu, changed, region, first, end,
+                                      convert_chroma, chroma_list);
+        if (picture) {
+            const size_t size = SpuCachePictureSize(src) +
+                                SpuCachePictureSize(picture);
+
+            picture_Release(changed->src);
+            picture_Release(changed->picture);
+            changed->order    = subpic->i_order;
+            changed->start    = subpic->i_start;
+            changed->src      = picture_Hold(src);
+            changed->picture  = picture_Hold(picture);
+            changed->last_use = cache->date;
+            cache->size      += size - changed->size;
+            changed->size     = size;
+            SpuCacheTrim(cache);
+        }
+    }
+    return picture ? SpuRegionPrivateNew(picture) : NULL;
+}
+
+static void SpuCachePutRegion(spu_cache_t *cache,
+                              const subpicture_t *subpic, unsigned index,
+                              const subpicture_region_t *region,
+                              unsigned width, unsigned height,
+                              vlc_fourcc_t chroma, picture_t *picture)
+{
+    if (!SpuCacheCanStore(region))
+        return;
+
+    const size_t size = SpuCachePictureSize(region->p_picture) +
+                        SpuCachePictureSize(picture);
+    if (size > cache->max_size)
+        return;
+
+    /* Replace the entry of the same region, a free entry or the least
+     * recently used one */
+    spu_cache_region_t *e = NULL;
+    for (int i = 0; i < SPU_CACHE_REGION_COUNT && !e; i++) {
+        spu_cache_region_t *c = &cache->region[i];
+        if (c->picture &&
+            c->channel == subpic->i_channel && c->order == subpic->i_order &&
+            c->index == index)
+            e = c;
+    }
+    for (int i = 0; i < SPU_CACHE_REGION_COUNT && !e; i++) {
+        if (!cache->region[i].picture)
+            e = &cache->region[i];
+    }
+    if (!e) {
+        e = &cache->region[0];
+        for (int i = 1; i < SPU_CACHE_REGION_COUNT; i++) {
+            spu_cache_region_t *c = &cache->region[i];
+            if (cache->date - c->last_use > cache->date - e->last_use)
+                e = c;
+        }
+    }
+    SpuCacheRegionClean(cache, e);
+
+    if (video_format_Copy(&e->fmt_src, &region->fmt) ||
+        video_format_Copy(&e->fmt, &picture->format)) {
+        SpuCacheRegionClean(cache, e);
+        return;
+    }
+    e->channel  = subpic->i_channel;
+    e->order    = subpic->i_order;
+    e->start    = subpic->i_start;
+    e->index    = index;
+    e->width    = width;
+    e->height   = height;
+    e->chroma   = chroma;
+    e->src      = picture_Hold(region->p_picture);
+    e->picture  = picture_Hold(picture);
+    e->size     = size;
+    e->last_use = cache->date;
+    cache->size += size;
+    SpuCacheTrim(cache);
+}
 
 /**
  * It will transform the provided region into another region suitable for rendering.
@@ -657,6 +1380,7 @@ static void SpuSelectSubpictures(spu_t *spu,
 static void SpuRenderRegion(spu_t *spu,
                             subpicture_region_t **dst_ptr, spu_area_t *dst_area,
                             subpicture_t *subpic, subpicture_region_t *region,
+                            unsigned region_index,
                             const spu_scale_t scale_size,
                             const vlc_fourcc_t *chroma_list,
                             const video_format_t *fmt,
@@ -679,9 +1403,23 @@ static void SpuRenderRegion(spu_t *spu,
 
     /* Render text region */
     if (region->fmt.i_chroma == VLC_CODEC_TEXT) {
-        SpuRenderText(spu, &restore_text, region,
-                      chroma_list,
-                      render_date - subpic->i_start);
+        filter_t *text = sys->text;
+        const int text_scale = text && text->p_module ?
+                               var_InheritInteger(text, "sub-text-scale") : 0;
+
+        if (!text || !text->p_module ||
+            !SpuCacheGetText(&sys->cache, region, text, text_scale,
+                             chroma_list)) {
+            SpuRenderText(spu, &restore_text, region,
+                          chroma_list,
+                          render_date - subpic->i_start);
+
+            /* Time-dependent text cannot be reused */
+            if (region->fmt.i_chroma != VLC_CODEC_TEXT && !restore_text &&
+                region->p_text && region->p_picture)
+                SpuCachePutText(&sys->cache, region, &fmt_original,
+                                text, text_scale, chroma_list);
+        }
 
         /* Check if the rendering has failed ... */
         if (region->fmt.i_chroma == VLC_CODEC_TEXT)
@@ -827,70 +1565,25 @@ static void SpuRenderRegion(spu_t *spu,
             }
         }
 
+        /* Reuse a scaled picture from a previous rendering */
+        if (!region->p_private && dst_width > 0 && dst_height > 0)
+            region->p_private = SpuCacheGetRegion(spu, subpic, region_index,
+                                                  region, dst_width, dst_height,
+                                                  convert_chroma, chroma_list);
+
         /* Scale if needed into cache */
         if (!region->p_private && dst_width > 0 && dst_height > 0) {
-            filter_t *scale = sys->scale;
-
-            picture_t *picture = region->p_picture;
-            picture_Hold(picture);
-
-            /* Convert YUVP to YUVA/RGBA first for better scaling quality */
-            if (using_palette) {
-                filter_t *scale_yuvp = sys->scale_yuvp;
-
-                scale_yuvp->fmt_in.video = region->fmt;
-
-                scale_yuvp->fmt_out.video = region->fmt;
-                scale_yuvp->fmt_out.video.i_chroma = chroma_list[0];
-
-                picture = scale_yuvp->pf_video_filter(scale_yuvp, picture);
-                if (!picture) {
-                    /* Well we will try conversion+scaling */
-                    msg_Warn(spu, "%4.4s to %4.4s conversion failed",
-                             (const char*)&scale_yuvp->fmt_in.video.i_chroma,
-                             (const char*)&scale_yuvp->fmt_out.video.i_chroma);
-                }
-            }
-
-            /* Conversion(except from YUVP)/Scaling */
-            if (picture &&
-                (picture->format.i_visible_width  != dst_width ||
-                 picture->format.i_visible_height != dst_height ||
-                 (convert_chroma && !using_palette)))
-            {
-                scale->fmt_in.video  = picture->format;
-                scale->fmt_out.video = picture->format;
-                if (using_palette)
-                    scale->fmt_in.video.i_chroma = chroma_list[0];
-                if (convert_chroma)
-                    scale->fmt_out.i_codec        =
-                    scale->fmt_out.video.i_chroma = chroma_list[0];
-
-                scale->fmt_out.video.i_width  = dst_width;
-                scale->fmt_out.video.i_height = dst_height;
-
-                scale->fmt_out.video.i_visible_width =
-                    spu_scale_w(region->fmt.i_visible_width, scale_size);
-                scale->fmt_out.video.i_visible_height =
-                    spu_scale_h(region->fmt.i_visible_height, scale_size);
-
-                picture = scale->pf_video_filter(scale, picture);
-                if (!picture)
-                    msg_Err(spu, "scaling failed");
-            }
-
-            /* */
+            picture_t *picture = SpuRenderScale(spu,
+                                                picture_Hold(region->p_picture),
+                                                &region->fmt,
+                                                dst_width, dst_height,
+                                                convert_chroma, chroma_list);
             if (picture) {
-                region->p_private = subpicture_region_private_New(&picture->format);
-                if (region->p_private) {
-                    region->p_private->p_picture = picture;
-                    if (!region->p_private->p_picture) {
-                        subpicture_region_private_Delete(region->p_private);
-                        region->p_private = NULL;
-                    }
-                } else {
-                    picture_Release(picture);
-                }
+                SpuCachePutRegion(&sys->cache, subpic, region_index, region,
+                                  dst_width, dst_height,
+                                  convert_chroma ? chroma_list[0] : 0,
+                                  picture);
+                region->p_private = SpuRegionPrivateNew(picture);
             }
         }
 
@@ -1048,6 +1741,7 @@ static subpicture_t *SpuRenderSubpictures(spu_t *spu,
     for (unsigned int index = 0; index < i_subpicture; index++) {
         subpicture_t        *subpic = pp_subpicture[index];
         subpicture_region_t *region;
+        unsigned region_index = 0;
 
         if (!subpic->p_region)
             continue;
@@ -1079,7 +1773,8 @@ static subpicture_t *SpuRenderSubpictures(spu_t *spu,
          * We always transform non absolute subtitle into absolute one on the
          * first rendering to allow good subtitle overlap support.
          */
-        for (region = subpic->p_region; region != NULL; region = region->p_next) {
+        for (region = subpic->p_region; region != NULL;
+             region = region->p_next, region_index++) {
             spu_area_t area;
 
             /* Compute region scale AR */
@@ -1110,7 +1805,7 @@ static subpicture_t *SpuRenderSubpictures(spu_t *spu,
 
             /* */
             SpuRenderRegion(spu, output_last_ptr, &area,
-                            subpic, region, scale,
+                            subpic, region, region_index, scale,
                             chroma_list, fmt_dst,
                             subtitle_area, subtitle_area_count,
                             subpic->b_subtitle ? render_subtitle_date : render_osd_date);
@@ -1301,6 +1996,8 @@ spu_t *spu_Create(vlc_object_t *object, vout_thread_t *vout)
     vlc_mutex_init(&sys->lock);
 
     SpuHeapInit(&sys->heap);
+    SpuCacheInit(&sys->cache,
+                 var_InheritInteger(spu, "sub-cache-size") * 1024);
 
     sys->text = NULL;
     sys->scale = NULL;
@@ -1374,6 +2071,7 @@ void spu_Destroy(spu_t *spu)
 
     /* Destroy all remaining subpictures */
     SpuHeapClean(&sys->heap);
+    SpuCacheClean(&sys->cache);
 
     vlc_mutex_destroy(&sys->lock);
 
@@ -1578,6 +2276,8 @@ subpicture_t *spu_Render(spu_t *spu,
 
     vlc_mutex_lock(&sys->lock);
 
+    SpuCacheAge(&sys->cache);
+
     unsigned int subpicture_count;
     subpicture_t *subpicture_array[VOUT_MAX_SUBPICTURES];
 
@@ -1592,9 +2292,10 @@ subpicture_t *spu_Render(spu_t *spu,
     /* Updates the subpictures */
     for (unsigned i = 0; i < subpicture_count; i++) {
         subpicture_t *subpic = subpicture_array[i];
-        subpicture_Update(subpic,
-                          fmt_src, fmt_dst,
-                          subpic->b_subtitle ? render_subtitle_date : render_osd_date);
+        if (subpicture_UpdateChanged(subpic,
+                                     fmt_src, fmt_dst,
+                                     subpic->b_subtitle ? render_subtitle_date : render_osd_date))
+            SpuCacheInvalidate(&sys->cache, subpic->i_order);
     }
 
     /* Now order the subpicture array
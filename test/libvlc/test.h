@@ -34,12 +34,15 @@
 #endif
 #include <vlc/vlc.h>
 
+/* Tests including the sources under test must include this file after
+ * them, as config.h defines NDEBUG again */
 #undef NDEBUG
 #include <assert.h>
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <unistd.h>
 
 
@@ -72,4 +75,19 @@ static inline void test_init (void)
     setenv( "VLC_PLUGIN_PATH", "../modules", 1 );
 }
 
+/* Reproducible pseudo-random numbers, for test data */
+#define TEST_RAND_SEED 0x12345678
+
+static inline unsigned test_rand_r (uint32_t *seed)
+{
+    *seed = *seed * 1103515245 + 12345;
+    return *seed >> 16;
+}
+
+static inline unsigned test_rand (void)
+{
+    static uint32_t seed = TEST_RAND_SEED;
+    return test_rand_r (&seed);
+}
+
 #endif /* TEST_H */
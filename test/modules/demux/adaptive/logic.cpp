@@ -0,0 +1,442 @@
+/*****************************************************************************
+ * logic.cpp: replays bandwidth traces through the adaptive logics
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Offline simulator: a single stream is downloaded segment by segment over
+ * a piecewise constant bandwidth trace, while playback drains the buffer.
+ * The logic only sees what the demuxer would feed it (download rates and
+ * tracker events), so runs are deterministic and comparable.
+ *
+ * usage: test_modules_demux_adaptive_logic [trace [logic]]
+ *   trace: text file of "start_seconds kbps" lines, '#' for comments
+ *   logic: one of the adaptive-logic values, default all of them
+ * Without arguments, the builtin traces are replayed and checked.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#ifdef NDEBUG
+ #undef NDEBUG
+#endif
+#include <assert.h>
+
+#include <vlc/vlc.h>
+#include "../../../../lib/libvlc_internal.h"
+
+#include <vlc_common.h>
+
+#include "../../../../modules/demux/adaptive/logic/AbstractAdaptationLogic.h"
+#include "../../../../modules/demux/adaptive/logic/AlwaysBestAdaptationLogic.h"
+#include "../../../../modules/demux/adaptive/logic/AlwaysLowestAdaptationLogic.hpp"
+#include "../../../../modules/demux/adaptive/logic/RateBasedAdaptationLogic.h"
+#include "../../../../modules/demux/adaptive/logic/PredictiveAdaptationLogic.hpp"
+#include "../../../../modules/demux/adaptive/logic/NearOptimalAdaptationLogic.hpp"
+#include "../../../../modules/demux/adaptive/logic/HybridAdaptationLogic.hpp"
+#include "../../../../modules/demux/adaptive/playlist/BaseAdaptationSet.h"
+#include "../../../../modules/demux/adaptive/playlist/BaseRepresentation.h"
+#include "../../../../modules/demux/adaptive/SegmentTracker.hpp"
+#include "../../../../modules/demux/adaptive/ID.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+using namespace adaptive;
+using namespace adaptive::logic;
+using namespace adaptive::playlist;
+
+#define SEGMENT_DURATION  (CLOCK_FREQ * 2)
+#define BUFFERING_MIN     (CLOCK_FREQ * 6)
+#define BUFFERING_TARGET  (CLOCK_FREQ * 30)
+#define REQUEST_LATENCY   (CLOCK_FREQ / 10)
+#define CONTENT_DURATION  (CLOCK_FREQ * 240)
+
+static const unsigned ladder[] = /* kbps */
+    { 235, 375, 560, 750, 1050, 1750, 2350, 3000, 4300, 5800 };
+
+static const char *const logics[] =
+    { "predictive", "nearoptimal", "hybrid", "rate", "fixedrate", "lowest", "highest" };
+
+struct trace_step
+{
+    mtime_t  start;
+    uint64_t bps;
+};
+
+typedef std::vector<trace_step> trace_t;
+
+struct sim_result
+{
+    mtime_t  startup;
+    mtime_t  rebuffering;
+    unsigned stalls;
+    unsigned switches;
+    uint64_t avg_bps;
+    uint64_t min_bps;
+    uint64_t max_bps;
+};
+
+static void trace_add(trace_t &trace, unsigned seconds, unsigned kbps)
+{
+    trace_step step = { CLOCK_FREQ * seconds, (uint64_t) kbps * 1000 };
+    trace.push_back(step);
+}
+
+static bool trace_load(trace_t &trace, const char *psz_file)
+{
+    FILE *f = fopen(psz_file, "r");
+    if(!f)
+        return false;
+
+    char line[256];
+    while(fgets(line, sizeof(line), f))
+    {
+        double seconds, kbps;
+        if(line[0] == '#' || sscanf(line, "%lf %lf", &seconds, &kbps) != 2)
+            continue;
+        trace_step step = { (mtime_t)(seconds * CLOCK_FREQ), (uint64_t)(kbps * 1000) };
+        if(!trace.empty() && step.start < trace.back().start)
+            continue;
+        trace.push_back(step);
+    }
+    fclose(f);
+    return !trace.empty();
+}
+
+/* returns the time at which the download of i_bits started at i_time ends */
+static mtime_t trace_download(const trace_t &trace, mtime_t i_time, uint64_t i_bits)
+{
+    for(size_t i=0; i<trace.size(); i++)
+    {
+        const bool b_last = (i + 1 == trace.size());
+        const mtime_t i_end = b_last ? INT64_MAX : trace[i + 1].start;
+        if(i_end <= i_time)
+            continue;
+        if(trace[i].bps == 0)
+        {
+            if(b_last) /* never recovers */
+                return INT64_MAX;
+            i_time = i_end;
+            continue;
+        }
+        const mtime_t i_needed = i_bits * CLOCK_FREQ / trace[i].bps;
+        if(b_last || i_time + i_needed <= i_end)
+            return i_time + i_needed;
+        i_bits -= (uint64_t)(i_end - i_time) * trace[i].bps / CLOCK_FREQ;
+        i_time = i_end;
+    }
+    return i_time;
+}
+
+static AbstractAdaptationLogic *logic_create(vlc_object_t *p_obj, const char *psz_name)
+{
+    if(!strcmp(psz_name, "predictive"))
+        return new PredictiveAdaptationLogic(p_obj);
+    else if(!strcmp(psz_name, "nearoptimal"))
+        return new NearOptimalAdaptationLogic(p_obj);
+    else if(!strcmp(psz_name, "hybrid"))
+        return new HybridAdaptationLogic(p_obj);
+    else if(!strcmp(psz_name, "rate"))
+        return new RateBasedAdaptationLogic(p_obj);
+    else if(!strcmp(psz_name, "fixedrate"))
+        return new FixedRateAdaptationLogic(1000 * 1000);
+    else if(!strcmp(psz_name, "lowest"))
+        return new AlwaysLowestAdaptationLogic();
+    else if(!strcmp(psz_name, "highest"))
+        return new AlwaysBestAdaptationLogic();
+    return NULL;
+}
+
+static void simulate(vlc_object_t *p_obj, const char *psz_logic,
+                     const trace_t &trace, sim_result *res)
+{
+    AbstractAdaptationLogic *logic = logic_create(p_obj, psz_logic);
+    assert(logic);
+
+    BaseAdaptationSet *adaptSet = new BaseAdaptationSet(NULL);
+    adaptSet->setID(ID("sim"));
+    for(size_t i=0; i<ARRAY_SIZE(ladder); i++)
+    {
+        BaseRepresentation *rep = new BaseRepresentation(adaptSet);
+        rep->setBandwidth(ladder[i] * 1000);
+        rep->setID(ID(i));
+        adaptSet->addRepresentation(rep);
+    }
+    const ID &id = adaptSet->getID();
+
+    memset(res, 0, sizeof(*res));
+    res->min_bps = UINT64_MAX;
+
+    mtime_t i_time = 0;
+    mtime_t i_buffering = 0;
+    mtime_t i_downloaded = 0;
+    mtime_t i_played = 0;
+    bool b_playing = false;
+    bool b_started = false;
+    uint64_t i_total_bps = 0;
+    unsigned i_segments = 0;
+    BaseRepresentation *prevRep = NULL;
+
+    logic->trackerEvent(SegmentTrackerEvent(id, true));
+
+    while(i_played < CONTENT_DURATION)
+    {
+        mtime_t i_next = i_time;
+
+        if(i_downloaded < CONTENT_DURATION)
+        {
+            /* like the demuxer, don't fetch beyond the buffering target */
+            if(i_buffering + SEGMENT_DURATION > BUFFERING_TARGET)
+                i_next += i_buffering + SEGMENT_DURATION - BUFFERING_TARGET;
+        }
+        else
+        {
+            i_next += i_buffering; /* drain till the end */
+        }
+
+        /* download */
+        BaseRepresentation *rep = NULL;
+        mtime_t i_dlstart = i_next;
+        if(i_downloaded < CONTENT_DURATION)
+        {
+            rep = logic->getNextRepresentation(adaptSet, prevRep);
+            assert(rep);
+            if(rep != prevRep)
+            {
+                logic->trackerEvent(SegmentTrackerEvent(prevRep, rep));
+                if(prevRep)
+                    res->switches++;
+                prevRep = rep;
+            }
+            const uint64_t i_bits = rep->getBandwidth() * SEGMENT_DURATION / CLOCK_FREQ;
+            i_next = trace_download(trace, i_dlstart + REQUEST_LATENCY, i_bits);
+            if(i_next == INT64_MAX)
+                break;
+        }
+
+        /* playback while waiting/downloading */
+        mtime_t i_elapsed = i_next - i_time;
+        if(b_playing)
+        {
+            if(i_elapsed >= i_buffering)
+            {
+                i_played += i_buffering;
+                i_elapsed -= i_buffering;
+                i_buffering = 0;
+                if(i_played < CONTENT_DURATION)
+                {
+                    b_playing = false;
+                    res->stalls++;
+                    res->rebuffering += i_elapsed;
+                }
+            }
+            else
+            {
+                i_played += i_elapsed;
+                i_buffering -= i_elapsed;
+            }
+        }
+        else if(b_started)
+        {
+            res->rebuffering += i_elapsed;
+        }
+        i_time = i_next;
+
+        if(rep)
+        {
+            const mtime_t i_dltime = i_next - i_dlstart;
+            logic->updateDownloadRate(id, rep->getBandwidth() * SEGMENT_DURATION / CLOCK_FREQ / 8,
+                                      i_dltime);
+            i_buffering += SEGMENT_DURATION;
+            i_downloaded += SEGMENT_DURATION;
+            logic->trackerEvent(SegmentTrackerEvent(id, SEGMENT_DURATION));
+            logic->trackerEvent(SegmentTrackerEvent(id, BUFFERING_MIN,
+                                                    i_buffering, BUFFERING_TARGET));
+
+            i_total_bps += rep->getBandwidth();
+            i_segments++;
+            res->min_bps = __MIN(res->min_bps, rep->getBandwidth());
+            res->max_bps = __MAX(res->max_bps, rep->getBandwidth());
+        }
+
+        if(!b_playing && (i_buffering >= BUFFERING_MIN ||
+                          i_downloaded >= CONTENT_DURATION))
+        {
+            b_playing = true;
+            if(!b_started)
+            {
+                b_started = true;
+                res->startup = i_time;
+            }
+        }
+    }
+
+    logic->trackerEvent(SegmentTrackerEvent(id, false));
+
+    if(i_segments)
+        res->avg_bps = i_total_bps / i_segments;
+
+    delete logic;
+    delete adaptSet;
+}
+
+static void print_result(const char *psz_trace, const char *psz_logic,
+                         const sim_result *res)
+{
+    printf("%-12s %-12s startup %5.2fs rebuffering %6.2fs (%2u) "
+           "switches %3u avg %5" PRIu64 " kbps\n",
+           psz_trace, psz_logic,
+           (double) res->startup / CLOCK_FREQ,
+           (double) res->rebuffering / CLOCK_FREQ, res->stalls,
+           res->switches, res->avg_bps / 1000);
+}
+
+static void check_builtin(vlc_object_t *p_obj)
+{
+    const uint64_t lowest = ladder[0] * 1000;
+    const uint64_t highest = ladder[ARRAY_SIZE(ladder) - 1] * 1000;
+    sim_result res, res2;
+
+    trace_t constant;
+    trace_add(constant, 0, 3000);
+
+    trace_t stepdown;
+    trace_add(stepdown, 0, 5000);
+    trace_add(stepdown, 80, 800);
+    trace_add(stepdown, 160, 5000);
+
+    trace_t fluctuating;
+    for(unsigned i=0; i<300; i+=10)
+        trace_add(fluctuating, i, (i % 20) ? 1500 : 4500);
+
+    trace_t outage;
+    trace_add(outage, 0, 3000);
+    trace_add(outage, 60, 0);
+    trace_add(outage, 70, 3000);
+
+    const struct
+    {
+        const char *psz_name;
+        const trace_t *trace;
+    } traces[] = {
+        { "constant", &constant },
+        { "stepdown", &stepdown },
+        { "fluctuating", &fluctuating },
+        { "outage", &outage },
+    };
+
+    for(size_t i=0; i<ARRAY_SIZE(traces); i++)
+    {
+        for(size_t j=0; j<ARRAY_SIZE(logics); j++)
+        {
+            simulate(p_obj, logics[j], *traces[i].trace, &res);
+            print_result(traces[i].psz_name, logics[j], &res);
+            fflush(stdout);
+
+            /* replays must be deterministic */
+            simulate(p_obj, logics[j], *traces[i].trace, &res2);
+            assert(!memcmp(&res, &res2, sizeof(res)));
+
+            assert(res.min_bps >= lowest && res.max_bps <= highest);
+            assert(res.startup > 0);
+
+            if(!strcmp(logics[j], "lowest"))
+            {
+                assert(res.switches == 0);
+                assert(res.avg_bps == lowest);
+            }
+            else if(!strcmp(logics[j], "highest"))
+            {
+                assert(res.switches == 0);
+                assert(res.avg_bps == highest);
+            }
+        }
+    }
+
+    /* sustainable link: throughput driven logics must not stall,
+     * nor stay on the lowest quality */
+    const char *const adaptive[] = { "hybrid", "rate" };
+    for(size_t j=0; j<ARRAY_SIZE(adaptive); j++)
+    {
+        simulate(p_obj, adaptive[j], constant, &res);
+        assert(res.rebuffering == 0);
+        assert(res.avg_bps > lowest);
+    }
+
+    simulate(p_obj, "highest", constant, &res);
+    assert(res.rebuffering > 0);
+
+    /* the hybrid logic must outlast drops and outages */
+    for(size_t i=0; i<ARRAY_SIZE(traces); i++)
+    {
+        simulate(p_obj, "hybrid", *traces[i].trace, &res);
+        assert(res.rebuffering == 0);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    alarm(10); /* Make sure "make check" does not get stuck */
+    setenv("VLC_PLUGIN_PATH", "../modules", 1);
+
+    libvlc_instance_t *vlc = libvlc_new(0, NULL);
+    assert(vlc != NULL);
+    vlc_object_t *p_obj = VLC_OBJECT(vlc->p_libvlc_int);
+
+    int ret = 0;
+    bool b_known = (argc < 3);
+    for(size_t j=0; j<ARRAY_SIZE(logics) && !b_known; j++)
+        b_known = !strcmp(argv[2], logics[j]);
+
+    if(argc > 1)
+    {
+        trace_t trace;
+        if(!trace_load(trace, argv[1]))
+        {
+            fprintf(stderr, "can't load trace %s\n", argv[1]);
+            ret = 1;
+        }
+        else if(!b_known)
+        {
+            fprintf(stderr, "unknown logic %s\n", argv[2]);
+            ret = 1;
+        }
+        else
+        {
+            sim_result res;
+            for(size_t j=0; j<ARRAY_SIZE(logics); j++)
+            {
+                if(argc > 2 && strcmp(argv[2], logics[j]))
+                    continue;
+                simulate(p_obj, logics[j], trace, &res);
+                print_result(argv[1], logics[j], &res);
+            }
+        }
+    }
+    else
+    {
+        check_builtin(p_obj);
+    }
+
+    libvlc_release(vlc);
+    return ret;
+}
@@ -0,0 +1,210 @@
+/*****************************************************************************
+ * freetype.c: test the glyph and paragraph cache of the text renderer
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <vlc_common.h>
+#include <vlc_filter.h>
+#include <vlc_modules.h>
+#include <vlc_picture.h>
+#include <vlc_subpicture.h>
+#include <vlc_text_style.h>
+#include "../../../lib/libvlc_internal.h"
+
+#include <vlc/vlc.h>
+
+#define WIDTH  720
+#define HEIGHT 576
+#define RUNS   3
+
+static const struct
+{
+    const char *psz_text;
+    int i_flags;        /* style flags of the second segment */
+    int i_x;            /* changes the available width */
+} tests[] = {
+    { "12:00:01", 0, 0 },
+    { "12:00:02", 0, 0 },
+    { "Hello world\nA second paragraph", 0, 0 },
+    { "Hello world\nA second paragraph", STYLE_BOLD, 0 },
+    { "Hello world\nA second paragraph", STYLE_ITALIC | STYLE_BOLD, 0 },
+    { "A rather long subtitle line which has to be wrapped over "
+      "several lines when the scrolling region gets narrow", 0, 0 },
+    { "A rather long subtitle line which has to be wrapped over "
+      "several lines when the scrolling region gets narrow", 0, 400 },
+    { "A rather long subtitle line which has to be wrapped over "
+      "several lines when the scrolling region gets narrow", 0, 560 },
+    { "Background", STYLE_BACKGROUND, 0 },
+};
+
+static filter_t *CreateRenderer( vlc_object_t *obj )
+{
+    filter_t *p_filter = vlc_object_create( obj, sizeof( *p_filter ) );
+    assert( p_filter != NULL );
+
+    es_format_Init( &p_filter->fmt_in, VIDEO_ES, 0 );
+    es_format_Init( &p_filter->fmt_out, VIDEO_ES, 0 );
+    p_filter->fmt_out.video.i_width =
+    p_filter->fmt_out.video.i_visible_width = WIDTH;
+    p_filter->fmt_out.video.i_height =
+    p_filter->fmt_out.video.i_visible_height = HEIGHT;
+
+    p_filter->p_module = module_need( p_filter, "text renderer",
+                                      "freetype", true );
+    return p_filter;
+}
+
+static void DeleteRenderer( filter_t *p_filter )
+{
+    if( p_filter->p_module )
+        module_unneed( p_filter, p_filter->p_module );
+    vlc_object_release( p_filter );
+}
+
+static subpicture_region_t *Render( filter_t *p_filter, unsigned i_test )
+{
+    video_format_t fmt;
+    video_format_Init( &fmt, VLC_CODEC_TEXT );
+    fmt.i_sar_num = fmt.i_sar_den = 1;
+
+    subpicture_region_t *p_region = subpicture_region_New( &fmt );
+    assert( p_region != NULL );
+    p_region->i_x = tests[i_test].i_x;
+
+    /* Splits the text in two segments with different styles */
+    const char *psz_text = tests[i_test].psz_text;
+    const size_t i_half = strlen( psz_text ) / 2;
+    char *psz_first = strndup( psz_text, i_half );
+    assert( psz_first != NULL );
+
+    text_segment_t *p_segment = text_segment_New( psz_first );
+    free( psz_first );
+    assert( p_segment != NULL );
+    p_segment->p_next = text_segment_New( psz_text + i_half );
+    assert( p_segment->p_next != NULL );
+    if( tests[i_test].i_flags )
+    {
+        text_style_t *p_style = text_style_Create( STYLE_NO_DEFAULTS );
+        assert( p_style != NULL );
+        p_style->i_style_flags = tests[i_test].i_flags;
+        p_style->i_features |= STYLE_HAS_FLAGS;
+        p_segment->p_next->style = p_style;
+    }
+    p_region->p_text = p_segment;
+
+    static const vlc_fourcc_t chroma_list[] = { VLC_CODEC_RGBA, 0 };
+    int ret = p_filter->pf_render( p_filter, p_region, p_region, chroma_list );
+    assert( ret == VLC_SUCCESS );
+    assert( p_region->p_picture != NULL );
+    return p_region;
+}
+
+static void CompareRegions( subpicture_region_t *a, subpicture_region_t *b )
+{
+    assert( a->fmt.i_chroma == b->fmt.i_chroma );
+    assert( a->fmt.i_visible_width == b->fmt.i_visible_width );
+    assert( a->fmt.i_visible_height == b->fmt.i_visible_height );
+    assert( a->i_x == b->i_x && a->i_y == b->i_y );
+
+    const plane_t *pa = &a->p_picture->p[0], *pb = &b->p_picture->p[0];
+    for( int y = 0; y < pa->i_visible_lines; y++ )
+        assert( !memcmp( &pa->p_pixels[y * pa->i_pitch],
+                         &pb->p_pixels[y * pb->i_pitch],
+                         pa->i_visible_pitch ) );
+
+    subpicture_region_Delete( a );
+    subpicture_region_Delete( b );
+}
+
+static void RunTests( filter_t *p_filter, filter_t *p_ref )
+{
+    for( unsigned run = 0; run < RUNS; run++ )
+        for( size_t i = 0; i < ARRAY_SIZE(tests); i++ )
+        {
+            mtime_t start = mdate();
+            subpicture_region_t *p_out = Render( p_filter, i );
+            mtime_t out_time = mdate() - start;
+
+            start = mdate();
+            subpicture_region_t *p_exp = Render( p_ref, i );
+            mtime_t ref_time = mdate() - start;
+
+            printf( "run %u, text %zu: %5"PRId64" us / %5"PRId64" us\n",
+                    run, i, ref_time, out_time );
+            fflush( stdout );
+
+            CompareRegions( p_exp, p_out );
+        }
+}
+
+int main( void )
+{
+    /* The small cache keeps evicting entries */
+    static const char *const argv_small[] = { "--freetype-cache-size=64" };
+    static const char *const argv_uncached[] = { "--freetype-cache-size=0" };
+
+    alarm( 60 );
+    setenv( "VLC_PLUGIN_PATH", "../modules", 1 );
+
+    libvlc_instance_t *cached = libvlc_new( 0, NULL );
+    libvlc_instance_t *small = libvlc_new( 1, argv_small );
+    libvlc_instance_t *uncached = libvlc_new( 1, argv_uncached );
+    assert( cached != NULL && small != NULL && uncached != NULL );
+
+    filter_t *p_cached = CreateRenderer( VLC_OBJECT(cached->p_libvlc_int) );
+    filter_t *p_small = CreateRenderer( VLC_OBJECT(small->p_libvlc_int) );
+    filter_t *p_ref = CreateRenderer( VLC_OBJECT(uncached->p_libvlc_int) );
+
+    int ret = 0;
+    if( p_cached->p_module && p_small->p_module && p_ref->p_module )
+    {
+        RunTests( p_cached, p_ref );
+        RunTests( p_small, p_ref );
+
+        /* Later runs render the same texts again */
+        assert( var_GetInteger( p_cached, "freetype-glyph-hits" ) > 0 );
+        assert( var_GetInteger( p_cached, "freetype-glyph-misses" ) > 0 );
+        assert( var_GetInteger( p_cached, "freetype-paragraph-hits" ) > 0 );
+        assert( var_GetInteger( p_cached, "freetype-paragraph-misses" ) > 0 );
+        assert( var_Type( p_ref, "freetype-glyph-hits" ) == 0 );
+    }
+    else
+    {
+        fprintf( stderr, "freetype text renderer not available, skipping\n" );
+        ret = 77;
+    }
+
+    DeleteRenderer( p_ref );
+    DeleteRenderer( p_small );
+    DeleteRenderer( p_cached );
+    libvlc_release( uncached );
+    libvlc_release( small );
+    libvlc_release( cached );
+    return ret;
+}
@@ -0,0 +1,172 @@
+/*****************************************************************************
+ * blend.cpp: test the SSE2 blending routines against the generic ones
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../modules/video_filter/blend.cpp"
+
+#include "../../libvlc/test.h"
+
+#ifdef HAVE_SSE2_INTRINSICS
+
+#define WIDTH  100
+#define HEIGHT 20
+
+static void FillPicture(picture_t *pic, unsigned bits, bool is_alpha_plane)
+{
+    const unsigned mask = (1 << bits) - 1;
+
+    for (int i = 0; i < pic->i_planes; i++) {
+        plane_t *p = &pic->p[i];
+        /* Mostly transparent and opaque samples, as in subtitles */
+        const bool alpha = is_alpha_plane && i == A_PLANE;
+
+        for (int y = 0; y < p->i_lines; y++) {
+            uint8_t *line = &p->p_pixels[y * p->i_pitch];
+
+            for (int x = 0; x < p->i_pitch / (bits > 8 ? 2 : 1); x++) {
+                unsigned v = test_rand() & mask;
+                if (alpha && (v & 3))
+                    v = (v & 4) ? 255 : 0;
+                if (bits > 8)
+                    ((uint16_t *)line)[x] = v;
+                else
+                    line[x] = v;
+            }
+        }
+    }
+}
+
+static void FillRGBA(picture_t *pic)
+{
+    plane_t *p = &pic->p[0];
+
+    for (int y = 0; y < p->i_lines; y++)
+        for (int x = 0; x < p->i_pitch; x++) {
+            unsigned v = test_rand() & 255;
+            if ((x % 4) == 3 && (v & 3))
+                v = (v & 4) ? 255 : 0;
+            p->p_pixels[y * p->i_pitch + x] = v;
+        }
+}
+
+static blend_function_t Find(const blend_routine_t *table, size_t count,
+                             vlc_fourcc_t dst, vlc_fourcc_t src)
+{
+    for (size_t i = 0; i < count; i++)
+        if (table[i].dst == dst && table[i].src == src)
+            return table[i].blend;
+    return NULL;
+}
+
+static void Test(vlc_fourcc_t dst_chroma, vlc_fourcc_t src_chroma,
+                 uint32_t rmask, uint32_t gmask, uint32_t bmask)
+{
+    blend_function_t blend_c = Find(blends, ARRAY_SIZE(blends),
+                                    dst_chroma, src_chroma);
+    blend_function_t blend_sse2 = Find(blends_sse2, ARRAY_SIZE(blends_sse2),
+                                       dst_chroma, src_chroma);
+    assert(blend_c != NULL && blend_sse2 != NULL);
+
+    video_format_t dst_fmt, src_fmt;
+    video_format_Setup(&dst_fmt, dst_chroma, WIDTH, HEIGHT, WIDTH, HEIGHT, 1, 1);
+    video_format_Setup(&src_fmt, src_chroma, WIDTH, HEIGHT, WIDTH, HEIGHT, 1, 1);
+    dst_fmt.i_rmask = rmask;
+    dst_fmt.i_gmask = gmask;
+    dst_fmt.i_bmask = bmask;
+    video_format_FixRgb(&dst_fmt);
+
+    picture_t *src = picture_NewFromFormat(&src_fmt);
+    picture_t *ref = picture_NewFromFormat(&dst_fmt);
+    picture_t *out = picture_NewFromFormat(&dst_fmt);
+    assert(src != NULL && ref != NULL && out != NULL);
+
+    const vlc_chroma_description_t *desc =
+        vlc_fourcc_GetChromaDescription(dst_chroma);
+    const unsigned bits = desc != NULL && desc->pixel_size == 2 ? desc->pixel_bits : 8;
+
+    for (unsigned run = 0; run < 200; run++) {
+        const unsigned x = test_rand() % 5;
+        const unsigned y = test_rand() % 3;
+        const unsigned width  = 1 + test_rand() % (WIDTH - x);
+        const unsigned height = 1 + test_rand() % (HEIGHT - y);
+        const int alpha = (run % 3) == 0 ? 255 : 1 + test_rand() % 255;
+
+        if (src_chroma == VLC_CODEC_RGBA)
+            FillRGBA(src);
+        else
+            FillPicture(src, 8, true);
+        FillPicture(ref, bits, false);
+        for (int i = 0; i < ref->i_planes; i++)
+            memcpy(out->p[i].p_pixels, ref->p[i].p_pixels,
+                   ref->p[i].i_pitch * ref->p[i].i_lines);
+
+        blend_c(CPicture(ref, &dst_fmt, x, y), CPicture(src, &src_fmt, 0, 0),
+                width, height, alpha);
+        blend_sse2(CPicture(out, &dst_fmt, x, y), CPicture(src, &src_fmt, 0, 0),
+                   width, height, alpha);
+
+        for (int i = 0; i < ref->i_planes; i++)
+            assert(!memcmp(ref->p[i].p_pixels, out->p[i].p_pixels,
+                           ref->p[i].i_pitch * ref->p[i].i_lines));
+    }
+
+    picture_Release(out);
+    picture_Release(ref);
+    picture_Release(src);
+}
+
+int main(void)
+{
+    if (!vlc_CPU_SSE2()) {
+        fprintf(stderr, "SSE2 not supported by the CPU, skipping\n");
+        return 77;
+    }
+
+    for (size_t i = 0; i < ARRAY_SIZE(blends_sse2); i++) {
+        if (blends_sse2[i].dst == VLC_CODEC_RGB32) {
+            Test(blends_sse2[i].dst, blends_sse2[i].src,
+                 0xff0000, 0x00ff00, 0x0000ff);
+            Test(blends_sse2[i].dst, blends_sse2[i].src,
+                 0x0000ff, 0x00ff00, 0xff0000);
+            Test(blends_sse2[i].dst, blends_sse2[i].src,
+                 0xff000000, 0x00ff0000, 0x0000ff00);
+        } else {
+            Test(blends_sse2[i].dst, blends_sse2[i].src, 0, 0, 0);
+        }
+    }
+    return 0;
+}
+
+#else
+
+int main(void)
+{
+    fprintf(stderr, "SSE2 intrinsics not supported, skipping\n");
+    return 77;
+}
+
+#endif
@@ -0,0 +1,234 @@
+/*****************************************************************************
+ * deinterlace.c: test the deinterlacer SIMD routines against the C versions
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_cpu.h>
+#include <vlc_picture.h>
+#include <vlc_filter.h>
+#include "../modules/video_filter/deinterlace/merge.c"
+#include "../modules/video_filter/deinterlace/helpers.c"
+#include "../modules/video_filter/deinterlace/algo_phosphor.c"
+#include "../modules/video_filter/deinterlace/yadif.h"
+
+#include "../../libvlc/test.h"
+
+#ifdef HAVE_AVX2_INTRINSICS
+
+#define PITCH  2048
+#define MARGIN 64
+
+/* Mostly smooth data, with some noise around the detection thresholds
+ * and some full-range values */
+static void Fill( uint8_t *p, size_t i_size )
+{
+    unsigned base = test_rand() & 255;
+
+    for( size_t i = 0; i < i_size; i++ )
+    {
+        unsigned r = test_rand();
+
+        if( (r & 15) == 0 )
+            p[i] = r >> 8;
+        else
+            p[i] = VLC_CLIP( (int)base + (int)((r >> 4) % 41) - 20, 0, 255 );
+        if( (r & 511) == 1 )
+            base = test_rand() & 255;
+    }
+}
+
+static void TestMerge( void )
+{
+    static uint8_t s1[PITCH], s2[PITCH];
+    static uint8_t ref[PITCH], out[PITCH];
+
+    for( size_t i_bytes = 0; i_bytes < 300; i_bytes++ )
+        for( size_t i_offset = 0; i_offset < 4; i_offset++ )
+        {
+            Fill( s1, sizeof(s1) );
+            Fill( s2, sizeof(s2) );
+
+            memset( ref, 0, sizeof(ref) );
+            memset( out, 0, sizeof(out) );
+            Merge8BitGeneric( ref, s1 + i_offset, s2, i_bytes );
+            Merge8BitAVX2( out, s1 + i_offset, s2, i_bytes );
+            assert( !memcmp( ref, out, sizeof(ref) ) );
+
+            memset( ref, 0, sizeof(ref) );
+            memset( out, 0, sizeof(out) );
+            Merge16BitGeneric( ref, s1, s2 + 2 * i_offset, i_bytes );
+            Merge16BitAVX2( out, s1, s2 + 2 * i_offset, i_bytes );
+            assert( !memcmp( ref, out, sizeof(ref) ) );
+        }
+}
+
+static void TestYadif( void )
+{
+    /* 5 lines: the filter reads up to 2 lines above and below */
+    static uint8_t prev[5 * PITCH], cur[5 * PITCH], next[5 * PITCH];
+    static uint8_t ref[PITCH], out[PITCH];
+    static const int widths[] = { 1, 15, 16, 17, 100, 360, 719, 720, 1920 };
+
+    for( size_t i = 0; i < ARRAY_SIZE(widths); i++ )
+        for( int parity = 0; parity < 2; parity++ )
+            for( int mode = 0; mode <= 2; mode += 2 )
+                for( int run = 0; run < 8; run++ )
+                {
+                    const int w = widths[i];
+                    /* The first and last lines are filtered upside down */
+                    const int refs = (run & 1) ? -PITCH : PITCH;
+                    uint8_t *p = &prev[2 * PITCH + MARGIN];
+                    uint8_t *c = &cur[2 * PITCH + MARGIN];
+                    uint8_t *n = &next[2 * PITCH + MARGIN];
+
+                    Fill( prev, sizeof(prev) );
+                    Fill( cur, sizeof(cur) );
+                    Fill( next, sizeof(next) );
+
+                    memset( ref, 0, sizeof(ref) );
+                    memset( out, 0, sizeof(out) );
+                    yadif_filter_line_c( ref, p, c, n, w, refs, -refs,
+                                         parity, mode );
+                    yadif_filter_line_avx2( out, p, c, n, w, refs, -refs,
+                                            parity, mode );
+                    assert( !memcmp( ref, out, sizeof(ref) ) );
+                }
+}
+
+static void TestMotion( void )
+{
+    static uint8_t prev[8 * PITCH], curr[8 * PITCH];
+
+    for( int run = 0; run < 2000; run++ )
+    {
+        Fill( prev, sizeof(prev) );
+        memcpy( curr, prev, sizeof(curr) );
+        /* Move some of the lines */
+        for( int y = 0; y < 8; y++ )
+            if( test_rand() & 1 )
+                Fill( &curr[y * PITCH], 32 );
+
+        int i_top = 0, i_bot = 0, i_motion = 0;
+        for( int i = 0; i < 4; i++ )
+        {
+            int i_top_temp, i_bot_temp;
+            i_motion += TestForMotionInBlock( &prev[8 * i], &curr[8 * i],
+                                              PITCH, PITCH,
+                                              &i_top_temp, &i_bot_temp );
+            i_top += i_top_temp;
+            i_bot += i_bot_temp;
+        }
+
+        int i_top_avx2, i_bot_avx2;
+        int i_motion_avx2 = TestForMotionIn4BlocksAVX2( prev, curr,
+                                                        PITCH, PITCH,
+                                                        &i_top_avx2,
+                                                        &i_bot_avx2 );
+        assert( i_motion == i_motion_avx2 );
+        assert( i_top == i_top_avx2 );
+        assert( i_bot == i_bot_avx2 );
+    }
+}
+
+static void TestInterlaceScore( void )
+{
+    static uint8_t c[PITCH], p[PITCH], n[PITCH];
+
+    for( int w = 0; w < 200; w++ )
+        for( int run = 0; run < 8; run++ )
+        {
+            Fill( c, sizeof(c) );
+            Fill( p, sizeof(p) );
+            Fill( n, sizeof(n) );
+
+            assert( CalculateInterlaceLineScore( c, p, n, 9 * w ) ==
+                    CalculateInterlaceLineScoreAVX2( c, p, n, 9 * w ) );
+        }
+}
+
+static void TestDarkenField( vlc_fourcc_t i_chroma )
+{
+    video_format_t fmt;
+    video_format_Setup( &fmt, i_chroma, 721, 577, 721, 577, 1, 1 );
+
+    picture_t *p_ref = picture_NewFromFormat( &fmt );
+    picture_t *p_out = picture_NewFromFormat( &fmt );
+    assert( p_ref != NULL && p_out != NULL );
+
+    for( int i_strength = 1; i_strength <= 3; i_strength++ )
+        for( int i_field = 0; i_field < 2; i_field++ )
+            for( int b_chroma = 0; b_chroma < 2; b_chroma++ )
+            {
+                for( int i = 0; i < p_ref->i_planes; i++ )
+                {
+                    size_t i_size = p_ref->p[i].i_pitch * p_ref->p[i].i_lines;
+
+                    Fill( p_ref->p[i].p_pixels, i_size );
+                    memcpy( p_out->p[i].p_pixels, p_ref->p[i].p_pixels,
+                            i_size );
+                }
+
+                DarkenField( p_ref, i_field, i_strength, b_chroma );
+                DarkenFieldAVX2( p_out, i_field, i_strength, b_chroma );
+
+                for( int i = 0; i < p_ref->i_planes; i++ )
+                    assert( !memcmp( p_ref->p[i].p_pixels,
+                                     p_out->p[i].p_pixels,
+                                     p_ref->p[i].i_pitch
+                                     * p_ref->p[i].i_lines ) );
+            }
+
+    picture_Release( p_out );
+    picture_Release( p_ref );
+}
+
+int main( void )
+{
+    if( !vlc_CPU_AVX2() )
+    {
+        fprintf( stderr, "AVX2 not supported by the CPU, skipping\n" );
+        return 77;
+    }
+
+    TestMerge();
+    TestYadif();
+    TestMotion();
+    TestInterlaceScore();
+    TestDarkenField( VLC_CODEC_I420 );
+    TestDarkenField( VLC_CODEC_I422 );
+    return 0;
+}
+
+#else
+
+int main( void )
+{
+    fprintf( stderr, "AVX2 intrinsics not supported, skipping\n" );
+    return 77;
+}
+
+#endif
@@ -0,0 +1,187 @@
+/*****************************************************************************
+ * slices.c: test video filters split across the filter threads
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_filter.h>
+#include <vlc_picture.h>
+#include "../../../lib/libvlc_internal.h"
+
+#include "../../libvlc/test.h"
+
+#define WIDTH  720
+#define HEIGHT 576
+#define FRAMES 8
+
+static const struct
+{
+    const char *chain;
+    vlc_fourcc_t chroma;
+} tests[] = {
+    { "adjust{contrast=1.4,hue=40,saturation=2.5,gamma=1.3}", VLC_CODEC_I420 },
+    { "adjust{brightness=0.8,saturation=0.5}", VLC_CODEC_YUYV },
+    { "sharpen{sigma=1.5}", VLC_CODEC_I420 },
+    { "gaussianblur", VLC_CODEC_I420 },
+    { "hqdn3d", VLC_CODEC_I420 },
+    { "gradfun", VLC_CODEC_I420 },
+    { "deinterlace{mode=yadif}", VLC_CODEC_I420 },
+    { "deinterlace{mode=yadif2x}", VLC_CODEC_I422 },
+    { "transform{type=90}", VLC_CODEC_I420 },
+    { "transform{type=vflip}", VLC_CODEC_I420 },
+    { "transform{type=270}", VLC_CODEC_I422 },
+    { "transform{type=antitranspose}", VLC_CODEC_YUYV },
+};
+
+static picture_t *BufferNew( filter_t *p_filter )
+{
+    return picture_NewFromFormat( &p_filter->fmt_out.video );
+}
+
+static void FillPicture( picture_t *p_pic, unsigned i_frame )
+{
+    uint32_t seed = TEST_RAND_SEED + i_frame;
+
+    for( int i = 0; i < p_pic->i_planes; i++ )
+    {
+        plane_t *p = &p_pic->p[i];
+
+        /* Fill the margins too: some filters read past the visible edges */
+        for( int y = 0; y < p->i_lines; y++ )
+            for( int x = 0; x < p->i_pitch; x++ )
+            {
+                /* smooth gradients with some noise and moving edges */
+                p->p_pixels[y * p->i_pitch + x] =
+                    (x + 2 * y + 4 * i_frame) / 4 + (test_rand_r( &seed ) & 15)
+                    + ((((x + i_frame * 8) / 32) & 1) ? 64 : 0);
+            }
+    }
+}
+
+static uint32_t HashPicture( const picture_t *p_pic )
+{
+    uint32_t hash = 2166136261u;
+
+    for( int i = 0; i < p_pic->i_planes; i++ )
+    {
+        const plane_t *p = &p_pic->p[i];
+
+        for( int y = 0; y < p->i_visible_lines; y++ )
+            for( int x = 0; x < p->i_visible_pitch; x++ )
+                hash = (hash ^ p->p_pixels[y * p->i_pitch + x]) * 16777619u;
+    }
+    return hash;
+}
+
+/* Runs the chain on FRAMES pictures, returns the number of output pictures */
+static unsigned RunChain( vlc_object_t *obj, const char *psz_chain,
+                          vlc_fourcc_t i_chroma, uint32_t *hashes,
+                          mtime_t *pi_duration )
+{
+    filter_owner_t owner = {
+        .video = { .buffer_new = BufferNew },
+    };
+    filter_chain_t *chain = filter_chain_NewVideo( obj, true, &owner );
+    assert( chain != NULL );
+
+    es_format_t fmt;
+    es_format_Init( &fmt, VIDEO_ES, i_chroma );
+    video_format_Setup( &fmt.video, i_chroma, WIDTH, HEIGHT,
+                        WIDTH, HEIGHT, 1, 1 );
+    filter_chain_Reset( chain, &fmt, &fmt );
+    int ret = filter_chain_AppendFromString( chain, psz_chain );
+    assert( ret > 0 );
+
+    unsigned count = 0;
+    mtime_t duration = 0;
+
+    for( unsigned i = 0; i < FRAMES; i++ )
+    {
+        picture_t *p_pic = picture_NewFromFormat( &fmt.video );
+        assert( p_pic != NULL );
+        FillPicture( p_pic, i );
+        p_pic->date = VLC_TS_0 + i * 40000;
+        p_pic->b_progressive = false;
+        p_pic->b_top_field_first = true;
+        p_pic->i_nb_fields = 2;
+
+        mtime_t start = mdate();
+        p_pic = filter_chain_VideoFilter( chain, p_pic );
+        duration += mdate() - start;
+
+        while( p_pic != NULL )
+        {
+            picture_t *p_next = p_pic->p_next;
+
+            assert( count < 2 * FRAMES );
+            hashes[count++] = HashPicture( p_pic );
+            picture_Release( p_pic );
+            p_pic = p_next;
+        }
+    }
+
+    filter_chain_Delete( chain );
+    es_format_Clean( &fmt );
+    *pi_duration = duration;
+    return count;
+}
+
+int main( void )
+{
+    static const char *const argv_single[] = { "--filter-threads=1" };
+    static const char *const argv_sliced[] = { "--filter-threads=4" };
+
+    alarm( 60 );
+    setenv( "VLC_PLUGIN_PATH", "../modules", 1 );
+
+    libvlc_instance_t *single = libvlc_new( 1, argv_single );
+    libvlc_instance_t *sliced = libvlc_new( 1, argv_sliced );
+    assert( single != NULL && sliced != NULL );
+
+    for( size_t i = 0; i < ARRAY_SIZE(tests); i++ )
+    {
+        uint32_t ref[2 * FRAMES], out[2 * FRAMES];
+        mtime_t ref_time, out_time;
+
+        unsigned ref_count = RunChain( VLC_OBJECT(single->p_libvlc_int),
+                                       tests[i].chain, tests[i].chroma,
+                                       ref, &ref_time );
+        unsigned out_count = RunChain( VLC_OBJECT(sliced->p_libvlc_int),
+                                       tests[i].chain, tests[i].chroma,
+                                       out, &out_time );
+
+        printf( "%-55s %4.4s %2u pictures, %6"PRId64" us / %6"PRId64" us\n",
+                tests[i].chain, (const char *)&tests[i].chroma, ref_count,
+                ref_time, out_time );
+        fflush( stdout );
+
+        /* The output must not depend on the number of slices */
+        assert( ref_count > 0 );
+        assert( ref_count == out_count );
+        for( unsigned j = 0; j < ref_count; j++ )
+            assert( ref[j] == out[j] );
+    }
+
+    libvlc_release( sliced );
+    libvlc_release( single );
+    return 0;
+}
@@ -0,0 +1,154 @@
+/*****************************************************************************
+ * block_fifo.c: block FIFO throughput benchmark
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "../../libvlc/test.h"
+#include <string.h>
+#include <vlc_common.h>
+#include <vlc_block.h>
+
+#define COUNT 300000
+
+static void *producer(void *data)
+{
+    block_fifo_t *fifo = data;
+
+    for (uint32_t i = 0; i < COUNT; i++)
+    {
+        block_t *block = block_Alloc(sizeof (i));
+        assert(block != NULL);
+        memcpy(block->p_buffer, &i, sizeof (i));
+        block_FifoPut(fifo, block);
+    }
+    return NULL;
+}
+
+static void check_block(block_t *block, uint32_t expected)
+{
+    uint32_t seq;
+
+    assert(block != NULL);
+    assert(block->i_buffer == sizeof (seq));
+    memcpy(&seq, block->p_buffer, sizeof (seq));
+    assert(seq == expected);
+    block_Release(block);
+}
+
+/* Consumer using the convenience functions, like access_output/udp */
+static mtime_t bench_get(block_fifo_t *fifo)
+{
+    vlc_thread_t th;
+    mtime_t start = mdate();
+
+    if (vlc_clone(&th, producer, fifo, VLC_THREAD_PRIORITY_LOW))
+        abort();
+    for (uint32_t i = 0; i < COUNT; i++)
+        check_block(block_FifoGet(fifo), i);
+    vlc_join(th, NULL);
+    return mdate() - start;
+}
+
+/* Consumer using the locked functions, like the decoder thread */
+static mtime_t bench_locked(block_fifo_t *fifo)
+{
+    vlc_thread_t th;
+    mtime_t start = mdate();
+
+    if (vlc_clone(&th, producer, fifo, VLC_THREAD_PRIORITY_LOW))
+        abort();
+
+    vlc_fifo_Lock(fifo);
+    for (uint32_t i = 0; i < COUNT; i++)
+    {
+        block_t *block;
+
+        while ((block = vlc_fifo_DequeueUnlocked(fifo)) == NULL)
+            vlc_fifo_Wait(fifo);
+        vlc_fifo_Unlock(fifo);
+        check_block(block, i);
+        vlc_fifo_Lock(fifo);
+    }
+    vlc_fifo_Unlock(fifo);
+    vlc_join(th, NULL);
+    return mdate() - start;
+}
+
+static void test_chain(block_fifo_t *fifo)
+{
+    block_t *chain = NULL, **pp = &chain;
+
+    for (uint32_t i = 0; i < 5; i++)
+    {
+        block_t *block = block_Alloc(sizeof (i));
+        assert(block != NULL);
+        memcpy(block->p_buffer, &i, sizeof (i));
+        *pp = block;
+        pp = &block->p_next;
+    }
+
+    block_FifoPut(fifo, chain);
+    vlc_fifo_Lock(fifo);
+    assert(vlc_fifo_GetCount(fifo) == 5);
+    vlc_fifo_Unlock(fifo);
+    check_block(block_FifoGet(fifo), 0);
+    check_block(block_FifoGet(fifo), 1);
+
+    vlc_fifo_Lock(fifo);
+    assert(vlc_fifo_GetCount(fifo) == 3);
+    assert(vlc_fifo_GetBytes(fifo) == 3 * sizeof (uint32_t));
+    chain = vlc_fifo_DequeueAllUnlocked(fifo);
+    assert(vlc_fifo_IsEmpty(fifo));
+    assert(vlc_fifo_GetBytes(fifo) == 0);
+    vlc_fifo_Unlock(fifo);
+
+    for (uint32_t i = 2; i < 5; i++)
+    {
+        block_t *next = chain->p_next;
+        check_block(chain, i);
+        chain = next;
+    }
+    assert(chain == NULL);
+}
+
+int main(void)
+{
+    block_fifo_t *fifo;
+
+    test_init();
+
+    for (int mpsc = 0; mpsc <= 1; mpsc++)
+    {
+        fifo = mpsc ? block_FifoNewMPSC() : block_FifoNew();
+        assert(fifo != NULL);
+
+        test_chain(fifo);
+
+        mtime_t get = bench_get(fifo);
+        mtime_t locked = bench_locked(fifo);
+        printf("%-7s: get %6.1f ns/block, locked %6.1f ns/block\n",
+               mpsc ? "mpsc" : "locked",
+               get * 1000. / COUNT, locked * 1000. / COUNT);
+
+        /* Leave some blocks for block_FifoRelease() */
+        block_FifoPut(fifo, block_Alloc(16));
+        block_FifoPut(fifo, block_Alloc(16));
+        block_FifoRelease(fifo);
+    }
+    return 0;
+}
@@ -39,6 +39,7 @@
 #include <vlc_block.h>
 #include <vlc_demux.h>
 #include <vlc_es_out.h>
+#include <vlc_modules.h>
 #include <vlc_url.h>
 #include "../lib/libvlc_internal.h"
 
@@ -56,6 +57,8 @@ struct test_es_out_t
 {
     struct es_out_t out;
     struct es_out_id_t *ids;
+    uint64_t blocks;
+    uint64_t payload;
 };
 
 struct es_out_id_t
@@ -94,8 +97,12 @@ static void EsOutCheckId(es_out_t *out, es_out_id_t *id)
 
 static int EsOutSend(es_out_t *out, es_out_id_t *id, block_t *block)
 {
+    struct test_es_out_t *ctx = (struct test_es_out_t *) out;
+
     //debug("[%p] Sent    ES: %zu\n", (void *)idd, block->i_buffer);
     EsOutCheckId(out, id);
+    ctx->blocks++;
+    ctx->payload += block->i_buffer;
     block_Release(block);
     return VLC_SUCCESS;
 }
@@ -183,6 +190,8 @@ static es_out_t *test_es_out_create(vlc_object_t *parent)
     }
 
     ctx->ids = NULL;
+    ctx->blocks = 0;
+    ctx->payload = 0;
 
     es_out_t *out = &ctx->out;
     out->pf_add = EsOutAdd;
@@ -195,7 +204,8 @@ static es_out_t *test_es_out_create(vlc_object_t *parent)
     return out;
 }
 
-static int demux_process_stream(const char *name, stream_t *s)
+static int demux_process_stream(const char *name, stream_t *s,
+                                struct vlc_demux_run_stats *stats)
 {
     if (name == NULL)
         name = "any";
@@ -207,6 +217,11 @@ static int demux_process_stream(const char *name, stream_t *s)
     if (out == NULL)
         return -1;
 
+    block_pool_stats_t pool_start;
+    mtime_t start = mdate();
+
+    block_PoolGetStats(&pool_start);
+
     demux_t *demux = demux_New(VLC_OBJECT(s), name, "", s, out);
     if (demux == NULL)
     {
@@ -222,6 +237,22 @@ static int demux_process_stream(const char *name, stream_t *s)
     while ((val = demux_Demux(demux)) == VLC_DEMUXER_SUCCESS)
          i++;
 
+    if (stats != NULL)
+    {
+        struct test_es_out_t *ctx = (struct test_es_out_t *)out;
+        block_pool_stats_t pool_end;
+
+        block_PoolGetStats(&pool_end);
+        stats->duration = mdate() - start;
+        stats->bytes = vlc_stream_Tell(s);
+        stats->blocks = ctx->blocks;
+        stats->payload = ctx->payload;
+        stats->pool_allocs = (pool_end.i_hits + pool_end.i_misses)
+                           - (pool_start.i_hits + pool_start.i_misses);
+        strlcpy(stats->module, module_get_object(demux->p_module),
+                sizeof (stats->module));
+    }
+
     demux_Delete(demux);
     es_out_Delete(out);
 
@@ -250,7 +281,8 @@ static libvlc_instance_t *libvlc_create(void)
     return vlc;
 }
 
-int vlc_demux_process_url(const char *demux, const char *url)
+static int demux_process_url(const char *demux, const char *url,
+                             struct vlc_demux_run_stats *stats)
 {
     libvlc_instance_t *vlc = libvlc_create();
     if (vlc == NULL)
@@ -260,12 +292,13 @@ int vlc_demux_process_url(const char *demux, const char *url)
     if (s == NULL)
         fprintf(stderr, "Error: cannot create input stream: %s\n", url);
 
-    int ret = demux_process_stream(demux, s);
+    int ret = demux_process_stream(demux, s, stats);
     libvlc_release(vlc);
     return ret;
 }
 
-int vlc_demux_process_path(const char *demux, const char *path)
+static int demux_process_path(const char *demux, const char *path,
+                              struct vlc_demux_run_stats *stats)
 {
     char *url = vlc_path2uri(path, NULL);
     if (url == NULL)
@@ -274,11 +307,28 @@ int vlc_demux_process_path(const char *demux, const char *path)
         return -1;
     }
 
-    int ret = vlc_demux_process_url(demux, url);
+    int ret = demux_process_url(demux, url, stats);
     free(url);
     return ret;
 }
 
+int vlc_demux_process_url(const char *demux, const char *url)
+{
+    return demux_process_url(demux, url, NULL);
+}
+
+int vlc_demux_process_path(const char *demux, const char *path)
+{
+    return demux_process_path(demux, path, NULL);
+}
+
+int vlc_demux_bench_path(const char *demux, const char *path,
+                         struct vlc_demux_run_stats *stats)
+{
+    memset(stats, 0, sizeof (*stats));
+    return demux_process_path(demux, path, stats);
+}
+
 int vlc_demux_process_memory(const char *demux,
                              const unsigned char *buf, size_t length)
 {
@@ -291,7 +341,7 @@ int vlc_demux_process_memory(const char *demux,
     if (s == NULL)
         fprintf(stderr, "Error: cannot create input stream\n");
 
-    int ret = demux_process_stream(demux, s);
+    int ret = demux_process_stream(demux, s, NULL);
     libvlc_release(vlc);
     return ret;
 }
@@ -24,8 +24,25 @@
  * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
  *****************************************************************************/
 
+#include <stdint.h>
 
 int vlc_demux_process_url(const char *demux, const char *url);
 int vlc_demux_process_path(const char *demux, const char *path);
 int vlc_demux_process_memory(const char *demux,
                              const unsigned char *buf, size_t length);
+
+struct vlc_demux_run_stats
+{
+    char module[32];   /**< Demux module that was actually used */
+    uint64_t bytes;    /**< Input bytes consumed */
+    uint64_t blocks;   /**< Blocks sent to the ES output */
+    uint64_t payload;  /**< Payload bytes sent to the ES output */
+    /** block_Alloc() calls of pool size (pool hits and misses). Blocks
+     * larger than the pool classes, and all blocks while the pool is
+     * disabled, are not counted. */
+    uint64_t pool_allocs;
+    int64_t duration;  /**< Wall clock time (microseconds) */
+};
+
+int vlc_demux_bench_path(const char *demux, const char *path,
+                         struct vlc_demux_run_stats *stats);
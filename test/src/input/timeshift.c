@@ -0,0 +1,215 @@
+/*****************************************************************************
+ * timeshift.c: test seeking inside the timeshift buffer
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/* The timeshift is internal to the input: test it from its source */
+#include "../../../src/input/es_out_timeshift.c"
+
+#include "../../libvlc/test.h"
+#include "../../../lib/libvlc_internal.h"
+
+#define SEGMENTS 3
+#define BLOCKS   4
+
+/* Internal core functions used by the timeshift */
+void input_ControlPush( input_thread_t *p_input, int i_type, vlc_value_t *p_val )
+{
+    (void) p_input; (void) i_type; (void) p_val;
+}
+
+#if (defined (LIBVLC_USE_PTHREAD) || defined(__ANDROID__)) && !defined (NDEBUG)
+void vlc_assert_locked( vlc_mutex_t *p_lock )
+{
+    (void) p_lock;
+}
+#endif
+
+/* Next es_out, recording what the timeshift thread plays */
+static struct
+{
+    es_out_t out;
+    es_out_t *p_ts_out;
+
+    vlc_mutex_t lock;
+    vlc_cond_t  wait;
+    int         i_groups;
+    int         i_flushes;
+    int         i_sends;
+    mtime_t     i_first_pts;
+} next;
+
+/* Replayed commands must not be sent with the timeshift lock held, as the
+ * next es_out may call back into the timeshift */
+static void CheckUnlocked( void )
+{
+    es_out_sys_t *p_sys = next.p_ts_out->p_sys;
+
+    assert( vlc_mutex_trylock( &p_sys->p_ts->lock ) == 0 );
+    vlc_mutex_unlock( &p_sys->p_ts->lock );
+}
+
+static es_out_id_t *NextAdd( es_out_t *p_out, const es_format_t *p_fmt )
+{
+    (void) p_fmt;
+    return (es_out_id_t *)p_out;
+}
+
+static int NextSend( es_out_t *p_out, es_out_id_t *p_es, block_t *p_block )
+{
+    (void) p_out; (void) p_es;
+
+    vlc_mutex_lock( &next.lock );
+    if( next.i_sends++ == 0 )
+        next.i_first_pts = p_block->i_pts;
+    vlc_cond_signal( &next.wait );
+    vlc_mutex_unlock( &next.lock );
+
+    block_Release( p_block );
+    return VLC_SUCCESS;
+}
+
+static void NextDel( es_out_t *p_out, es_out_id_t *p_es )
+{
+    (void) p_out; (void) p_es;
+}
+
+static int NextControl( es_out_t *p_out, int i_query, va_list args )
+{
+    (void) p_out;
+
+    switch( i_query )
+    {
+    case ES_OUT_GET_BUFFERING:
+        *va_arg( args, bool * ) = false;
+        break;
+    case ES_OUT_GET_EMPTY:
+        *va_arg( args, bool * ) = true;
+        break;
+    case ES_OUT_SET_GROUP:
+        CheckUnlocked();
+        vlc_mutex_lock( &next.lock );
+        next.i_groups++;
+        vlc_mutex_unlock( &next.lock );
+        break;
+    case ES_OUT_SET_TIME:
+        assert( va_arg( args, mtime_t ) < 0 );
+        CheckUnlocked();
+        vlc_mutex_lock( &next.lock );
+        next.i_flushes++;
+        vlc_cond_signal( &next.wait );
+        vlc_mutex_unlock( &next.lock );
+        break;
+    }
+    return VLC_SUCCESS;
+}
+
+static void NextDestroy( es_out_t *p_out )
+{
+    (void) p_out;
+}
+
+int main( void )
+{
+    test_init();
+
+    libvlc_instance_t *vlc = libvlc_new( test_defaults_nargs,
+                                         test_defaults_args );
+    assert( vlc != NULL );
+
+    /* A live input: without pace control */
+    input_thread_t *p_input =
+        vlc_custom_create( VLC_OBJECT(vlc->p_libvlc_int),
+                           sizeof(input_thread_private_t), "input" );
+    assert( p_input != NULL );
+
+    next.out.pf_add = NextAdd;
+    next.out.pf_send = NextSend;
+    next.out.pf_del = NextDel;
+    next.out.pf_control = NextControl;
+    next.out.pf_destroy = NextDestroy;
+    vlc_mutex_init( &next.lock );
+    vlc_cond_init( &next.wait );
+
+    es_out_t *p_out = input_EsOutTimeshiftNew( p_input, &next.out,
+                                               INPUT_RATE_DEFAULT );
+    assert( p_out != NULL );
+    next.p_ts_out = p_out;
+
+    es_format_t fmt;
+    es_format_Init( &fmt, VIDEO_ES, VLC_CODEC_H264 );
+    es_out_id_t *p_es = es_out_Add( p_out, &fmt );
+    assert( p_es != NULL );
+
+    /* Pausing starts spooling */
+    assert( !es_out_SetPauseState( p_out, false, true, mdate() ) );
+
+    for( int i = 0; i < SEGMENTS; i++ )
+    {
+        es_out_Control( p_out, ES_OUT_SET_GROUP, i + 1 );
+        es_out_SetTimes( p_out, 0., (i + 1) * CLOCK_FREQ, 10 * CLOCK_FREQ );
+
+        for( int j = 0; j < BLOCKS; j++ )
+        {
+            block_t *p_block = block_Alloc( 16 );
+            assert( p_block != NULL );
+            p_block->i_pts = p_block->i_dts =
+                VLC_TS_0 + i * CLOCK_FREQ + j * 40000;
+            if( j == 0 )
+                p_block->i_flags |= BLOCK_FLAG_TYPE_I;
+
+            es_out_SetPCR( p_out, p_block->i_dts );
+            assert( !es_out_Send( p_out, p_es, p_block ) );
+        }
+        /* Leave room for a seek point per segment */
+        msleep( TS_INDEX_MIN_INTERVAL + CLOCK_FREQ / 20 );
+    }
+
+    /* Seek forward to the last segment while paused */
+    assert( !es_out_SetTime( p_out, SEGMENTS * CLOCK_FREQ ) );
+
+    vlc_mutex_lock( &next.lock );
+    while( next.i_flushes == 0 )
+        vlc_cond_wait( &next.wait, &next.lock );
+    /* Skipped controls are replayed, skipped data is not */
+    assert( next.i_groups == SEGMENTS );
+    assert( next.i_sends == 0 );
+    vlc_mutex_unlock( &next.lock );
+
+    /* Playback resumes from the seek point */
+    assert( !es_out_SetPauseState( p_out, false, false, mdate() ) );
+
+    vlc_mutex_lock( &next.lock );
+    while( next.i_sends < BLOCKS )
+        vlc_cond_wait( &next.wait, &next.lock );
+    assert( next.i_first_pts == VLC_TS_0 + (SEGMENTS - 1) * CLOCK_FREQ );
+    assert( next.i_flushes == 1 );
+    vlc_mutex_unlock( &next.lock );
+
+    es_out_Delete( p_out );
+    vlc_cond_destroy( &next.wait );
+    vlc_mutex_destroy( &next.lock );
+
+    vlc_object_release( p_input );
+    libvlc_release( vlc );
+    return 0;
+}
@@ -0,0 +1,234 @@
+/*****************************************************************************
+ * block_pool.c: block allocator pool test and benchmark
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "../../libvlc/test.h"
+#include <vlc_common.h>
+#include <vlc_block.h>
+
+#define COUNT 64
+#define SIZE  1316
+
+/* Enough iterations to get a meaningful figure, few enough for make check */
+#define ITERATIONS 200000
+#define BATCH      64
+
+static const size_t sizes[] = { 188, 1316, 7 * 188 + 12, 4096, 65536 };
+
+static block_pool_stats_t stats(void)
+{
+    block_pool_stats_t s;
+
+    block_PoolGetStats(&s);
+    return s;
+}
+
+static void alloc_all(block_t **blocks, size_t size)
+{
+    for (unsigned i = 0; i < COUNT; i++)
+    {
+        blocks[i] = block_Alloc(size);
+        assert(blocks[i] != NULL);
+        memset(blocks[i]->p_buffer, i, size);
+    }
+}
+
+static void release_all(block_t **blocks)
+{
+    for (unsigned i = 0; i < COUNT; i++)
+        block_Release(blocks[i]);
+}
+
+static void *release_thread(void *data)
+{
+    release_all(data);
+    return NULL;
+}
+
+static mtime_t bench_single(size_t size)
+{
+    block_t *batch[BATCH];
+    mtime_t start = mdate();
+
+    for (unsigned i = 0; i < ITERATIONS / BATCH; i++)
+    {
+        for (unsigned j = 0; j < BATCH; j++)
+        {
+            batch[j] = block_Alloc(size);
+            assert(batch[j] != NULL);
+            batch[j]->p_buffer[0] = j;
+        }
+        for (unsigned j = 0; j < BATCH; j++)
+            block_Release(batch[j]);
+    }
+    return mdate() - start;
+}
+
+/* Allocating in one thread and releasing in another is the common case
+ * between the input and decoder threads. */
+struct handoff
+{
+    block_fifo_t *fifo;
+    size_t size;
+};
+
+static void *consumer(void *data)
+{
+    struct handoff *h = data;
+
+    for (unsigned i = 0; i < ITERATIONS; i++)
+        block_Release(block_FifoGet(h->fifo));
+    return NULL;
+}
+
+static mtime_t bench_handoff(size_t size)
+{
+    struct handoff h = { block_FifoNew(), size };
+    vlc_thread_t th;
+
+    assert(h.fifo != NULL);
+
+    mtime_t start = mdate();
+
+    if (vlc_clone(&th, consumer, &h, VLC_THREAD_PRIORITY_LOW))
+        abort();
+
+    for (unsigned i = 0; i < ITERATIONS; i++)
+    {
+        block_t *block = block_Alloc(size);
+        assert(block != NULL);
+        block_FifoPut(h.fifo, block);
+    }
+    vlc_join(th, NULL);
+
+    mtime_t duration = mdate() - start;
+    block_FifoRelease(h.fifo);
+    return duration;
+}
+
+static void report(const char *name, size_t size, mtime_t heap, mtime_t pool)
+{
+    printf("%-8s %6zu bytes: heap %6.1f ns/block, pool %6.1f ns/block\n",
+           name, size, heap * 1000. / ITERATIONS, pool * 1000. / ITERATIONS);
+}
+
+static void bench(size_t limit)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(sizes); i++)
+    {
+        block_PoolSetLimit(0);
+        mtime_t heap = bench_single(sizes[i]);
+        block_PoolSetLimit(limit);
+        mtime_t pool = bench_single(sizes[i]);
+        report("single", sizes[i], heap, pool);
+
+        block_PoolSetLimit(0);
+        heap = bench_handoff(sizes[i]);
+        block_PoolSetLimit(limit);
+        pool = bench_handoff(sizes[i]);
+        report("handoff", sizes[i], heap, pool);
+    }
+
+    block_pool_stats_t s = stats();
+    printf("hits: %"PRIu64", misses: %"PRIu64", drops: %"PRIu64
+           ", held: %zu bytes\n", s.i_hits, s.i_misses, s.i_drops,
+           s.i_bytes_held);
+    assert(s.i_hits > s.i_misses);
+    assert(s.i_bytes_held <= limit);
+}
+
+int main(void)
+{
+    const size_t limit = 8 << 20;
+    block_t *blocks[COUNT];
+    block_pool_stats_t before, after;
+
+    test_init();
+
+    /* Disabled pool: blocks go straight back to the heap */
+    block_PoolSetLimit(0);
+    before = stats();
+    alloc_all(blocks, SIZE);
+    release_all(blocks);
+    after = stats();
+    assert(after.i_hits == before.i_hits);
+    assert(after.i_misses == before.i_misses);
+    assert(after.i_drops == before.i_drops);
+    assert(after.i_bytes_held == 0);
+
+    /* Released blocks are reused by the same thread */
+    block_PoolSetLimit(limit);
+    assert(stats().i_bytes_limit == limit);
+    block_t *block = block_Alloc(SIZE);
+    assert(block != NULL);
+    block_Release(block);
+    assert(stats().i_bytes_held > 0);
+    before = stats();
+    block_t *again = block_Alloc(SIZE);
+    assert(again == block);
+    after = stats();
+    assert(after.i_hits == before.i_hits + 1);
+    assert(after.i_bytes_held == 0);
+
+    /* Recycled blocks must behave like fresh ones */
+    assert(again->i_buffer == SIZE);
+    assert(again->p_buffer >= again->p_start);
+    assert(again->p_buffer + again->i_buffer
+           <= again->p_start + again->i_size);
+    again = block_Realloc(again, 100, 1000);
+    assert(again != NULL && again->i_buffer == 1100);
+    block_Release(again);
+
+    /* Blocks released by another thread are reused once it has exited */
+    alloc_all(blocks, SIZE);
+    vlc_thread_t th;
+    if (vlc_clone(&th, release_thread, blocks, VLC_THREAD_PRIORITY_LOW))
+        abort();
+    vlc_join(th, NULL);
+    before = stats();
+    alloc_all(blocks, SIZE);
+    after = stats();
+    assert(after.i_hits > before.i_hits);
+    release_all(blocks);
+
+    /* Shrinking the limit must also empty the thread caches */
+    assert(stats().i_bytes_held > 0);
+    block_PoolSetLimit(0);
+    after = stats();
+    assert(after.i_bytes_limit == 0);
+    assert(after.i_bytes_held == 0);
+
+    /* Blocks beyond the limit are dropped */
+    block_PoolSetLimit(16 << 10);
+    alloc_all(blocks, SIZE);
+    before = stats();
+    release_all(blocks);
+    after = stats();
+    assert(after.i_drops > before.i_drops);
+    assert(after.i_bytes_held <= (16 << 10));
+
+    block_PoolSetLimit(0);
+    assert(stats().i_bytes_held == 0);
+
+    bench(limit);
+
+    block_PoolSetLimit(0);
+    assert(stats().i_bytes_held == 0);
+    return 0;
+}
@@ -0,0 +1,256 @@
+/*****************************************************************************
+ * spu.c: test the subpicture rendering cache
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_picture.h>
+#include <vlc_subpicture.h>
+#include <vlc_spu.h>
+#include <vlc_text_style.h>
+#include "../../../lib/libvlc_internal.h"
+
+#include "../../libvlc/test.h"
+
+#define WIDTH  640
+#define HEIGHT 480
+#define FRAMES 40
+
+/* Changes the lines [first, end) of the region content */
+static void FillLines( picture_t *p_pic, unsigned first, unsigned end )
+{
+    for( int i = 0; i < p_pic->i_planes; i++ )
+    {
+        plane_t *p = &p_pic->p[i];
+
+        for( unsigned y = first; y < end && y < (unsigned)p->i_lines; y++ )
+            for( int x = 0; x < p->i_pitch; x++ )
+                p->p_pixels[y * p->i_pitch + x] =
+                    p_pic->format.i_chroma == VLC_CODEC_YUVP ? test_rand() & 3
+                                                            : test_rand();
+    }
+}
+
+static subpicture_t *NewSubpicture( int i_channel, int64_t i_order,
+                                    mtime_t i_date,
+                                    const picture_t *p_content,
+                                    const char *psz_text,
+                                    unsigned i_width, unsigned i_height )
+{
+    subpicture_t *p_subpic = subpicture_New( NULL );
+    assert( p_subpic != NULL );
+
+    p_subpic->i_channel  = i_channel;
+    p_subpic->i_order    = i_order;
+    p_subpic->i_start    = i_date;
+    p_subpic->i_stop     = i_date + CLOCK_FREQ;
+    p_subpic->b_ephemer  = true;
+    p_subpic->b_absolute = true;
+    p_subpic->b_subtitle = true;
+    p_subpic->i_original_picture_width  = i_width;
+    p_subpic->i_original_picture_height = i_height;
+
+    subpicture_region_t *p_region = subpicture_region_New( &p_content->format );
+    assert( p_region != NULL );
+    picture_CopyPixels( p_region->p_picture, p_content );
+    p_region->i_x = 16;
+    p_region->i_y = 24;
+    p_subpic->p_region = p_region;
+
+    if( psz_text )
+    {
+        video_format_t fmt;
+        video_format_Init( &fmt, VLC_CODEC_TEXT );
+        fmt.i_sar_num = fmt.i_sar_den = 1;
+
+        p_region->p_next = subpicture_region_New( &fmt );
+        assert( p_region->p_next != NULL );
+        p_region->p_next->p_text = text_segment_New( psz_text );
+        p_region->p_next->i_align = SUBPICTURE_ALIGN_BOTTOM;
+    }
+    return p_subpic;
+}
+
+static void ComparePictures( const subpicture_region_t *a,
+                             const subpicture_region_t *b )
+{
+    const video_format_t *fa = &a->fmt, *fb = &b->fmt;
+
+    assert( fa->i_chroma == fb->i_chroma );
+    assert( fa->i_visible_width == fb->i_visible_width );
+    assert( fa->i_visible_height == fb->i_visible_height );
+    assert( fa->i_x_offset == fb->i_x_offset );
+    assert( fa->i_y_offset == fb->i_y_offset );
+    assert( a->p_picture->i_planes == b->p_picture->i_planes );
+
+    const vlc_chroma_description_t *dsc =
+        vlc_fourcc_GetChromaDescription( fa->i_chroma );
+    assert( dsc != NULL );
+
+    for( int i = 0; i < a->p_picture->i_planes; i++ )
+    {
+        const plane_t *pa = &a->p_picture->p[i];
+        const plane_t *pb = &b->p_picture->p[i];
+        const unsigned x = fa->i_x_offset * dsc->p[i].w.num / dsc->p[i].w.den
+                         * dsc->pixel_size;
+        const unsigned y = fa->i_y_offset * dsc->p[i].h.num / dsc->p[i].h.den;
+        const unsigned w = fa->i_visible_width * dsc->p[i].w.num
+                         / dsc->p[i].w.den * dsc->pixel_size;
+        const unsigned h = fa->i_visible_height * dsc->p[i].h.num
+                         / dsc->p[i].h.den;
+
+        for( unsigned j = y; j < y + h; j++ )
+            assert( !memcmp( &pa->p_pixels[j * pa->i_pitch + x],
+                             &pb->p_pixels[j * pb->i_pitch + x], w ) );
+    }
+}
+
+static void CompareRenders( subpicture_t *a, subpicture_t *b )
+{
+    assert( (a == NULL) == (b == NULL) );
+    if( a == NULL )
+        return;
+
+    const subpicture_region_t *ra = a->p_region, *rb = b->p_region;
+    for( ; ra != NULL && rb != NULL; ra = ra->p_next, rb = rb->p_next )
+    {
+        assert( ra->i_x == rb->i_x && ra->i_y == rb->i_y );
+        assert( ra->i_alpha == rb->i_alpha );
+        ComparePictures( ra, rb );
+    }
+    assert( ra == NULL && rb == NULL );
+
+    subpicture_Delete( a );
+    subpicture_Delete( b );
+}
+
+/* Renders a sequence of updates of a region with a cached renderer and
+ * checks the result against fresh renderers */
+static void Test( vlc_object_t *obj, const video_format_t *p_fmt,
+                  unsigned i_width, unsigned i_height, bool b_text )
+{
+    static const char *const texts[] = { "Hello world", "Another line" };
+    video_format_t fmt_dst;
+    video_format_Setup( &fmt_dst, VLC_CODEC_I420, WIDTH, HEIGHT,
+                        WIDTH, HEIGHT, 1, 1 );
+
+    spu_t *p_spu = spu_Create( obj, NULL );
+    assert( p_spu != NULL );
+    int i_channel = spu_RegisterChannel( p_spu );
+
+    picture_t *p_content = picture_NewFromFormat( p_fmt );
+    assert( p_content != NULL );
+    FillLines( p_content, 0, p_fmt->i_height );
+
+    for( unsigned i = 0; i < FRAMES; i++ )
+    {
+        const mtime_t i_date = VLC_TS_0 + i * 40000;
+        const unsigned lines = p_fmt->i_visible_height;
+
+        switch( test_rand() % 4 )
+        {
+            case 0: /* same content */
+                break;
+            case 1: /* a few lines */
+            {
+                unsigned first = test_rand() % lines;
+                FillLines( p_content, first, first + 1 + test_rand() % 8 );
+                break;
+            }
+            case 2: /* a band */
+            {
+                unsigned first = test_rand() % lines;
+                FillLines( p_content, first, first + test_rand() % (lines / 2) );
+                break;
+            }
+            default: /* everything */
+                FillLines( p_content, 0, p_fmt->i_height );
+                break;
+        }
+        const char *psz_text = b_text ? texts[(i / 4) % 2] : NULL;
+
+        spu_PutSubpicture( p_spu, NewSubpicture( i_channel, i, i_date,
+                                                 p_content, psz_text,
+                                                 i_width, i_height ) );
+        subpicture_t *p_out = spu_Render( p_spu, NULL, &fmt_dst, &fmt_dst,
+                                          i_date, i_date, false );
+
+        spu_t *p_ref_spu = spu_Create( obj, NULL );
+        assert( p_ref_spu != NULL );
+        int i_ref_channel = spu_RegisterChannel( p_ref_spu );
+        assert( i_ref_channel == i_channel );
+        spu_PutSubpicture( p_ref_spu,
+                           NewSubpicture( i_channel, i, i_date, p_content,
+                                          psz_text, i_width, i_height ) );
+        subpicture_t *p_ref = spu_Render( p_ref_spu, NULL, &fmt_dst, &fmt_dst,
+                                          i_date, i_date, false );
+        spu_Destroy( p_ref_spu );
+
+        CompareRenders( p_ref, p_out );
+    }
+
+    picture_Release( p_content );
+    spu_Destroy( p_spu );
+}
+
+int main( void )
+{
+    alarm( 60 );
+    setenv( "VLC_PLUGIN_PATH", "../modules", 1 );
+
+    libvlc_instance_t *vlc = libvlc_new( 0, NULL );
+    assert( vlc != NULL );
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+
+    video_format_t fmt;
+    video_palette_t palette = {
+        .i_entries = 4,
+        .palette = { { 0x00, 0x80, 0x80, 0x00 }, { 0xeb, 0x80, 0x80, 0xff },
+                     { 0x10, 0x80, 0x80, 0xff }, { 0x80, 0x40, 0xc0, 0x80 } },
+    };
+
+    /* Bitmap subtitles, converted only, then converted and scaled */
+    video_format_Init( &fmt, VLC_CODEC_YUVP );
+    video_format_Setup( &fmt, VLC_CODEC_YUVP, 300, 120, 300, 120, 1, 1 );
+    fmt.p_palette = &palette;
+    Test( obj, &fmt, WIDTH, HEIGHT, false );
+    Test( obj, &fmt, WIDTH / 2, HEIGHT / 2, false );
+
+    /* Scaled only */
+    video_format_Init( &fmt, VLC_CODEC_YUVA );
+    video_format_Setup( &fmt, VLC_CODEC_YUVA, 200, 64, 200, 64, 1, 1 );
+    Test( obj, &fmt, WIDTH * 2 / 3, HEIGHT * 2 / 3, false );
+
+    /* Text along with a bitmap */
+    Test( obj, &fmt, WIDTH, HEIGHT, true );
+
+    /* With a budget too small to keep all the entries */
+    var_Create( obj, "sub-cache-size", VLC_VAR_INTEGER );
+    var_SetInteger( obj, "sub-cache-size", 256 );
+    Test( obj, &fmt, WIDTH * 2 / 3, HEIGHT * 2 / 3, true );
+    var_Destroy( obj, "sub-cache-size" );
+
+    libvlc_release( vlc );
+    return 0;
+}
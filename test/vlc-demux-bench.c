@@ -0,0 +1,450 @@
+/**
+ * @file vlc-demux-bench.c
+ */
+/*****************************************************************************
+ * Copyright © 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Runs a corpus of files through their demuxers with a dummy ES output and
+ * reports throughput, block_Alloc() calls and memory usage as JSON, per file
+ * and per demuxer. Each file is processed in a child process, so that the
+ * peak resident set size is that of a single demuxer run.
+ *
+ * Only the block_Alloc() calls served or missed by the block pool are
+ * counted (pool_allocs): blocks above the largest pool size class, or
+ * allocated while the pool is disabled, are not.
+ *
+ * With -c, the per-demuxer figures are compared against a previous report,
+ * and the exit status is non-zero if any of them regressed by more than the
+ * tolerance.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <getopt.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include "src/input/demux-run.h"
+
+struct result
+{
+    const char *path;
+    int status;
+    struct vlc_demux_run_stats stats;
+    long peak_rss; /* KiB */
+};
+
+struct summary
+{
+    char module[32];
+    unsigned files;
+    uint64_t bytes;
+    uint64_t blocks;
+    uint64_t pool_allocs;
+    int64_t duration;
+    long peak_rss;
+};
+
+static double mb_per_s(uint64_t bytes, int64_t duration)
+{
+    return duration > 0 ? bytes / (double)duration : 0.;
+}
+
+static double per_s(uint64_t count, int64_t duration)
+{
+    return duration > 0 ? count * 1000000. / duration : 0.;
+}
+
+static double per_block(uint64_t count, uint64_t blocks)
+{
+    return blocks > 0 ? count / (double)blocks : 0.;
+}
+
+/** Processes one file in a child process. */
+static int bench_file(const char *demux, struct result *res)
+{
+    int fds[2];
+
+    if (pipe(fds))
+        return -1;
+
+    pid_t pid = fork();
+    if (pid == -1)
+    {
+        close(fds[0]);
+        close(fds[1]);
+        return -1;
+    }
+
+    if (pid == 0)
+    {
+        struct result child = *res;
+
+        close(fds[0]);
+        child.status = vlc_demux_bench_path(demux, res->path, &child.stats);
+        if (write(fds[1], &child, sizeof (child)) != sizeof (child))
+            _exit(1);
+        _exit(0);
+    }
+
+    close(fds[1]);
+
+    ssize_t len = read(fds[0], res, sizeof (*res));
+    close(fds[0]);
+
+    struct rusage ru;
+    int wstatus;
+
+    while (wait4(pid, &wstatus, 0, &ru) == -1)
+        if (errno != EINTR)
+            return -1;
+
+    if (len != sizeof (*res) || !WIFEXITED(wstatus)
+     || WEXITSTATUS(wstatus) != 0)
+    {   /* The demuxer crashed */
+        res->status = -1;
+        memset(&res->stats, 0, sizeof (res->stats));
+        strcpy(res->stats.module, "crash");
+    }
+    res->peak_rss = ru.ru_maxrss;
+#ifdef __APPLE__
+    res->peak_rss /= 1024; /* Darwin reports bytes */
+#endif
+    return 0;
+}
+
+static struct summary *summary_find(struct summary *tab, size_t *count,
+                                    const char *module)
+{
+    for (size_t i = 0; i < *count; i++)
+        if (!strcmp(tab[i].module, module))
+            return &tab[i];
+
+    struct summary *sum = &tab[(*count)++];
+    memset(sum, 0, sizeof (*sum));
+    snprintf(sum->module, sizeof (sum->module), "%s", module);
+    return sum;
+}
+
+static void print_string(const char *str)
+{
+    putchar('"');
+    for (; *str; str++)
+    {
+        if (*str == '"' || *str == '\\')
+            putchar('\\');
+        if ((unsigned char)*str < 0x20)
+            printf("\\u%04x", *str);
+        else
+            putchar(*str);
+    }
+    putchar('"');
+}
+
+static void print_summary(const struct summary *sum)
+{
+    printf("{\"files\": %u, \"mb_per_s\": %.3f, \"blocks_per_s\": %.1f, "
+           "\"pool_allocs_per_block\": %.3f, \"peak_rss_kib\": %ld}",
+           sum->files, mb_per_s(sum->bytes, sum->duration),
+           per_s(sum->blocks, sum->duration),
+           per_block(sum->pool_allocs, sum->blocks), sum->peak_rss);
+}
+
+/**
+ * Compares the per-demuxer figures against a baseline report.
+ * Each demuxer summary is on a line of its own, as printed by main().
+ */
+static int compare(const char *baseline, const struct summary *tab,
+                   size_t count, double tolerance)
+{
+    FILE *stream = fopen(baseline, "rt");
+    if (stream == NULL)
+    {
+        perror(baseline);
+        return -1;
+    }
+
+    char line[1024];
+    bool in_demuxers = false;
+    int regressions = 0;
+
+    while (fgets(line, sizeof (line), stream) != NULL)
+    {
+        if (strstr(line, "\"demuxers\"") != NULL)
+        {
+            in_demuxers = true;
+            continue;
+        }
+        if (!in_demuxers)
+            continue;
+
+        char module[32];
+        unsigned files;
+        double mbps, bps, apb;
+        long rss;
+
+        if (sscanf(line, " \"%31[^\"]\": {\"files\": %u, \"mb_per_s\": %lf, "
+                   "\"blocks_per_s\": %lf, \"pool_allocs_per_block\": %lf, "
+                   "\"peak_rss_kib\": %ld}", module, &files, &mbps, &bps,
+                   &apb, &rss) != 6)
+            continue;
+
+        const struct summary *sum = NULL;
+        for (size_t i = 0; i < count; i++)
+            if (!strcmp(tab[i].module, module))
+                sum = &tab[i];
+        if (sum == NULL)
+        {
+            fprintf(stderr, "%s: not in this run\n", module);
+            continue;
+        }
+
+        double now_mbps = mb_per_s(sum->bytes, sum->duration);
+        double now_apb = per_block(sum->pool_allocs, sum->blocks);
+        double slack = 1. + tolerance / 100.;
+
+        if (now_mbps * slack < mbps)
+        {
+            fprintf(stderr, "%s: throughput regressed: %.3f -> %.3f MB/s\n",
+                    module, mbps, now_mbps);
+            regressions++;
+        }
+        /* Ignore differences below one allocation per hundred blocks */
+        if (now_apb > apb * slack && now_apb > apb + .01)
+        {
+            fprintf(stderr, "%s: pool allocations regressed: %.3f -> %.3f "
+                    "per block\n", module, apb, now_apb);
+            regressions++;
+        }
+        if (sum->peak_rss > rss * slack)
+        {
+            fprintf(stderr, "%s: peak RSS regressed: %ld -> %ld KiB\n",
+                    module, rss, sum->peak_rss);
+            regressions++;
+        }
+    }
+    fclose(stream);
+    return regressions;
+}
+
+static int cmpstringp(const void *a, const void *b)
+{
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+/** Expands directories (one level) into their regular files. */
+static void add_path(const char *path, char ***paths, size_t *count)
+{
+    struct stat st;
+    DIR *dir;
+
+    if (stat(path, &st) == 0 && S_ISDIR(st.st_mode)
+     && (dir = opendir(path)) != NULL)
+    {
+        size_t first = *count;
+        struct dirent *ent;
+
+        while ((ent = readdir(dir)) != NULL)
+        {
+            char *file;
+
+            if (ent->d_name[0] == '.'
+             || asprintf(&file, "%s/%s", path, ent->d_name) == -1)
+                continue;
+            if (stat(file, &st) || !S_ISREG(st.st_mode))
+            {
+                free(file);
+                continue;
+            }
+            *paths = realloc(*paths, (*count + 1) * sizeof (**paths));
+            if (*paths == NULL)
+                abort();
+            (*paths)[(*count)++] = file;
+        }
+        closedir(dir);
+        qsort(*paths + first, *count - first, sizeof (**paths), cmpstringp);
+        return;
+    }
+
+    *paths = realloc(*paths, (*count + 1) * sizeof (**paths));
+    if (*paths == NULL)
+        abort();
+    (*paths)[(*count)++] = strdup(path);
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "Usage: %s [-d demux] [-n runs] [-c baseline.json [-t percent]] "
+            "<file|directory>...\n"
+            "  -d  force the demuxer (default: probe)\n"
+            "  -n  runs per file, the fastest successful one is kept "
+            "(default: 1)\n"
+            "  -c  compare against a previous report\n"
+            "  -t  regression tolerance in percent (default: 10)\n",
+            name);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *demux = NULL, *baseline = NULL;
+    double tolerance = 10.;
+    unsigned runs = 1;
+    int c;
+
+    while ((c = getopt(argc, argv, "c:d:n:t:h")) != -1)
+        switch (c)
+        {
+            case 'c':
+                baseline = optarg;
+                break;
+            case 'd':
+                demux = optarg;
+                break;
+            case 'n':
+                runs = strtoul(optarg, NULL, 10);
+                if (runs == 0)
+                    runs = 1;
+                break;
+            case 't':
+                tolerance = strtod(optarg, NULL);
+                break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+
+    if (optind >= argc)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    char **paths = NULL;
+    size_t count = 0;
+
+    for (int i = optind; i < argc; i++)
+        add_path(argv[i], &paths, &count);
+
+    struct result *results = calloc(count, sizeof (*results));
+    struct summary *sums = calloc(count, sizeof (*sums));
+    size_t nsums = 0;
+    if (results == NULL || sums == NULL)
+        abort();
+
+    for (size_t i = 0; i < count; i++)
+    {
+        struct result *res = &results[i];
+
+        res->path = paths[i];
+        res->status = -1;
+        for (unsigned r = 0; r < runs; r++)
+        {
+            struct result run = { .path = paths[i] };
+
+            if (bench_file(demux, &run))
+            {
+                perror(paths[i]);
+                run.status = -1;
+            }
+            /* A failed run is only reported if no run succeeded */
+            if (res->status != 0 || (run.status == 0
+                                  && run.stats.duration < res->stats.duration))
+                *res = run;
+        }
+        fprintf(stderr, "%s: %s, %.3f MB/s\n", res->path, res->stats.module,
+                mb_per_s(res->stats.bytes, res->stats.duration));
+
+        if (res->status != 0 || res->stats.module[0] == '\0')
+            continue;
+
+        struct summary *sum = summary_find(sums, &nsums, res->stats.module);
+        sum->files++;
+        sum->bytes += res->stats.bytes;
+        sum->blocks += res->stats.blocks;
+        sum->pool_allocs += res->stats.pool_allocs;
+        sum->duration += res->stats.duration;
+        if (res->peak_rss > sum->peak_rss)
+            sum->peak_rss = res->peak_rss;
+    }
+
+    /* Report */
+    printf("{\n  \"files\": [\n");
+    for (size_t i = 0; i < count; i++)
+    {
+        const struct result *res = &results[i];
+        const struct vlc_demux_run_stats *st = &res->stats;
+
+        printf("    {\"path\": ");
+        print_string(res->path);
+        printf(", \"demux\": ");
+        print_string(st->module);
+        printf(", \"status\": %d, \"bytes\": %"PRIu64", \"blocks\": %"PRIu64
+               ", \"payload\": %"PRIu64", \"pool_allocs\": %"PRIu64
+               ", \"seconds\": %.6f, \"mb_per_s\": %.3f, "
+               "\"blocks_per_s\": %.1f, \"pool_allocs_per_block\": %.3f, "
+               "\"peak_rss_kib\": %ld}%s\n",
+               res->status, st->bytes, st->blocks, st->payload,
+               st->pool_allocs,
+               st->duration / 1000000., mb_per_s(st->bytes, st->duration),
+               per_s(st->blocks, st->duration),
+               per_block(st->pool_allocs, st->blocks), res->peak_rss,
+               (i + 1 < count) ? "," : "");
+    }
+    printf("  ],\n  \"demuxers\": {\n");
+    for (size_t i = 0; i < nsums; i++)
+    {
+        printf("    ");
+        print_string(sums[i].module);
+        printf(": ");
+        print_summary(&sums[i]);
+        printf("%s\n", (i + 1 < nsums) ? "," : "");
+    }
+    printf("  }\n}\n");
+
+    int ret = 0;
+    for (size_t i = 0; i < count; i++)
+        if (results[i].status != 0)
+            ret = 1;
+
+    if (baseline != NULL)
+    {
+        int regressions = compare(baseline, sums, nsums, tolerance);
+        if (regressions != 0)
+            ret = 2;
+    }
+
+    for (size_t i = 0; i < count; i++)
+        free(paths[i]);
+    free(paths);
+    free(results);
+    free(sums);
+    return ret;
+}